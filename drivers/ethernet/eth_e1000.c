@@ -89,35 +89,149 @@ static enum ethernet_hw_caps e1000_caps(const struct device *dev)
 		ETHERNET_LINK_1000BASE_T;
 }
 
-static int e1000_tx(struct e1000_dev *dev, void *buf, size_t len)
+static inline uint16_t e1000_tx_next(uint16_t idx)
 {
-	hexdump(buf, len, "%zu byte(s)", len);
+	return (idx + 1) % E1000_TX_DESC_COUNT;
+}
+
+static inline int e1000_tx_free(struct e1000_dev *dev)
+{
+	/* One descriptor is kept unused so that a full ring can be told
+	 * apart from an empty one.
+	 */
+	return (dev->tx_head + E1000_TX_DESC_COUNT - dev->tx_tail - 1) %
+		E1000_TX_DESC_COUNT;
+}
+
+/* Release the fragments of the descriptors the hardware is done with */
+static void e1000_tx_clean(struct e1000_dev *dev)
+{
+	while (dev->tx_head != dev->tx_tail) {
+		volatile struct e1000_tx *desc = &dev->tx[dev->tx_head];
 
-	dev->tx.addr = POINTER_TO_INT(buf);
-	dev->tx.len = len;
-	dev->tx.cmd = TDESC_EOP | TDESC_RS;
+		if (!(desc->sta & TDESC_STA_DD)) {
+			break;
+		}
+
+		if (dev->tx_bufs[dev->tx_head]) {
+			net_buf_unref(dev->tx_bufs[dev->tx_head]);
+			dev->tx_bufs[dev->tx_head] = NULL;
+		}
+
+		desc->sta = 0U;
+		dev->tx_head = e1000_tx_next(dev->tx_head);
+	}
+}
 
-	iow32(dev, TDT, 1);
+static void e1000_tx_kick(struct e1000_dev *dev)
+{
+	iow32(dev, TDT, dev->tx_tail);
+}
 
-	while (!(dev->tx.sta)) {
+static void e1000_tx_wait(struct e1000_dev *dev, int count)
+{
+	e1000_tx_clean(dev);
+
+	while (e1000_tx_free(dev) < count) {
+		e1000_tx_kick(dev);
 		k_yield();
+		e1000_tx_clean(dev);
 	}
+}
+
+static void e1000_tx_desc(struct e1000_dev *dev, void *buf, size_t len,
+			  struct net_buf *ref, bool last)
+{
+	volatile struct e1000_tx *desc = &dev->tx[dev->tx_tail];
+
+	hexdump(buf, len, "%zu byte(s)", len);
 
-	LOG_DBG("tx.sta: 0x%02hx", dev->tx.sta);
+	desc->addr = POINTER_TO_INT(buf);
+	desc->len = len;
+	desc->sta = 0U;
+	desc->cmd = TDESC_RS | (last ? TDESC_EOP : 0);
 
-	return (dev->tx.sta & TDESC_STA_DD) ? 0 : -EIO;
+	dev->tx_bufs[dev->tx_tail] = ref;
+	dev->tx_tail = e1000_tx_next(dev->tx_tail);
 }
 
-static int e1000_send(const struct device *ddev, struct net_pkt *pkt)
+/* Frames with more fragments than there are descriptors are copied to
+ * the bounce buffer, which can be reused only when the ring is empty.
+ */
+static int e1000_tx_linear(struct e1000_dev *dev, struct net_pkt *pkt)
 {
-	struct e1000_dev *dev = ddev->data;
 	size_t len = net_pkt_get_len(pkt);
 
+	e1000_tx_wait(dev, E1000_TX_DESC_COUNT - 1);
+
 	if (net_pkt_read(pkt, dev->txb, len)) {
 		return -EIO;
 	}
 
-	return e1000_tx(dev, dev->txb, len);
+	e1000_tx_desc(dev, dev->txb, len, NULL, true);
+
+	return 0;
+}
+
+static int e1000_send(const struct device *ddev, struct net_pkt *pkt)
+{
+	struct e1000_dev *dev = ddev->data;
+	struct net_buf *frag;
+	int count = 0;
+	int ret = 0;
+
+	for (frag = pkt->buffer; frag; frag = frag->frags) {
+		if (frag->len) {
+			count++;
+		}
+	}
+
+	if (count == 0) {
+		ret = -ENODATA;
+		goto out;
+	}
+
+	if (count > E1000_TX_DESC_COUNT - 1) {
+		ret = e1000_tx_linear(dev, pkt);
+		goto out;
+	}
+
+	e1000_tx_wait(dev, count);
+
+	/* One descriptor per fragment, the fragments are kept alive until
+	 * the hardware has read them.
+	 */
+	for (frag = pkt->buffer; frag; frag = frag->frags) {
+		if (!frag->len) {
+			continue;
+		}
+
+		e1000_tx_desc(dev, frag->data, frag->len, net_buf_ref(frag),
+			      --count == 0);
+	}
+
+out:
+	/* More frames to follow, let them be posted before starting the
+	 * transmission. A failed frame might not be followed by the rest
+	 * of the batch, so do not leave the posted ones waiting.
+	 */
+	if (ret < 0 || !net_pkt_tx_more(pkt)) {
+		e1000_tx_kick(dev);
+	}
+
+	return ret;
+}
+
+static void e1000_tx_flush(const struct device *ddev)
+{
+	struct e1000_dev *dev = ddev->data;
+
+	e1000_tx_kick(dev);
+
+	/* Nothing more might be sent for a while, release what the
+	 * hardware is already done with.
+	 */
+	e1000_tx_clean(dev);
 }
 
 static struct net_pkt *e1000_rx(struct e1000_dev *dev)
@@ -229,11 +343,14 @@ int e1000_probe(const struct device *ddev)
 	device_map(&dev->address, mbar.phys_addr, mbar.size,
 		   K_MEM_CACHE_NONE);
 
-	/* Setup TX descriptor */
+	/* Setup TX descriptor ring */
+
+	dev->tx_head = 0U;
+	dev->tx_tail = 0U;
 
-	iow32(dev, TDBAL, (uint32_t) &dev->tx);
+	iow32(dev, TDBAL, (uint32_t) dev->tx);
 	iow32(dev, TDBAH, 0);
-	iow32(dev, TDLEN, 1*16);
+	iow32(dev, TDLEN, sizeof(dev->tx));
 
 	iow32(dev, TDH, 0);
 	iow32(dev, TDT, 0);
@@ -299,6 +416,7 @@ static const struct ethernet_api e1000_api = {
 	.iface_api.init		= e1000_iface_init,
 	.get_capabilities	= e1000_caps,
 	.send			= e1000_send,
+	.tx_flush		= e1000_tx_flush,
 };
 
 ETH_NET_DEVICE_DT_INST_DEFINE(0,
@@ -32,6 +32,9 @@ extern "C" {
 
 #define ETH_ALEN 6	/* TODO: Add a global reusable definition in OS */
 
+/* The TX ring length needs to be a multiple of 128 bytes */
+#define E1000_TX_DESC_COUNT 8
+
 enum e1000_reg_t {
 	CTRL	= 0x0000,	/* Device Control */
 	ICR	= 0x00C0,	/* Interrupt Cause Read */
@@ -75,8 +78,14 @@ struct e1000_rx {
 };
 
 struct e1000_dev {
-	volatile struct e1000_tx tx __aligned(16);
+	volatile struct e1000_tx tx[E1000_TX_DESC_COUNT] __aligned(16);
 	volatile struct e1000_rx rx __aligned(16);
+	/* Packet fragments referenced by the TX descriptors */
+	struct net_buf *tx_bufs[E1000_TX_DESC_COUNT];
+	/* Oldest TX descriptor not yet reclaimed */
+	uint16_t tx_head;
+	/* Next free TX descriptor */
+	uint16_t tx_tail;
 	mm_reg_t address;
 	/* If VLAN is enabled, there can be multiple VLAN interfaces related to
 	 * this physical device. In that case, this iface pointer value is not
@@ -48,6 +48,7 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 struct eth_context {
 	uint8_t recv[NET_ETH_MTU + ETH_HDR_LEN];
 	uint8_t send[NET_ETH_MTU + ETH_HDR_LEN];
+	struct net_pkt *rx_batch[CONFIG_NET_RX_BATCH_BUDGET];
 	uint8_t mac_addr[6];
 	struct net_linkaddr ll_addr;
 	struct net_if *iface;
@@ -178,22 +179,54 @@ static void update_gptp(struct net_if *iface, struct net_pkt *pkt,
 #define update_gptp(iface, pkt, send)
 #endif /* CONFIG_NET_GPTP */
 
+/* Pass the packet fragments to the host as is, without copying them to
+ * the send buffer first. Returns -E2BIG if the packet has too many
+ * fragments for one write.
+ */
+static int eth_send_vec(struct eth_context *ctx, struct net_pkt *pkt)
+{
+	void *bufs[ETH_NATIVE_POSIX_MAX_IOV];
+	size_t lens[ETH_NATIVE_POSIX_MAX_IOV];
+	struct net_buf *frag;
+	int count = 0;
+
+	for (frag = pkt->buffer; frag; frag = frag->frags) {
+		if (!frag->len) {
+			continue;
+		}
+
+		if (count == ETH_NATIVE_POSIX_MAX_IOV) {
+			return -E2BIG;
+		}
+
+		bufs[count] = frag->data;
+		lens[count] = frag->len;
+		count++;
+	}
+
+	return eth_write_data_vec(ctx->dev_fd, bufs, lens, count);
+}
+
 static int eth_send(const struct device *dev, struct net_pkt *pkt)
 {
 	struct eth_context *ctx = dev->data;
 	int count = net_pkt_get_len(pkt);
 	int ret;
 
-	ret = net_pkt_read(pkt, ctx->send, count);
-	if (ret) {
-		return ret;
-	}
-
 	update_gptp(net_pkt_iface(pkt), pkt, true);
 
 	LOG_DBG("Send pkt %p len %d", pkt, count);
 
-	ret = eth_write_data(ctx->dev_fd, ctx->send, count);
+	ret = eth_send_vec(ctx, pkt);
+	if (ret == -E2BIG) {
+		ret = net_pkt_read(pkt, ctx->send, count);
+		if (ret) {
+			return ret;
+		}
+
+		ret = eth_write_data(ctx->dev_fd, ctx->send, count);
+	}
+
 	if (ret < 0) {
 		LOG_DBG("Cannot send pkt %p (%d)", pkt, ret);
 	}
@@ -319,7 +352,8 @@ static struct net_pkt *prepare_non_vlan_pkt(struct eth_context *ctx,
 	return pkt;
 }
 
-static int read_data(struct eth_context *ctx, int fd)
+static int read_data(struct eth_context *ctx, int fd, struct net_pkt **ret_pkt,
+		     struct net_if **ret_iface)
 {
 	uint16_t vlan_tag = NET_VLAN_TAG_UNSPEC;
 	struct net_if *iface;
@@ -327,6 +361,8 @@ static int read_data(struct eth_context *ctx, int fd)
 	int status;
 	int count;
 
+	*ret_pkt = NULL;
+
 	count = eth_read_data(fd, ctx->recv, sizeof(ctx->recv));
 	if (count <= 0) {
 		return 0;
@@ -363,21 +399,66 @@ static int read_data(struct eth_context *ctx, int fd)
 
 	update_gptp(iface, pkt, false);
 
-	if (net_recv_data(iface, pkt) < 0) {
-		net_pkt_unref(pkt);
-	}
+	*ret_pkt = pkt;
+	*ret_iface = iface;
 
 	return 0;
 }
 
+static void rx_batch_flush(struct net_if *iface, struct net_pkt **pkts,
+			   int count)
+{
+	int i;
+
+	if (net_recv_data_batch(iface, pkts, count) < 0) {
+		for (i = 0; i < count; i++) {
+			net_pkt_unref(pkts[i]);
+		}
+	}
+}
+
+/* Read up to the RX budget of frames and pass them to the stack in one go.
+ * Frames for different (VLAN) interfaces are passed in separate batches.
+ * Returns the number of frames read.
+ */
+static int read_batch(struct eth_context *ctx, int fd)
+{
+	struct net_if *batch_iface = NULL;
+	struct net_if *iface = NULL;
+	struct net_pkt *pkt;
+	int count = 0;
+	int total = 0;
+
+	while (total < CONFIG_NET_RX_BATCH_BUDGET && !eth_wait_data(fd)) {
+		read_data(ctx, fd, &pkt, &iface);
+		if (!pkt) {
+			break;
+		}
+
+		if (count > 0 && iface != batch_iface) {
+			rx_batch_flush(batch_iface, ctx->rx_batch, count);
+			count = 0;
+		}
+
+		batch_iface = iface;
+		ctx->rx_batch[count++] = pkt;
+		total++;
+	}
+
+	if (count > 0) {
+		rx_batch_flush(batch_iface, ctx->rx_batch, count);
+	}
+
+	return total;
+}
+
 static void eth_rx(struct eth_context *ctx)
 {
 	LOG_DBG("Starting ZETH RX thread");
 
 	while (1) {
 		if (net_if_is_up(ctx->iface)) {
-			while (!eth_wait_data(ctx->dev_fd)) {
-				read_data(ctx, ctx->dev_fd);
+			while (read_batch(ctx, ctx->dev_fd) > 0) {
 				k_yield();
 			}
 		}
@@ -22,6 +22,7 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/select.h>
 #include <net/if.h>
 #include <time.h>
@@ -175,6 +176,23 @@ ssize_t eth_write_data(int fd, void *buf, size_t buf_len)
 	return write(fd, buf, buf_len);
 }
 
+ssize_t eth_write_data_vec(int fd, void **bufs, size_t *lens, int count)
+{
+	struct iovec iov[ETH_NATIVE_POSIX_MAX_IOV];
+	int i;
+
+	if (count > ETH_NATIVE_POSIX_MAX_IOV) {
+		return -E2BIG;
+	}
+
+	for (i = 0; i < count; i++) {
+		iov[i].iov_base = bufs[i];
+		iov[i].iov_len = lens[i];
+	}
+
+	return writev(fd, iov, count);
+}
+
 #if defined(CONFIG_NET_GPTP)
 int eth_clock_gettime(struct net_ptp_time *time)
 {
@@ -14,6 +14,9 @@
 #define ETH_NATIVE_POSIX_DRV_NAME CONFIG_ETH_NATIVE_POSIX_DRV_NAME
 #define ETH_NATIVE_POSIX_DEV_NAME CONFIG_ETH_NATIVE_POSIX_DEV_NAME
 
+/* Max number of packet fragments that are written to host in one go */
+#define ETH_NATIVE_POSIX_MAX_IOV 16
+
 #if defined(CONFIG_ETH_NATIVE_POSIX_STARTUP_AUTOMATIC)
 #define ETH_NATIVE_POSIX_SETUP_SCRIPT CONFIG_ETH_NATIVE_POSIX_SETUP_SCRIPT
 #define ETH_NATIVE_POSIX_STARTUP_SCRIPT CONFIG_ETH_NATIVE_POSIX_STARTUP_SCRIPT
@@ -32,6 +35,7 @@ int eth_start_script(const char *if_name);
 int eth_wait_data(int fd);
 ssize_t eth_read_data(int fd, void *buf, size_t buf_len);
 ssize_t eth_write_data(int fd, void *buf, size_t buf_len);
+ssize_t eth_write_data_vec(int fd, void **bufs, size_t *lens, int count);
 int eth_if_up(const char *if_name);
 int eth_if_down(const char *if_name);
 
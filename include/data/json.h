@@ -8,6 +8,7 @@
 #define ZEPHYR_INCLUDE_DATA_JSON_H_
 
 #include <sys/util.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <zephyr/types.h>
 #include <sys/types.h>
@@ -43,6 +44,7 @@ enum json_tokens {
 	JSON_TOK_COLON = ':',
 	JSON_TOK_COMMA = ',',
 	JSON_TOK_NUMBER = '0',
+	JSON_TOK_INT64 = '5',
 	JSON_TOK_TRUE = 't',
 	JSON_TOK_FALSE = 'f',
 	JSON_TOK_NULL = 'n',
@@ -64,7 +66,7 @@ struct json_obj_descr {
 	uint32_t field_name_len : 7;
 
 	/* Valid values here (enum json_tokens): JSON_TOK_STRING,
-	 * JSON_TOK_NUMBER, JSON_TOK_TRUE, JSON_TOK_FALSE,
+	 * JSON_TOK_NUMBER, JSON_TOK_INT64, JSON_TOK_TRUE, JSON_TOK_FALSE,
 	 * JSON_TOK_OBJECT_START, JSON_TOK_LIST_START.  (All others
 	 * ignored.) Maximum value is '}' (125), so this has to be 7 bits
 	 * long.
@@ -115,7 +117,8 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  *
  * @param type_ Token type for JSON value corresponding to a primitive
  * type. Must be one of: JSON_TOK_STRING for strings, JSON_TOK_NUMBER
- * for numbers, JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
+ * for numbers (int32_t), JSON_TOK_INT64 for int64_t numbers,
+ * JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
  *
  * Here's an example of use:
  *
@@ -571,7 +574,8 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  * (1) strings are not unescaped (but only valid escape sequences are
  * accepted);
  * (2) no UTF-8 validation is performed; and
- * (3) only integer numbers are supported (no strtod() in the minimal libc).
+ * (3) only integer numbers are supported (no strtod() in the minimal libc);
+ * they are decoded as int32_t, or as int64_t for JSON_TOK_INT64 fields.
  *
  * @param json Pointer to JSON-encoded value to be parsed
  *
@@ -711,6 +715,201 @@ int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
 int json_arr_encode(const struct json_obj_descr *descr, const void *val,
 		    json_append_bytes_t append_bytes, void *data);
 
+/** Maximum nesting of objects and arrays in a streamed document */
+#define JSON_STREAM_MAX_DEPTH 8
+
+/** @cond INTERNAL_HIDDEN */
+struct json_obj_stream_frame {
+	const struct json_obj_descr *descr;
+	void *val;
+	char *field;
+	size_t left;
+	ptrdiff_t elem_size;
+	uint32_t decoded;
+	bool array;
+};
+/** @endcond */
+
+/**
+ * @brief Incremental decoder, see json_obj_stream_init()
+ *
+ * All fields are private.
+ */
+struct json_obj_stream {
+	/** @cond INTERNAL_HIDDEN */
+	struct json_obj_stream_frame frames[JSON_STREAM_MAX_DEPTH];
+
+	/* value being decoded, descr is NULL for skipped values */
+	const struct json_obj_descr *descr;
+	void *field;
+	void *val;
+
+	/* object key being matched */
+	uint32_t candidates;
+	size_t key_len;
+
+	/* number being decoded */
+	uint64_t num;
+	uint8_t num_flags;
+
+	/* true / false being matched */
+	const char *literal;
+	uint8_t literal_pos;
+
+	uint8_t depth;
+	uint8_t state;
+	uint8_t escape;
+
+	/* storage for decoded strings */
+	char *str_buf;
+	size_t str_buf_size;
+	size_t str_used;
+	size_t str_start;
+
+	int result;
+	/** @endcond */
+};
+
+/**
+ * @brief Prepares the incremental decoding of an object
+ *
+ * Unlike json_obj_parse(), the document doesn't need to be available in a
+ * single buffer: it's pushed to json_obj_stream_feed() in chunks of any
+ * size, as they are received, and the fields are decoded on the fly. The
+ * same documents are accepted, with the same limitations, and objects or
+ * arrays under keys which are not in the descriptor are skipped.
+ *
+ * The input chunks don't need to be kept around: decoded strings are
+ * copied, NUL terminated, to @a str_buf and the JSON_TOK_STRING fields
+ * point there.
+ *
+ * @param stream Decoder state
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array. Must be less
+ * than 31.
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @param str_buf Storage for the decoded strings, may be NULL if there
+ * are none
+ *
+ * @param str_buf_size Size of @a str_buf
+ */
+void json_obj_stream_init(struct json_obj_stream *stream,
+			  const struct json_obj_descr *descr, size_t descr_len,
+			  void *val, char *str_buf, size_t str_buf_size);
+
+/**
+ * @brief Decodes the next chunk of a document
+ *
+ * @param stream Decoder state, see json_obj_stream_init()
+ *
+ * @param data Next bytes of the document
+ *
+ * @param len Number of bytes in @a data
+ *
+ * @return -EAGAIN if all of @a data has been consumed and the object
+ * isn't complete yet. Once complete, the bitmap of decoded fields, as
+ * returned by json_obj_parse(); any bytes after the object are ignored.
+ * -ENOMEM if the document is nested too deeply or @a str_buf is too
+ * small, -ENOSPC if an array has too many elements, -ERANGE if a number
+ * doesn't fit its field, other negative values on invalid documents.
+ * Errors and completion are sticky.
+ */
+int json_obj_stream_feed(struct json_obj_stream *stream, const char *data,
+			 size_t len);
+
+/**
+ * @brief Buffered output for the encoders, see json_out_stream_init()
+ *
+ * All fields are private.
+ */
+struct json_out_stream {
+	/** @cond INTERNAL_HIDDEN */
+	char *buf;
+	size_t size;
+	size_t used;
+	json_append_bytes_t flush;
+	void *data;
+	/** @endcond */
+};
+
+/**
+ * @brief Prepares buffered encoding
+ *
+ * The encoders emit small pieces at a time, a brace, a key, an escaped
+ * character. json_out_stream_append() gathers them in a fixed-size buffer
+ * which is handed to @a flush whenever it fills up, so a socket or a
+ * flash page sees few large writes and the whole document never has to
+ * be in memory.
+ *
+ * @param out Output state
+ *
+ * @param buf Buffer, its size is the largest chunk passed to @a flush
+ *
+ * @param size Size of @a buf
+ *
+ * @param flush Function called with each full (or the final) chunk
+ *
+ * @param data Data pointer to be passed to @a flush
+ */
+void json_out_stream_init(struct json_out_stream *out, char *buf,
+			  size_t size, json_append_bytes_t flush, void *data);
+
+/**
+ * @brief json_append_bytes_t appending to a json_out_stream
+ *
+ * Can be given to json_obj_encode() or json_arr_encode(), with the
+ * json_out_stream as data pointer.
+ *
+ * @return 0 on success, or the error returned by the flush function.
+ */
+int json_out_stream_append(const char *bytes, size_t len, void *data);
+
+/**
+ * @brief Passes any buffered bytes to the flush function
+ *
+ * @param out Output state
+ *
+ * @return 0 on success, or the error returned by the flush function.
+ */
+int json_out_stream_flush(struct json_out_stream *out);
+
+/**
+ * @brief Encodes an object to a json_out_stream and flushes it
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Struct holding the values
+ *
+ * @param out Output state, see json_out_stream_init()
+ *
+ * @return 0 if object has been successfully encoded. A negative value
+ * indicates an error.
+ */
+int json_obj_encode_stream(const struct json_obj_descr *descr,
+			   size_t descr_len, const void *val,
+			   struct json_out_stream *out);
+
+/**
+ * @brief Encodes an array to a json_out_stream and flushes it
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param val Struct holding the values
+ *
+ * @param out Output state, see json_out_stream_init()
+ *
+ * @return 0 if object has been successfully encoded. A negative value
+ * indicates an error.
+ */
+int json_arr_encode_stream(const struct json_obj_descr *descr,
+			   const void *val, struct json_out_stream *out);
+
 #ifdef __cplusplus
 }
 #endif
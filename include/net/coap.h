@@ -73,6 +73,9 @@ enum coap_method {
 	COAP_METHOD_POST = 2,
 	COAP_METHOD_PUT = 3,
 	COAP_METHOD_DELETE = 4,
+	COAP_METHOD_FETCH = 5,
+	COAP_METHOD_PATCH = 6,
+	COAP_METHOD_IPATCH = 7,
 };
 
 #define COAP_REQUEST_MASK 0x07
@@ -216,6 +219,7 @@ struct coap_resource {
  */
 struct coap_observer {
 	sys_snode_t list;
+	sys_snode_t table_node;
 	struct sockaddr addr;
 	uint8_t token[8];
 	uint8_t tkl;
@@ -511,6 +515,84 @@ int coap_handle_request(struct coap_packet *cpkt,
 			uint8_t opt_num,
 			struct sockaddr *addr, socklen_t addr_len);
 
+/**
+ * @brief Node of a resource index.
+ */
+struct coap_resource_index_node {
+	const char *segment;
+	struct coap_resource *resource;
+	uint16_t child;
+	uint16_t sibling;
+	uint8_t len;
+};
+
+/**
+ * @brief Path trie of a resource table.
+ *
+ * Resolves the resource addressed by a request in a single walk over its
+ * URI-Path options, instead of comparing the path of every resource.
+ */
+struct coap_resource_index {
+	struct coap_resource_index_node *nodes;
+	uint16_t num_nodes;
+	uint16_t used;
+};
+
+/**
+ * @brief Build the index of a resource table.
+ *
+ * The table must not change while the index is in use. One node is needed
+ * for each distinct path prefix of the table, plus one for the root: at
+ * most one node per path segment, plus one.
+ *
+ * @param index Index to initialize
+ * @param resources Array of known resources, terminated by an empty entry
+ * @param nodes Storage for the nodes of the index
+ * @param num_nodes Number of nodes in @a nodes
+ *
+ * @return 0 in case of success, -ENOMEM if @a nodes is too small, or
+ * -EINVAL if a path segment is too long.
+ */
+int coap_resource_index_init(struct coap_resource_index *index,
+			     struct coap_resource *resources,
+			     struct coap_resource_index_node *nodes,
+			     uint16_t num_nodes);
+
+/**
+ * @brief Find the resource addressed by a request.
+ *
+ * The same resource as coap_handle_request() would use is returned,
+ * i.e. the first one of the table matching the path, wildcards included.
+ *
+ * @param index Index of the resource table
+ * @param options Parsed options from coap_packet_parse()
+ * @param opt_num Number of options
+ *
+ * @return A pointer to the resource, NULL if none matches.
+ */
+struct coap_resource *coap_resource_index_find(
+	const struct coap_resource_index *index,
+	const struct coap_option *options, uint8_t opt_num);
+
+/**
+ * @brief When a request is received, call the appropriate methods of
+ * the matching resource, found with an index of the resource table.
+ *
+ * @param cpkt Packet received
+ * @param index Index of the known resources
+ * @param options Parsed options from coap_packet_parse()
+ * @param opt_num Number of options
+ * @param addr Peer address
+ * @param addr_len Peer address length
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_handle_request_index(struct coap_packet *cpkt,
+			      const struct coap_resource_index *index,
+			      struct coap_option *options,
+			      uint8_t opt_num,
+			      struct sockaddr *addr, socklen_t addr_len);
+
 /**
  * Represents the size of each block that will be transferred using
  * block-wise transfers [RFC7959]:
@@ -710,6 +792,58 @@ struct coap_observer *coap_find_observer_by_addr(
 struct coap_observer *coap_observer_next_unused(
 	struct coap_observer *observers, size_t len);
 
+/**
+ * @brief Observers indexed by the address of the remote device.
+ */
+struct coap_observer_table {
+	sys_slist_t *buckets;
+	uint16_t num_buckets;
+};
+
+/**
+ * @brief Initialize an observer table.
+ *
+ * @param table Table to initialize
+ * @param buckets Storage for the hash buckets of the table
+ * @param num_buckets Number of buckets, the table is fastest with at least
+ * as many buckets as remote devices.
+ */
+void coap_observer_table_init(struct coap_observer_table *table,
+			      sys_slist_t *buckets, uint16_t num_buckets);
+
+/**
+ * @brief Add an initialized observer to a table.
+ *
+ * @param table Observer table
+ * @param observer Observer to be added
+ */
+void coap_observer_table_add(struct coap_observer_table *table,
+			     struct coap_observer *observer);
+
+/**
+ * @brief Remove an observer from a table.
+ *
+ * @param table Observer table
+ * @param observer Observer to be removed
+ */
+void coap_observer_table_remove(struct coap_observer_table *table,
+				struct coap_observer *observer);
+
+/**
+ * @brief Returns the observer of a table matching an address and a token.
+ *
+ * @param table Observer table
+ * @param addr Address of the endpoint observing a resource
+ * @param token Token of the observation, NULL to match any token
+ * @param tkl Length of the token
+ *
+ * @return A pointer to a observer if a match is found, NULL
+ * otherwise.
+ */
+struct coap_observer *coap_observer_table_find(
+	const struct coap_observer_table *table,
+	const struct sockaddr *addr, const uint8_t *token, uint8_t tkl);
+
 /**
  * @brief Indicates that a reply is expected for @a request.
  *
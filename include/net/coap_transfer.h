@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief CoAP block-wise transfers.
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_COAP_TRANSFER_H_
+#define ZEPHYR_INCLUDE_NET_COAP_TRANSFER_H_
+
+#include <net/coap.h>
+
+/**
+ * @addtogroup coap COAP Library
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest ETag allowed by RFC 7252 */
+#define COAP_TRANSFER_ETAG_MAX_LEN 8
+
+struct coap_transfer;
+
+/**
+ * @typedef coap_transfer_send_t
+ * @brief Type of the callback sending a message of a transfer to the peer.
+ *
+ * @param xfer Transfer the message belongs to
+ * @param data Encoded CoAP message
+ * @param len Length of the message
+ *
+ * @return 0 on success, a negative error code otherwise.
+ */
+typedef int (*coap_transfer_send_t)(struct coap_transfer *xfer,
+				    const uint8_t *data, uint16_t len);
+
+/**
+ * @typedef coap_transfer_data_t
+ * @brief Type of the callback receiving the blocks of a download.
+ *
+ * Called once for each block. With more than one block in flight, the
+ * blocks may not arrive in order, hence the offset of each block in the
+ * resource is given.
+ *
+ * @param xfer Transfer the block belongs to
+ * @param offset Offset of the block in the resource
+ * @param data Block data
+ * @param len Length of the block
+ *
+ * @return 0 to continue the transfer, a negative error code to abort it.
+ */
+typedef int (*coap_transfer_data_t)(struct coap_transfer *xfer,
+				    size_t offset, const uint8_t *data,
+				    uint16_t len);
+
+/**
+ * @typedef coap_transfer_read_t
+ * @brief Type of the callback providing the blocks of an upload.
+ *
+ * A block may be read again when its request is retransmitted, the same
+ * data must be returned every time.
+ *
+ * @param xfer Transfer the block belongs to
+ * @param offset Offset of the block in the resource
+ * @param buf Buffer to fill
+ * @param len Length of the block
+ *
+ * @return Number of bytes read, a negative error code to abort the transfer.
+ */
+typedef int (*coap_transfer_read_t)(struct coap_transfer *xfer,
+				    size_t offset, uint8_t *buf,
+				    uint16_t len);
+
+/**
+ * @typedef coap_transfer_done_t
+ * @brief Type of the callback notified at the end of a transfer.
+ *
+ * @param xfer Finished transfer
+ * @param result 0 on success, -EIO if the peer answered with an error code,
+ *        -ECANCELED if the resource changed during a download, -ETIMEDOUT if
+ *        the peer stopped answering, -ECONNRESET if the peer reset the
+ *        exchange, -EPROTO on an invalid response, or the error returned
+ *        by a callback.
+ * @param response Last response received, NULL if none.
+ */
+typedef void (*coap_transfer_done_t)(struct coap_transfer *xfer, int result,
+				     const struct coap_packet *response);
+
+/**
+ * @brief Block-wise transfer of a resource.
+ *
+ * The transfer does not own a socket: messages are handed to the @a send
+ * callback and the datagrams received from the peer are fed back with
+ * coap_transfer_input().
+ */
+struct coap_transfer {
+	/** Address of the peer, for use by the send callback */
+	struct sockaddr addr;
+
+	/** Sends the messages of the transfer */
+	coap_transfer_send_t send;
+
+	/** Receives the blocks of a download */
+	coap_transfer_data_t data;
+
+	/** Provides the blocks of an upload */
+	coap_transfer_read_t read;
+
+	/** Notified at the end of the transfer, may be NULL */
+	coap_transfer_done_t done;
+
+	/** User data */
+	void *user_data;
+
+	/**
+	 * Content-Format of an upload, or Accept option of a download.
+	 * Not sent if negative.
+	 */
+	int content_format;
+
+	/**
+	 * Maximum number of blocks of a download requested at the same time,
+	 * up to CONFIG_COAP_TRANSFER_MAX_BLOCKS_IN_FLIGHT. 0 for the maximum.
+	 */
+	uint8_t window;
+
+	/** Number of retransmissions during the last transfer */
+	uint32_t retransmissions;
+
+	/* Internal state */
+	struct coap_pending pending[CONFIG_COAP_TRANSFER_MAX_BLOCKS_IN_FLIGHT];
+	uint32_t block_num[CONFIG_COAP_TRANSFER_MAX_BLOCKS_IN_FLIGHT];
+	uint32_t in_flight;
+	const char * const *path;
+	struct coap_block_context ctx;
+	uint32_t next_num;
+	uint32_t last_num;
+	uint32_t received;
+	uint8_t token[COAP_TOKEN_MAX_LEN];
+	uint8_t etag[COAP_TRANSFER_ETAG_MAX_LEN];
+	uint8_t etag_len;
+	uint8_t method;
+	bool upload : 1;
+	bool last_known : 1;
+	bool active : 1;
+	uint8_t buf[CONFIG_COAP_TRANSFER_BUF_SIZE];
+};
+
+/**
+ * @brief Start downloading a resource with Block2 transfers.
+ *
+ * The first block is requested alone, together with the size of the
+ * resource. Once the size is known, up to @a window blocks are requested
+ * at the same time, otherwise one block is requested after another. The
+ * block size proposed by the server is used if smaller than @a block_size.
+ * If the ETag of the resource changes during the download, the transfer
+ * ends with -ECANCELED.
+ *
+ * @param xfer Transfer, with the peer address and callbacks set
+ * @param path NULL terminated path of the resource, must remain valid
+ *        until the end of the transfer
+ * @param block_size Preferred block size
+ *
+ * @return 0 if the transfer was started, a negative error code otherwise.
+ */
+int coap_transfer_download(struct coap_transfer *xfer,
+			   const char * const *path,
+			   enum coap_block_size block_size);
+
+/**
+ * @brief Start uploading a resource with Block1 transfers.
+ *
+ * The blocks are sent one after another, each of them once the previous
+ * one is acknowledged by the server. The total size is announced with the
+ * Size1 option in the first block. The block size is reduced if the server
+ * asks for it.
+ *
+ * @param xfer Transfer, with the peer address and callbacks set
+ * @param method COAP_METHOD_PUT or COAP_METHOD_POST
+ * @param path NULL terminated path of the resource, must remain valid
+ *        until the end of the transfer
+ * @param block_size Preferred block size
+ * @param total_size Size of the resource
+ *
+ * @return 0 if the transfer was started, a negative error code otherwise.
+ */
+int coap_transfer_upload(struct coap_transfer *xfer, enum coap_method method,
+			 const char * const *path,
+			 enum coap_block_size block_size, size_t total_size);
+
+/**
+ * @brief Handle a datagram received from the peer.
+ *
+ * @param xfer Transfer
+ * @param data Received datagram
+ * @param len Length of the datagram
+ *
+ * @return 0 if the message was handled, -ENOENT if it does not belong to
+ *         the transfer, -EINVAL if it is not a valid CoAP message.
+ */
+int coap_transfer_input(struct coap_transfer *xfer, uint8_t *data,
+			uint16_t len);
+
+/**
+ * @brief Retransmit the requests which were not acknowledged in time.
+ *
+ * @param xfer Transfer
+ *
+ * @return Time in milliseconds until the function should be called again,
+ *         SYS_FOREVER_MS if no retransmission is scheduled.
+ */
+int32_t coap_transfer_process(struct coap_transfer *xfer);
+
+/**
+ * @brief Abort a transfer, without notifying its done callback.
+ *
+ * @param xfer Transfer
+ */
+void coap_transfer_cancel(struct coap_transfer *xfer);
+
+/**
+ * @brief Check if a transfer is ongoing.
+ *
+ * @param xfer Transfer
+ *
+ * @return true if the transfer is ongoing, false otherwise.
+ */
+static inline bool coap_transfer_is_active(const struct coap_transfer *xfer)
+{
+	return xfer->active;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_COAP_TRANSFER_H_ */
@@ -234,6 +234,14 @@ struct dns_resolve_context {
 		 * cannot be used to find correct pending query.
 		 */
 		uint16_t query_hash;
+
+		/** Query whose DNS request is shared by this query, or NULL
+		 * if this query sent a request of its own. A query sharing
+		 * the request of another one gets the same results at the
+		 * same time. If the owner is cancelled or times out, the
+		 * request is sent again for the queries sharing it.
+		 */
+		struct dns_pending_query *owner;
 	} queries[CONFIG_DNS_NUM_CONCUR_QUERIES];
 
 	/** Is this context in use */
@@ -323,6 +331,11 @@ int dns_resolve_cancel_with_name(struct dns_resolve_context *ctx,
  * We might send the query to multiple servers (if there are more than one
  * server configured), but we only use the result of the first received
  * response.
+ * If a query for the same name and type is already pending in @a ctx, no
+ * new request is sent and the result of the pending one is used instead.
+ * If CONFIG_DNS_RESOLVER_CACHE is enabled and the answer is found in the
+ * cache, the callback is called before this function returns and the
+ * returned DNS id is 0.
  *
  * @param ctx DNS context
  * @param query What the caller wants to resolve.
@@ -348,6 +361,66 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 		     void *user_data,
 		     int32_t timeout);
 
+/**
+ * @brief DNS resolver cache statistics.
+ */
+struct dns_resolve_cache_stats {
+	/** Lookups answered with addresses from the cache */
+	uint32_t hits;
+	/** Lookups answered with a cached negative result */
+	uint32_t negative_hits;
+	/** Lookups not found in the cache */
+	uint32_t misses;
+	/** Unexpired entries removed to make room for new ones */
+	uint32_t evictions;
+	/** Lookups that shared the request of a pending query */
+	uint32_t shared;
+};
+
+/**
+ * @typedef dns_resolve_cache_cb_t
+ * @brief Callback used while iterating over the DNS cache.
+ *
+ * @param query Cached name.
+ * @param type Query type of the entry.
+ * @param addrs Cached addresses.
+ * @param count Number of addresses, 0 for a negative entry.
+ * @param ttl Remaining lifetime of the entry in seconds.
+ * @param user_data A valid pointer to user data or NULL
+ */
+typedef void (*dns_resolve_cache_cb_t)(const char *query,
+				       enum dns_query_type type,
+				       const struct sockaddr *addrs,
+				       int count, uint32_t ttl,
+				       void *user_data);
+
+/**
+ * @brief Get DNS resolver cache statistics.
+ *
+ * @details Only available if CONFIG_DNS_RESOLVER_CACHE is enabled.
+ *
+ * @param stats Statistics are copied here.
+ */
+void dns_resolve_cache_stats_get(struct dns_resolve_cache_stats *stats);
+
+/**
+ * @brief Remove all entries from the DNS resolver cache.
+ *
+ * @details Only available if CONFIG_DNS_RESOLVER_CACHE is enabled.
+ */
+void dns_resolve_cache_flush(void);
+
+/**
+ * @brief Go through all unexpired entries of the DNS resolver cache.
+ *
+ * @details Only available if CONFIG_DNS_RESOLVER_CACHE is enabled. The
+ * cache is locked while the callback is called.
+ *
+ * @param cb User supplied callback function to call.
+ * @param user_data User specified data.
+ */
+void dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data);
+
 /**
  * @brief Get default DNS context.
  *
@@ -285,8 +285,16 @@ struct ethernet_api {
 	const struct device *(*get_ptp_clock)(const struct device *dev);
 #endif /* CONFIG_PTP_CLOCK */
 
-	/** Send a network packet */
+	/** Send a network packet. If net_pkt_tx_more() is set for the packet,
+	 * the driver can postpone starting the transmission until a packet
+	 * without it is sent or tx_flush() is called.
+	 */
 	int (*send)(const struct device *dev, struct net_pkt *pkt);
+
+	/** Start transmitting the packets the driver has postponed. This is
+	 * optional and only needed if the driver checks net_pkt_tx_more().
+	 */
+	void (*tx_flush)(const struct device *dev);
 };
 
 /* Make sure that the network interface API is properly setup inside
@@ -349,6 +357,7 @@ struct ethernet_lldp {
 
 enum ethernet_flags {
 	ETH_CARRIER_UP,
+	ETH_TX_POSTPONED,
 };
 
 /** Ethernet L2 context that is needed for VLAN */
@@ -766,6 +775,20 @@ void net_eth_carrier_off(struct net_if *iface);
  */
 int net_eth_promisc_mode(struct net_if *iface, bool enable);
 
+/**
+ * @brief Start transmitting the packets the driver has postponed.
+ *
+ * Called after the packet ending a TX batch, or a failed packet, has been
+ * handled by the L2. If the last packet given to the driver had
+ * net_pkt_tx_more() set, for example because the packet ending the batch
+ * was consumed or dropped before it reached the driver, the driver's
+ * tx_flush() is called so that the postponed packets are not left
+ * waiting. Otherwise this does nothing.
+ *
+ * @param iface Network interface
+ */
+void net_eth_tx_flush(struct net_if *iface);
+
 /**
  * @brief Return PTP clock that is tied to this ethernet network interface.
  *
@@ -0,0 +1,387 @@
+/** @file
+ * @brief HTTP server API
+ *
+ * An API for applications to serve HTTP/1.1 requests
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_
+#define ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_
+
+/**
+ * @brief HTTP server API
+ * @defgroup http_server HTTP server API
+ * @ingroup networking
+ * @{
+ */
+
+#include <kernel.h>
+#include <net/net_ip.h>
+#include <net/socket.h>
+#include <net/http_parser.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if !defined(HTTP_CRLF)
+#define HTTP_CRLF "\r\n"
+#endif
+
+/** Length of the base64 encoded Sec-WebSocket-Key field value */
+#define HTTP_SERVER_WS_KEY_LEN 24
+
+struct http_server_ctx;
+struct http_server_request;
+struct http_server_response;
+
+/**
+ * @typedef http_server_handler_t
+ * @brief Callback used when a complete request is received for a route.
+ *
+ * The handler is called from the thread running the server, it should
+ * send its response using http_server_send_response() or the
+ * http_server_send_chunked_*() functions before returning. Responses to
+ * pipelined requests are sent in the order the requests were received.
+ * If the client does not read them within CONFIG_HTTP_SERVER_SEND_TIMEOUT,
+ * the send functions fail and the connection is closed.
+ *
+ * @param req Received request, valid only during the callback
+ * @param rsp Response to fill in
+ * @param user_data User data specified in the route
+ *
+ * @return 0 if ok, <0 if there was an error. In that case a
+ *         "500 Internal Server Error" response is sent if nothing was sent
+ *         yet, and the connection is closed.
+ */
+typedef int (*http_server_handler_t)(const struct http_server_request *req,
+				     struct http_server_response *rsp,
+				     void *user_data);
+
+/**
+ * @typedef http_server_websocket_cb_t
+ * @brief Callback used when a connection is upgraded to a Websocket.
+ *
+ * The handshake response has been sent when this is called. The socket
+ * is no longer handled by the server, the application owns it and must
+ * close it when done.
+ *
+ * @param sock Socket of the upgraded connection
+ * @param req Upgrade request, valid only during the callback
+ * @param user_data User data specified in the route
+ */
+typedef void (*http_server_websocket_cb_t)(
+	int sock, const struct http_server_request *req, void *user_data);
+
+/**
+ * HTTP server route. The routes are a static table given to
+ * http_server_init(), the first route matching the request is used.
+ */
+struct http_server_route {
+	/** Path of the resource, for example "/index.html". A path ending
+	 * with '*' matches every path starting with the part before it.
+	 */
+	const char *path;
+
+	/** Handler called for requests to this route */
+	http_server_handler_t handler;
+
+	/** Websocket callback, the route accepts Websocket upgrade requests
+	 * if this is set. Requires CONFIG_HTTP_SERVER_WEBSOCKET.
+	 */
+	http_server_websocket_cb_t websocket_cb;
+
+	/** User data passed to the callbacks */
+	void *user_data;
+
+	/** The HTTP method: GET, POST, ... A GET route also serves HEAD
+	 * requests, the body of the response is left out in that case.
+	 */
+	enum http_method method;
+};
+
+/**
+ * @brief Initialize a HTTP server route.
+ *
+ * @param _method HTTP method of the route
+ * @param _path Path of the route
+ * @param _handler Request handler
+ * @param _user_data User data passed to the handler
+ */
+#define HTTP_SERVER_ROUTE(_method, _path, _handler, _user_data)	\
+	{							\
+		.path = (_path),				\
+		.handler = (_handler),				\
+		.user_data = (_user_data),			\
+		.method = (_method),				\
+	}
+
+/**
+ * @brief Initialize a HTTP server route accepting Websocket upgrades.
+ *
+ * @param _path Path of the route
+ * @param _handler Handler for requests not asking for an upgrade, may be
+ *        NULL
+ * @param _websocket_cb Callback taking over the upgraded connection
+ * @param _user_data User data passed to the callbacks
+ */
+#define HTTP_SERVER_WEBSOCKET_ROUTE(_path, _handler, _websocket_cb,	\
+				    _user_data)				\
+	{								\
+		.path = (_path),					\
+		.handler = (_handler),					\
+		.websocket_cb = (_websocket_cb),			\
+		.user_data = (_user_data),				\
+		.method = HTTP_GET,					\
+	}
+
+/**
+ * HTTP request received by the server.
+ */
+struct http_server_request {
+	/** Path of the request, without the query */
+	const char *path;
+
+	/** Query of the request, the part after '?', or NULL */
+	const char *query;
+
+	/** Request body, with any chunked transfer encoding removed */
+	const uint8_t *body;
+
+	/** Length of the request body */
+	size_t body_len;
+
+	/** The HTTP method: GET, HEAD, POST, ... */
+	enum http_method method;
+
+	/** Minor version of HTTP/1.x used by the client */
+	uint8_t http_minor;
+};
+
+/** Connection state of a client, the application should not touch this */
+struct http_server_client {
+	/** HTTP parser context */
+	struct http_parser parser;
+
+	/** Uptime of the last activity, for closing idle connections */
+	int64_t last_activity;
+
+	/** Client socket, -1 if unused */
+	int sock;
+
+	/** Length of the URL received so far */
+	uint16_t url_len;
+
+	/** Length of the body received so far */
+	uint16_t body_len;
+
+	/** Error status detected while receiving the request */
+	uint16_t status;
+
+	/** Position in the header field name being matched */
+	uint8_t field_pos;
+
+	/** Length of the Sec-WebSocket-Key received so far */
+	uint8_t ws_key_len;
+
+	/** The last header callback was for a value */
+	uint8_t in_value : 1;
+
+	/** The header being received is Sec-WebSocket-Key */
+	uint8_t ws_key_field : 1;
+
+	/** No more requests are handled, close after the responses */
+	uint8_t closing : 1;
+
+	/** The connection was handed over to a Websocket callback */
+	uint8_t upgraded : 1;
+
+	/** Request URL */
+	char url[CONFIG_HTTP_SERVER_MAX_URL_LENGTH];
+
+#if defined(CONFIG_HTTP_SERVER_WEBSOCKET)
+	/** Sec-WebSocket-Key field value */
+	char ws_key[HTTP_SERVER_WS_KEY_LEN];
+#endif
+
+	/** Request body */
+	uint8_t body[CONFIG_HTTP_SERVER_MAX_BODY_SIZE];
+};
+
+/** Response to a request, passed to the request handler */
+struct http_server_response {
+	/** Server context */
+	struct http_server_ctx *ctx;
+
+	/** Client the response is sent to */
+	struct http_server_client *client;
+
+	/** Request being answered */
+	const struct http_server_request *req;
+
+	/** Response headers were sent */
+	uint8_t started : 1;
+
+	/** Response is sent with chunked transfer encoding */
+	uint8_t chunked : 1;
+
+	/** Response is complete */
+	uint8_t done : 1;
+};
+
+/**
+ * HTTP server context. All the memory used by the server is allocated
+ * here, the receive and send buffers are shared by all the clients.
+ */
+struct http_server_ctx {
+	/** Static route table */
+	const struct http_server_route *routes;
+
+	/** Number of routes */
+	size_t num_routes;
+
+	/** Connected clients */
+	struct http_server_client clients[CONFIG_HTTP_SERVER_MAX_CLIENTS];
+
+	/** Poll set, the listening socket first and then the clients */
+	struct zsock_pollfd fds[CONFIG_HTTP_SERVER_MAX_CLIENTS + 1];
+
+	/** Client whose responses are in the send buffer */
+	struct http_server_client *tx_client;
+
+	/** Length of the data in the send buffer */
+	size_t tx_len;
+
+	/** Uptime by which the responses to the client must be sent */
+	int64_t tx_deadline;
+
+	/** Listening socket */
+	int sock;
+
+	/** Set by http_server_stop() */
+	atomic_t stop;
+
+	/** Receive buffer */
+	uint8_t rx_buf[CONFIG_HTTP_SERVER_RX_BUF_SIZE];
+
+	/** Send buffer, responses to pipelined requests are sent together */
+	uint8_t tx_buf[CONFIG_HTTP_SERVER_TX_BUF_SIZE];
+};
+
+/**
+ * @brief Initialize a HTTP server and start listening for connections.
+ *
+ * @param ctx Server context
+ * @param addr Local address to listen on
+ * @param addrlen Length of the address
+ * @param routes Route table, must stay valid while the server runs
+ * @param num_routes Number of routes
+ *
+ * @return 0 if ok, <0 if error
+ */
+int http_server_init(struct http_server_ctx *ctx, const struct sockaddr *addr,
+		     socklen_t addrlen, const struct http_server_route *routes,
+		     size_t num_routes);
+
+/**
+ * @brief Wait for and handle network events once: accept new connections,
+ * handle the received requests and close idle connections.
+ *
+ * @param ctx Server context
+ * @param timeout Max time to wait for events in milliseconds, or
+ *        SYS_FOREVER_MS. Idle connections shorten the wait.
+ *
+ * @return 0 if ok, <0 if error
+ */
+int http_server_process(struct http_server_ctx *ctx, int timeout);
+
+/**
+ * @brief Handle connections until http_server_stop() is called.
+ *
+ * @param ctx Server context
+ *
+ * @return 0 if stopped, <0 if error
+ */
+int http_server_run(struct http_server_ctx *ctx);
+
+/**
+ * @brief Make http_server_run() return. It returns once its current wait
+ * for events ends, at most after CONFIG_HTTP_SERVER_CLIENT_TIMEOUT ms.
+ *
+ * @param ctx Server context
+ */
+void http_server_stop(struct http_server_ctx *ctx);
+
+/**
+ * @brief Close the listening socket and all the client connections.
+ *
+ * @param ctx Server context
+ */
+void http_server_close(struct http_server_ctx *ctx);
+
+/**
+ * @brief Send a complete response with a Content-Length header.
+ *
+ * @param rsp Response passed to the handler
+ * @param status HTTP status code, for example 200
+ * @param content_type Value of the Content-Type header, or NULL
+ * @param body Response body, may be NULL if body_len is 0
+ * @param body_len Length of the response body
+ *
+ * @return 0 if ok, <0 if error
+ */
+int http_server_send_response(struct http_server_response *rsp,
+			      uint16_t status, const char *content_type,
+			      const void *body, size_t body_len);
+
+/**
+ * @brief Start a response whose body is sent in chunks, with chunked
+ * transfer encoding. HTTP/1.0 clients get the body as is, and the
+ * connection is closed after it.
+ *
+ * @param rsp Response passed to the handler
+ * @param status HTTP status code, for example 200
+ * @param content_type Value of the Content-Type header, or NULL
+ *
+ * @return 0 if ok, <0 if error
+ */
+int http_server_send_chunked_begin(struct http_server_response *rsp,
+				   uint16_t status, const char *content_type);
+
+/**
+ * @brief Send a chunk of a response started with
+ * http_server_send_chunked_begin().
+ *
+ * @param rsp Response passed to the handler
+ * @param data Chunk data
+ * @param len Length of the chunk, empty chunks are ignored
+ *
+ * @return 0 if ok, <0 if error
+ */
+int http_server_send_chunk(struct http_server_response *rsp,
+			   const void *data, size_t len);
+
+/**
+ * @brief End a response started with http_server_send_chunked_begin().
+ * This is done by the server if the handler returns without ending it.
+ *
+ * @param rsp Response passed to the handler
+ *
+ * @return 0 if ok, <0 if error
+ */
+int http_server_send_chunked_end(struct http_server_response *rsp);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_ */
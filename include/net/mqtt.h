@@ -432,6 +432,24 @@ struct mqtt_transport {
 #endif
 };
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+/** @brief Outgoing QoS 1 or QoS 2 message waiting for acknowledgment. */
+struct mqtt_inflight {
+	/** Internal. Published message. Topic and payload are owned by the
+	 *  application.
+	 */
+	struct mqtt_publish_param param;
+
+	/** Internal. Position of the message in the publishing order. */
+	uint32_t seq;
+
+	/** Internal. Type of the packet expected from the broker, 0 if the
+	 *  entry is free.
+	 */
+	uint8_t expect;
+};
+#endif /* CONFIG_MQTT_INFLIGHT */
+
 /** @brief MQTT internal state. */
 struct mqtt_internal {
 	/** Internal. Mutex to protect access to the client instance. */
@@ -450,6 +468,27 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	uint32_t remaining_payload;
+
+	/** Internal. Remaining payload length to write, for a message
+	 *  started with mqtt_publish_begin().
+	 */
+	uint32_t tx_remaining_payload;
+
+	/** Internal. Offset of the first unprocessed byte in the receive
+	 *  buffer.
+	 */
+	uint32_t rx_buf_pos;
+
+	/** Internal. Last allocated message id. */
+	uint16_t last_message_id;
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+	/** Internal. Position of the next message in the publishing order. */
+	uint32_t inflight_seq;
+
+	/** Internal. QoS 1 and QoS 2 messages waiting for acknowledgment. */
+	struct mqtt_inflight inflight[CONFIG_MQTT_INFLIGHT_MAX];
+#endif
 };
 
 /**
@@ -579,16 +618,85 @@ int mqtt_connect(struct mqtt_client *client);
 /**
  * @brief API to publish messages on topics.
  *
+ * @note If the message id in @a param is 0 for a QoS 1 or QoS 2 message,
+ *       an id is allocated with @ref mqtt_message_id_alloc.
+ *
+ * @note With CONFIG_MQTT_INFLIGHT, QoS 1 and QoS 2 messages are kept by the
+ *       library until acknowledged, and sent again with the DUP flag set
+ *       after reconnecting with a persistent session. The topic and payload
+ *       must stay valid until the MQTT_EVT_PUBACK or MQTT_EVT_PUBCOMP event
+ *       for the message. Several messages can be published without waiting
+ *       for the acknowledgment of the previous ones.
+ *
  * @param[in] client Client instance for which the procedure is requested.
  *                   Shall not be NULL.
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ *         With CONFIG_MQTT_INFLIGHT, -EAGAIN if CONFIG_MQTT_INFLIGHT_MAX
+ *         messages are already in flight and -EBUSY if a message with the
+ *         same id is in flight.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+/**
+ * @brief API to start publishing a message whose payload is written
+ *        separately with @ref mqtt_write_publish_payload.
+ *
+ * @note This allows publishing a payload which is not available in a single
+ *       buffer, for example when it is produced or read from storage in
+ *       chunks. The payload length must be set in @a param, the payload data
+ *       pointer is ignored. No other message can be sent until the whole
+ *       payload has been written. A message that cannot be completed is
+ *       given up with @ref mqtt_disconnect.
+ *
+ * @note If the message id in @a param is 0 for a QoS 1 or QoS 2 message,
+ *       an id is allocated with @ref mqtt_message_id_alloc. With
+ *       CONFIG_MQTT_INFLIGHT, the message does not take a slot in the
+ *       in-flight window and is not sent again after reconnecting.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] param Parameters to be used for the publish message.
+ *                  Shall not be NULL.
+ *
+ * @return Message id used for the message, 0 for a QoS 0 message, or a
+ *         negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_publish_begin(struct mqtt_client *client,
+		       const struct mqtt_publish_param *param);
+
+/**
+ * @brief API to write a part of the payload of a message started with
+ *        @ref mqtt_publish_begin.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] data Payload data to write.
+ * @param[in] length Length of the data, not more than the remaining length
+ *                   of the payload.
+ *
+ * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_write_publish_payload(struct mqtt_client *client, const void *data,
+			       size_t length);
+
+/**
+ * @brief API to allocate a message id for a publish, subscribe or
+ *        unsubscribe message.
+ *
+ * @note Ids are allocated in increasing order, skipping 0 and, with
+ *       CONFIG_MQTT_INFLIGHT, the ids of the messages in flight.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ *
+ * @return Allocated message id.
+ */
+uint16_t mqtt_message_id_alloc(struct mqtt_client *client);
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
@@ -685,6 +793,13 @@ int mqtt_ping(struct mqtt_client *client);
 /**
  * @brief API to disconnect MQTT connection.
  *
+ * @note If the payload of a message started with @ref mqtt_publish_begin
+ *       has not been written completely, no DISCONNECT message can be sent
+ *       as the broker would take it as a part of the payload. The transport
+ *       is closed without it and the MQTT_EVT_DISCONNECT event is notified
+ *       with -ECONNABORTED. The broker then drops the incomplete message and
+ *       publishes the will message of the client, if any.
+ *
  * @param[in] client Identifies client instance for which procedure is
  *                   requested.
  *
@@ -740,6 +855,12 @@ int mqtt_keepalive_time_left(const struct mqtt_client *client);
  *       @ref mqtt_read_publish_payload function. The size of the payload to
  *       read is provided in the publish event structure.
  *
+ * @note All the packets already received are handled, until a PUBLISH
+ *       message whose payload is not read from the callback. In that case,
+ *       call this function again once the payload has been read, even if
+ *       the socket is not readable, as the following packets may already be
+ *       buffered.
+ *
  * @note This is a non-blocking call.
  *
  * @param[in] client Client instance for which the procedure is requested.
@@ -271,6 +271,11 @@ __net_socket struct net_context {
 		struct k_fifo accept_q;
 	};
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	/** epoll interest list entries watching this socket */
+	sys_slist_t epoll_items;
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
+
 #endif /* CONFIG_NET_SOCKETS */
 
 #if defined(CONFIG_NET_OFFLOAD)
@@ -305,6 +310,20 @@ __net_socket struct net_context {
 #endif
 #if defined(CONFIG_NET_CONTEXT_SNDTIMEO)
 		k_timeout_t sndtimeo;
+#endif
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+		/** Acknowledge all received TCP data immediately */
+		bool tcp_quickack;
+#endif
+#if defined(CONFIG_NET_CONTEXT_RECV_PKTINFO)
+		/** Report the destination of received datagrams */
+		bool recv_pktinfo;
+#endif
+#if defined(CONFIG_NET_CONTEXT_PACING)
+		/** Max send rate in bytes per second, 0 if not paced */
+		uint32_t pacing_rate;
+		/** Uptime in nanoseconds when the next send is allowed */
+		uint64_t pacing_next;
 #endif
 	} options;
 
@@ -1047,6 +1066,9 @@ enum net_context_option {
 	NET_OPT_SOCKS5		= 4,
 	NET_OPT_RCVTIMEO        = 5,
 	NET_OPT_SNDTIMEO        = 6,
+	NET_OPT_TCP_QUICKACK    = 7,
+	NET_OPT_RECV_PKTINFO    = 8,
+	NET_OPT_MAX_PACING_RATE = 9,
 };
 
 /**
@@ -117,6 +117,72 @@ enum net_verdict {
  */
 int net_recv_data(struct net_if *iface, struct net_pkt *pkt);
 
+/**
+ * @brief Called by network device driver when a number of network packets
+ * have been received. This is the same as calling net_recv_data() for each
+ * of the packets but the RX queue is woken up only once for the whole batch.
+ *
+ * @param iface Network interface where the packets were received.
+ * @param pkts Array of received network packets.
+ * @param count Number of packets in the array.
+ *
+ * @return 0 if ok, <0 if error. On error none of the packets is queued
+ * and the caller still owns all of them.
+ */
+int net_recv_data_batch(struct net_if *iface, struct net_pkt **pkts,
+			int count);
+
+/**
+ * @typedef net_rx_poll_cb_t
+ * @brief Callback used by the network stack to poll received packets
+ * from the network device driver.
+ *
+ * @details The driver should pass at most budget packets to the stack
+ * using net_recv_data() or net_recv_data_batch(). If less than budget
+ * packets were available, the driver should re-enable its RX interrupt
+ * before returning.
+ *
+ * @param iface Network interface to poll.
+ * @param budget Max number of packets the driver can pass to the stack.
+ *
+ * @return Number of packets passed to the stack.
+ */
+typedef int (*net_rx_poll_cb_t)(struct net_if *iface, int budget);
+
+/**
+ * @brief RX polling context of a network device driver.
+ */
+struct net_rx_poll {
+	/** Work item run in the RX queue */
+	struct k_work work;
+	/** Network interface to poll */
+	struct net_if *iface;
+	/** Driver callback that passes the received packets to the stack */
+	net_rx_poll_cb_t cb;
+};
+
+/**
+ * @brief Initialize RX polling context.
+ *
+ * @param poll RX polling context.
+ * @param iface Network interface to poll.
+ * @param cb Driver callback that is called from the RX queue.
+ */
+void net_rx_poll_init(struct net_rx_poll *poll, struct net_if *iface,
+		      net_rx_poll_cb_t cb);
+
+/**
+ * @brief Schedule polling of the network device driver.
+ *
+ * @details Typically called from the RX interrupt handler after
+ * the driver has masked the RX interrupt. The poll callback is then called
+ * from the RX queue until it passes less than the budget packets to
+ * the stack. Can be called from ISR context.
+ *
+ * @param poll RX polling context.
+ */
+void net_rx_poll_schedule(struct net_rx_poll *poll);
+
 /**
  * @brief Send data to network.
  *
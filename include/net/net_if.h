@@ -187,6 +187,13 @@ enum net_if_flag {
 	 */
 	NET_IF_FORWARD_MULTICASTS,
 
+	/** Received packets are distributed to the RX worker threads by
+	 * their flow hash. Packets of the same flow are always processed
+	 * by the same worker so their order is preserved.
+	 * Used only if CONFIG_NET_RX_STEERING is enabled.
+	 */
+	NET_IF_RX_STEERING,
+
 /** @cond INTERNAL_HIDDEN */
 	/* Total number of flags - must be at the end of the enum */
 	NET_IF_NUM_FLAGS
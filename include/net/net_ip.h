@@ -234,6 +234,11 @@ struct msghdr {
 	int           msg_flags;      /* flags on received message */
 };
 
+struct mmsghdr {
+	struct msghdr msg_hdr;        /* message header */
+	unsigned int  msg_len;        /* number of bytes transmitted */
+};
+
 struct cmsghdr {
 	socklen_t cmsg_len;    /* Number of bytes, including header */
 	int       cmsg_level;  /* Originating protocol */
@@ -281,6 +286,18 @@ struct cmsghdr {
 #define CMSG_LEN(length) (ALIGN_D(sizeof(struct cmsghdr)) + length)
 #endif
 
+/* Ancillary data of IP_PKTINFO and IPV6_RECVPKTINFO socket options */
+struct in_pktinfo {
+	unsigned int   ipi_ifindex;  /* Interface index */
+	struct in_addr ipi_spec_dst; /* Local address */
+	struct in_addr ipi_addr;     /* Header destination address */
+};
+
+struct in6_pktinfo {
+	struct in6_addr ipi6_addr;    /* Header destination address */
+	unsigned int    ipi6_ifindex; /* Interface index */
+};
+
 /** @cond INTERNAL_HIDDEN */
 
 /* Packet types.  */
@@ -27,7 +27,9 @@
 #include <net/net_ip.h>
 #include <net/dns_resolve.h>
 #include <net/socket_select.h>
+#include <net/socket_epoll.h>
 #include <stdlib.h>
+#include <errno.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +57,10 @@ struct zsock_pollfd {
 
 /** zsock_recv: Read data without removing it from socket input queue */
 #define ZSOCK_MSG_PEEK 0x02
+/** zsock_recvmsg: Ancillary data was discarded due to lack of space in the
+ *  control buffer (output value in msg_flags only)
+ */
+#define ZSOCK_MSG_CTRUNC 0x08
 /** zsock_recv: return the real length of the datagram, even when it was longer
  *  than the passed buffer
  */
@@ -63,6 +69,8 @@ struct zsock_pollfd {
 #define ZSOCK_MSG_DONTWAIT 0x40
 /** zsock_recv: block until the full amount of data can be returned */
 #define ZSOCK_MSG_WAITALL 0x100
+/** zsock_recvmmsg: Do not block after the first message has been received */
+#define ZSOCK_MSG_WAITFORONE 0x10000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -132,6 +140,20 @@ struct zsock_pollfd {
  *  the TLS handshake.
  */
 #define TLS_ALPN_LIST 7
+/** Socket option to enable TLS/DTLS session resumption. It accepts and
+ *  returns an integer, TLS_SESSION_CACHE_ENABLED or
+ *  TLS_SESSION_CACHE_DISABLED (default). On a client, the session of an
+ *  established connection is stored per peer address and the next
+ *  connection to the same peer resumes it with an abbreviated handshake.
+ *  On a server, the sessions of the clients are cached so that they can
+ *  resume them. Must be set before connect()/listen() or, for DTLS, before
+ *  the handshake starts.
+ */
+#define TLS_SESSION_CACHE 8
+/** Write-only socket option to purge all cached TLS/DTLS sessions. It
+ *  accepts any value.
+ */
+#define TLS_SESSION_CACHE_PURGE 9
 
 /** @} */
 
@@ -144,6 +166,10 @@ struct zsock_pollfd {
 #define TLS_DTLS_ROLE_CLIENT 0 /**< Client role in a DTLS session. */
 #define TLS_DTLS_ROLE_SERVER 1 /**< Server role in a DTLS session. */
 
+/* Valid values for TLS_SESSION_CACHE option */
+#define TLS_SESSION_CACHE_DISABLED 0 /**< Disable TLS session caching. */
+#define TLS_SESSION_CACHE_ENABLED 1 /**< Enable TLS session caching. */
+
 struct zsock_addrinfo {
 	struct zsock_addrinfo *ai_next;
 	int ai_flags;
@@ -364,6 +390,26 @@ static inline ssize_t zsock_send(int sock, const void *buf, size_t len,
 __syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg,
 				int flags);
 
+/**
+ * @brief Send multiple messages on a socket
+ *
+ * @details
+ * @rst
+ * See `Linux man page
+ * <https://man7.org/linux/man-pages/man2/sendmmsg.2.html>`__
+ * for normative description.
+ * All the messages are sent within one call, which saves the per call
+ * overhead, especially the system call overhead of user mode threads.
+ * This function is also exposed as ``sendmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @return Number of messages sent from @a msgvec. If an error occurs
+ * before any message has been sent, -1 is returned and errno is set.
+ */
+__syscall int zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
 /**
  * @brief Receive data from an arbitrary network address
  *
@@ -380,6 +426,90 @@ __syscall ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len,
 				 int flags, struct sockaddr *src_addr,
 				 socklen_t *addrlen);
 
+/**
+ * @brief Receive a message from an arbitrary network address
+ *
+ * @details
+ * @rst
+ * See `POSIX.1-2017 article
+ * <http://pubs.opengroup.org/onlinepubs/9699919799/functions/recvmsg.html>`__
+ * for normative description.
+ * For datagram sockets, ancillary data is returned for the
+ * ``IP_PKTINFO``, ``IPV6_RECVPKTINFO`` and ``SO_TIMESTAMPING`` socket
+ * options enabled on the socket.
+ * This function is also exposed as ``recvmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+__syscall ssize_t zsock_recvmsg(int sock, struct msghdr *msg, int flags);
+
+/**
+ * @brief Receive multiple messages from a socket
+ *
+ * @details
+ * @rst
+ * See `Linux man page
+ * <https://man7.org/linux/man-pages/man2/recvmmsg.2.html>`__
+ * for normative description. Unlike in Linux, there is no timeout
+ * parameter, the socket receive timeout is used instead.
+ * With ``ZSOCK_MSG_WAITFORONE`` flag, the call blocks only until the
+ * first message has been received.
+ * This function is also exposed as ``recvmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @return Number of messages received into @a msgvec. If an error occurs
+ * before any message has been received, -1 is returned and errno is set.
+ */
+__syscall int zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+struct net_pkt;
+
+/**
+ * @brief Receive data from a socket without copying it
+ *
+ * @details
+ * Zephyr-specific zero-copy counterpart of zsock_recvfrom(). Instead of
+ * copying the data into a user buffer, the next received network packet
+ * is handed over to the caller. On return, the fragments of the packet
+ * (``pkt->buffer``) hold only the received data, the protocol headers
+ * have been dropped. The data can be accessed directly in the fragments
+ * or with net_pkt_read(). The packet must be given back with
+ * zsock_recv_zc_release() when the data has been consumed.
+ *
+ * For a stream socket, all the data of one received segment is returned.
+ * A packet held by the application is not accounted in the TCP receive
+ * window but it occupies network buffers, so it should be released as
+ * soon as possible to avoid running out of RX buffers.
+ *
+ * Zero-copy receive must be enabled for the socket with the
+ * ``SO_RCVZEROCOPY`` socket option. Only ``ZSOCK_MSG_DONTWAIT`` flag is
+ * supported. Available only to supervisor threads and only for the native
+ * IP sockets, needs :option:`CONFIG_NET_SOCKETS_RECV_ZEROCOPY`.
+ *
+ * @param sock Socket descriptor
+ * @param pkt Received network packet is returned here
+ * @param flags Receive flags
+ * @param src_addr Source address of the data, can be NULL
+ * @param addrlen Length of @a src_addr, value-result argument
+ *
+ * @return Number of bytes received, 0 if the peer has closed the stream
+ * connection, -1 with errno set on error.
+ */
+ssize_t zsock_recv_zc(int sock, struct net_pkt **pkt, int flags,
+		      struct sockaddr *src_addr, socklen_t *addrlen);
+
+/**
+ * @brief Release a packet received with zsock_recv_zc()
+ *
+ * @param sock Socket descriptor the packet was received from
+ * @param pkt Network packet returned by zsock_recv_zc()
+ *
+ * @return 0 on success, -1 with errno set on error.
+ */
+int zsock_recv_zc_release(int sock, struct net_pkt *pkt);
+
 /**
  * @brief Receive data from a connected peer
  *
@@ -698,12 +828,38 @@ static inline ssize_t sendmsg(int sock, const struct msghdr *message,
 	return zsock_sendmsg(sock, message, flags);
 }
 
+static inline int sendmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 			       struct sockaddr *src_addr, socklen_t *addrlen)
 {
 	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
 }
 
+static inline ssize_t recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg(sock, msg, flags);
+}
+
+struct timespec;
+
+static inline int recvmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags,
+			   struct timespec *timeout)
+{
+	if (timeout) {
+		/* Use SO_RCVTIMEO socket option instead */
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	return zsock_poll(fds, nfds, timeout);
@@ -780,6 +936,8 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 #define MSG_TRUNC ZSOCK_MSG_TRUNC
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
 #define MSG_WAITALL ZSOCK_MSG_WAITALL
+#define MSG_CTRUNC ZSOCK_MSG_CTRUNC
+#define MSG_WAITFORONE ZSOCK_MSG_WAITFORONE
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
@@ -821,14 +979,31 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 /** sockopt: Protocol used with the socket */
 #define SO_PROTOCOL 38
 
+/** sockopt: Max send rate of the socket in bytes per second */
+#define SO_MAX_PACING_RATE 47
+
+/** sockopt: Enable zero-copy receive with zsock_recv_zc() */
+#define SO_RCVZEROCOPY 62
+
 /* Socket options for IPPROTO_TCP level */
 /** sockopt: Disable TCP buffering (ignored, for compatibility) */
 #define TCP_NODELAY 1
+/** sockopt: Acknowledge received data immediately instead of delaying ACKs */
+#define TCP_QUICKACK 12
+
+/* Socket options for IPPROTO_IP level */
+/** sockopt: Pass an IP_PKTINFO ancillary message with received datagrams */
+#define IP_PKTINFO 8
 
 /* Socket options for IPPROTO_IPV6 level */
 /** sockopt: Don't support IPv4 access (ignored, for compatibility) */
 #define IPV6_V6ONLY 26
 
+/** sockopt: Pass an IPV6_PKTINFO ancillary message with received datagrams */
+#define IPV6_RECVPKTINFO 49
+/** Type of the ancillary message set by IPV6_RECVPKTINFO */
+#define IPV6_PKTINFO 50
+
 /** sockopt: Socket priority */
 #define SO_PRIORITY 12
 
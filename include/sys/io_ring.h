@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_IO_RING_H_
+#define ZEPHYR_INCLUDE_SYS_IO_RING_H_
+
+#include <kernel.h>
+#include <sys/atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Asynchronous I/O rings
+ * @defgroup io_ring Asynchronous I/O rings
+ * @ingroup os_services
+ * @{
+ *
+ * An I/O ring is a pair of submission (SQ) and completion (CQ) queues
+ * living in application memory. The application places submission queue
+ * entries (SQEs) describing socket or file operations in the SQ and hands
+ * them to the kernel with io_ring_enter(). A kernel service thread waits
+ * for all submitted operations at once using k_poll(), runs each one as
+ * soon as its file descriptor is ready and posts the result to the CQ,
+ * where the application reaps it without a system call.
+ *
+ * This allows a single thread to drive many connections without blocking
+ * in any of them and without one thread per connection.
+ */
+
+struct fs_file_t;
+
+/**
+ * Read from a file descriptor (socket, socketpair, eventfd, ...). The
+ * descriptor must be in non-blocking mode (O_NONBLOCK), otherwise the
+ * operation completes with -EINVAL.
+ */
+#define IO_RING_OP_READ 0
+/** Write to a file descriptor, which must be in non-blocking mode */
+#define IO_RING_OP_WRITE 1
+/** Receive from a socket, @a op_flags are ZSOCK_MSG_* flags */
+#define IO_RING_OP_RECV 2
+/** Send on a socket, @a op_flags are ZSOCK_MSG_* flags */
+#define IO_RING_OP_SEND 3
+/** Accept a connection on a listening socket, result is the new socket */
+#define IO_RING_OP_ACCEPT 4
+/** Read from a file opened with fs_open() (supervisor mode only) */
+#define IO_RING_OP_FS_READ 5
+/** Write to a file opened with fs_open() (supervisor mode only) */
+#define IO_RING_OP_FS_WRITE 6
+
+/**
+ * SQE flag: keep the operation armed after each completion. Every
+ * completion is posted with IO_RING_CQE_F_MORE until the operation fails
+ * or the ring is closed. Only supported for IO_RING_OP_ACCEPT.
+ */
+#define IO_RING_SQE_MULTISHOT BIT(0)
+
+/** CQE flag: the operation is still armed and will complete again */
+#define IO_RING_CQE_F_MORE BIT(0)
+
+/** Submission queue entry */
+struct io_ring_sqe {
+	/** IO_RING_OP_* operation */
+	uint8_t opcode;
+	/** IO_RING_SQE_* flags */
+	uint8_t flags;
+	uint16_t reserved;
+	/** File descriptor, unused for IO_RING_OP_FS_* */
+	int32_t fd;
+	/** Operation specific flags */
+	int32_t op_flags;
+	/** Length of @a buf */
+	uint32_t len;
+	/** Data buffer, unused for IO_RING_OP_ACCEPT */
+	void *buf;
+	/** File for IO_RING_OP_FS_* operations */
+	struct fs_file_t *file;
+	/** Opaque value copied to the completion */
+	uint64_t user_data;
+};
+
+/** Completion queue entry */
+struct io_ring_cqe {
+	/** @a user_data of the completed submission */
+	uint64_t user_data;
+	/** Operation result, as returned by the synchronous call, or -errno */
+	int32_t res;
+	/** IO_RING_CQE_F_* flags */
+	uint32_t flags;
+};
+
+/**
+ * @brief I/O ring shared between the application and the kernel
+ *
+ * The application sets @a sqes, @a cqes, @a sq_entries and @a cq_entries
+ * before calling io_ring_setup(); the number of entries must be a power
+ * of two. The head and tail indexes are free running and must only be
+ * accessed through the inline helpers below.
+ */
+struct io_ring {
+	struct io_ring_sqe *sqes;
+	struct io_ring_cqe *cqes;
+	uint32_t sq_entries;
+	uint32_t cq_entries;
+	/** File descriptor of the ring, set by io_ring_setup() */
+	int fd;
+	/** Next SQE to be consumed, written by the kernel */
+	atomic_t sq_head;
+	/** Next free SQE, written by the application */
+	atomic_t sq_tail;
+	/** Next CQE to be reaped, written by the application */
+	atomic_t cq_head;
+	/** Next free CQE, written by the kernel */
+	atomic_t cq_tail;
+};
+
+/**
+ * @brief Register an I/O ring with the kernel
+ *
+ * The ring memory must stay valid and accessible to the calling thread
+ * until the returned file descriptor is closed with zsock_close(). Closing
+ * the ring cancels all of its pending operations without completing them;
+ * it must not be closed while a thread waits in io_ring_enter(). From user
+ * mode, only the thread which set up the ring may use it.
+ *
+ * @param ring I/O ring, see struct io_ring for the fields to fill in
+ *
+ * @return File descriptor of the ring (also stored in @a ring), or
+ *         -EINVAL if the ring geometry is invalid, -ENOMEM if
+ *         CONFIG_NET_SOCKETS_IO_RING_MAX rings are already in use,
+ *         -ENFILE if no file descriptor is available.
+ */
+__syscall int io_ring_setup(struct io_ring *ring);
+
+/**
+ * @brief Submit queued SQEs and optionally wait for completions
+ *
+ * Consumes up to @a to_submit entries from the SQ, then waits until at
+ * least @a min_complete entries are available in the CQ or @a timeout
+ * expires. Submission stops early if CONFIG_NET_SOCKETS_IO_RING_MAX_OPS
+ * operations are already in flight.
+ *
+ * The file descriptor of each SQE is resolved when it is submitted. If
+ * it is closed or refers to another object before the operation runs,
+ * the operation completes with -EBADF.
+ *
+ * From user mode, the buffers and the file descriptor of each SQE must be
+ * accessible to the calling thread and IO_RING_OP_FS_* operations are
+ * completed with -EPERM.
+ *
+ * @param ring_fd File descriptor returned by io_ring_setup()
+ * @param to_submit Maximum number of SQEs to submit
+ * @param min_complete Number of completions to wait for
+ * @param timeout Maximum time to wait for completions
+ *
+ * @return Number of SQEs submitted, -EBADF if @a ring_fd is not a ring,
+ *         -EBUSY if no SQE could be submitted because too many operations
+ *         are in flight, -EAGAIN if nothing was submitted and the wait
+ *         timed out.
+ */
+__syscall int io_ring_enter(int ring_fd, uint32_t to_submit,
+			    uint32_t min_complete, k_timeout_t timeout);
+
+/**
+ * @brief Get the next free SQE
+ *
+ * @param ring I/O ring
+ *
+ * @return Pointer to the SQE to fill in, or NULL if the SQ is full.
+ *         The entry is queued with io_ring_sqe_commit().
+ */
+static inline struct io_ring_sqe *io_ring_get_sqe(struct io_ring *ring)
+{
+	uint32_t head = (uint32_t)atomic_get(&ring->sq_head);
+	uint32_t tail = (uint32_t)atomic_get(&ring->sq_tail);
+
+	if (tail - head >= ring->sq_entries) {
+		return NULL;
+	}
+
+	return &ring->sqes[tail & (ring->sq_entries - 1)];
+}
+
+/**
+ * @brief Queue the SQE returned by the last io_ring_get_sqe() call
+ *
+ * @param ring I/O ring
+ */
+static inline void io_ring_sqe_commit(struct io_ring *ring)
+{
+	(void)atomic_inc(&ring->sq_tail);
+}
+
+/**
+ * @brief Number of queued SQEs not yet consumed by the kernel
+ *
+ * @param ring I/O ring
+ */
+static inline uint32_t io_ring_sq_pending(struct io_ring *ring)
+{
+	return (uint32_t)atomic_get(&ring->sq_tail) -
+	       (uint32_t)atomic_get(&ring->sq_head);
+}
+
+/**
+ * @brief Get the oldest CQE without removing it
+ *
+ * @param ring I/O ring
+ *
+ * @return Pointer to the CQE, or NULL if the CQ is empty. The entry is
+ *         released with io_ring_cqe_seen().
+ */
+static inline struct io_ring_cqe *io_ring_peek_cqe(struct io_ring *ring)
+{
+	uint32_t head = (uint32_t)atomic_get(&ring->cq_head);
+
+	if (head == (uint32_t)atomic_get(&ring->cq_tail)) {
+		return NULL;
+	}
+
+	return &ring->cqes[head & (ring->cq_entries - 1)];
+}
+
+/**
+ * @brief Release the CQE returned by io_ring_peek_cqe()
+ *
+ * @param ring I/O ring
+ */
+static inline void io_ring_cqe_seen(struct io_ring *ring)
+{
+	(void)atomic_inc(&ring->cq_head);
+}
+
+/**
+ * @brief Submit all queued SQEs and wait for completions
+ *
+ * @param ring I/O ring
+ * @param min_complete Number of completions to wait for
+ * @param timeout Maximum time to wait for completions
+ *
+ * @return See io_ring_enter()
+ */
+static inline int io_ring_submit_and_wait(struct io_ring *ring,
+					  uint32_t min_complete,
+					  k_timeout_t timeout)
+{
+	return io_ring_enter(ring->fd, io_ring_sq_pending(ring),
+			     min_complete, timeout);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#include <syscalls/io_ring.h>
+
+#endif /* ZEPHYR_INCLUDE_SYS_IO_RING_H_ */
@@ -415,12 +415,73 @@ static int decode_num(const struct token *token, int32_t *num)
 	return 0;
 }
 
+/* Largest magnitude of an int64_t, the one of INT64_MIN */
+#define INT64_MAGNITUDE_MAX ((uint64_t)INT64_MAX + 1U)
+
+static bool accumulate_digit(uint64_t *magnitude, int digit)
+{
+	if (*magnitude > (INT64_MAGNITUDE_MAX - digit) / 10U) {
+		return false;
+	}
+
+	*magnitude = *magnitude * 10U + digit;
+
+	return true;
+}
+
+static int magnitude_to_int64(uint64_t magnitude, bool negative,
+			      int64_t *num)
+{
+	if (negative) {
+		*num = (int64_t)(0U - magnitude);
+	} else if (magnitude > INT64_MAX) {
+		return -ERANGE;
+	} else {
+		*num = (int64_t)magnitude;
+	}
+
+	return 0;
+}
+
+/* strtoll() is not available in the minimal libc either */
+static int decode_int64(const struct token *token, int64_t *num)
+{
+	const char *pos = token->start;
+	uint64_t magnitude = 0U;
+	bool negative = false;
+
+	if (pos < token->end && *pos == '-') {
+		negative = true;
+		pos++;
+	}
+
+	if (pos == token->end) {
+		return -EINVAL;
+	}
+
+	for (; pos < token->end; pos++) {
+		if (!isdigit((unsigned char)*pos)) {
+			return -EINVAL;
+		}
+
+		if (!accumulate_digit(&magnitude, *pos - '0')) {
+			return -ERANGE;
+		}
+	}
+
+	return magnitude_to_int64(magnitude, negative, num);
+}
+
 static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
 {
 	if (type1 == JSON_TOK_TRUE || type1 == JSON_TOK_FALSE) {
 		return type2 == JSON_TOK_TRUE || type2 == JSON_TOK_FALSE;
 	}
 
+	if (type1 == JSON_TOK_NUMBER) {
+		return type2 == JSON_TOK_NUMBER || type2 == JSON_TOK_INT64;
+	}
+
 	return type1 == type2;
 }
 
@@ -461,6 +522,11 @@ static int decode_value(struct json_obj *obj,
 
 		return decode_num(value, num);
 	}
+	case JSON_TOK_INT64: {
+		int64_t *num = field;
+
+		return decode_int64(value, num);
+	}
 	case JSON_TOK_STRING: {
 		char **str = field;
 
@@ -479,6 +545,8 @@ static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
 	switch (descr->type) {
 	case JSON_TOK_NUMBER:
 		return sizeof(int32_t);
+	case JSON_TOK_INT64:
+		return sizeof(int64_t);
 	case JSON_TOK_STRING:
 		return sizeof(char *);
 	case JSON_TOK_TRUE:
@@ -599,6 +667,566 @@ int json_obj_parse(char *payload, size_t len,
 	return obj_parse(&obj, descr, descr_len, val);
 }
 
+/*
+ * Incremental decoder: the lexer and the parser above, turned into a state
+ * machine which is fed one character at a time, with an explicit stack of
+ * the objects and arrays being decoded instead of the recursion.
+ */
+
+enum stream_state {
+	STREAM_START,			/* before the top level object */
+	STREAM_KEY,			/* key, ',' or end of object */
+	STREAM_KEY_AFTER_COMMA,
+	STREAM_KEY_STRING,
+	STREAM_COLON,
+	STREAM_VALUE,
+	STREAM_ELEMENT,		/* element, ',' or end of array */
+	STREAM_ELEMENT_AFTER_COMMA,
+	STREAM_STRING,
+	STREAM_NUMBER,
+	STREAM_LITERAL,
+	STREAM_DONE,
+	STREAM_ERROR,
+};
+
+#define NUM_NEGATIVE	BIT(0)
+#define NUM_DIGITS	BIT(1)
+#define NUM_FRACTION	BIT(2)
+#define NUM_OVERFLOW	BIT(3)
+
+/* Escape sequence progress: backslash seen, or hex digits left + 1 */
+#define ESCAPE_NONE	0
+#define ESCAPE_START	1
+#define ESCAPE_UNICODE	5
+
+static struct json_obj_stream_frame *stream_frame(struct json_obj_stream *s)
+{
+	return &s->frames[s->depth - 1];
+}
+
+static void stream_after_value(struct json_obj_stream *s)
+{
+	s->state = stream_frame(s)->array ? STREAM_ELEMENT : STREAM_KEY;
+}
+
+static int stream_push(struct json_obj_stream *s, bool array)
+{
+	struct json_obj_stream_frame *frame;
+
+	if (s->depth == ARRAY_SIZE(s->frames)) {
+		return -ENOMEM;
+	}
+
+	frame = &s->frames[s->depth++];
+	frame->array = array;
+	frame->decoded = 0U;
+	frame->descr = NULL;
+	s->state = array ? STREAM_ELEMENT : STREAM_KEY;
+
+	if (!s->descr) {
+		/* value of an unknown key, only checked for validity */
+		return 0;
+	}
+
+	if (array) {
+		frame->descr = s->descr->array.element_descr;
+		frame->left = s->descr->array.n_elements;
+		frame->elem_size = get_elem_size(frame->descr);
+		frame->field = s->field;
+		frame->val = s->val;
+
+		__ASSERT_NO_MSG(frame->elem_size > 0);
+
+		*(size_t *)((char *)frame->val + frame->descr->offset) = 0;
+	} else {
+		frame->descr = s->descr->object.sub_descr;
+		frame->left = s->descr->object.sub_descr_len;
+		frame->val = s->field;
+	}
+
+	return 0;
+}
+
+static void stream_pop(struct json_obj_stream *s)
+{
+	if (--s->depth == 0U) {
+		s->result = (int)s->frames[0].decoded;
+		s->state = STREAM_DONE;
+		return;
+	}
+
+	stream_after_value(s);
+}
+
+/* Select the array element the next value is stored into */
+static int stream_element(struct json_obj_stream *s)
+{
+	struct json_obj_stream_frame *frame = stream_frame(s);
+
+	s->descr = frame->descr;
+	if (!frame->descr) {
+		return 0;
+	}
+
+	if (frame->left == 0U) {
+		return -ENOSPC;
+	}
+
+	s->field = frame->field;
+	s->val = frame->val;
+
+	frame->field += frame->elem_size;
+	frame->left--;
+	(*(size_t *)((char *)frame->val + frame->descr->offset))++;
+
+	return 0;
+}
+
+static void stream_key_begin(struct json_obj_stream *s)
+{
+	struct json_obj_stream_frame *frame = stream_frame(s);
+
+	/* fields which have been decoded already are skipped */
+	s->candidates = frame->descr ?
+			(BIT(frame->left) - 1U) & ~frame->decoded : 0U;
+	s->key_len = 0;
+	s->escape = ESCAPE_NONE;
+	s->state = STREAM_KEY_STRING;
+}
+
+/* Keys are matched as they arrive, without being stored */
+static void stream_key_char(struct json_obj_stream *s, char chr)
+{
+	const struct json_obj_descr *descr = stream_frame(s)->descr;
+	uint32_t candidates = s->candidates;
+	int i;
+
+	for (i = 0; candidates; i++) {
+		if (!(candidates & BIT(i))) {
+			continue;
+		}
+
+		candidates &= ~BIT(i);
+
+		if (s->key_len >= descr[i].field_name_len ||
+		    descr[i].field_name[s->key_len] != chr) {
+			s->candidates &= ~BIT(i);
+		}
+	}
+
+	s->key_len++;
+}
+
+static void stream_key_end(struct json_obj_stream *s)
+{
+	struct json_obj_stream_frame *frame = stream_frame(s);
+	uint32_t candidates = s->candidates;
+	int i;
+
+	s->descr = NULL;
+
+	for (i = 0; candidates; i++) {
+		if (!(candidates & BIT(i))) {
+			continue;
+		}
+
+		candidates &= ~BIT(i);
+
+		if (frame->descr[i].field_name_len == s->key_len) {
+			s->descr = &frame->descr[i];
+			s->field = (char *)frame->val + frame->descr[i].offset;
+			s->val = frame->val;
+			frame->decoded |= BIT(i);
+			break;
+		}
+	}
+
+	s->state = STREAM_VALUE;
+}
+
+static int stream_value_begin(struct json_obj_stream *s, char chr)
+{
+	enum json_tokens type;
+
+	switch (chr) {
+	case '{':
+	case '[':
+	case '"':
+	case 't':
+	case 'f':
+		type = (enum json_tokens)chr;
+		break;
+	case '-':
+		type = JSON_TOK_NUMBER;
+		break;
+	default:
+		if (!isdigit((unsigned char)chr)) {
+			/* null isn't accepted by json_obj_parse() either */
+			return -EINVAL;
+		}
+
+		type = JSON_TOK_NUMBER;
+		break;
+	}
+
+	if (s->descr && !equivalent_types(type, s->descr->type)) {
+		return -EINVAL;
+	}
+
+	switch (type) {
+	case JSON_TOK_OBJECT_START:
+		return stream_push(s, false);
+	case JSON_TOK_LIST_START:
+		return stream_push(s, true);
+	case JSON_TOK_STRING:
+		s->str_start = s->str_used;
+		s->escape = ESCAPE_NONE;
+		s->state = STREAM_STRING;
+		return 0;
+	case JSON_TOK_TRUE:
+		s->literal = "true";
+		break;
+	case JSON_TOK_FALSE:
+		s->literal = "false";
+		break;
+	default:
+		s->num = chr == '-' ? 0U : (uint64_t)(chr - '0');
+		s->num_flags = chr == '-' ? NUM_NEGATIVE : NUM_DIGITS;
+		s->state = STREAM_NUMBER;
+		return 0;
+	}
+
+	s->literal_pos = 1U;
+	s->state = STREAM_LITERAL;
+
+	return 0;
+}
+
+static int stream_number_end(struct json_obj_stream *s)
+{
+	int64_t num;
+	int ret;
+
+	if (!(s->num_flags & NUM_DIGITS)) {
+		return -EINVAL;
+	}
+
+	if (!s->descr) {
+		return 0;
+	}
+
+	if (s->num_flags & NUM_FRACTION) {
+		return -EINVAL;
+	}
+
+	if (s->num_flags & NUM_OVERFLOW) {
+		return -ERANGE;
+	}
+
+	ret = magnitude_to_int64(s->num, s->num_flags & NUM_NEGATIVE, &num);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (s->descr->type == JSON_TOK_INT64) {
+		*(int64_t *)s->field = num;
+	} else if (num < INT32_MIN || num > INT32_MAX) {
+		return -ERANGE;
+	} else {
+		*(int32_t *)s->field = (int32_t)num;
+	}
+
+	return 0;
+}
+
+static int stream_string_store(struct json_obj_stream *s, const char *data,
+			       size_t len)
+{
+	if (!s->descr) {
+		return 0;
+	}
+
+	/* keep room for the terminating NUL */
+	if (len >= s->str_buf_size - s->str_used) {
+		return -ENOMEM;
+	}
+
+	memcpy(s->str_buf + s->str_used, data, len);
+	s->str_used += len;
+
+	return 0;
+}
+
+static int stream_string_end(struct json_obj_stream *s)
+{
+	if (!s->descr) {
+		return 0;
+	}
+
+	if (s->str_used >= s->str_buf_size) {
+		return -ENOMEM;
+	}
+
+	s->str_buf[s->str_used++] = '\0';
+	*(char **)s->field = s->str_buf + s->str_start;
+
+	return 0;
+}
+
+/*
+ * Same escape sequences as lexer_string(), which are kept as they are.
+ * Returns 1 for the closing quote, 0 for any other character.
+ */
+static int stream_string_char(struct json_obj_stream *s, char chr)
+{
+	switch (s->escape) {
+	case ESCAPE_NONE:
+		if (chr == '"') {
+			return 1;
+		}
+
+		if (chr == '\\') {
+			s->escape = ESCAPE_START;
+		}
+
+		return 0;
+	case ESCAPE_START:
+		switch (chr) {
+		case '"':
+		case '\\':
+		case '/':
+		case 'b':
+		case 'f':
+		case 'n':
+		case 'r':
+		case 't':
+			s->escape = ESCAPE_NONE;
+			return 0;
+		case 'u':
+			s->escape = ESCAPE_UNICODE;
+			return 0;
+		default:
+			return -EINVAL;
+		}
+	default:
+		if (!isxdigit((unsigned char)chr)) {
+			return -EINVAL;
+		}
+
+		s->escape = s->escape == ESCAPE_START + 1 ?
+			    ESCAPE_NONE : s->escape - 1;
+		return 0;
+	}
+}
+
+/* Returns 1 if the character has to be processed again in the new state */
+static int stream_char(struct json_obj_stream *s, char chr)
+{
+	int ret;
+
+	switch (s->state) {
+	case STREAM_STRING:
+		ret = stream_string_char(s, chr);
+		if (ret == 0) {
+			return stream_string_store(s, &chr, 1);
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = stream_string_end(s);
+		if (ret == 0) {
+			stream_after_value(s);
+		}
+
+		return ret;
+	case STREAM_KEY_STRING:
+		ret = stream_string_char(s, chr);
+		if (ret == 0) {
+			stream_key_char(s, chr);
+		} else if (ret > 0) {
+			s->state = STREAM_COLON;
+			ret = 0;
+		}
+
+		return ret;
+	case STREAM_NUMBER:
+		if (isdigit((unsigned char)chr)) {
+			if (!(s->num_flags & (NUM_FRACTION | NUM_OVERFLOW)) &&
+			    !accumulate_digit(&s->num, chr - '0')) {
+				s->num_flags |= NUM_OVERFLOW;
+			}
+
+			s->num_flags |= NUM_DIGITS;
+			return 0;
+		}
+
+		if (chr == '.' && (s->num_flags & NUM_DIGITS)) {
+			s->num_flags |= NUM_FRACTION;
+			return 0;
+		}
+
+		ret = stream_number_end(s);
+		if (ret < 0) {
+			return ret;
+		}
+
+		stream_after_value(s);
+		return 1;
+	case STREAM_LITERAL:
+		if (chr != s->literal[s->literal_pos]) {
+			return -EINVAL;
+		}
+
+		if (s->literal[++s->literal_pos] != '\0') {
+			return 0;
+		}
+
+		if (s->descr) {
+			*(bool *)s->field = s->literal[0] == 't';
+		}
+
+		stream_after_value(s);
+		return 0;
+	default:
+		break;
+	}
+
+	if (isspace((unsigned char)chr)) {
+		return 0;
+	}
+
+	switch (s->state) {
+	case STREAM_START:
+		if (chr != '{') {
+			return -EINVAL;
+		}
+
+		/* the top level descriptor array is the root object's */
+		s->depth = 1U;
+		s->state = STREAM_KEY;
+		return 0;
+	case STREAM_KEY:
+		if (chr == '}') {
+			stream_pop(s);
+			return 0;
+		}
+
+		if (chr == ',') {
+			s->state = STREAM_KEY_AFTER_COMMA;
+			return 0;
+		}
+
+		__fallthrough;
+	case STREAM_KEY_AFTER_COMMA:
+		if (chr != '"') {
+			return -EINVAL;
+		}
+
+		stream_key_begin(s);
+		return 0;
+	case STREAM_COLON:
+		if (chr != ':') {
+			return -EINVAL;
+		}
+
+		stream_key_end(s);
+		return 0;
+	case STREAM_VALUE:
+		return stream_value_begin(s, chr);
+	case STREAM_ELEMENT:
+		if (chr == ']') {
+			stream_pop(s);
+			return 0;
+		}
+
+		if (chr == ',') {
+			s->state = STREAM_ELEMENT_AFTER_COMMA;
+			return 0;
+		}
+
+		__fallthrough;
+	case STREAM_ELEMENT_AFTER_COMMA:
+		ret = stream_element(s);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return stream_value_begin(s, chr);
+	default:
+		return -EINVAL;
+	}
+}
+
+void json_obj_stream_init(struct json_obj_stream *stream,
+			  const struct json_obj_descr *descr, size_t descr_len,
+			  void *val, char *str_buf, size_t str_buf_size)
+{
+	__ASSERT_NO_MSG(descr_len < (sizeof(stream->result) * CHAR_BIT - 1));
+
+	(void)memset(stream, 0, sizeof(*stream));
+
+	stream->frames[0].descr = descr;
+	stream->frames[0].left = descr_len;
+	stream->frames[0].val = val;
+	stream->str_buf = str_buf;
+	stream->str_buf_size = str_buf_size;
+	stream->state = STREAM_START;
+}
+
+int json_obj_stream_feed(struct json_obj_stream *stream, const char *data,
+			 size_t len)
+{
+	const char *end = data + len;
+	const char *run;
+	int ret;
+
+	if (stream->state == STREAM_DONE || stream->state == STREAM_ERROR) {
+		return stream->result;
+	}
+
+	while (data < end) {
+		/* copy the plain characters of a string at once */
+		if (stream->state == STREAM_STRING &&
+		    stream->escape == ESCAPE_NONE) {
+			for (run = data; data < end && *data != '"' &&
+			     *data != '\\'; data++) {
+			}
+
+			ret = stream_string_store(stream, run,
+						  (size_t)(data - run));
+			if (ret < 0 || data == end) {
+				goto out;
+			}
+		}
+
+		ret = stream_char(stream, *data);
+		if (ret < 0) {
+			goto out;
+		}
+
+		if (ret == 0) {
+			data++;
+		}
+
+		if (stream->state == STREAM_DONE) {
+			return stream->result;
+		}
+	}
+
+	return -EAGAIN;
+
+out:
+	if (ret < 0) {
+		stream->result = ret;
+		stream->state = STREAM_ERROR;
+		return ret;
+	}
+
+	return -EAGAIN;
+}
+
 static char escape_as(char chr)
 {
 	switch (chr) {
@@ -625,19 +1253,31 @@ static int json_escape_internal(const char *str,
 				json_append_bytes_t append_bytes,
 				void *data)
 {
+	const char *run = str; /* Start of the characters kept as they are. */
 	const char *cur;
 	int ret = 0;
 
 	for (cur = str; ret == 0 && *cur; cur++) {
 		char escaped = escape_as(*cur);
+		char bytes[2] = { '\\', escaped };
 
-		if (escaped) {
-			char bytes[2] = { '\\', escaped };
+		if (!escaped) {
+			continue;
+		}
 
-			ret = append_bytes(bytes, 2, data);
-		} else {
-			ret = append_bytes(cur, 1, data);
+		if (cur != run) {
+			ret = append_bytes(run, (size_t)(cur - run), data);
+			if (ret < 0) {
+				return ret;
+			}
 		}
+
+		ret = append_bytes(bytes, 2, data);
+		run = cur + 1;
+	}
+
+	if (ret == 0 && cur != run) {
+		ret = append_bytes(run, (size_t)(cur - run), data);
 	}
 
 	return ret;
@@ -790,6 +1430,26 @@ static int num_encode(const int32_t *num, json_append_bytes_t append_bytes,
 	return append_bytes(buf, (size_t)ret, data);
 }
 
+static int num64_encode(const int64_t *num, json_append_bytes_t append_bytes,
+			void *data)
+{
+	/* 19 digits and the sign of INT64_MIN */
+	char buf[20];
+	char *pos = buf + sizeof(buf);
+	uint64_t magnitude = *num < 0 ? 0U - (uint64_t)*num : (uint64_t)*num;
+
+	do {
+		*--pos = '0' + magnitude % 10U;
+		magnitude /= 10U;
+	} while (magnitude);
+
+	if (*num < 0) {
+		*--pos = '-';
+	}
+
+	return append_bytes(pos, (size_t)(buf + sizeof(buf) - pos), data);
+}
+
 static int bool_encode(const bool *value, json_append_bytes_t append_bytes,
 		       void *data)
 {
@@ -820,6 +1480,8 @@ static int encode(const struct json_obj_descr *descr, const void *val,
 				       ptr, append_bytes, data);
 	case JSON_TOK_NUMBER:
 		return num_encode(ptr, append_bytes, data);
+	case JSON_TOK_INT64:
+		return num64_encode(ptr, append_bytes, data);
 	default:
 		return -EINVAL;
 	}
@@ -936,3 +1598,81 @@ ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 
 	return total;
 }
+
+void json_out_stream_init(struct json_out_stream *out, char *buf,
+			  size_t size, json_append_bytes_t flush, void *data)
+{
+	__ASSERT_NO_MSG(size > 0);
+
+	out->buf = buf;
+	out->size = size;
+	out->used = 0;
+	out->flush = flush;
+	out->data = data;
+}
+
+int json_out_stream_append(const char *bytes, size_t len, void *data)
+{
+	struct json_out_stream *out = data;
+	size_t chunk;
+	int ret;
+
+	while (len) {
+		chunk = MIN(len, out->size - out->used);
+
+		memcpy(out->buf + out->used, bytes, chunk);
+		out->used += chunk;
+		bytes += chunk;
+		len -= chunk;
+
+		if (out->used == out->size) {
+			ret = json_out_stream_flush(out);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int json_out_stream_flush(struct json_out_stream *out)
+{
+	size_t used = out->used;
+
+	if (!used) {
+		return 0;
+	}
+
+	out->used = 0;
+
+	return out->flush(out->buf, used, out->data);
+}
+
+int json_obj_encode_stream(const struct json_obj_descr *descr,
+			   size_t descr_len, const void *val,
+			   struct json_out_stream *out)
+{
+	int ret;
+
+	ret = json_obj_encode(descr, descr_len, val, json_out_stream_append,
+			      out);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return json_out_stream_flush(out);
+}
+
+int json_arr_encode_stream(const struct json_obj_descr *descr,
+			   const void *val, struct json_out_stream *out)
+{
+	int ret;
+
+	ret = json_arr_encode(descr, val, json_out_stream_append, out);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return json_out_stream_flush(out);
+}
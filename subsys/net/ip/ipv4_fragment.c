@@ -0,0 +1,652 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <sys/byteorder.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/net_context.h>
+#include <random/rand32.h>
+#include "net_private.h"
+#include "ipv4.h"
+#include "net_stats.h"
+
+/* Timeout for various buffer allocations in this file. */
+#define NET_BUF_TIMEOUT K_MSEC(50)
+
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+/* Largest possible IPv4 datagram payload (RFC 791) */
+#define IPV4_MAX_PAYLOAD_LEN (0xffff - NET_IPV4H_LEN)
+
+static void reassembly_timeout(struct k_work *work);
+static void reassembly_cancel(struct net_ipv4_reassembly *reass);
+static bool reassembly_init_done;
+
+static struct net_ipv4_reassembly
+reassembly[CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT];
+
+/* Fragments are handled in the RX path and the pending reassemblies are
+ * expired from the system work queue, so the slots are protected by this
+ * lock.
+ */
+static K_MUTEX_DEFINE(reassembly_lock);
+
+/* Amount of upper layer data carried in the fragment. */
+static inline size_t fragment_len(struct net_pkt *pkt)
+{
+	return net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		net_pkt_ipv4_opts_len(pkt);
+}
+
+/* RFC 791 identifies the fragments of one datagram by the tuple
+ * (source, destination, protocol, identification).
+ */
+static struct net_ipv4_reassembly *reassembly_get(uint16_t id,
+						  uint8_t protocol,
+						  struct in_addr *src,
+						  struct in_addr *dst)
+{
+	int i, avail = -1;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+
+		if (k_delayed_work_remaining_get(&reassembly[i].timer) &&
+		    reassembly[i].id == id &&
+		    reassembly[i].protocol == protocol &&
+		    net_ipv4_addr_cmp(src, &reassembly[i].src) &&
+		    net_ipv4_addr_cmp(dst, &reassembly[i].dst)) {
+			return &reassembly[i];
+		}
+
+		if (k_delayed_work_remaining_get(&reassembly[i].timer)) {
+			continue;
+		}
+
+		if (avail < 0) {
+			avail = i;
+		}
+	}
+
+	if (avail < 0) {
+		return NULL;
+	}
+
+	/* The slot might have expired with its timeout handler still
+	 * waiting to be run, drop whatever fragments it has left.
+	 */
+	reassembly_cancel(&reassembly[avail]);
+
+	k_delayed_work_submit(&reassembly[avail].timer,
+			      IPV4_REASSEMBLY_TIMEOUT);
+
+	net_ipaddr_copy(&reassembly[avail].src, src);
+	net_ipaddr_copy(&reassembly[avail].dst, dst);
+
+	reassembly[avail].id = id;
+	reassembly[avail].protocol = protocol;
+
+	return &reassembly[avail];
+}
+
+static void reassembly_cancel(struct net_ipv4_reassembly *reass)
+{
+	int i;
+
+	NET_DBG("Cancel 0x%x", reass->id);
+
+	k_delayed_work_cancel(&reass->timer);
+
+	reass->id = 0U;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			continue;
+		}
+
+		NET_DBG("[%d] IPv4 reassembly pkt %p %zd bytes data",
+			i, reass->pkt[i], net_pkt_get_len(reass->pkt[i]));
+
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+}
+
+static void reassembly_info(char *str, struct net_ipv4_reassembly *reass)
+{
+	NET_DBG("%s id 0x%x src %s dst %s remain %d ms", str, reass->id,
+		log_strdup(net_sprint_ipv4_addr(&reass->src)),
+		log_strdup(net_sprint_ipv4_addr(&reass->dst)),
+		k_delayed_work_remaining_get(&reass->timer));
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct net_ipv4_reassembly *reass =
+		CONTAINER_OF(work, struct net_ipv4_reassembly, timer);
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	/* The slot might have been completed and reused while this work
+	 * item was waiting to be run.
+	 */
+	if (k_delayed_work_remaining_get(&reass->timer)) {
+		goto out;
+	}
+
+	reassembly_info("Reassembly cancelled", reass);
+
+	reassembly_cancel(reass);
+
+out:
+	k_mutex_unlock(&reassembly_lock);
+}
+
+static void reassemble_packet(struct net_ipv4_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ipv4_hdr;
+	uint16_t old_len, old_offset;
+	struct net_pkt *pkt;
+	struct net_buf *last;
+	int i;
+
+	k_delayed_work_cancel(&reass->timer);
+
+	NET_ASSERT(reass->pkt[0]);
+
+	last = net_buf_frag_last(reass->pkt[0]->buffer);
+
+	/* The fragments are already sorted by offset, so we only need to
+	 * strip the IPv4 header from all but the first fragment and chain
+	 * the buffers together.
+	 */
+	for (i = 1; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		size_t removed_len;
+
+		pkt = reass->pkt[i];
+		if (!pkt) {
+			break;
+		}
+
+		net_pkt_cursor_init(pkt);
+
+		removed_len = net_pkt_ip_hdr_len(pkt) +
+			net_pkt_ipv4_opts_len(pkt);
+
+		NET_DBG("Removing %zd bytes from start of pkt %p",
+			removed_len, pkt->buffer);
+
+		if (net_pkt_pull(pkt, removed_len)) {
+			NET_ERR("Failed to pull headers");
+			reassembly_cancel(reass);
+			return;
+		}
+
+		/* Attach the data to previous pkt */
+		last->frags = pkt->buffer;
+		last = net_buf_frag_last(pkt->buffer);
+
+		pkt->buffer = NULL;
+		reass->pkt[i] = NULL;
+
+		net_pkt_unref(pkt);
+	}
+
+	pkt = reass->pkt[0];
+	reass->pkt[0] = NULL;
+	reass->id = 0U;
+
+	/* The payload was checked when the fragments were received, but the
+	 * options of the first fragment can still make the datagram too
+	 * long for the 16-bit total length field.
+	 */
+	if (net_pkt_get_len(pkt) > 0xffff) {
+		NET_DBG("Reassembled datagram too long (%zd bytes)",
+			net_pkt_get_len(pkt));
+		goto error;
+	}
+
+	/* Fix the total length and clear the fragment fields of the IPv4
+	 * header so that the packet looks like it was never fragmented.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!ipv4_hdr) {
+		NET_ERR("Failed to get IPv4 header");
+		goto error;
+	}
+
+	/* Only the length and the fragment fields change, so the header
+	 * checksum can be updated instead of calculated again.
+	 */
+	old_len = ipv4_hdr->len;
+	old_offset = UNALIGNED_GET((uint16_t *)ipv4_hdr->offset);
+
+	ipv4_hdr->len = htons(net_pkt_get_len(pkt));
+	ipv4_hdr->offset[0] = 0U;
+	ipv4_hdr->offset[1] = 0U;
+
+	ipv4_hdr->chksum = net_chksum_update_u16(ipv4_hdr->chksum, old_len,
+						 ipv4_hdr->len);
+	ipv4_hdr->chksum = net_chksum_update_u16(ipv4_hdr->chksum, old_offset,
+						 0U);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	net_pkt_set_ipv4_fragment_offset(pkt, 0U);
+	net_pkt_set_ipv4_fragment_more(pkt, false);
+	net_pkt_set_ipv4_reassembled(pkt, true);
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt,
+		net_pkt_get_len(pkt));
+
+	/* We need to use the queue when feeding the packet back into the
+	 * IP stack as we might run out of stack if we call processing_data()
+	 * directly. As the packet does not contain link layer header, we
+	 * MUST NOT pass it to L2 so there will be a special check for that
+	 * in process_data() when handling the packet.
+	 */
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data)
+{
+	int i;
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	for (i = 0; reassembly_init_done &&
+		     i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (!k_delayed_work_remaining_get(&reassembly[i].timer)) {
+			continue;
+		}
+
+		cb(&reassembly[i], user_data);
+	}
+
+	k_mutex_unlock(&reassembly_lock);
+}
+
+/* Insert the fragment into the reassembly slot so that the fragments are
+ * kept sorted by their offset. Returns -EALREADY for an exact duplicate,
+ * -EINVAL if the fragment overlaps with already received data and -ENOMEM
+ * if there is no room for the fragment.
+ */
+static int fragment_insert(struct net_ipv4_reassembly *reass,
+			   struct net_pkt *pkt)
+{
+	uint16_t offset = net_pkt_ipv4_fragment_offset(pkt);
+	size_t len = fragment_len(pkt);
+	struct net_pkt *other;
+	int pos;
+
+	for (pos = 0; pos < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; pos++) {
+		if (!reass->pkt[pos] ||
+		    net_pkt_ipv4_fragment_offset(reass->pkt[pos]) >= offset) {
+			break;
+		}
+	}
+
+	if (pos < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT && reass->pkt[pos]) {
+		other = reass->pkt[pos];
+
+		if (net_pkt_ipv4_fragment_offset(other) == offset &&
+		    fragment_len(other) == len &&
+		    net_pkt_ipv4_fragment_more(other) ==
+		    net_pkt_ipv4_fragment_more(pkt)) {
+			return -EALREADY;
+		}
+
+		if (offset + len > net_pkt_ipv4_fragment_offset(other)) {
+			return -EINVAL;
+		}
+	}
+
+	if (pos > 0) {
+		other = reass->pkt[pos - 1];
+
+		if (net_pkt_ipv4_fragment_offset(other) + fragment_len(other) >
+		    offset) {
+			return -EINVAL;
+		}
+	}
+
+	if (reass->pkt[CONFIG_NET_IPV4_FRAGMENT_MAX_PKT - 1]) {
+		return -ENOMEM;
+	}
+
+	memmove(&reass->pkt[pos + 1], &reass->pkt[pos],
+		(CONFIG_NET_IPV4_FRAGMENT_MAX_PKT - pos - 1) *
+		sizeof(struct net_pkt *));
+
+	reass->pkt[pos] = pkt;
+
+	return 0;
+}
+
+/* Check that all the fragments of the datagram have been received, i.e.
+ * the data is contiguous from offset 0 up to the last fragment.
+ */
+static bool fragments_complete(struct net_ipv4_reassembly *reass)
+{
+	size_t expected = 0;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		if (!reass->pkt[i] ||
+		    net_pkt_ipv4_fragment_offset(reass->pkt[i]) != expected) {
+			return false;
+		}
+
+		expected += fragment_len(reass->pkt[i]);
+
+		if (!net_pkt_ipv4_fragment_more(reass->pkt[i])) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	struct net_ipv4_reassembly *reass;
+	uint16_t flag;
+	uint16_t id;
+	enum net_verdict verdict;
+	int ret;
+	int i;
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	if (!reassembly_init_done) {
+		/* Static initializing does not work here because of the array
+		 * so we must do it at runtime.
+		 */
+		for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+			k_delayed_work_init(&reassembly[i].timer,
+					    reassembly_timeout);
+		}
+
+		reassembly_init_done = true;
+	}
+
+	flag = sys_get_be16(hdr->offset);
+	id = sys_get_be16(hdr->id);
+
+	reass = reassembly_get(id, hdr->proto, &hdr->src, &hdr->dst);
+	if (!reass) {
+		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+		verdict = NET_DROP;
+		goto out;
+	}
+
+	net_pkt_set_ipv4_fragment_offset(pkt,
+				 (flag & NET_IPV4_FRAGH_OFFSET_MASK) * 8U);
+	net_pkt_set_ipv4_fragment_more(pkt, flag & NET_IPV4_MF);
+	net_pkt_set_ipv4_fragment_id(pkt, id);
+
+	/* Every fragment except the last one must carry a multiple of
+	 * 8 bytes of data, and the datagram cannot exceed the maximum IPv4
+	 * packet size.
+	 */
+	if ((net_pkt_ipv4_fragment_more(pkt) && (fragment_len(pkt) % 8U)) ||
+	    (net_pkt_ipv4_fragment_offset(pkt) + fragment_len(pkt) >
+	     IPV4_MAX_PAYLOAD_LEN)) {
+		NET_DBG("Invalid fragment, dropping id 0x%x", id);
+		goto drop;
+	}
+
+	ret = fragment_insert(reass, pkt);
+	if (ret == -EALREADY) {
+		NET_DBG("Duplicate fragment offset %u, dropping pkt %p",
+			net_pkt_ipv4_fragment_offset(pkt), pkt);
+		verdict = NET_DROP;
+		goto out;
+	} else if (ret < 0) {
+		NET_DBG("Cannot store fragment (%d), dropping id 0x%x",
+			ret, id);
+		goto drop;
+	}
+
+	if (!fragments_complete(reass)) {
+		reassembly_info("Reassembly nth pkt", reass);
+
+		NET_DBG("More fragments to be received");
+		verdict = NET_OK;
+		goto out;
+	}
+
+	reassembly_info("Reassembly last pkt", reass);
+
+	/* The last fragment received, reassemble the packet */
+	reassemble_packet(reass);
+
+	verdict = NET_OK;
+	goto out;
+
+drop:
+	/* The whole datagram is useless if one of its fragments is bogus.
+	 * The current packet is not stored yet so it is released by the
+	 * caller.
+	 */
+	reassembly_cancel(reass);
+	verdict = NET_DROP;
+
+out:
+	k_mutex_unlock(&reassembly_lock);
+
+	return verdict;
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt, uint16_t id,
+			      uint16_t fit_len, uint16_t frag_offset,
+			      bool final)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *frag_hdr;
+	struct net_pkt *frag_pkt;
+	uint8_t hdr_len = net_pkt_ip_hdr_len(pkt);
+	uint8_t opts_len = net_pkt_ipv4_opts_len(pkt);
+	uint8_t frag_opts_len;
+	uint16_t flag;
+	int ret = -ENOBUFS;
+
+	/* Only the first fragment carries the IPv4 options. Options that
+	 * must be copied to every fragment (RFC 791 "copied" flag) are not
+	 * generated by this stack.
+	 */
+	frag_opts_len = frag_offset ? 0U : opts_len;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt),
+					     frag_opts_len + fit_len,
+					     AF_INET, 0, NET_BUF_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	net_pkt_set_priority(frag_pkt, net_pkt_priority(pkt));
+
+	net_pkt_cursor_init(pkt);
+
+	/* Copy the IPv4 header and possible options */
+	if (net_pkt_copy(frag_pkt, pkt, hdr_len + frag_opts_len)) {
+		goto fail;
+	}
+
+	if (net_pkt_skip(pkt, opts_len - frag_opts_len + frag_offset)) {
+		goto fail;
+	}
+
+	if (net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_set_ip_hdr_len(frag_pkt, hdr_len);
+	net_pkt_set_ipv4_opts_len(frag_pkt, frag_opts_len);
+
+	net_pkt_cursor_init(frag_pkt);
+	net_pkt_set_overwrite(frag_pkt, true);
+
+	frag_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(frag_pkt,
+							   &ipv4_access);
+	if (!frag_hdr) {
+		goto fail;
+	}
+
+	flag = frag_offset / 8U;
+	if (!final) {
+		flag |= NET_IPV4_MF;
+	}
+
+	frag_hdr->vhl = 0x40 | ((hdr_len + frag_opts_len) >> 2);
+	frag_hdr->len = htons(net_pkt_get_len(frag_pkt));
+	sys_put_be16(id, frag_hdr->id);
+	sys_put_be16(flag, frag_hdr->offset);
+
+	frag_hdr->chksum = 0U;
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(frag_pkt))) {
+		frag_hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	net_pkt_set_data(frag_pkt, &ipv4_access);
+
+	NET_DBG("Sending fragment len %zd", net_pkt_get_len(frag_pkt));
+
+	if (net_send_data(frag_pkt) < 0) {
+		goto fail;
+	}
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+static int net_ipv4_send_fragmented_pkt(struct net_pkt *pkt, uint16_t mtu)
+{
+	uint8_t hdr_len = net_pkt_ip_hdr_len(pkt);
+	uint8_t opts_len = net_pkt_ipv4_opts_len(pkt);
+	uint16_t payload_len;
+	uint16_t frag_offset = 0U;
+	uint16_t fit_len;
+	uint16_t id;
+	int ret;
+
+	payload_len = net_pkt_get_len(pkt) - hdr_len - opts_len;
+
+	/* Every fragment, except the last one, must carry a multiple of
+	 * 8 bytes of payload. The first fragment is the only one having
+	 * the options so it determines how much data fits in each one.
+	 */
+	fit_len = (mtu - hdr_len - opts_len) & ~0x07;
+	if (!fit_len) {
+		return -EINVAL;
+	}
+
+	id = (uint16_t)sys_rand32_get();
+
+	while (frag_offset < payload_len) {
+		bool final = false;
+
+		if ((frag_offset + fit_len) >= payload_len) {
+			final = true;
+			fit_len = payload_len - frag_offset;
+		}
+
+		ret = send_ipv4_fragment(pkt, id, fit_len, frag_offset, final);
+		if (ret < 0) {
+			return ret;
+		}
+
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ip_hdr;
+	uint16_t mtu;
+	int ret;
+
+	mtu = net_if_get_mtu(net_pkt_iface(pkt));
+	if (!mtu) {
+		mtu = NET_IPV4_MTU;
+	}
+
+	/* A GSO packet is split into packets that fit the MTU just
+	 * before L2, so it must not be fragmented.
+	 */
+	if (net_pkt_get_len(pkt) <= mtu || net_pkt_gso_size(pkt)) {
+		return NET_OK;
+	}
+
+	/* The original packet is only read from now on */
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+
+	ip_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!ip_hdr) {
+		return NET_DROP;
+	}
+
+	if (sys_get_be16(ip_hdr->offset) & NET_IPV4_DF) {
+		NET_DBG("Packet len %zd larger than MTU %u and DF set",
+			net_pkt_get_len(pkt), mtu);
+		return NET_DROP;
+	}
+
+	ret = net_ipv4_send_fragmented_pkt(pkt, mtu);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+
+		if (ret == -ENOMEM) {
+			/* Try to send the packet if we could not allocate
+			 * space for the fragments. This is just a last
+			 * resort, as the packet is bigger than the MTU and
+			 * will probably be dropped by the link.
+			 */
+			return NET_OK;
+		}
+
+		return NET_DROP;
+	}
+
+	/* We need to unref here because we simulate the packet being
+	 * sent.
+	 */
+	net_pkt_unref(pkt);
+
+	/* No need to continue with the sending as the packet is now split
+	 * and its fragments will be sent separately to the network.
+	 */
+	return NET_CONTINUE;
+}
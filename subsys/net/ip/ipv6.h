@@ -392,16 +392,16 @@ static inline void net_ipv6_nbr_set_reachable_timer(struct net_if *iface,
 
 /** Store pending IPv6 fragment information that is needed for reassembly. */
 struct net_ipv6_reassembly {
+	/** Node in the reassembly lookup table or in the free list */
+	sys_snode_t node;
+
 	/** IPv6 source address of the fragment */
 	struct in6_addr src;
 
 	/** IPv6 destination address of the fragment */
 	struct in6_addr dst;
 
-	/**
-	 * Timeout for cancelling the reassembly. The timer is used
-	 * also to detect if this reassembly slot is used or not.
-	 */
+	/** Timeout for cancelling the reassembly */
 	struct k_delayed_work timer;
 
 	/** Pointers to pending fragments */
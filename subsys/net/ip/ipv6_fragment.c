@@ -46,6 +46,18 @@ static bool reassembly_init_done;
 static struct net_ipv6_reassembly
 reassembly[CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT];
 
+/* Pending reassemblies are looked up by hashing (src, dst, id) so that the
+ * cost of handling a fragment does not grow with the number of slots.
+ */
+static sys_slist_t reassembly_hash_table[CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE];
+static sys_slist_t reassembly_free;
+
+/* Fragments are handled in the RX path and the pending reassemblies are
+ * expired from the system work queue, so the slots and the lookup table
+ * are protected by this lock.
+ */
+static K_MUTEX_DEFINE(reassembly_lock);
+
 int net_ipv6_find_last_ext_hdr(struct net_pkt *pkt, uint16_t *next_hdr_off,
 			       uint16_t *last_hdr_off)
 {
@@ -121,89 +133,140 @@ fail:
 	return -EINVAL;
 }
 
-static struct net_ipv6_reassembly *reassembly_get(uint32_t id,
-						  struct in6_addr *src,
-						  struct in6_addr *dst)
+static uint32_t reassembly_hash(uint32_t id, const struct in6_addr *src,
+				const struct in6_addr *dst)
+{
+	uint32_t hash = id;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		hash ^= UNALIGNED_GET(&src->s6_addr32[i]);
+		hash = (hash << 5) | (hash >> 27);
+		hash ^= UNALIGNED_GET(&dst->s6_addr32[i]);
+		hash = (hash << 5) | (hash >> 27);
+	}
+
+	/* Mix the upper bits in as the bucket count is usually small */
+	hash ^= hash >> 16;
+	hash *= 0x45d9f3bU;
+	hash ^= hash >> 16;
+
+	return hash % CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE;
+}
+
+static void reassembly_init(void)
 {
-	int i, avail = -1;
+	int i;
+
+	/* Static initializing does not work here because of the array
+	 * so we must do it at runtime.
+	 */
+	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE; i++) {
+		sys_slist_init(&reassembly_hash_table[i]);
+	}
+
+	sys_slist_init(&reassembly_free);
 
 	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
+		k_delayed_work_init(&reassembly[i].timer, reassembly_timeout);
+		sys_slist_append(&reassembly_free, &reassembly[i].node);
+	}
 
-		if (k_delayed_work_remaining_get(&reassembly[i].timer) &&
-		    reassembly[i].id == id &&
-		    net_ipv6_addr_cmp(src, &reassembly[i].src) &&
-		    net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			return &reassembly[i];
-		}
+	reassembly_init_done = true;
+}
 
-		if (k_delayed_work_remaining_get(&reassembly[i].timer)) {
-			continue;
-		}
+static struct net_ipv6_reassembly *reassembly_find(sys_slist_t *bucket,
+						   uint32_t id,
+						   struct in6_addr *src,
+						   struct in6_addr *dst)
+{
+	struct net_ipv6_reassembly *reass;
 
-		if (avail < 0) {
-			avail = i;
+	SYS_SLIST_FOR_EACH_CONTAINER(bucket, reass, node) {
+		if (reass->id == id &&
+		    net_ipv6_addr_cmp(src, &reass->src) &&
+		    net_ipv6_addr_cmp(dst, &reass->dst)) {
+			return reass;
 		}
 	}
 
-	if (avail < 0) {
+	return NULL;
+}
+
+static struct net_ipv6_reassembly *reassembly_get(uint32_t id,
+						  struct in6_addr *src,
+						  struct in6_addr *dst)
+{
+	sys_slist_t *bucket;
+	struct net_ipv6_reassembly *reass;
+	sys_snode_t *node;
+
+	bucket = &reassembly_hash_table[reassembly_hash(id, src, dst)];
+
+	reass = reassembly_find(bucket, id, src, dst);
+	if (reass) {
+		return reass;
+	}
+
+	node = sys_slist_get(&reassembly_free);
+	if (!node) {
 		return NULL;
 	}
 
-	k_delayed_work_submit(&reassembly[avail].timer,
-			      IPV6_REASSEMBLY_TIMEOUT);
+	reass = CONTAINER_OF(node, struct net_ipv6_reassembly, node);
+
+	k_delayed_work_submit(&reass->timer, IPV6_REASSEMBLY_TIMEOUT);
+
+	net_ipaddr_copy(&reass->src, src);
+	net_ipaddr_copy(&reass->dst, dst);
 
-	net_ipaddr_copy(&reassembly[avail].src, src);
-	net_ipaddr_copy(&reassembly[avail].dst, dst);
+	reass->id = id;
 
-	reassembly[avail].id = id;
+	sys_slist_prepend(bucket, &reass->node);
 
-	return &reassembly[avail];
+	return reass;
 }
 
-static bool reassembly_cancel(uint32_t id,
-			      struct in6_addr *src,
-			      struct in6_addr *dst)
+/* Take the reassembly slot out of the lookup table and return it to the
+ * free list. The caller is responsible for the stored fragments.
+ */
+static void reassembly_release(struct net_ipv6_reassembly *reass)
 {
-	int i, j;
+	sys_slist_t *bucket;
 
-	NET_DBG("Cancel 0x%x", id);
+	bucket = &reassembly_hash_table[reassembly_hash(reass->id,
+							 &reass->src,
+							 &reass->dst)];
 
-	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		int32_t remaining;
-
-		if (reassembly[i].id != id ||
-		    !net_ipv6_addr_cmp(src, &reassembly[i].src) ||
-		    !net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			continue;
-		}
+	k_delayed_work_cancel(&reass->timer);
 
-		remaining = k_delayed_work_remaining_get(&reassembly[i].timer);
-		if (remaining) {
-			k_delayed_work_cancel(&reassembly[i].timer);
-		}
+	if (sys_slist_find_and_remove(bucket, &reass->node)) {
+		sys_slist_append(&reassembly_free, &reass->node);
+	}
 
-		NET_DBG("IPv6 reassembly id 0x%x remaining %d ms",
-			reassembly[i].id, remaining);
+	reass->id = 0U;
+}
 
-		reassembly[i].id = 0U;
+static void reassembly_cancel(struct net_ipv6_reassembly *reass)
+{
+	int i;
 
-		for (j = 0; j < NET_IPV6_FRAGMENTS_MAX_PKT; j++) {
-			if (!reassembly[i].pkt[j]) {
-				continue;
-			}
+	NET_DBG("IPv6 reassembly id 0x%x remaining %d ms", reass->id,
+		k_delayed_work_remaining_get(&reass->timer));
 
-			NET_DBG("[%d] IPv6 reassembly pkt %p %zd bytes data",
-				j, reassembly[i].pkt[j],
-				net_pkt_get_len(reassembly[i].pkt[j]));
+	reassembly_release(reass);
 
-			net_pkt_unref(reassembly[i].pkt[j]);
-			reassembly[i].pkt[j] = NULL;
+	for (i = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			continue;
 		}
 
-		return true;
-	}
+		NET_DBG("[%d] IPv6 reassembly pkt %p %zd bytes data",
+			i, reass->pkt[i], net_pkt_get_len(reass->pkt[i]));
 
-	return false;
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
 }
 
 static void reassembly_info(char *str, struct net_ipv6_reassembly *reass)
@@ -219,26 +282,104 @@ static void reassembly_timeout(struct k_work *work)
 	struct net_ipv6_reassembly *reass =
 		CONTAINER_OF(work, struct net_ipv6_reassembly, timer);
 
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	/* The slot might have been completed and reused while this work
+	 * item was waiting to be run.
+	 */
+	if (k_delayed_work_remaining_get(&reass->timer)) {
+		goto out;
+	}
+
 	reassembly_info("Reassembly cancelled", reass);
 
-	reassembly_cancel(reass->id, &reass->src, &reass->dst);
+	reassembly_cancel(reass);
+
+out:
+	k_mutex_unlock(&reassembly_lock);
 }
 
-static void reassemble_packet(struct net_ipv6_reassembly *reass)
+/* Remove len bytes from the start of the packet by advancing the buffer
+ * data pointers, so that the payload is never moved around.
+ */
+static int pkt_pull_head(struct net_pkt *pkt, size_t len)
+{
+	while (len > 0 && pkt->buffer) {
+		struct net_buf *buf = pkt->buffer;
+
+		if (buf->len > len) {
+			net_buf_pull(buf, len);
+			len = 0;
+			break;
+		}
+
+		len -= buf->len;
+		pkt->buffer = net_buf_frag_del(NULL, buf);
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	return len ? -ENOBUFS : 0;
+}
+
+/* Remove the fragment header from the first fragment. Usually all the
+ * headers are in the first buffer, in which case the headers in front of
+ * the fragment header are moved over it instead of moving the payload.
+ */
+static int strip_frag_hdr(struct net_pkt *pkt, uint8_t *next_hdr)
 {
-	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access, struct net_ipv6_hdr);
 	NET_PKT_DATA_ACCESS_DEFINE(frag_access, struct net_ipv6_frag_hdr);
-	union {
-		struct net_ipv6_hdr *hdr;
-		struct net_ipv6_frag_hdr *frag_hdr;
-	} ipv6;
+	uint16_t start = net_pkt_ipv6_fragment_start(pkt);
+	struct net_ipv6_frag_hdr *frag_hdr;
+	struct net_buf *buf = pkt->buffer;
+
+	if (buf->len >= start + sizeof(struct net_ipv6_frag_hdr)) {
+		frag_hdr = (struct net_ipv6_frag_hdr *)(buf->data + start);
+		*next_hdr = frag_hdr->nexthdr;
+
+		memmove(buf->data + sizeof(struct net_ipv6_frag_hdr),
+			buf->data, start);
+		net_buf_pull(buf, sizeof(struct net_ipv6_frag_hdr));
+
+		net_pkt_cursor_init(pkt);
+
+		return 0;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_skip(pkt, start)) {
+		NET_ERR("Failed to move to fragment header");
+		return -ENOBUFS;
+	}
+
+	frag_hdr = (struct net_ipv6_frag_hdr *)net_pkt_get_data(pkt,
+								&frag_access);
+	if (!frag_hdr) {
+		NET_ERR("Failed to get fragment header");
+		return -ENOBUFS;
+	}
+
+	*next_hdr = frag_hdr->nexthdr;
 
+	if (net_pkt_pull(pkt, sizeof(struct net_ipv6_frag_hdr))) {
+		NET_ERR("Failed to remove fragment header");
+		return -ENOBUFS;
+	}
+
+	return 0;
+}
+
+static void reassemble_packet(struct net_ipv6_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access, struct net_ipv6_hdr);
+	struct net_ipv6_hdr *hdr;
 	struct net_pkt *pkt;
 	struct net_buf *last;
 	uint8_t next_hdr;
 	int i, len;
 
-	k_delayed_work_cancel(&reass->timer);
+	reassembly_release(reass);
 
 	NET_ASSERT(reass->pkt[0]);
 
@@ -252,8 +393,6 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 
 		pkt = reass->pkt[i];
 
-		net_pkt_cursor_init(pkt);
-
 		/* Get rid of IPv6 and fragment header which are at
 		 * the beginning of the fragment.
 		 */
@@ -263,15 +402,17 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 		NET_DBG("Removing %d bytes from start of pkt %p",
 			removed_len, pkt->buffer);
 
-		if (net_pkt_pull(pkt, removed_len)) {
+		if (pkt_pull_head(pkt, removed_len)) {
 			NET_ERR("Failed to pull headers");
-			reassembly_cancel(reass->id, &reass->src, &reass->dst);
+			reassembly_cancel(reass);
 			return;
 		}
 
 		/* Attach the data to previous pkt */
-		last->frags = pkt->buffer;
-		last = net_buf_frag_last(pkt->buffer);
+		if (pkt->buffer) {
+			last->frags = pkt->buffer;
+			last = net_buf_frag_last(pkt->buffer);
+		}
 
 		pkt->buffer = NULL;
 		reass->pkt[i] = NULL;
@@ -285,24 +426,7 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 	/* Next we need to strip away the fragment header from the first packet
 	 * and set the various pointers and values in packet.
 	 */
-	net_pkt_cursor_init(pkt);
-
-	if (net_pkt_skip(pkt, net_pkt_ipv6_fragment_start(pkt))) {
-		NET_ERR("Failed to move to fragment header");
-		goto error;
-	}
-
-	ipv6.frag_hdr = (struct net_ipv6_frag_hdr *)net_pkt_get_data(
-							pkt, &frag_access);
-	if (!ipv6.frag_hdr) {
-		NET_ERR("Failed to get fragment header");
-		goto error;
-	}
-
-	next_hdr = ipv6.frag_hdr->nexthdr;
-
-	if (net_pkt_pull(pkt, sizeof(struct net_ipv6_frag_hdr))) {
-		NET_ERR("Failed to remove fragment header");
+	if (strip_frag_hdr(pkt, &next_hdr)) {
 		goto error;
 	}
 
@@ -314,8 +438,8 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 
 	net_pkt_cursor_init(pkt);
 
-	ipv6.hdr = (struct net_ipv6_hdr *)net_pkt_get_data(pkt, &ipv6_access);
-	if (!ipv6.hdr) {
+	hdr = (struct net_ipv6_hdr *)net_pkt_get_data(pkt, &ipv6_access);
+	if (!hdr) {
 		goto error;
 	}
 
@@ -329,7 +453,7 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 
 	len = net_pkt_get_len(pkt) - sizeof(struct net_ipv6_hdr);
 
-	ipv6.hdr->len = htons(len);
+	hdr->len = htons(len);
 
 	net_pkt_set_data(pkt, &ipv6_access);
 
@@ -353,14 +477,19 @@ void net_ipv6_frag_foreach(net_ipv6_frag_cb_t cb, void *user_data)
 {
 	int i;
 
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
 	for (i = 0; reassembly_init_done &&
-		     i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		if (!k_delayed_work_remaining_get(&reassembly[i].timer)) {
-			continue;
-		}
+		     i < CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE; i++) {
+		struct net_ipv6_reassembly *reass, *next;
 
-		cb(&reassembly[i], user_data);
+		SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&reassembly_hash_table[i],
+						  reass, next, node) {
+			cb(reass, user_data);
+		}
 	}
+
+	k_mutex_unlock(&reassembly_lock);
 }
 
 /* Verify that we have all the fragments received and in correct order.
@@ -436,16 +565,10 @@ enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 	uint32_t id;
 	int i;
 
-	if (!reassembly_init_done) {
-		/* Static initializing does not work here because of the array
-		 * so we must do it at runtime.
-		 */
-		for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-			k_delayed_work_init(&reassembly[i].timer,
-					    reassembly_timeout);
-		}
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
 
-		reassembly_init_done = true;
+	if (!reassembly_init_done) {
+		reassembly_init();
 	}
 
 	/* Each fragment has a fragment header, however since we already
@@ -549,15 +672,20 @@ enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 	reassemble_packet(reass);
 
 accept:
+	k_mutex_unlock(&reassembly_lock);
+
 	return NET_OK;
 
 drop:
 	if (reass) {
-		if (reassembly_cancel(reass->id, &reass->src, &reass->dst)) {
-			return NET_OK;
-		}
+		reassembly_cancel(reass);
+		k_mutex_unlock(&reassembly_lock);
+
+		return NET_OK;
 	}
 
+	k_mutex_unlock(&reassembly_lock);
+
 	return NET_DROP;
 }
 
@@ -1254,6 +1254,54 @@ static int get_context_sndtimeo(struct net_context *context,
 #endif
 }
 
+static int get_context_tcp_quickack(struct net_context *context,
+				    void *value, size_t *len)
+{
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	*((bool *)value) = context->options.tcp_quickack;
+
+	if (len) {
+		*len = sizeof(bool);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int get_context_recv_pktinfo(struct net_context *context,
+				    void *value, size_t *len)
+{
+#if defined(CONFIG_NET_CONTEXT_RECV_PKTINFO)
+	*((bool *)value) = context->options.recv_pktinfo;
+
+	if (len) {
+		*len = sizeof(bool);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int get_context_max_pacing_rate(struct net_context *context,
+				       void *value, size_t *len)
+{
+#if defined(CONFIG_NET_CONTEXT_PACING)
+	*((uint32_t *)value) = context->options.pacing_rate;
+
+	if (len) {
+		*len = sizeof(uint32_t);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 /* If buf is not NULL, then use it. Otherwise read the data to be written
  * to net_pkt from msghdr.
  */
@@ -1405,6 +1453,57 @@ static void set_pkt_txtime(struct net_pkt *pkt, const struct msghdr *msghdr)
 	}
 }
 
+#if defined(CONFIG_NET_CONTEXT_PACING)
+/* Wait until the data of the previous send calls has been spread over
+ * time according to the pacing rate. The context lock is released while
+ * waiting so that the receive path of the context is not blocked.
+ */
+static int context_pacing_wait(struct net_context *context,
+			       k_timeout_t timeout)
+{
+	uint64_t now = k_ticks_to_ns_floor64(k_uptime_ticks());
+	uint64_t wait;
+
+	if (context->options.pacing_rate == 0U ||
+	    context->options.pacing_next <= now) {
+		return 0;
+	}
+
+	wait = context->options.pacing_next - now;
+
+	if (K_TIMEOUT_EQ(timeout, K_NO_WAIT) ||
+	    (!K_TIMEOUT_EQ(timeout, K_FOREVER) &&
+	     k_ticks_to_ns_floor64(timeout.ticks) < wait)) {
+		return -EAGAIN;
+	}
+
+	k_mutex_unlock(&context->lock);
+	k_sleep(K_NSEC(wait));
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	if (!net_context_is_used(context)) {
+		return -EBADF;
+	}
+
+	return 0;
+}
+
+static void context_pacing_update(struct net_context *context, size_t len)
+{
+	uint64_t now = k_ticks_to_ns_floor64(k_uptime_ticks());
+
+	if (context->options.pacing_rate == 0U) {
+		return;
+	}
+
+	context->options.pacing_next = MAX(context->options.pacing_next, now) +
+		(uint64_t)len * NSEC_PER_SEC / context->options.pacing_rate;
+}
+#else
+#define context_pacing_wait(...) 0
+#define context_pacing_update(...)
+#endif /* CONFIG_NET_CONTEXT_PACING */
+
 static int context_sendto(struct net_context *context,
 			  const void *buf,
 			  size_t len,
@@ -1621,6 +1720,11 @@ static int context_sendto(struct net_context *context,
 		return -ENETDOWN;
 	}
 
+	ret = context_pacing_wait(context, timeout);
+	if (ret < 0) {
+		return ret;
+	}
+
 	pkt = context_alloc_pkt(context, len, PKT_WAIT_TIME);
 	if (!pkt) {
 		return -ENOBUFS;
@@ -1760,6 +1864,8 @@ static int context_sendto(struct net_context *context,
 		goto fail;
 	}
 
+	context_pacing_update(context, len);
+
 	return len;
 fail:
 	net_pkt_unref(pkt);
@@ -2252,6 +2358,55 @@ static int set_context_sndtimeo(struct net_context *context,
 #endif
 }
 
+static int set_context_tcp_quickack(struct net_context *context,
+				    const void *value, size_t len)
+{
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	if (len > sizeof(bool)) {
+		return -EINVAL;
+	}
+
+	context->options.tcp_quickack = *((bool *)value);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int set_context_recv_pktinfo(struct net_context *context,
+				    const void *value, size_t len)
+{
+#if defined(CONFIG_NET_CONTEXT_RECV_PKTINFO)
+	if (len > sizeof(bool)) {
+		return -EINVAL;
+	}
+
+	context->options.recv_pktinfo = *((bool *)value);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int set_context_max_pacing_rate(struct net_context *context,
+				       const void *value, size_t len)
+{
+#if defined(CONFIG_NET_CONTEXT_PACING)
+	if (len != sizeof(uint32_t)) {
+		return -EINVAL;
+	}
+
+	context->options.pacing_rate = *((uint32_t *)value);
+	context->options.pacing_next = 0U;
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 int net_context_set_option(struct net_context *context,
 			   enum net_context_option option,
 			   const void *value, size_t len)
@@ -2285,6 +2440,15 @@ int net_context_set_option(struct net_context *context,
 	case NET_OPT_SNDTIMEO:
 		ret = set_context_sndtimeo(context, value, len);
 		break;
+	case NET_OPT_TCP_QUICKACK:
+		ret = set_context_tcp_quickack(context, value, len);
+		break;
+	case NET_OPT_RECV_PKTINFO:
+		ret = set_context_recv_pktinfo(context, value, len);
+		break;
+	case NET_OPT_MAX_PACING_RATE:
+		ret = set_context_max_pacing_rate(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -2325,6 +2489,15 @@ int net_context_get_option(struct net_context *context,
 	case NET_OPT_SNDTIMEO:
 		ret = get_context_sndtimeo(context, value, len);
 		break;
+	case NET_OPT_TCP_QUICKACK:
+		ret = get_context_tcp_quickack(context, value, len);
+		break;
+	case NET_OPT_RECV_PKTINFO:
+		ret = get_context_recv_pktinfo(context, value, len);
+		break;
+	case NET_OPT_MAX_PACING_RATE:
+		ret = get_context_max_pacing_rate(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -40,6 +40,7 @@ LOG_MODULE_REGISTER(net_core, CONFIG_NET_CORE_LOG_LEVEL);
 #include "ipv6.h"
 
 #include "icmpv4.h"
+#include "ipv4.h"
 
 #include "dhcpv4.h"
 
@@ -55,6 +56,127 @@ LOG_MODULE_REGISTER(net_core, CONFIG_NET_CORE_LOG_LEVEL);
 
 #include "net_stats.h"
 
+static enum net_verdict process_ip_data(struct net_pkt *pkt, bool is_loopback);
+
+#if defined(CONFIG_NET_RX_STEERING) || defined(CONFIG_NET_TC_TX_FQ)
+static inline uint32_t flow_hash_mix(uint32_t hash, uint32_t val)
+{
+	hash ^= val;
+	hash *= 0x9e3779b1U;
+
+	return hash ^ (hash >> 16);
+}
+
+/* Hash the IP addresses, the protocol and for TCP and UDP also the ports.
+ * Only the first fragment of a datagram carries the ports, so fragments
+ * are hashed on the addresses and the fragment identification instead.
+ * This way all the fragments of a datagram end up in the same flow and
+ * are reassembled by one RX worker. The cursor needs to be at the start
+ * of the IP header.
+ */
+uint32_t net_pkt_flow_hash(struct net_pkt *pkt)
+{
+	struct net_pkt_cursor backup;
+	uint32_t hash = 0U;
+	uint32_t ports = 0U;
+	size_t hdr_len = 0;
+	uint8_t proto = 0U;
+	int i;
+
+	switch (NET_IPV6_HDR(pkt)->vtc & 0xf0) {
+#if defined(CONFIG_NET_IPV6)
+	case 0x60: {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *hdr;
+
+		hdr = (struct net_ipv6_hdr *)net_pkt_get_data(pkt,
+							      &ipv6_access);
+		if (!hdr) {
+			return 0U;
+		}
+
+		for (i = 0; i < 4; i++) {
+			hash = flow_hash_mix(
+				hash, UNALIGNED_GET(&hdr->src.s6_addr32[i]));
+			hash = flow_hash_mix(
+				hash, UNALIGNED_GET(&hdr->dst.s6_addr32[i]));
+		}
+
+		/* Extension headers are not followed, so a fragment header
+		 * after other extension headers is hashed like any other
+		 * extension header, on the addresses only.
+		 */
+		proto = hdr->nexthdr;
+		hdr_len = sizeof(struct net_ipv6_hdr);
+
+		if (proto == NET_IPV6_NEXTHDR_FRAG) {
+			uint32_t id = 0U;
+
+			net_pkt_cursor_backup(pkt, &backup);
+
+			if (net_pkt_skip(pkt, hdr_len +
+					 offsetof(struct net_ipv6_frag_hdr,
+						  id)) ||
+			    net_pkt_read(pkt, &id, sizeof(id))) {
+				id = 0U;
+			}
+
+			net_pkt_cursor_restore(pkt, &backup);
+
+			hash = flow_hash_mix(hash, id);
+			hdr_len = 0;
+		}
+
+		break;
+	}
+#endif
+#if defined(CONFIG_NET_IPV4)
+	case 0x40: {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *hdr;
+
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt,
+							      &ipv4_access);
+		if (!hdr) {
+			return 0U;
+		}
+
+		hash = flow_hash_mix(hash, UNALIGNED_GET(&hdr->src.s_addr));
+		hash = flow_hash_mix(hash, UNALIGNED_GET(&hdr->dst.s_addr));
+
+		proto = hdr->proto;
+		hdr_len = (hdr->vhl & NET_IPV4_IHL_MASK) * 4U;
+
+		if (sys_get_be16(hdr->offset) &
+		    (NET_IPV4_MF | NET_IPV4_FRAGH_OFFSET_MASK)) {
+			hash = flow_hash_mix(hash, sys_get_be16(hdr->id));
+			hdr_len = 0;
+		}
+
+		break;
+	}
+#endif
+	default:
+		return 0U;
+	}
+
+	if (hdr_len && (proto == IPPROTO_TCP || proto == IPPROTO_UDP)) {
+		net_pkt_cursor_backup(pkt, &backup);
+
+		if (net_pkt_skip(pkt, hdr_len) ||
+		    net_pkt_read(pkt, &ports, sizeof(ports))) {
+			ports = 0U;
+		}
+
+		net_pkt_cursor_restore(pkt, &backup);
+	}
+
+	return flow_hash_mix(flow_hash_mix(hash, proto), ports);
+}
+#endif /* CONFIG_NET_RX_STEERING || CONFIG_NET_TC_TX_FQ */
+
 static inline enum net_verdict process_data(struct net_pkt *pkt,
 					    bool is_loopback)
 {
@@ -76,6 +198,13 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	/* Same as above but for reassembled IPv4 packets. */
+	if (net_pkt_ipv4_reassembled(pkt)) {
+		locally_routed = true;
+	}
+#endif
+
 	/* If there is no data, then drop the packet. */
 	if (!pkt->frags) {
 		NET_DBG("Corrupted packet (frags %p)", pkt->frags);
@@ -107,6 +236,19 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	 */
 	net_pkt_cursor_init(pkt);
 
+#if defined(CONFIG_NET_RX_STEERING)
+	if (!is_loopback &&
+	    net_if_flag_is_set(net_pkt_iface(pkt), NET_IF_RX_STEERING)) {
+		net_tc_submit_to_rx_worker(net_pkt_flow_hash(pkt), pkt);
+		return NET_OK;
+	}
+#endif
+
+	return process_ip_data(pkt, is_loopback);
+}
+
+static enum net_verdict process_ip_data(struct net_pkt *pkt, bool is_loopback)
+{
 	/* IP version and header length. */
 	switch (NET_IPV6_HDR(pkt)->vtc & 0xf0) {
 #if defined(CONFIG_NET_IPV6)
@@ -308,6 +450,18 @@ int net_send_data(struct net_pkt *pkt)
 		 * to RX processing.
 		 */
 		NET_DBG("Loopback pkt %p back to us", pkt);
+
+		/* A GSO packet is only split by the interface, so it is
+		 * received here as one large segment. It still needs the
+		 * checksum it would have got when split.
+		 */
+		if (IS_ENABLED(CONFIG_NET_TCP_GSO) && net_pkt_gso_size(pkt)) {
+			status = net_tcp_gso_finalize(pkt);
+			if (status < 0) {
+				return status;
+			}
+		}
+
 		processing_data(pkt, true);
 		return 0;
 	}
@@ -319,6 +473,22 @@ int net_send_data(struct net_pkt *pkt)
 	return 0;
 }
 
+#if defined(CONFIG_NET_RX_STEERING)
+void net_process_steered_packet(struct net_pkt *pkt)
+{
+	switch (process_ip_data(pkt, false)) {
+	case NET_OK:
+		NET_DBG("Consumed pkt %p", pkt);
+		break;
+	case NET_DROP:
+	default:
+		NET_DBG("Dropping pkt %p", pkt);
+		net_pkt_unref(pkt);
+		break;
+	}
+}
+#endif
+
 static void net_rx(struct net_if *iface, struct net_pkt *pkt)
 {
 	bool is_loopback = false;
@@ -344,24 +514,18 @@ static void net_rx(struct net_if *iface, struct net_pkt *pkt)
 	net_pkt_print();
 }
 
-static void process_rx_packet(struct k_work *work)
+void net_process_rx_packet(struct net_pkt *pkt)
 {
-	struct net_pkt *pkt;
-
-	pkt = CONTAINER_OF(work, struct net_pkt, work);
-
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
 
 	net_rx(net_pkt_iface(pkt), pkt);
 }
 
-static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
+static uint8_t net_queue_rx_prepare(struct net_if *iface, struct net_pkt *pkt)
 {
 	uint8_t prio = net_pkt_priority(pkt);
 	uint8_t tc = net_rx_priority2tc(prio);
 
-	k_work_init(net_pkt_work(pkt), process_rx_packet);
-
 #if defined(CONFIG_NET_STATISTICS)
 	net_stats_update_tc_recv_pkt(iface, tc);
 	net_stats_update_tc_recv_bytes(iface, tc, net_pkt_get_len(pkt));
@@ -372,11 +536,15 @@ static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
 	NET_DBG("TC %d with prio %d pkt %p", tc, prio, pkt);
 #endif
 
-	net_tc_submit_to_rx_queue(tc, pkt);
+	return tc;
 }
 
-/* Called by driver when an IP packet has been received */
-int net_recv_data(struct net_if *iface, struct net_pkt *pkt)
+static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
+{
+	net_tc_submit_to_rx_queue(net_queue_rx_prepare(iface, pkt), pkt);
+}
+
+static int net_recv_data_check(struct net_if *iface, struct net_pkt *pkt)
 {
 	if (!pkt || !iface) {
 		return -EINVAL;
@@ -390,6 +558,11 @@ int net_recv_data(struct net_if *iface, struct net_pkt *pkt)
 		return -ENETDOWN;
 	}
 
+	return 0;
+}
+
+static void net_recv_data_setup(struct net_if *iface, struct net_pkt *pkt)
+{
 	net_pkt_set_overwrite(pkt, true);
 	net_pkt_cursor_init(pkt);
 
@@ -401,12 +574,104 @@ int net_recv_data(struct net_if *iface, struct net_pkt *pkt)
 	}
 
 	net_pkt_set_iface(pkt, iface);
+}
+
+/* Called by driver when an IP packet has been received */
+int net_recv_data(struct net_if *iface, struct net_pkt *pkt)
+{
+	int ret;
+
+	ret = net_recv_data_check(iface, pkt);
+	if (ret < 0) {
+		return ret;
+	}
+
+	net_recv_data_setup(iface, pkt);
 
 	net_queue_rx(iface, pkt);
 
 	return 0;
 }
 
+/* Called by driver when a number of packets have been received */
+int net_recv_data_batch(struct net_if *iface, struct net_pkt **pkts,
+			int count)
+{
+	sys_slist_t lists[NET_TC_RX_COUNT];
+	uint32_t now = k_cycle_get_32();
+	uint8_t tc;
+	int i, ret;
+
+	if (!pkts || count <= 0) {
+		return -EINVAL;
+	}
+
+	/* Either all or none of the packets are queued so that the caller
+	 * knows which packets it still owns.
+	 */
+	for (i = 0; i < count; i++) {
+		ret = net_recv_data_check(iface, pkts[i]);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	for (tc = 0; tc < NET_TC_RX_COUNT; tc++) {
+		sys_slist_init(&lists[tc]);
+	}
+
+	for (i = 0; i < count; i++) {
+		net_recv_data_setup(iface, pkts[i]);
+		net_pkt_set_rx_stats_tick(pkts[i], now);
+
+		tc = net_queue_rx_prepare(iface, pkts[i]);
+
+		/* The first word of the packet is reserved for the queue */
+		sys_slist_append(&lists[tc], (sys_snode_t *)pkts[i]);
+	}
+
+	for (tc = 0; tc < NET_TC_RX_COUNT; tc++) {
+		if (!sys_slist_is_empty(&lists[tc])) {
+			net_tc_submit_list_to_rx_queue(tc, &lists[tc]);
+		}
+	}
+
+	return 0;
+}
+
+static void rx_poll_handler(struct k_work *work)
+{
+	struct net_rx_poll *poll = CONTAINER_OF(work, struct net_rx_poll,
+						work);
+	int done;
+
+	done = poll->cb(poll->iface, CONFIG_NET_RX_BATCH_BUDGET);
+
+	NET_DBG("iface %p polled %d pkts", poll->iface, done);
+
+	/* The driver used the whole budget so there is probably more data
+	 * pending. Continue polling after the queued packets are processed.
+	 * Otherwise the driver has re-enabled its RX interrupt and will call
+	 * net_rx_poll_schedule() when new data arrives.
+	 */
+	if (done >= CONFIG_NET_RX_BATCH_BUDGET) {
+		net_rx_poll_schedule(poll);
+	}
+}
+
+void net_rx_poll_init(struct net_rx_poll *poll, struct net_if *iface,
+		      net_rx_poll_cb_t cb)
+{
+	k_work_init(&poll->work, rx_poll_handler);
+	poll->iface = iface;
+	poll->cb = cb;
+}
+
+void net_rx_poll_schedule(struct net_rx_poll *poll)
+{
+	net_tc_submit_work_to_rx_queue(net_rx_priority2tc(0), &poll->work);
+}
+
 static inline void l3_init(void)
 {
 	net_icmpv4_init();
@@ -21,7 +21,9 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 #include <net/ethernet.h>
 
 #include "net_private.h"
+#include "ipv4.h"
 #include "ipv6.h"
+#include "tcp_internal.h"
 #include "ipv4_autoconf_internal.h"
 
 #include "net_stats.h"
@@ -202,6 +204,21 @@ static void update_txtime_stats_detail(struct net_pkt *pkt,
 	}
 }
 
+/* Packets posted to the driver earlier in the TX batch may be waiting for
+ * one that failed, or that ended the batch but never reached the driver,
+ * let the driver start transmitting them.
+ */
+static void net_if_tx_flush(struct net_if *iface)
+{
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		net_eth_tx_flush(iface);
+	}
+#else
+	ARG_UNUSED(iface);
+#endif
+}
+
 static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 {
 	struct net_linkaddr ll_dst = {
@@ -209,6 +226,7 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 	};
 	struct net_linkaddr_storage ll_dst_storage;
 	struct net_context *context;
+	bool batch_end;
 	int status;
 
 	/* Timestamp of the current network packet sent if enabled */
@@ -222,6 +240,9 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 		return false;
 	}
 
+	/* Read before the L2 consumes the packet */
+	batch_end = !net_pkt_tx_more(pkt);
+
 	debug_check_packet(pkt);
 
 	/* If there're any link callbacks, with such a callback receiving
@@ -268,7 +289,11 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 			}
 		}
 
-		status = net_if_l2(iface)->send(iface, pkt);
+		if (IS_ENABLED(CONFIG_NET_TCP_GSO) && net_pkt_gso_size(pkt)) {
+			status = net_tcp_gso_send(iface, pkt);
+		} else {
+			status = net_if_l2(iface)->send(iface, pkt);
+		}
 
 		if (IS_ENABLED(CONFIG_NET_CONTEXT_TIMESTAMP) && status >= 0 &&
 		    context) {
@@ -314,6 +339,10 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 		status = -ENETDOWN;
 	}
 
+	if (status < 0 || batch_end) {
+		net_if_tx_flush(iface);
+	}
+
 	if (status < 0) {
 		net_pkt_unref(pkt);
 	} else {
@@ -346,12 +375,9 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 	return true;
 }
 
-static void process_tx_packet(struct k_work *work)
+void net_process_tx_packet(struct net_pkt *pkt)
 {
 	struct net_if *iface;
-	struct net_pkt *pkt;
-
-	pkt = CONTAINER_OF(work, struct net_pkt, work);
 
 	net_pkt_set_tx_stats_tick(pkt, k_cycle_get_32());
 
@@ -369,8 +395,6 @@ void net_if_queue_tx(struct net_if *iface, struct net_pkt *pkt)
 	uint8_t prio = net_pkt_priority(pkt);
 	uint8_t tc = net_tx_priority2tc(prio);
 
-	k_work_init(net_pkt_work(pkt), process_tx_packet);
-
 	net_stats_update_tc_sent_pkt(iface, tc);
 	net_stats_update_tc_sent_bytes(iface, tc, net_pkt_get_len(pkt));
 	net_stats_update_tc_sent_priority(iface, tc, prio);
@@ -473,9 +497,15 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 
 #if defined(CONFIG_NET_LOOPBACK)
 	/* If the packet is destined back to us, then there is no need to do
-	 * additional checks, so let the packet through.
+	 * additional checks, so let the packet through. It must still be
+	 * fragmented if the interface has an MTU that it does not fit.
 	 */
 	if (net_if_l2(iface) == &NET_L2_GET_NAME(DUMMY)) {
+		if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		    net_pkt_family(pkt) == AF_INET && net_if_get_mtu(iface)) {
+			verdict = net_ipv4_prepare_for_send(pkt);
+		}
+
 		goto done;
 	}
 #endif
@@ -487,6 +517,10 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 		verdict = net_ipv6_prepare_for_send(pkt);
 	}
 
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		verdict = net_ipv4_prepare_for_send(pkt);
+	}
+
 done:
 	/*   NET_OK in which case packet has checked successfully. In this case
 	 *   the net_context callback is called after successful delivery in
@@ -968,6 +968,13 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 
 		max_len = MAX(max_len, NET_IPV6_MTU);
 	} else if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
+		if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) && (size > max_len)) {
+			/* We support larger packets if IPv4 fragmentation is
+			 * enabled.
+			 */
+			max_len = size;
+		}
+
 		max_len = MAX(max_len, NET_IPV4_MTU);
 	} else { /* family == AF_UNSPEC */
 #if defined (CONFIG_NET_L2_ETHERNET)
@@ -1762,16 +1769,41 @@ static void clone_pkt_attributes(struct net_pkt *pkt, struct net_pkt *clone_pkt)
 struct net_pkt *net_pkt_clone(struct net_pkt *pkt, k_timeout_t timeout)
 {
 	size_t cursor_offset = net_pkt_get_current_offset(pkt);
+	size_t len = net_pkt_get_len(pkt);
 	struct net_pkt *clone_pkt;
 	struct net_pkt_cursor backup;
+	size_t available;
 
-	clone_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt),
-					      net_pkt_get_len(pkt),
+	clone_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), len,
 					      AF_UNSPEC, 0, timeout);
 	if (!clone_pkt) {
 		return NULL;
 	}
 
+	/* The buffer length is limited by the MTU, but a packet that has been
+	 * reassembled or merged on receive can be larger than that.
+	 */
+	available = net_pkt_available_buffer(clone_pkt);
+	if (available < len) {
+		struct net_buf_pool *pool;
+		struct net_buf *buf;
+
+		pool = clone_pkt->slab == &tx_pkts ? &tx_bufs : &rx_bufs;
+
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+		buf = pkt_alloc_buffer(pool, len - available, timeout,
+				       __func__, __LINE__);
+#else
+		buf = pkt_alloc_buffer(pool, len - available, timeout);
+#endif
+		if (!buf) {
+			net_pkt_unref(clone_pkt);
+			return NULL;
+		}
+
+		net_pkt_append_buffer(clone_pkt, buf);
+	}
+
 	net_pkt_cursor_backup(pkt, &backup);
 	net_pkt_cursor_init(pkt);
 
@@ -88,6 +88,18 @@ static inline enum net_verdict net_ipv6_input(struct net_pkt *pkt,
 #endif
 extern bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt);
 extern void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt);
+extern void net_tc_submit_list_to_rx_queue(uint8_t tc, sys_slist_t *list);
+extern void net_tc_submit_work_to_rx_queue(uint8_t tc, struct k_work *work);
+extern struct k_work_q *net_tc_rx_current_queue(void);
+extern void net_process_rx_packet(struct net_pkt *pkt);
+extern void net_process_tx_packet(struct net_pkt *pkt);
+#if defined(CONFIG_NET_RX_STEERING) || defined(CONFIG_NET_TC_TX_FQ)
+extern uint32_t net_pkt_flow_hash(struct net_pkt *pkt);
+#endif
+#if defined(CONFIG_NET_RX_STEERING)
+extern void net_tc_submit_to_rx_worker(uint32_t hash, struct net_pkt *pkt);
+extern void net_process_steered_packet(struct net_pkt *pkt);
+#endif
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
 char *net_sprint_addr(sa_family_t af, const void *addr);
@@ -158,6 +170,54 @@ extern char *net_byte_to_hex(char *ptr, uint8_t byte, char base, bool pad);
 extern char *net_sprint_ll_addr_buf(const uint8_t *ll, uint8_t ll_len,
 				    char *buf, int buflen);
 extern uint16_t net_calc_chksum(struct net_pkt *pkt, uint8_t proto);
+extern uint16_t net_calc_chksum_buf(uint16_t sum, const uint8_t *data,
+				    size_t len);
+
+/**
+ * @brief Update a checksum after a 16 bit field covered by it has changed,
+ * without summing the whole data again (RFC 1624, eqn. 3).
+ *
+ * @param chksum Old checksum as found in the header.
+ * @param old_val Old value of the field.
+ * @param new_val New value of the field.
+ *
+ * All the values are in network byte order as the one's complement sum
+ * does not depend on it.
+ *
+ * @return New checksum
+ */
+static inline uint16_t net_chksum_update_u16(uint16_t chksum,
+					     uint16_t old_val,
+					     uint16_t new_val)
+{
+	uint32_t sum;
+
+	sum = (uint16_t)~chksum + (uint16_t)~old_val + new_val;
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum;
+}
+
+/**
+ * @brief Update a checksum after a 32 bit field, for example an IPv4
+ * address, covered by it has changed.
+ *
+ * @param chksum Old checksum as found in the header.
+ * @param old_val Old value of the field.
+ * @param new_val New value of the field.
+ *
+ * @return New checksum
+ */
+static inline uint16_t net_chksum_update_u32(uint16_t chksum,
+					     uint32_t old_val,
+					     uint32_t new_val)
+{
+	chksum = net_chksum_update_u16(chksum, old_val >> 16, new_val >> 16);
+
+	return net_chksum_update_u16(chksum, old_val & 0xffff,
+				     new_val & 0xffff);
+}
 
 /**
  * @brief Deliver the incoming packet through the recv_cb of the net_context
@@ -37,6 +37,7 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #include <sys/slist.h>
 #endif
 
+#include "ipv4.h"
 #include "ipv6.h"
 
 #if defined(CONFIG_NET_ARP)
@@ -1470,6 +1471,51 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 }
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static void ipv4_frag_cb(struct net_ipv4_reassembly *reass,
+			 void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int *count = data->user_data;
+	char src[ADDR_LEN];
+	int i;
+
+	if (!*count) {
+		PR("\nIPv4 reassembly Id     Remain "
+		   "Src             \tDst\n");
+	}
+
+	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv4_addr(&reass->src));
+
+	PR("%p      0x%04x  %5d %16s\t%16s\n",
+	   reass, reass->id,
+	   k_delayed_work_remaining_get(&reass->timer),
+	   src, net_sprint_ipv4_addr(&reass->dst));
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		if (reass->pkt[i]) {
+			struct net_buf *frag = reass->pkt[i]->frags;
+
+			PR("[%d] pkt %p->", i, reass->pkt[i]);
+
+			while (frag) {
+				PR("%p", frag);
+
+				frag = frag->frags;
+				if (frag) {
+					PR("->");
+				}
+			}
+
+			PR("\n");
+		}
+	}
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 static void allocs_cb(struct net_pkt *pkt,
 		      struct net_buf *buf,
@@ -1708,6 +1754,12 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 	/* Do not print anything if no fragments are pending atm */
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	count = 0;
+
+	net_ipv4_frag_foreach(ipv4_frag_cb, &user_data);
+#endif
+
 #else
 	PR_INFO("Set %s to enable %s support.\n",
 		"CONFIG_NET_OFFLOAD or CONFIG_NET_NATIVE",
@@ -1816,7 +1868,50 @@ static void print_dns_info(const struct shell *shell,
 		}
 	}
 }
-#endif
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static void dns_cache_cb(const char *query, enum dns_query_type type,
+			 const struct sockaddr *addrs, int count,
+			 uint32_t ttl, void *user_data)
+{
+	const struct shell *shell = user_data;
+	int i;
+
+	PR("\t%s %s ttl %u\n", query,
+	   type == DNS_QUERY_TYPE_A ? "A" : "AAAA", ttl);
+
+	if (count == 0) {
+		PR("\t\t<no such name>\n");
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (addrs[i].sa_family == AF_INET) {
+			PR("\t\t%s\n", net_sprint_ipv4_addr(
+				   &net_sin(&addrs[i])->sin_addr));
+		} else if (addrs[i].sa_family == AF_INET6) {
+			PR("\t\t%s\n", net_sprint_ipv6_addr(
+				   &net_sin6(&addrs[i])->sin6_addr));
+		}
+	}
+}
+
+static void print_dns_cache(const struct shell *shell)
+{
+	struct dns_resolve_cache_stats stats;
+
+	dns_resolve_cache_stats_get(&stats);
+
+	PR("DNS cache:\n");
+	PR("\tHits %u, negative hits %u, misses %u\n", stats.hits,
+	   stats.negative_hits, stats.misses);
+	PR("\tEvictions %u, shared queries %u\n", stats.evictions,
+	   stats.shared);
+
+	dns_resolve_cache_foreach(dns_cache_cb, (void *)shell);
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+#endif /* CONFIG_DNS_RESOLVER */
 
 static int cmd_net_dns_cancel(const struct shell *shell, size_t argc,
 			      char *argv[])
@@ -1859,6 +1954,39 @@ static int cmd_net_dns_cancel(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+static int cmd_net_dns_cache(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	print_dns_cache(shell);
+#else
+	PR_INFO("Set %s to enable %s support.\n",
+		"CONFIG_DNS_RESOLVER_CACHE", "DNS cache");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_dns_cache_flush(const struct shell *shell, size_t argc,
+				   char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	dns_resolve_cache_flush();
+	PR("DNS cache flushed.\n");
+#else
+	PR_INFO("Set %s to enable %s support.\n",
+		"CONFIG_DNS_RESOLVER_CACHE", "DNS cache");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_dns_query(const struct shell *shell, size_t argc,
 			     char *argv[])
 {
@@ -1929,6 +2057,10 @@ static int cmd_net_dns(const struct shell *shell, size_t argc, char *argv[])
 	}
 
 	print_dns_info(shell, ctx);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	print_dns_cache(shell);
+#endif
 #else
 	PR_INFO("DNS resolver not supported. Set CONFIG_DNS_RESOLVER to "
 		"enable it.\n");
@@ -5200,7 +5332,16 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_arp,
 	SHELL_SUBCMD_SET_END
 );
 
+SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns_cache,
+	SHELL_CMD(flush, NULL, "Remove all entries from DNS cache.",
+		  cmd_net_dns_cache_flush),
+	SHELL_SUBCMD_SET_END
+);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns,
+	SHELL_CMD(cache, &net_cmd_dns_cache,
+		  "Print DNS cache entries and statistics.",
+		  cmd_net_dns_cache),
 	SHELL_CMD(cancel, NULL, "Cancel all pending requests.",
 		  cmd_net_dns_cancel),
 	SHELL_CMD(query, NULL,
@@ -11,6 +11,7 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include <string.h>
 
 #include <net/net_core.h>
+#include <net/ethernet.h>
 #include <net/net_pkt.h>
 #include <net/net_stats.h>
 
@@ -32,23 +33,378 @@ K_KERNEL_STACK_ARRAY_DEFINE(tx_stack, NET_TC_TX_COUNT,
 K_KERNEL_STACK_ARRAY_DEFINE(rx_stack, NET_TC_RX_COUNT,
 			    CONFIG_NET_RX_STACK_SIZE);
 
+#if defined(CONFIG_NET_RX_STEERING)
+/* Stacks for RX worker threads */
+K_KERNEL_STACK_ARRAY_DEFINE(rx_worker_stack, CONFIG_NET_RX_STEERING_WORKERS,
+			    CONFIG_NET_RX_STEERING_STACK_SIZE);
+
+static struct k_thread rx_worker_thread[CONFIG_NET_RX_STEERING_WORKERS];
+static struct k_fifo rx_worker_fifo[CONFIG_NET_RX_STEERING_WORKERS];
+#endif
+
 static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
 static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
 
+/* Received packets are queued per traffic class and a single work item
+ * processes them in batches, so that the RX thread does not need to
+ * dispatch a work item for every packet.
+ */
+struct net_pkt_batch {
+	struct k_fifo fifo;
+	struct k_work work;
+	uint8_t tc;
+};
+
+static struct net_pkt_batch rx_batch[NET_TC_RX_COUNT];
+
+/* Packets to be sent are queued the same way. This lets the drivers know
+ * when more packets to the same interface are following, see
+ * net_pkt_tx_more().
+ */
+static struct net_pkt_batch tx_batch[NET_TC_TX_COUNT];
+
+#if defined(CONFIG_NET_TC_TX_FQ)
+/* Instead of a single FIFO, each Tx traffic class has a number of flow
+ * queues that are served in deficit round robin order. Flows that become
+ * active are served before the ones that already used their quantum, so
+ * that sparse traffic like pings or ACKs does not wait behind a bulk
+ * transfer. The total number of queued bytes is limited, and when the
+ * limit is exceeded packets are dropped from the head of the longest
+ * flow, which keeps the queueing delay of the other flows bounded.
+ *
+ * The only packet of a flow is never dropped, so neither is the packet
+ * just queued. A single packet larger than the limit, like a TCP GSO
+ * segment, is thus sent instead of stalling its flow.
+ */
+struct tx_fq_flow {
+	sys_slist_t pkts;
+	sys_dnode_t node;
+	int32_t deficit;
+	uint32_t bytes;
+};
+
+struct tx_fq {
+	struct k_spinlock lock;
+	struct tx_fq_flow flows[CONFIG_NET_TC_TX_FQ_FLOWS];
+	sys_dlist_t new_flows;
+	sys_dlist_t old_flows;
+	uint32_t bytes;
+};
+
+static struct tx_fq tx_fq[NET_TC_TX_COUNT];
+
+#if defined(CONFIG_NET_TCP_GSO)
+/* Otherwise every GSO segment of a flow would evict the previous one
+ * before it is sent.
+ */
+BUILD_ASSERT(CONFIG_NET_TC_TX_QUEUE_LIMIT >=
+	     2 * CONFIG_NET_TCP_GSO_MAX_SEGMENTS *
+	     (NET_ETH_MTU - NET_IPV4TCPH_LEN),
+	     "Tx queue limit must hold two full GSO segments");
+#endif
+
+static uint32_t tx_flow_hash(struct net_pkt *pkt)
+{
+	struct net_pkt_cursor backup;
+	uint32_t hash;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	hash = net_pkt_flow_hash(pkt);
+
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return hash;
+}
+
+/* Longest flow having more than one packet queued, or NULL */
+static struct tx_fq_flow *tx_fq_fattest_flow(struct tx_fq *fq)
+{
+	struct tx_fq_flow *fattest = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(fq->flows); i++) {
+		struct tx_fq_flow *flow = &fq->flows[i];
+
+		if (sys_slist_peek_head(&flow->pkts) ==
+		    sys_slist_peek_tail(&flow->pkts)) {
+			continue;
+		}
+
+		if (!fattest || flow->bytes > fattest->bytes) {
+			fattest = flow;
+		}
+	}
+
+	return fattest;
+}
+
+static void tx_queue_put(uint8_t tc, struct net_pkt *pkt)
+{
+	struct tx_fq *fq = &tx_fq[tc];
+	uint32_t len = net_pkt_get_len(pkt);
+	struct tx_fq_flow *flow;
+	sys_slist_t dropped;
+	k_spinlock_key_t key;
+
+	flow = &fq->flows[tx_flow_hash(pkt) % ARRAY_SIZE(fq->flows)];
+
+	sys_slist_init(&dropped);
+
+	key = k_spin_lock(&fq->lock);
+
+	sys_slist_append(&flow->pkts, (sys_snode_t *)pkt);
+	flow->bytes += len;
+	fq->bytes += len;
+
+	if (!sys_dnode_is_linked(&flow->node)) {
+		flow->deficit = CONFIG_NET_TC_TX_FQ_QUANTUM;
+		sys_dlist_append(&fq->new_flows, &flow->node);
+	}
+
+	while (fq->bytes > CONFIG_NET_TC_TX_QUEUE_LIMIT) {
+		struct tx_fq_flow *fattest = tx_fq_fattest_flow(fq);
+		struct net_pkt *drop;
+
+		if (!fattest) {
+			break;
+		}
+
+		drop = (struct net_pkt *)sys_slist_get(&fattest->pkts);
+
+		len = net_pkt_get_len(drop);
+		fattest->bytes -= len;
+		fq->bytes -= len;
+
+		sys_slist_append(&dropped, (sys_snode_t *)drop);
+	}
+
+	k_spin_unlock(&fq->lock, key);
+
+	while ((pkt = (struct net_pkt *)sys_slist_get(&dropped))) {
+		struct net_if *iface = net_pkt_iface(pkt);
+
+		NET_DBG("TC %d queue full, dropping pkt %p", tc, pkt);
+
+		net_stats_update_processing_error(iface);
+
+#if defined(CONFIG_NET_POWER_MANAGEMENT)
+		iface->tx_pending--;
+#endif
+		net_pkt_unref(pkt);
+	}
+}
+
+static struct net_pkt *tx_queue_get(uint8_t tc)
+{
+	struct tx_fq *fq = &tx_fq[tc];
+	struct net_pkt *pkt = NULL;
+	struct tx_fq_flow *flow;
+	k_spinlock_key_t key;
+	sys_dnode_t *node;
+	uint32_t len;
+
+	key = k_spin_lock(&fq->lock);
+
+	while (1) {
+		node = sys_dlist_peek_head(&fq->new_flows);
+		if (!node) {
+			node = sys_dlist_peek_head(&fq->old_flows);
+			if (!node) {
+				break;
+			}
+		}
+
+		flow = CONTAINER_OF(node, struct tx_fq_flow, node);
+
+		if (flow->deficit <= 0) {
+			flow->deficit += CONFIG_NET_TC_TX_FQ_QUANTUM;
+			sys_dlist_remove(node);
+			sys_dlist_append(&fq->old_flows, node);
+			continue;
+		}
+
+		pkt = (struct net_pkt *)sys_slist_get(&flow->pkts);
+		if (!pkt) {
+			sys_dlist_remove(node);
+			continue;
+		}
+
+		len = net_pkt_get_len(pkt);
+		flow->deficit -= len;
+		flow->bytes -= len;
+		fq->bytes -= len;
+		break;
+	}
+
+	k_spin_unlock(&fq->lock, key);
+
+	return pkt;
+}
+
+static bool tx_queue_is_empty(uint8_t tc)
+{
+	return tx_fq[tc].bytes == 0U;
+}
+
+static void tx_queue_init(uint8_t tc)
+{
+	struct tx_fq *fq = &tx_fq[tc];
+	int i;
+
+	sys_dlist_init(&fq->new_flows);
+	sys_dlist_init(&fq->old_flows);
+
+	for (i = 0; i < ARRAY_SIZE(fq->flows); i++) {
+		sys_slist_init(&fq->flows[i].pkts);
+		sys_dnode_init(&fq->flows[i].node);
+	}
+}
+#else /* CONFIG_NET_TC_TX_FQ */
+static inline void tx_queue_put(uint8_t tc, struct net_pkt *pkt)
+{
+	k_fifo_put(&tx_batch[tc].fifo, pkt);
+}
+
+static inline struct net_pkt *tx_queue_get(uint8_t tc)
+{
+	return k_fifo_get(&tx_batch[tc].fifo, K_NO_WAIT);
+}
+
+static inline bool tx_queue_is_empty(uint8_t tc)
+{
+	return k_fifo_is_empty(&tx_batch[tc].fifo);
+}
+
+static inline void tx_queue_init(uint8_t tc)
+{
+	k_fifo_init(&tx_batch[tc].fifo);
+}
+#endif /* CONFIG_NET_TC_TX_FQ */
+
 bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt)
 {
 	net_pkt_set_tx_stats_tick(pkt, k_cycle_get_32());
 
-	k_work_submit_to_queue(&tx_classes[tc].work_q, net_pkt_work(pkt));
+	tx_queue_put(tc, pkt);
+
+	k_work_submit_to_queue(&tx_classes[tc].work_q, &tx_batch[tc].work);
 
 	return true;
 }
 
+static void tx_batch_process(struct k_work *work)
+{
+	struct net_pkt_batch *batch = CONTAINER_OF(work, struct net_pkt_batch,
+						   work);
+	int budget = CONFIG_NET_TX_BATCH_BUDGET;
+	struct net_pkt *pkt, *next;
+
+	pkt = tx_queue_get(batch->tc);
+
+	while (pkt) {
+		next = NULL;
+
+		if (--budget > 0) {
+			next = tx_queue_get(batch->tc);
+		}
+
+		/* The driver can postpone starting the transmission until
+		 * the last packet of the batch has been handed over.
+		 */
+		net_pkt_set_tx_more(pkt, next &&
+				    net_pkt_iface(next) == net_pkt_iface(pkt));
+
+		net_process_tx_packet(pkt);
+
+		pkt = next;
+	}
+
+	if (!tx_queue_is_empty(batch->tc)) {
+		k_work_submit_to_queue(&tx_classes[batch->tc].work_q, work);
+	}
+}
+
 void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt)
 {
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
 
-	k_work_submit_to_queue(&rx_classes[tc].work_q, net_pkt_work(pkt));
+	k_fifo_put(&rx_batch[tc].fifo, pkt);
+
+	k_work_submit_to_queue(&rx_classes[tc].work_q, &rx_batch[tc].work);
+}
+
+#if defined(CONFIG_NET_RX_STEERING)
+void net_tc_submit_to_rx_worker(uint32_t hash, struct net_pkt *pkt)
+{
+	k_fifo_put(&rx_worker_fifo[hash % CONFIG_NET_RX_STEERING_WORKERS],
+		   pkt);
+}
+
+static void rx_worker(void *p1, void *p2, void *p3)
+{
+	struct k_fifo *fifo = p1;
+	struct net_pkt *pkt;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		pkt = k_fifo_get(fifo, K_FOREVER);
+
+		net_process_steered_packet(pkt);
+	}
+}
+#endif /* CONFIG_NET_RX_STEERING */
+
+void net_tc_submit_list_to_rx_queue(uint8_t tc, sys_slist_t *list)
+{
+	k_fifo_put_slist(&rx_batch[tc].fifo, list);
+
+	k_work_submit_to_queue(&rx_classes[tc].work_q, &rx_batch[tc].work);
+}
+
+void net_tc_submit_work_to_rx_queue(uint8_t tc, struct k_work *work)
+{
+	k_work_submit_to_queue(&rx_classes[tc].work_q, work);
+}
+
+struct k_work_q *net_tc_rx_current_queue(void)
+{
+	int i;
+
+	for (i = 0; i < NET_TC_RX_COUNT; i++) {
+		if (k_current_get() == &rx_classes[i].work_q.thread) {
+			return &rx_classes[i].work_q;
+		}
+	}
+
+	return NULL;
+}
+
+static void rx_batch_process(struct k_work *work)
+{
+	struct net_pkt_batch *batch = CONTAINER_OF(work, struct net_pkt_batch,
+						   work);
+	int budget = CONFIG_NET_RX_BATCH_BUDGET;
+	struct net_pkt *pkt;
+
+	while (budget-- > 0) {
+		pkt = k_fifo_get(&batch->fifo, K_NO_WAIT);
+		if (!pkt) {
+			return;
+		}
+
+		net_process_rx_packet(pkt);
+	}
+
+	/* The budget is used, let the other work items in this queue run
+	 * before continuing with the rest of the packets.
+	 */
+	if (!k_fifo_is_empty(&batch->fifo)) {
+		k_work_submit_to_queue(&rx_classes[batch->tc].work_q, work);
+	}
 }
 
 int net_tx_priority2tc(enum net_priority prio)
@@ -211,6 +567,10 @@ void net_tc_tx_init(void)
 
 		thread_priority = tx_tc2thread(i);
 
+		tx_queue_init(i);
+		k_work_init(&tx_batch[i].work, tx_batch_process);
+		tx_batch[i].tc = i;
+
 		priority = IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE) ?
 			K_PRIO_COOP(thread_priority) :
 			K_PRIO_PREEMPT(thread_priority);
@@ -238,6 +598,48 @@ void net_tc_tx_init(void)
 	}
 }
 
+#if defined(CONFIG_NET_RX_STEERING)
+/* The workers run with the priority of the lowest RX traffic class */
+static void net_tc_rx_worker_init(void)
+{
+	uint8_t thread_priority = rx_tc2thread(0);
+	int priority;
+	int i;
+
+	priority = IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE) ?
+		K_PRIO_COOP(thread_priority) :
+		K_PRIO_PREEMPT(thread_priority);
+
+	for (i = 0; i < CONFIG_NET_RX_STEERING_WORKERS; i++) {
+		k_tid_t tid;
+
+		k_fifo_init(&rx_worker_fifo[i]);
+
+		tid = k_thread_create(&rx_worker_thread[i], rx_worker_stack[i],
+				      K_KERNEL_STACK_SIZEOF(rx_worker_stack[i]),
+				      rx_worker, &rx_worker_fifo[i], NULL, NULL,
+				      priority, 0, K_FOREVER);
+
+#if defined(CONFIG_SCHED_CPU_MASK)
+		k_thread_cpu_mask_clear(tid);
+		k_thread_cpu_mask_enable(tid, i % CONFIG_MP_NUM_CPUS);
+#endif
+
+		if (IS_ENABLED(CONFIG_THREAD_NAME)) {
+			char name[sizeof("rx_w[y]")];
+
+			snprintk(name, sizeof(name), "rx_w[%d]", i);
+			k_thread_name_set(tid, name);
+		}
+
+		NET_DBG("[%d] Starting RX worker %p prio %d", i, tid,
+			priority);
+
+		k_thread_start(tid);
+	}
+}
+#endif /* CONFIG_NET_RX_STEERING */
+
 void net_tc_rx_init(void)
 {
 	int i;
@@ -254,6 +656,10 @@ void net_tc_rx_init(void)
 
 		thread_priority = rx_tc2thread(i);
 
+		k_fifo_init(&rx_batch[i].fifo);
+		k_work_init(&rx_batch[i].work, rx_batch_process);
+		rx_batch[i].tc = i;
+
 		priority = IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE) ?
 			K_PRIO_COOP(thread_priority) :
 			K_PRIO_PREEMPT(thread_priority);
@@ -279,4 +685,8 @@ void net_tc_rx_init(void)
 			k_thread_name_set(&rx_classes[i].work_q.thread, name);
 		}
 	}
+
+#if defined(CONFIG_NET_RX_STEERING)
+	net_tc_rx_worker_init();
+#endif
 }
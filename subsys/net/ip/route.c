@@ -16,6 +16,7 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 #include <limits.h>
 #include <zephyr/types.h>
 #include <sys/slist.h>
+#include <sys/dlist.h>
 
 #include <net/net_pkt.h>
 #include <net/net_core.h>
@@ -34,9 +35,10 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 #endif
 
 /* We keep track of the routes in a separate list so that we can remove
- * the oldest routes (at tail) if needed.
+ * the oldest routes (at tail) if needed. The list is doubly linked so
+ * that moving an accessed route to the front does not need a list walk.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -253,12 +255,13 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
 }
 
-struct net_route_entry *net_route_lookup(struct net_if *iface,
-					 struct in6_addr *dst)
+#if !defined(CONFIG_NET_ROUTE_TRIE)
+static struct net_route_entry *route_scan_lookup(struct net_if *iface,
+						 struct in6_addr *dst)
 {
 	struct net_route_entry *route, *found = NULL;
 	uint8_t longest_match = 0U;
@@ -286,6 +289,240 @@ struct net_route_entry *net_route_lookup(struct net_if *iface,
 		}
 	}
 
+	return found;
+}
+#endif /* !CONFIG_NET_ROUTE_TRIE */
+
+
+#if defined(CONFIG_NET_ROUTE_TRIE)
+/* The routes are indexed by a path compressed binary trie. Every node
+ * covers the first prefix_len bits of its prefix, and its two children
+ * continue with the next bit being 0 or 1. Nodes without routes are only
+ * kept where the trie branches, so each route needs at most two nodes.
+ */
+struct route_trie_node {
+	struct route_trie_node *child[2];
+
+	/** Routes that have exactly this prefix */
+	sys_slist_t routes;
+
+	struct in6_addr prefix;
+	uint8_t prefix_len;
+	bool in_use;
+};
+
+static struct route_trie_node route_trie_nodes[2 * CONFIG_NET_MAX_ROUTES];
+static struct route_trie_node *route_trie_root;
+
+static inline uint8_t route_trie_bit(const struct in6_addr *addr,
+				     uint8_t pos)
+{
+	return (addr->s6_addr[pos / 8] >> (7 - (pos % 8))) & 0x01;
+}
+
+/* Return the number of leading bits (at most max_len) that are the same
+ * in both addresses.
+ */
+static uint8_t route_trie_common_len(const struct in6_addr *a,
+				     const struct in6_addr *b,
+				     uint8_t max_len)
+{
+	uint8_t len;
+	int i;
+
+	for (i = 0; i * 8 < max_len; i++) {
+		uint8_t diff = a->s6_addr[i] ^ b->s6_addr[i];
+
+		if (diff) {
+			len = i * 8 + (__builtin_clz(diff) - 24);
+
+			return MIN(len, max_len);
+		}
+	}
+
+	return max_len;
+}
+
+static struct route_trie_node *route_trie_node_alloc(
+						const struct in6_addr *addr,
+						uint8_t prefix_len)
+{
+	struct route_trie_node *node;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(route_trie_nodes); i++) {
+		node = &route_trie_nodes[i];
+
+		if (node->in_use) {
+			continue;
+		}
+
+		memset(node, 0, sizeof(*node));
+		node->in_use = true;
+		node->prefix_len = prefix_len;
+
+		memcpy(node->prefix.s6_addr, addr->s6_addr, prefix_len / 8);
+		if (prefix_len % 8) {
+			node->prefix.s6_addr[prefix_len / 8] =
+				addr->s6_addr[prefix_len / 8] &
+				(0xff << (8 - (prefix_len % 8)));
+		}
+
+		return node;
+	}
+
+	return NULL;
+}
+
+static inline void route_trie_node_free(struct route_trie_node *node)
+{
+	node->in_use = false;
+}
+
+static int route_trie_insert(struct net_route_entry *route)
+{
+	struct route_trie_node **link = &route_trie_root;
+	struct route_trie_node *node, *new, *branch;
+	uint8_t prefix_len = route->prefix_len;
+	uint8_t common = 0U;
+
+	while ((node = *link) != NULL) {
+		common = route_trie_common_len(&node->prefix, &route->addr,
+					       MIN(node->prefix_len,
+						   prefix_len));
+		if (common < node->prefix_len) {
+			break;
+		}
+
+		if (node->prefix_len == prefix_len) {
+			sys_slist_prepend(&node->routes, &route->trie_node);
+			return 0;
+		}
+
+		link = &node->child[route_trie_bit(&route->addr,
+						   node->prefix_len)];
+	}
+
+	new = route_trie_node_alloc(&route->addr, prefix_len);
+	if (!new) {
+		return -ENOMEM;
+	}
+
+	sys_slist_prepend(&new->routes, &route->trie_node);
+
+	if (!node) {
+		*link = new;
+		return 0;
+	}
+
+	if (common == prefix_len) {
+		/* The new prefix covers the existing node */
+		new->child[route_trie_bit(&node->prefix, prefix_len)] = node;
+		*link = new;
+		return 0;
+	}
+
+	/* The prefixes diverge at bit "common" so add a branch there */
+	branch = route_trie_node_alloc(&route->addr, common);
+	if (!branch) {
+		route_trie_node_free(new);
+		return -ENOMEM;
+	}
+
+	branch->child[route_trie_bit(&node->prefix, common)] = node;
+	branch->child[route_trie_bit(&route->addr, common)] = new;
+	*link = branch;
+
+	return 0;
+}
+
+/* Remove a node that has no routes and at most one child */
+static void route_trie_compact(struct route_trie_node **link)
+{
+	struct route_trie_node *node = *link;
+
+	if (!node || !sys_slist_is_empty(&node->routes) ||
+	    (node->child[0] && node->child[1])) {
+		return;
+	}
+
+	*link = node->child[0] ? node->child[0] : node->child[1];
+
+	route_trie_node_free(node);
+}
+
+static void route_trie_remove(struct net_route_entry *route)
+{
+	struct route_trie_node **link = &route_trie_root;
+	struct route_trie_node **parent_link = NULL;
+	struct route_trie_node *node;
+
+	while ((node = *link) != NULL) {
+		if (node->prefix_len > route->prefix_len ||
+		    !net_ipv6_is_prefix(route->addr.s6_addr,
+					node->prefix.s6_addr,
+					node->prefix_len)) {
+			return;
+		}
+
+		if (node->prefix_len == route->prefix_len) {
+			break;
+		}
+
+		parent_link = link;
+		link = &node->child[route_trie_bit(&route->addr,
+						   node->prefix_len)];
+	}
+
+	if (!node || !sys_slist_find_and_remove(&node->routes,
+						&route->trie_node)) {
+		return;
+	}
+
+	route_trie_compact(link);
+
+	if (parent_link) {
+		route_trie_compact(parent_link);
+	}
+}
+
+static struct net_route_entry *route_trie_lookup(struct net_if *iface,
+						 struct in6_addr *dst)
+{
+	struct route_trie_node *node = route_trie_root;
+	struct net_route_entry *route, *found = NULL;
+
+	while (node && net_ipv6_is_prefix(dst->s6_addr, node->prefix.s6_addr,
+					  node->prefix_len)) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&node->routes, route, trie_node) {
+			if (!iface || route->iface == iface) {
+				found = route;
+				break;
+			}
+		}
+
+		if (node->prefix_len == 128) {
+			break;
+		}
+
+		node = node->child[route_trie_bit(dst, node->prefix_len)];
+	}
+
+	return found;
+}
+#endif /* CONFIG_NET_ROUTE_TRIE */
+
+struct net_route_entry *net_route_lookup(struct net_if *iface,
+					 struct in6_addr *dst)
+{
+	struct net_route_entry *found;
+
+#if defined(CONFIG_NET_ROUTE_TRIE)
+	found = route_trie_lookup(iface, dst);
+#else
+	found = route_scan_lookup(iface, dst);
+#endif
+
 	if (found) {
 		net_route_info("Found", found, dst);
 
@@ -353,9 +590,9 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
-		sys_slist_find_and_remove(&routes, last);
+		sys_dlist_remove(last);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -401,7 +638,16 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+#if defined(CONFIG_NET_ROUTE_TRIE)
+	if (route_trie_insert(route) < 0) {
+		NET_ERR("No route trie node available!");
+		net_nbr_unref(tmp);
+		nbr_free(nbr);
+		return NULL;
+	}
+#endif
+
+	sys_dlist_prepend(&routes, &route->node);
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -454,7 +700,13 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
+	if (sys_dnode_is_linked(&route->node)) {
+		sys_dlist_remove(&route->node);
+	}
+
+#if defined(CONFIG_NET_ROUTE_TRIE)
+	route_trie_remove(route);
+#endif
 
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
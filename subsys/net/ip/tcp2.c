@@ -24,7 +24,7 @@ LOG_MODULE_REGISTER(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
 #include "connection.h"
 #include "net_stats.h"
 #include "net_private.h"
-#include "tcp2_priv.h"
+#include "tcp_internal.h"
 
 #define ACK_TIMEOUT_MS CONFIG_NET_TCP_ACK_TIMEOUT
 #define ACK_TIMEOUT K_MSEC(ACK_TIMEOUT_MS)
@@ -422,6 +422,15 @@ static int tcp_conn_unref(struct tcp *conn)
 
 	k_delayed_work_cancel(&conn->timewait_timer);
 	k_delayed_work_cancel(&conn->fin_timer);
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	k_delayed_work_cancel(&conn->ack_timer);
+#endif
+#if defined(CONFIG_NET_TCP_GRO)
+	k_delayed_work_cancel(&conn->gro_work);
+	if (conn->gro_pkt) {
+		net_pkt_unref(conn->gro_pkt);
+	}
+#endif
 
 	sys_slist_find_and_remove(&tcp_conns, &conn->next);
 
@@ -812,6 +821,12 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 	}
 
 	if (data) {
+		/* A segment larger than MSS is split just before L2 */
+		if (IS_ENABLED(CONFIG_NET_TCP_GSO) &&
+		    net_pkt_get_len(data) > conn_mss(conn)) {
+			net_pkt_set_gso_size(pkt, conn_mss(conn));
+		}
+
 		/* Append the data buffer to the pkt */
 		net_pkt_append_buffer(pkt, data->buffer);
 		data->buffer = NULL;
@@ -837,6 +852,14 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 
 	NET_DBG("%s", log_strdup(tcp_th(pkt)));
 
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	if (ACK & flags) {
+		/* Any segment carrying an ACK acknowledges the pending data */
+		conn->unacked_recv_len = 0U;
+		k_delayed_work_cancel(&conn->ack_timer);
+	}
+#endif
+
 	if (tcp_send_cb) {
 		ret = tcp_send_cb(pkt);
 		goto out;
@@ -888,6 +911,107 @@ static int tcp_pkt_peek(struct net_pkt *to, struct net_pkt *from, size_t pos,
 	return net_pkt_copy(to, from, len);
 }
 
+#if defined(CONFIG_NET_TCP_ZERO_COPY_SEND)
+static bool tcp_buf_can_slice(struct net_buf *buf)
+{
+	struct net_buf_pool *pool = net_buf_pool_get(buf->pool_id);
+
+	return pool->alloc->cb->ref && !(buf->flags & NET_BUF_EXTERNAL_DATA);
+}
+
+/* Build the segment payload by referencing the data of the send_data
+ * fragments instead of copying it. Each fragment overlapping the
+ * [pos, pos + len) range gets a clone sharing the same data block, so
+ * the data is only released once it has been both sent and acknowledged.
+ * Returns -ENOTSUP if some fragment cannot be referenced, in which case
+ * the caller should fall back to tcp_pkt_peek().
+ */
+static int tcp_pkt_slice(struct net_pkt *to, struct net_pkt *from, size_t pos,
+			 size_t len)
+{
+	struct net_buf *frag = from->buffer;
+	struct net_buf *first;
+
+	while (frag && pos >= frag->len) {
+		pos -= frag->len;
+		frag = frag->frags;
+	}
+
+	first = frag;
+
+	for (size_t left = len + pos; frag && left; frag = frag->frags) {
+		if (!tcp_buf_can_slice(frag)) {
+			return -ENOTSUP;
+		}
+
+		left -= MIN(left, frag->len);
+	}
+
+	for (frag = first; frag && len; frag = frag->frags) {
+		size_t slice_len = MIN(frag->len - pos, len);
+		struct net_buf *slice;
+
+		slice = net_buf_clone(frag, TCP_PKT_ALLOC_TIMEOUT);
+		if (!slice) {
+			return -ENOBUFS;
+		}
+
+		net_buf_pull(slice, pos);
+		slice->len = slice_len;
+
+		net_pkt_append_buffer(to, slice);
+
+		len -= slice_len;
+		pos = 0;
+	}
+
+	return len ? -EINVAL : 0;
+}
+#endif /* CONFIG_NET_TCP_ZERO_COPY_SEND */
+
+/* Build the payload of a segment. If the data needs to be copied, at most
+ * one MSS worth of it is put to the segment and len is updated accordingly.
+ */
+static struct net_pkt *tcp_pkt_segment(struct tcp *conn, size_t pos,
+				       size_t *len)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+#if defined(CONFIG_NET_TCP_ZERO_COPY_SEND)
+	pkt = tcp_pkt_alloc(conn, 0);
+	if (!pkt) {
+		return NULL;
+	}
+
+	ret = tcp_pkt_slice(pkt, conn->send_data, pos, *len);
+	if (ret == 0) {
+		return pkt;
+	}
+
+	tcp_pkt_unref(pkt);
+
+	if (ret != -ENOTSUP) {
+		return NULL;
+	}
+#endif /* CONFIG_NET_TCP_ZERO_COPY_SEND */
+
+	*len = MIN(*len, conn_mss(conn));
+
+	pkt = tcp_pkt_alloc(conn, *len);
+	if (!pkt) {
+		return NULL;
+	}
+
+	ret = tcp_pkt_peek(pkt, conn->send_data, pos, *len);
+	if (ret < 0) {
+		tcp_pkt_unref(pkt);
+		return NULL;
+	}
+
+	return pkt;
+}
+
 static bool tcp_window_full(struct tcp *conn)
 {
 	bool window_full = !(conn->unacked_len < conn->send_win);
@@ -915,27 +1039,41 @@ static int tcp_unsent_len(struct tcp *conn)
 	return unsent_len;
 }
 
+/* How much data can be put into one segment. With GSO the segment is
+ * split into MSS sized packets only when it is given to L2. The 6lo
+ * technologies need a copy of the sent packet, see tcp_send(), so they
+ * always get MSS sized segments.
+ */
+static size_t tcp_segment_len(struct tcp *conn)
+{
+#if defined(CONFIG_NET_TCP_GSO)
+	enum net_link_type type = net_if_get_link_addr(conn->iface)->type;
+
+	if (type != NET_LINK_BLUETOOTH && type != NET_LINK_IEEE802154 &&
+	    type != NET_LINK_CANBUS) {
+		return conn_mss(conn) * CONFIG_NET_TCP_GSO_MAX_SEGMENTS;
+	}
+#endif
+
+	return conn_mss(conn);
+}
+
 static int tcp_send_data(struct tcp *conn)
 {
 	int ret = 0;
-	int pos, len;
+	int pos;
+	size_t len;
 	struct net_pkt *pkt;
 
 	pos = conn->unacked_len;
 	len = MIN3(conn->send_data_total - conn->unacked_len,
 		   conn->send_win - conn->unacked_len,
-		   conn_mss(conn));
+		   tcp_segment_len(conn));
 
-	pkt = tcp_pkt_alloc(conn, len);
+	pkt = tcp_pkt_segment(conn, pos, &len);
 	if (!pkt) {
-		NET_ERR("conn: %p packet allocation failed, len=%d", conn, len);
-		ret = -ENOBUFS;
-		goto out;
-	}
-
-	ret = tcp_pkt_peek(pkt, conn->send_data, pos, len);
-	if (ret < 0) {
-		tcp_pkt_unref(pkt);
+		NET_ERR("conn: %p packet allocation failed, len=%zd", conn,
+			len);
 		ret = -ENOBUFS;
 		goto out;
 	}
@@ -1119,6 +1257,65 @@ static void tcp_fin_timeout(struct k_work *work)
 	net_context_unref(conn->context);
 }
 
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+static void tcp_ack_timeout(struct k_work *work)
+{
+	struct tcp *conn = CONTAINER_OF(work, struct tcp, ack_timer);
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+
+	if (conn->unacked_recv_len) {
+		NET_DBG("conn: %p sending delayed ACK", conn);
+		tcp_out(conn, ACK);
+	}
+
+	k_mutex_unlock(&conn->lock);
+}
+
+static bool tcp_ack_quick(struct tcp *conn)
+{
+	if (conn->context->options.tcp_quickack) {
+		return true;
+	}
+
+	if (conn->quickack_segs) {
+		conn->quickack_segs--;
+		return true;
+	}
+
+	return false;
+}
+#endif /* CONFIG_NET_TCP_DELAYED_ACK */
+
+/* Acknowledge len bytes of received in-order data. With delayed ACKs
+ * (RFC 1122 ch. 4.2.3.2) the ACK is sent once two full-sized segments
+ * worth of data is unacknowledged, or when the delayed ACK timer expires,
+ * unless the caller requests an immediate ACK. PSH does not make the ACK
+ * immediate, as tcp2 peers set it on every data segment.
+ */
+static void tcp_out_data_ack(struct tcp *conn, size_t len, bool immediate)
+{
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	conn->unacked_recv_len += len;
+
+	if (!immediate && !tcp_ack_quick(conn) &&
+	    conn->unacked_recv_len < 2U * net_tcp_get_recv_mss(conn)) {
+		if (!k_delayed_work_remaining_get(&conn->ack_timer)) {
+			k_delayed_work_submit_to_queue(&tcp_work_q,
+				&conn->ack_timer,
+				K_MSEC(CONFIG_NET_TCP_DELAYED_ACK_TIMEOUT));
+		}
+
+		return;
+	}
+#else
+	ARG_UNUSED(len);
+	ARG_UNUSED(immediate);
+#endif
+
+	tcp_out(conn, ACK);
+}
+
 static void tcp_conn_ref(struct tcp *conn)
 {
 	int ref_count = atomic_inc(&conn->ref_count) + 1;
@@ -1126,6 +1323,153 @@ static void tcp_conn_ref(struct tcp *conn)
 	NET_DBG("conn: %p, ref_count: %d", conn, ref_count);
 }
 
+#if defined(CONFIG_NET_TCP_GRO)
+#define TCP_GRO_OPT_MAX_LEN 40 /* (15 - 5) * 4 bytes */
+
+static void tcp_gro_flush(struct tcp *conn)
+{
+	struct net_pkt *pkt;
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+	pkt = conn->gro_pkt;
+	conn->gro_pkt = NULL;
+	k_mutex_unlock(&conn->lock);
+
+	if (pkt) {
+		NET_DBG("conn: %p flush %zd bytes", conn, tcp_data_len(pkt));
+
+		tcp_in(conn, pkt);
+		net_pkt_unref(pkt);
+	}
+}
+
+static void tcp_gro_flush_work(struct k_work *work)
+{
+	struct tcp *conn = CONTAINER_OF(work, struct tcp, gro_work);
+
+	tcp_gro_flush(conn);
+}
+
+/* Append the payload of pkt to the held segment if pkt continues it and
+ * carries an identical TCP header apart from the sequence number and PSH.
+ */
+static bool tcp_gro_merge(struct net_pkt *held, struct net_pkt *pkt,
+			  struct tcphdr *th, size_t len)
+{
+	uint8_t held_opts[TCP_GRO_OPT_MAX_LEN];
+	uint8_t opts[TCP_GRO_OPT_MAX_LEN];
+	size_t opts_len = (th_off(th) - 5) * 4;
+	size_t held_len = tcp_data_len(held);
+	struct tcphdr *held_th = th_get(held);
+	bool psh = th_flags(th) & PSH;
+	uint16_t total;
+
+	if (!held_th || net_pkt_iface(held) != net_pkt_iface(pkt) ||
+	    th_seq(th) != th_seq(held_th) + held_len ||
+	    th_ack(th) != th_ack(held_th) || th_win(th) != th_win(held_th) ||
+	    th_off(th) != th_off(held_th) ||
+	    held_len + len > CONFIG_NET_TCP_GRO_MAX_SIZE) {
+		return false;
+	}
+
+	if (opts_len && (!tcp_options_get(held, opts_len, held_opts,
+					  sizeof(held_opts)) ||
+			 !tcp_options_get(pkt, opts_len, opts, sizeof(opts)) ||
+			 memcmp(held_opts, opts, opts_len))) {
+		return false;
+	}
+
+	if (tcp_pkt_pull(pkt, net_pkt_get_len(pkt) - len) < 0) {
+		return false;
+	}
+
+	net_pkt_append_buffer(held, pkt->buffer);
+	pkt->buffer = NULL;
+	net_pkt_unref(pkt);
+
+	total = net_pkt_get_len(held);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(held) == AF_INET) {
+		struct net_ipv4_hdr *ip = NET_IPV4_HDR(held);
+
+		ip->chksum = net_chksum_update_u16(ip->chksum, ip->len,
+						   htons(total));
+		ip->len = htons(total);
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(held) == AF_INET6) {
+		NET_IPV6_HDR(held)->len = htons(total -
+						sizeof(struct net_ipv6_hdr));
+	}
+
+	if (psh) {
+		UNALIGNED_PUT(th_flags(held_th) | PSH, &held_th->th_flags);
+	}
+
+	return true;
+}
+
+/* Hold in-order data segments received within one Rx batch and pass them
+ * to tcp_in() as a single segment when the batch has been processed. This
+ * is only done in the Rx traffic class threads, which flush the held data
+ * from their work queue once the current batch is done.
+ */
+static bool tcp_gro_receive(struct tcp *conn, struct net_pkt *pkt)
+{
+	struct k_work_q *work_q = net_tc_rx_current_queue();
+	struct tcphdr *th = th_get(pkt);
+	bool consumed = false;
+	bool flush = false;
+	size_t len;
+
+	if (!work_q || !th) {
+		tcp_gro_flush(conn);
+		return false;
+	}
+
+	len = tcp_data_len(pkt);
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+
+	if (conn->state != TCP_ESTABLISHED || !len ||
+	    (th_flags(th) & ~PSH) != ACK) {
+		flush = conn->gro_pkt != NULL;
+		goto out;
+	}
+
+	if (conn->gro_pkt) {
+		consumed = tcp_gro_merge(conn->gro_pkt, pkt, th, len);
+		if (!consumed) {
+			flush = true;
+		} else if ((th_flags(th_get(conn->gro_pkt)) & PSH) ||
+			   tcp_data_len(conn->gro_pkt) +
+			   conn_mss(conn) > CONFIG_NET_TCP_GRO_MAX_SIZE) {
+			/* The sender wants the data delivered or there
+			 * is no room for another segment.
+			 */
+			flush = true;
+		}
+
+		goto out;
+	}
+
+	if (!(th_flags(th) & PSH) && th_seq(th) == conn->ack) {
+		conn->gro_pkt = pkt;
+		consumed = true;
+
+		k_delayed_work_submit_to_queue(work_q, &conn->gro_work,
+					       K_NO_WAIT);
+	}
+out:
+	k_mutex_unlock(&conn->lock);
+
+	if (flush) {
+		tcp_gro_flush(conn);
+	}
+
+	return consumed;
+}
+#endif /* CONFIG_NET_TCP_GRO */
+
 static struct tcp *tcp_conn_alloc(void)
 {
 	struct tcp *conn = NULL;
@@ -1174,6 +1518,13 @@ static struct tcp *tcp_conn_alloc(void)
 	k_delayed_work_init(&conn->fin_timer, tcp_fin_timeout);
 	k_delayed_work_init(&conn->send_data_timer, tcp_resend_data);
 	k_delayed_work_init(&conn->recv_queue_timer, tcp_cleanup_recv_queue);
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	k_delayed_work_init(&conn->ack_timer, tcp_ack_timeout);
+	conn->quickack_segs = CONFIG_NET_TCP_QUICKACK_SEGMENTS;
+#endif
+#if defined(CONFIG_NET_TCP_GRO)
+	k_delayed_work_init(&conn->gro_work, tcp_gro_flush_work);
+#endif
 
 	tcp_conn_ref(conn);
 
@@ -1286,6 +1637,11 @@ static enum net_verdict tcp_recv(struct net_conn *net_conn,
 	}
  in:
 	if (conn) {
+#if defined(CONFIG_NET_TCP_GRO)
+		if (tcp_gro_receive(conn, pkt)) {
+			return NET_OK;
+		}
+#endif
 		tcp_in(conn, pkt);
 	}
 
@@ -1592,13 +1948,19 @@ static void tcp_queue_recv_data(struct tcp *conn, struct net_pkt *pkt,
 static bool tcp_data_received(struct tcp *conn, struct net_pkt *pkt,
 			      size_t *len)
 {
+	/* A segment filling a hole in the sequence space is acknowledged
+	 * immediately (RFC 5681 ch. 4.2).
+	 */
+	bool immediate = CONFIG_NET_TCP_RECV_QUEUE_TIMEOUT &&
+			 !net_pkt_is_empty(conn->queue_recv_data);
+
 	if (tcp_data_get(conn, pkt, len) < 0) {
 		return false;
 	}
 
 	net_stats_update_tcp_seg_recv(conn->iface);
 	conn_ack(conn, *len);
-	tcp_out(conn, ACK);
+	tcp_out_data_ack(conn, *len, immediate);
 
 	return true;
 }
@@ -1618,6 +1980,13 @@ static void tcp_out_of_order_data(struct tcp *conn, struct net_pkt *pkt,
 	/* We received out-of-order data. Try to queue it.
 	 */
 	tcp_queue_recv_data(conn, pkt, data_len, seq);
+
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	/* Acknowledge the following segments quickly so that the peer
+	 * can recover from the loss without waiting for delayed ACKs.
+	 */
+	conn->quickack_segs = CONFIG_NET_TCP_QUICKACK_SEGMENTS;
+#endif
 }
 
 /* TCP state machine, everything happens here */
@@ -2367,13 +2736,209 @@ int net_tcp_finalize(struct net_pkt *pkt)
 
 	tcp_hdr->chksum = 0U;
 
-	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+	/* A GSO packet gets its checksums when it is split */
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt)) &&
+	    !net_pkt_gso_size(pkt)) {
 		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
 	}
 
 	return net_pkt_set_data(pkt, &tcp_access);
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+/* Largest IPv4 header with options followed by the largest TCP header */
+#define TCP_GSO_HDR_MAX_LEN (60 + 60)
+
+struct tcp_gso {
+	uint8_t hdr[TCP_GSO_HDR_MAX_LEN] __aligned(4);
+	struct net_pkt *pkt;
+	struct tcphdr *th;
+	size_t hdr_len;
+	size_t data_len;
+	size_t pos;
+	uint32_t seq;
+	uint16_t id;
+	uint8_t flags;
+};
+
+static int tcp_gso_init(struct tcp_gso *gso, struct net_pkt *pkt)
+{
+	size_t ip_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ip_opts_len(pkt);
+	size_t opts_len;
+
+	if (ip_len + sizeof(struct tcphdr) > sizeof(gso->hdr)) {
+		return -EINVAL;
+	}
+
+	gso->th = (struct tcphdr *)(gso->hdr + ip_len);
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_read(pkt, gso->hdr, ip_len + sizeof(struct tcphdr))) {
+		return -EINVAL;
+	}
+
+	gso->hdr_len = ip_len + th_off(gso->th) * 4U;
+	if (th_off(gso->th) < 5 || gso->hdr_len > sizeof(gso->hdr)) {
+		return -EINVAL;
+	}
+
+	opts_len = gso->hdr_len - ip_len - sizeof(struct tcphdr);
+	if (opts_len && net_pkt_read(pkt, gso->hdr + ip_len +
+				     sizeof(struct tcphdr), opts_len)) {
+		return -EINVAL;
+	}
+
+	gso->pkt = pkt;
+	gso->data_len = net_pkt_get_len(pkt) - gso->hdr_len;
+	gso->pos = 0;
+	gso->seq = th_seq(gso->th);
+	gso->flags = th_flags(gso->th);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		struct net_ipv4_hdr *ipv4_hdr = (struct net_ipv4_hdr *)gso->hdr;
+
+		gso->id = sys_get_be16(ipv4_hdr->id);
+
+		/* The header checksum is calculated with the field zeroed */
+		ipv4_hdr->chksum = 0U;
+	}
+
+	return 0;
+}
+
+/* Build the next packet of a GSO packet. The headers are copied and fixed,
+ * the payload references the data of the GSO packet. Returns NULL when
+ * all the data has been handled, or if there was an error in which case
+ * gso->pos stays smaller than gso->data_len.
+ */
+static struct net_pkt *tcp_gso_next(struct tcp_gso *gso)
+{
+	struct net_pkt *pkt = gso->pkt;
+	struct net_pkt *seg;
+	size_t len;
+	bool last;
+
+	len = MIN(gso->data_len - gso->pos, net_pkt_gso_size(pkt));
+	if (!len) {
+		return NULL;
+	}
+
+	last = (gso->pos + len == gso->data_len);
+
+	UNALIGNED_PUT(htonl(gso->seq + gso->pos), &gso->th->th_seq);
+	UNALIGNED_PUT(last ? gso->flags : gso->flags & ~(PSH | FIN),
+		      &gso->th->th_flags);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		sys_put_be16(gso->id++,
+			     ((struct net_ipv4_hdr *)gso->hdr)->id);
+	}
+
+	seg = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), gso->hdr_len,
+					AF_UNSPEC, 0, TCP_PKT_ALLOC_TIMEOUT);
+	if (!seg) {
+		return NULL;
+	}
+
+	net_pkt_set_family(seg, net_pkt_family(pkt));
+	net_pkt_set_context(seg, net_pkt_context(pkt));
+	net_pkt_set_priority(seg, net_pkt_priority(pkt));
+	net_pkt_set_vlan_tag(seg, net_pkt_vlan_tag(pkt));
+	net_pkt_set_ip_hdr_len(seg, net_pkt_ip_hdr_len(pkt));
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		net_pkt_set_ipv4_opts_len(seg, net_pkt_ipv4_opts_len(pkt));
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		net_pkt_set_ipv6_ext_len(seg, net_pkt_ipv6_ext_len(pkt));
+	}
+
+	memcpy(net_pkt_lladdr_src(seg), net_pkt_lladdr_src(pkt),
+	       sizeof(struct net_linkaddr));
+	memcpy(net_pkt_lladdr_dst(seg), net_pkt_lladdr_dst(pkt),
+	       sizeof(struct net_linkaddr));
+
+	if (net_pkt_write(seg, gso->hdr, gso->hdr_len) < 0 ||
+	    tcp_pkt_slice(seg, pkt, gso->hdr_len + gso->pos, len) < 0 ||
+	    tcp_finalize_pkt(seg) < 0) {
+		net_pkt_unref(seg);
+		return NULL;
+	}
+
+	gso->pos += len;
+
+	return seg;
+}
+
+int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	struct net_pkt *seg, *next;
+	struct tcp_gso gso;
+	int ret, sent = 0;
+
+	ret = tcp_gso_init(&gso, pkt);
+	if (ret < 0) {
+		return ret;
+	}
+
+	NET_DBG("pkt %p len %zd gso %u", pkt, gso.data_len,
+		net_pkt_gso_size(pkt));
+
+	seg = tcp_gso_next(&gso);
+
+	while (seg) {
+		/* The next packet is built before this one is sent, so that
+		 * the driver is not told that more packets follow if they
+		 * cannot be built.
+		 */
+		next = tcp_gso_next(&gso);
+
+		net_pkt_set_tx_more(seg, next ? true : net_pkt_tx_more(pkt));
+
+		ret = net_if_l2(iface)->send(iface, seg);
+		if (ret < 0) {
+			net_pkt_unref(seg);
+
+			if (next) {
+				net_pkt_unref(next);
+			}
+
+			return ret;
+		}
+
+		sent += ret;
+		seg = next;
+	}
+
+	if (gso.pos < gso.data_len) {
+		NET_DBG("pkt %p split failed at %zd", pkt, gso.pos);
+		return -ENOBUFS;
+	}
+
+	/* All the data is referenced by the sent packets, release the GSO
+	 * packet like L2 would do.
+	 */
+	net_pkt_unref(pkt);
+
+	return sent;
+}
+
+int net_tcp_gso_finalize(struct net_pkt *pkt)
+{
+	int ret;
+
+	net_pkt_set_gso_size(pkt, 0U);
+
+	ret = tcp_finalize_pkt(pkt);
+
+	net_pkt_cursor_init(pkt);
+
+	return ret;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 struct net_tcp_hdr *net_tcp_input(struct net_pkt *pkt,
 				  struct net_pkt_data_access *tcp_access)
 {
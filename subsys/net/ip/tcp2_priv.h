@@ -227,6 +227,13 @@ struct tcp { /* TCP connection */
 	struct k_delayed_work recv_queue_timer;
 	struct k_delayed_work send_data_timer;
 	struct k_delayed_work timewait_timer;
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	struct k_delayed_work ack_timer;
+#endif
+#if defined(CONFIG_NET_TCP_GRO)
+	struct net_pkt *gro_pkt;  /* merged segment not yet given to tcp_in() */
+	struct k_delayed_work gro_work;   /* flushes gro_pkt at the end of Rx batch */
+#endif
 	union {
 		/* Because FIN and establish timers are never happening
 		 * at the same time, share the timer between them to
@@ -240,6 +247,9 @@ struct tcp { /* TCP connection */
 	size_t send_data_total;
 	size_t send_retries;
 	int unacked_len;
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	size_t unacked_recv_len; /* received data not yet acknowledged */
+#endif
 	atomic_t ref_count;
 	enum tcp_state state;
 	enum tcp_data_mode data_mode;
@@ -248,6 +258,9 @@ struct tcp { /* TCP connection */
 	uint16_t recv_win;
 	uint16_t send_win;
 	uint8_t send_data_retries;
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	uint8_t quickack_segs;
+#endif
 	bool in_retransmission : 1;
 	bool in_connect : 1;
 	bool in_close : 1;
@@ -359,6 +359,50 @@ static inline int net_tcp_put(struct net_context *context)
 }
 #endif
 
+/**
+ * @brief Split a large TCP segment into MSS sized packets and pass them
+ * to the L2 of the network interface.
+ *
+ * @param iface Network interface
+ * @param pkt Packet with a non-zero GSO size
+ *
+ * @return Number of bytes sent, < 0 if error. The packet is released
+ *         only if the call succeeds.
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt);
+#else
+static inline int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(pkt);
+
+	return -ENOTSUP;
+}
+#endif
+
+/**
+ * @brief Finalize a GSO packet that is looped back to the local host
+ * without being split.
+ *
+ * The packet stops being a GSO packet and gets the TCP checksum that was
+ * left out for the split packets.
+ *
+ * @param pkt GSO packet, the cursor can be anywhere
+ *
+ * @return 0 if ok, <0 if error
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_finalize(struct net_pkt *pkt);
+#else
+static inline int net_tcp_gso_finalize(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return -ENOTSUP;
+}
+#endif
+
 #define NET_TCP_MAX_OPT_SIZE  8
 
 #if defined(CONFIG_NET_NATIVE_TCP)
@@ -493,32 +493,68 @@ int z_vrfy_net_addr_pton(sa_family_t family, const char *src,
 #include <syscalls/net_addr_pton_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+/* The one's complement sum does not depend on the byte order (RFC 1071),
+ * so the data is summed as native 32 bit words into a 64 bit accumulator
+ * and the carries are folded back only once at the end. The result is
+ * returned in the same big endian based form as the sum given in.
+ */
 static uint16_t calc_chksum(uint16_t sum, const uint8_t *data, size_t len)
 {
-	const uint8_t *end;
-	uint16_t tmp;
+	uint64_t acc = 0U;
+	uint16_t native;
+	uint32_t tmp;
 
-	end = data + len - 1;
+	while (len >= 16U) {
+		acc += UNALIGNED_GET((const uint32_t *)data);
+		acc += UNALIGNED_GET((const uint32_t *)(data + 4));
+		acc += UNALIGNED_GET((const uint32_t *)(data + 8));
+		acc += UNALIGNED_GET((const uint32_t *)(data + 12));
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+		data += 16;
+		len -= 16U;
+	}
+
+	while (len >= 4U) {
+		acc += UNALIGNED_GET((const uint32_t *)data);
+
+		data += 4;
+		len -= 4U;
+	}
+
+	if (len >= 2U) {
+		acc += UNALIGNED_GET((const uint16_t *)data);
 
 		data += 2;
+		len -= 2U;
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	/* Odd byte is the high byte of a zero padded big endian word */
+	if (len) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		acc += data[0];
+#else
+		acc += (uint16_t)data[0] << 8;
+#endif
 	}
 
-	return sum;
+	acc = (acc & 0xffffffff) + (acc >> 32);
+	acc = (acc & 0xffffffff) + (acc >> 32);
+
+	tmp = (uint32_t)acc;
+	tmp = (tmp & 0xffff) + (tmp >> 16);
+	tmp = (tmp & 0xffff) + (tmp >> 16);
+
+	native = ntohs((uint16_t)tmp);
+
+	tmp = (uint32_t)sum + native;
+	tmp = (tmp & 0xffff) + (tmp >> 16);
+
+	return (uint16_t)tmp;
+}
+
+uint16_t net_calc_chksum_buf(uint16_t sum, const uint8_t *data, size_t len)
+{
+	return calc_chksum(sum, data, len);
 }
 
 static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum)
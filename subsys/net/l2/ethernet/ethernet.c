@@ -670,6 +670,16 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 	net_pkt_cursor_init(pkt);
 
 send:
+	/* Remember if the driver can postpone starting the transmission,
+	 * so that net_eth_tx_flush() knows whether there is anything to
+	 * start.
+	 */
+	if (net_pkt_tx_more(pkt)) {
+		atomic_set_bit(&ctx->flags, ETH_TX_POSTPONED);
+	} else {
+		atomic_clear_bit(&ctx->flags, ETH_TX_POSTPONED);
+	}
+
 	ret = api->send(net_if_get_device(iface), pkt);
 	if (ret != 0) {
 		eth_stats_update_errors_tx(iface);
@@ -1121,6 +1131,21 @@ void net_eth_set_ptp_port(struct net_if *iface, int port)
 }
 #endif /* CONFIG_NET_GPTP */
 
+void net_eth_tx_flush(struct net_if *iface)
+{
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+	const struct device *dev = net_if_get_device(iface);
+	const struct ethernet_api *api = dev->api;
+
+	if (!atomic_test_and_clear_bit(&ctx->flags, ETH_TX_POSTPONED)) {
+		return;
+	}
+
+	if (api && api->tx_flush) {
+		api->tx_flush(dev);
+	}
+}
+
 int net_eth_promisc_mode(struct net_if *iface, bool enable)
 {
 	struct ethernet_req_params params;
@@ -705,6 +705,9 @@ uint8_t coap_header_get_code(const struct coap_packet *cpkt)
 	case COAP_METHOD_POST:
 	case COAP_METHOD_PUT:
 	case COAP_METHOD_DELETE:
+	case COAP_METHOD_FETCH:
+	case COAP_METHOD_PATCH:
+	case COAP_METHOD_IPATCH:
 
 	/* All the defined response codes */
 	case COAP_RESPONSE_CODE_OK:
@@ -838,6 +841,22 @@ static bool is_request(const struct coap_packet *cpkt)
 	return !(code & ~COAP_REQUEST_MASK);
 }
 
+static int resource_invoke(struct coap_resource *resource,
+			   struct coap_packet *cpkt,
+			   struct sockaddr *addr, socklen_t addr_len)
+{
+	coap_method_t method;
+	uint8_t code;
+
+	code = coap_header_get_code(cpkt);
+	method = method_from_code(resource, code);
+	if (!method) {
+		return -EPERM;
+	}
+
+	return method(resource, cpkt, addr, addr_len);
+}
+
 int coap_handle_request(struct coap_packet *cpkt,
 			struct coap_resource *resources,
 			struct coap_option *options,
@@ -852,26 +871,191 @@ int coap_handle_request(struct coap_packet *cpkt,
 
 	/* FIXME: deal with hierarchical resources */
 	for (resource = resources; resource && resource->path; resource++) {
-		coap_method_t method;
-		uint8_t code;
-
 		if (!uri_path_eq(cpkt, resource->path, options, opt_num)) {
 			continue;
 		}
 
-		code = coap_header_get_code(cpkt);
-		method = method_from_code(resource, code);
-		if (!method) {
-			return -EPERM;
-		}
-
-		return method(resource, cpkt, addr, addr_len);
+		return resource_invoke(resource, cpkt, addr, addr_len);
 	}
 
 	NET_DBG("%d", __LINE__);
 	return -ENOENT;
 }
 
+static bool is_wildcard(const char *segment, size_t len, char wildcard)
+{
+	return IS_ENABLED(CONFIG_COAP_URI_WILDCARD) && len == 1 &&
+	       *segment == wildcard;
+}
+
+static uint16_t index_find_child(const struct coap_resource_index *index,
+				 uint16_t node, const char *segment,
+				 size_t len)
+{
+	const struct coap_resource_index_node *n;
+	uint16_t child;
+
+	for (child = index->nodes[node].child; child; child = n->sibling) {
+		n = &index->nodes[child];
+
+		if (n->len == len && !memcmp(n->segment, segment, len)) {
+			return child;
+		}
+	}
+
+	return 0;
+}
+
+static int index_insert(struct coap_resource_index *index,
+			struct coap_resource *resource)
+{
+	struct coap_resource_index_node *n;
+	const char * const *p;
+	uint16_t node = 0U;
+	uint16_t child;
+	size_t len;
+
+	for (p = resource->path; *p; p++) {
+		len = strlen(*p);
+		if (len > UINT8_MAX) {
+			return -EINVAL;
+		}
+
+		child = index_find_child(index, node, *p, len);
+		if (!child) {
+			if (index->used == index->num_nodes) {
+				return -ENOMEM;
+			}
+
+			child = index->used++;
+
+			n = &index->nodes[child];
+			n->segment = *p;
+			n->len = len;
+			n->sibling = index->nodes[node].child;
+			index->nodes[node].child = child;
+		}
+
+		node = child;
+
+		/* Whatever follows a multi-level wildcard is ignored */
+		if (is_wildcard(*p, len, '#')) {
+			break;
+		}
+	}
+
+	/* The first resource of the table wins, as in coap_handle_request() */
+	if (!index->nodes[node].resource) {
+		index->nodes[node].resource = resource;
+	}
+
+	return 0;
+}
+
+int coap_resource_index_init(struct coap_resource_index *index,
+			     struct coap_resource *resources,
+			     struct coap_resource_index_node *nodes,
+			     uint16_t num_nodes)
+{
+	struct coap_resource *resource;
+	int r;
+
+	if (num_nodes == 0U) {
+		return -ENOMEM;
+	}
+
+	memset(nodes, 0, num_nodes * sizeof(*nodes));
+
+	index->nodes = nodes;
+	index->num_nodes = num_nodes;
+	index->used = 1U;
+
+	for (resource = resources; resource && resource->path; resource++) {
+		r = index_insert(index, resource);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	return 0;
+}
+
+/* Resources are compared by their position in the table */
+static struct coap_resource *first_resource(struct coap_resource *a,
+					    struct coap_resource *b)
+{
+	if (!a || (b && b < a)) {
+		return b;
+	}
+
+	return a;
+}
+
+/* Without wildcards in the table, a single child matches each URI-Path
+ * option. Otherwise, every matching branch is followed, the recursion being
+ * bounded by the number of options.
+ */
+static struct coap_resource *index_match(
+	const struct coap_resource_index *index, uint16_t node,
+	const struct coap_option *options, uint8_t opt_num, uint8_t i)
+{
+	const struct coap_resource_index_node *n;
+	struct coap_resource *found = NULL;
+	uint16_t child;
+
+	while (i < opt_num && options[i].delta != COAP_OPTION_URI_PATH) {
+		i++;
+	}
+
+	if (i == opt_num) {
+		return index->nodes[node].resource;
+	}
+
+	for (child = index->nodes[node].child; child; child = n->sibling) {
+		n = &index->nodes[child];
+
+		if (is_wildcard(n->segment, n->len, '#')) {
+			found = first_resource(found, n->resource);
+		} else if (is_wildcard(n->segment, n->len, '+') ||
+			   (n->len == options[i].len &&
+			    !memcmp(n->segment, options[i].value, n->len))) {
+			found = first_resource(found,
+					       index_match(index, child,
+							   options, opt_num,
+							   i + 1));
+		}
+	}
+
+	return found;
+}
+
+struct coap_resource *coap_resource_index_find(
+	const struct coap_resource_index *index,
+	const struct coap_option *options, uint8_t opt_num)
+{
+	return index_match(index, 0U, options, opt_num, 0U);
+}
+
+int coap_handle_request_index(struct coap_packet *cpkt,
+			      const struct coap_resource_index *index,
+			      struct coap_option *options,
+			      uint8_t opt_num,
+			      struct sockaddr *addr, socklen_t addr_len)
+{
+	struct coap_resource *resource;
+
+	if (!is_request(cpkt)) {
+		return 0;
+	}
+
+	resource = coap_resource_index_find(index, options, opt_num);
+	if (!resource) {
+		return -ENOENT;
+	}
+
+	return resource_invoke(resource, cpkt, addr, addr_len);
+}
+
 int coap_block_transfer_init(struct coap_block_context *ctx,
 			      enum coap_block_size block_size,
 			      size_t total_size)
@@ -1458,6 +1642,94 @@ struct coap_observer *coap_find_observer_by_addr(
 	return NULL;
 }
 
+static uint32_t sockaddr_hash(const struct sockaddr *addr)
+{
+	const uint8_t *p;
+	uint32_t hash;
+	uint16_t port;
+	size_t len;
+	size_t i;
+
+	if (addr->sa_family == AF_INET) {
+		p = (const uint8_t *)&net_sin(addr)->sin_addr;
+		len = sizeof(struct in_addr);
+		port = net_sin(addr)->sin_port;
+	} else if (addr->sa_family == AF_INET6) {
+		p = (const uint8_t *)&net_sin6(addr)->sin6_addr;
+		len = sizeof(struct in6_addr);
+		port = net_sin6(addr)->sin6_port;
+	} else {
+		return 0;
+	}
+
+	/* FNV-1a */
+	hash = 2166136261U;
+
+	for (i = 0; i < len; i++) {
+		hash = (hash ^ p[i]) * 16777619U;
+	}
+
+	hash = (hash ^ (port & 0xff)) * 16777619U;
+	hash = (hash ^ (port >> 8)) * 16777619U;
+
+	return hash;
+}
+
+static sys_slist_t *observer_bucket(const struct coap_observer_table *table,
+				    const struct sockaddr *addr)
+{
+	return &table->buckets[sockaddr_hash(addr) % table->num_buckets];
+}
+
+void coap_observer_table_init(struct coap_observer_table *table,
+			      sys_slist_t *buckets, uint16_t num_buckets)
+{
+	uint16_t i;
+
+	for (i = 0U; i < num_buckets; i++) {
+		sys_slist_init(&buckets[i]);
+	}
+
+	table->buckets = buckets;
+	table->num_buckets = num_buckets;
+}
+
+void coap_observer_table_add(struct coap_observer_table *table,
+			     struct coap_observer *observer)
+{
+	sys_slist_prepend(observer_bucket(table, &observer->addr),
+			  &observer->table_node);
+}
+
+void coap_observer_table_remove(struct coap_observer_table *table,
+				struct coap_observer *observer)
+{
+	sys_slist_find_and_remove(observer_bucket(table, &observer->addr),
+				  &observer->table_node);
+}
+
+struct coap_observer *coap_observer_table_find(
+	const struct coap_observer_table *table,
+	const struct sockaddr *addr, const uint8_t *token, uint8_t tkl)
+{
+	struct coap_observer *o;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(observer_bucket(table, addr), o,
+				     table_node) {
+		if (!sockaddr_equal(&o->addr, addr)) {
+			continue;
+		}
+
+		if (token && (o->tkl != tkl || memcmp(o->token, token, tkl))) {
+			continue;
+		}
+
+		return o;
+	}
+
+	return NULL;
+}
+
 /**
  * @brief Internal initialization function for CoAP library.
  *
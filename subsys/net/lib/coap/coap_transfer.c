@@ -0,0 +1,654 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_coap, CONFIG_COAP_LOG_LEVEL);
+
+#include <string.h>
+#include <errno.h>
+#include <kernel.h>
+#include <sys/util.h>
+
+#include <net/coap.h>
+#include <net/coap_transfer.h>
+
+#define RESPONSE_CLASS(code) ((code) >> 5)
+
+#define EMPTY_MESSAGE_SIZE 4
+
+static void transfer_finish(struct coap_transfer *xfer, int result,
+			    const struct coap_packet *response)
+{
+	LOG_DBG("Transfer finished (%d), %u retransmissions", result,
+		xfer->retransmissions);
+
+	xfer->active = false;
+	xfer->in_flight = 0U;
+	coap_pendings_clear(xfer->pending, ARRAY_SIZE(xfer->pending));
+
+	if (xfer->done) {
+		xfer->done(xfer, result, response);
+	}
+}
+
+static int append_payload(struct coap_transfer *xfer,
+			  struct coap_packet *request, size_t offset,
+			  uint16_t len)
+{
+	int r;
+
+	r = coap_packet_append_payload_marker(request);
+	if (r < 0) {
+		return r;
+	}
+
+	if (len > request->max_len - request->offset) {
+		return -ENOMEM;
+	}
+
+	/* Read the block in place, it is not worth another buffer */
+	r = xfer->read(xfer, offset, request->data + request->offset, len);
+	if (r < 0) {
+		return r;
+	}
+
+	if (r != len) {
+		return -EIO;
+	}
+
+	request->offset += len;
+
+	return 0;
+}
+
+static int build_request(struct coap_transfer *xfer, uint32_t num,
+			 uint16_t id, struct coap_packet *request)
+{
+	uint8_t szx = xfer->ctx.block_size;
+	size_t offset = (size_t)num << (szx + 4);
+	uint16_t len = coap_block_size_to_bytes(szx);
+	const char * const *p;
+	bool more;
+	int r;
+
+	r = coap_packet_init(request, xfer->buf, sizeof(xfer->buf),
+			     COAP_VERSION_1, COAP_TYPE_CON,
+			     sizeof(xfer->token), xfer->token,
+			     xfer->method, id);
+	if (r < 0) {
+		return r;
+	}
+
+	for (p = xfer->path; p && *p; p++) {
+		r = coap_packet_append_option(request, COAP_OPTION_URI_PATH,
+					      (const uint8_t *)*p, strlen(*p));
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	if (!xfer->upload) {
+		if (xfer->content_format >= 0) {
+			r = coap_append_option_int(request, COAP_OPTION_ACCEPT,
+						   xfer->content_format);
+			if (r < 0) {
+				return r;
+			}
+		}
+
+		r = coap_append_option_int(request, COAP_OPTION_BLOCK2,
+					   (num << 4) | szx);
+		if (r < 0) {
+			return r;
+		}
+
+		/* Ask for the size of the resource with the first block */
+		if (num == 0U) {
+			r = coap_append_option_int(request, COAP_OPTION_SIZE2,
+						   0);
+		}
+
+		return r;
+	}
+
+	if (xfer->content_format >= 0) {
+		r = coap_append_option_int(request, COAP_OPTION_CONTENT_FORMAT,
+					   xfer->content_format);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	more = offset + len < xfer->ctx.total_size;
+	if (!more) {
+		len = xfer->ctx.total_size - offset;
+	}
+
+	r = coap_append_option_int(request, COAP_OPTION_BLOCK1,
+				   (num << 4) | (more ? 0x08 : 0) | szx);
+	if (r < 0) {
+		return r;
+	}
+
+	if (num == 0U) {
+		r = coap_append_option_int(request, COAP_OPTION_SIZE1,
+					   xfer->ctx.total_size);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	if (len == 0U) {
+		return 0;
+	}
+
+	return append_payload(xfer, request, offset, len);
+}
+
+static int request_block(struct coap_transfer *xfer, int slot, uint32_t num)
+{
+	struct coap_pending *pending = &xfer->pending[slot];
+	struct coap_packet request;
+	int r;
+
+	r = build_request(xfer, num, coap_next_id(), &request);
+	if (r < 0) {
+		return r;
+	}
+
+	coap_pending_init(pending, &request, &xfer->addr,
+			  COAP_DEFAULT_MAX_RETRANSMIT);
+	coap_pending_cycle(pending);
+
+	xfer->block_num[slot] = num;
+	xfer->in_flight |= BIT(slot);
+
+	LOG_DBG("Block %u requested, id %u", num, pending->id);
+
+	return xfer->send(xfer, request.data, request.offset);
+}
+
+static int retransmit_block(struct coap_transfer *xfer, int slot)
+{
+	struct coap_packet request;
+	int r;
+
+	r = build_request(xfer, xfer->block_num[slot], xfer->pending[slot].id,
+			  &request);
+	if (r < 0) {
+		return r;
+	}
+
+	xfer->retransmissions++;
+
+	LOG_DBG("Block %u retransmitted", xfer->block_num[slot]);
+
+	return xfer->send(xfer, request.data, request.offset);
+}
+
+/* Request as many blocks as the window allows. Until the size of a download
+ * is known, a single block is in flight, so that no block past the end of
+ * the resource is requested.
+ */
+static int transfer_fill(struct coap_transfer *xfer)
+{
+	int window = 1;
+	int slot, r;
+
+	if (!xfer->upload && xfer->last_known) {
+		window = ARRAY_SIZE(xfer->pending);
+
+		if (xfer->window > 0 && xfer->window < window) {
+			window = xfer->window;
+		}
+	}
+
+	for (slot = 0; slot < window; slot++) {
+		if (xfer->in_flight & BIT(slot)) {
+			continue;
+		}
+
+		if (!xfer->upload && xfer->last_known &&
+		    xfer->next_num > xfer->last_num) {
+			break;
+		}
+
+		r = request_block(xfer, slot, xfer->next_num);
+		if (r < 0) {
+			return r;
+		}
+
+		xfer->next_num++;
+	}
+
+	return 0;
+}
+
+static int check_etag(struct coap_transfer *xfer,
+		      const struct coap_packet *response, bool first)
+{
+	struct coap_option option;
+	int r;
+
+	r = coap_find_options(response, COAP_OPTION_ETAG, &option, 1);
+	if (r < 0) {
+		return -EPROTO;
+	}
+
+	if (r == 0) {
+		option.len = 0U;
+	}
+
+	if (option.len > sizeof(xfer->etag)) {
+		return -EPROTO;
+	}
+
+	if (first) {
+		memcpy(xfer->etag, option.value, option.len);
+		xfer->etag_len = option.len;
+		return 0;
+	}
+
+	if (option.len != xfer->etag_len ||
+	    memcmp(xfer->etag, option.value, option.len)) {
+		LOG_DBG("ETag changed");
+		return -ECANCELED;
+	}
+
+	return 0;
+}
+
+/* Returns 1 when the download is complete, 0 to continue */
+static int handle_download(struct coap_transfer *xfer, uint32_t num,
+			   const struct coap_packet *response)
+{
+	uint8_t code = coap_header_get_code(response);
+	const uint8_t *payload;
+	uint16_t len;
+	uint8_t szx;
+	int block, size, r;
+
+	/* Block requested past the end of a resource smaller than announced */
+	if (xfer->last_known && num > xfer->last_num) {
+		return 0;
+	}
+
+	if (RESPONSE_CLASS(code) != 2) {
+		return -EIO;
+	}
+
+	payload = coap_packet_get_payload(response, &len);
+	block = coap_get_option_int(response, COAP_OPTION_BLOCK2);
+
+	if (block < 0) {
+		/* The whole resource fits in the response */
+		if (num != 0U) {
+			return -EPROTO;
+		}
+
+		if (len > 0) {
+			r = xfer->data(xfer, 0, payload, len);
+			if (r < 0) {
+				return r;
+			}
+		}
+
+		return 1;
+	}
+
+	r = check_etag(xfer, response, num == 0U);
+	if (r < 0) {
+		return r;
+	}
+
+	if (num == 0U) {
+		/* Adopt a smaller block size proposed by the server */
+		if (GET_BLOCK_SIZE(block) < xfer->ctx.block_size) {
+			xfer->ctx.block_size = GET_BLOCK_SIZE(block);
+		}
+
+		size = coap_get_option_int(response, COAP_OPTION_SIZE2);
+		if (size >= 0) {
+			xfer->ctx.total_size = size;
+			xfer->last_num = size > 0 ?
+				(size - 1) >> (xfer->ctx.block_size + 4) : 0;
+			xfer->last_known = true;
+		}
+	}
+
+	szx = xfer->ctx.block_size;
+
+	if (GET_BLOCK_NUM(block) != num || GET_BLOCK_SIZE(block) != szx ||
+	    len > coap_block_size_to_bytes(szx)) {
+		return -EPROTO;
+	}
+
+	if (!GET_MORE(block)) {
+		xfer->last_num = num;
+		xfer->last_known = true;
+	}
+
+	if (len > 0) {
+		r = xfer->data(xfer, (size_t)num << (szx + 4), payload, len);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	xfer->received++;
+
+	return xfer->last_known && xfer->received > xfer->last_num;
+}
+
+/* Returns 1 when the upload is complete, 0 to continue */
+static int handle_upload(struct coap_transfer *xfer, uint32_t num,
+			 const struct coap_packet *response)
+{
+	uint8_t code = coap_header_get_code(response);
+	uint8_t szx = xfer->ctx.block_size;
+	size_t offset = (size_t)num << (szx + 4);
+	int block;
+
+	block = coap_get_option_int(response, COAP_OPTION_BLOCK1);
+
+	/* The server tells which block size it can handle */
+	if (code == COAP_RESPONSE_CODE_REQUEST_TOO_LARGE && num == 0U &&
+	    block >= 0 && GET_BLOCK_SIZE(block) < szx) {
+		LOG_DBG("Block size reduced to %u",
+			coap_block_size_to_bytes(GET_BLOCK_SIZE(block)));
+		xfer->ctx.block_size = GET_BLOCK_SIZE(block);
+		xfer->next_num = 0U;
+		return 0;
+	}
+
+	if (RESPONSE_CLASS(code) != 2) {
+		return -EIO;
+	}
+
+	offset += coap_block_size_to_bytes(szx);
+	if (offset >= xfer->ctx.total_size) {
+		return 1;
+	}
+
+	if (block >= 0) {
+		if (GET_BLOCK_NUM(block) != num ||
+		    GET_BLOCK_SIZE(block) > szx) {
+			return -EPROTO;
+		}
+
+		xfer->ctx.block_size = GET_BLOCK_SIZE(block);
+	}
+
+	xfer->next_num = offset >> (xfer->ctx.block_size + 4);
+
+	return 0;
+}
+
+static void handle_response(struct coap_transfer *xfer, int slot,
+			    const struct coap_packet *response)
+{
+	uint32_t num = xfer->block_num[slot];
+	int r;
+
+	xfer->in_flight &= ~BIT(slot);
+	coap_pending_clear(&xfer->pending[slot]);
+
+	if (xfer->upload) {
+		r = handle_upload(xfer, num, response);
+	} else {
+		r = handle_download(xfer, num, response);
+	}
+
+	if (r > 0) {
+		transfer_finish(xfer, 0, response);
+		return;
+	}
+
+	if (r == 0) {
+		r = transfer_fill(xfer);
+	}
+
+	if (r < 0) {
+		transfer_finish(xfer, r, response);
+	}
+}
+
+/* Separate responses are matched by the block they carry */
+static int find_block(struct coap_transfer *xfer,
+		      const struct coap_packet *response)
+{
+	uint32_t num = 0U;
+	int block, slot;
+
+	block = coap_get_option_int(response, xfer->upload ?
+				    COAP_OPTION_BLOCK1 : COAP_OPTION_BLOCK2);
+	if (block >= 0) {
+		num = GET_BLOCK_NUM(block);
+	}
+
+	for (slot = 0; slot < ARRAY_SIZE(xfer->pending); slot++) {
+		if (!(xfer->in_flight & BIT(slot))) {
+			continue;
+		}
+
+		/* A single block of an upload is in flight */
+		if (xfer->upload || xfer->block_num[slot] == num) {
+			return slot;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static void send_ack(struct coap_transfer *xfer, uint16_t id)
+{
+	uint8_t buf[EMPTY_MESSAGE_SIZE];
+	struct coap_packet ack;
+
+	if (coap_packet_init(&ack, buf, sizeof(buf), COAP_VERSION_1,
+			     COAP_TYPE_ACK, 0, NULL, COAP_CODE_EMPTY, id) < 0) {
+		return;
+	}
+
+	(void)xfer->send(xfer, ack.data, ack.offset);
+}
+
+static int transfer_start(struct coap_transfer *xfer,
+			  const char * const *path,
+			  enum coap_block_size block_size, size_t total_size)
+{
+	int r;
+
+	if (xfer->active) {
+		return -EBUSY;
+	}
+
+	if (!xfer->send || block_size > COAP_BLOCK_1024) {
+		return -EINVAL;
+	}
+
+	coap_block_transfer_init(&xfer->ctx, block_size, total_size);
+	coap_pendings_clear(xfer->pending, ARRAY_SIZE(xfer->pending));
+	memcpy(xfer->token, coap_next_token(), sizeof(xfer->token));
+
+	xfer->path = path;
+	xfer->in_flight = 0U;
+	xfer->next_num = 0U;
+	xfer->last_num = 0U;
+	xfer->received = 0U;
+	xfer->etag_len = 0U;
+	xfer->last_known = false;
+	xfer->retransmissions = 0U;
+	xfer->active = true;
+
+	r = transfer_fill(xfer);
+	if (r < 0) {
+		xfer->active = false;
+		xfer->in_flight = 0U;
+		coap_pendings_clear(xfer->pending, ARRAY_SIZE(xfer->pending));
+	}
+
+	return r;
+}
+
+int coap_transfer_download(struct coap_transfer *xfer,
+			   const char * const *path,
+			   enum coap_block_size block_size)
+{
+	if (!xfer || !xfer->data) {
+		return -EINVAL;
+	}
+
+	xfer->method = COAP_METHOD_GET;
+	xfer->upload = false;
+
+	return transfer_start(xfer, path, block_size, 0);
+}
+
+int coap_transfer_upload(struct coap_transfer *xfer, enum coap_method method,
+			 const char * const *path,
+			 enum coap_block_size block_size, size_t total_size)
+{
+	if (!xfer || !xfer->read) {
+		return -EINVAL;
+	}
+
+	if (method != COAP_METHOD_PUT && method != COAP_METHOD_POST) {
+		return -EINVAL;
+	}
+
+	xfer->method = method;
+	xfer->upload = true;
+
+	return transfer_start(xfer, path, block_size, total_size);
+}
+
+int coap_transfer_input(struct coap_transfer *xfer, uint8_t *data,
+			uint16_t len)
+{
+	uint8_t token[COAP_TOKEN_MAX_LEN];
+	struct coap_pending *pending;
+	struct coap_packet response;
+	uint8_t type, tkl;
+	int slot, r;
+
+	r = coap_packet_parse(&response, data, len, NULL, 0);
+	if (r < 0) {
+		return -EINVAL;
+	}
+
+	if (!xfer->active) {
+		return -ENOENT;
+	}
+
+	type = coap_header_get_type(&response);
+
+	if (coap_header_get_code(&response) == COAP_CODE_EMPTY) {
+		if (type != COAP_TYPE_ACK && type != COAP_TYPE_RESET) {
+			return -ENOENT;
+		}
+
+		pending = coap_pending_received(&response, xfer->pending,
+						ARRAY_SIZE(xfer->pending));
+		if (!pending) {
+			return -ENOENT;
+		}
+
+		if (type == COAP_TYPE_RESET) {
+			transfer_finish(xfer, -ECONNRESET, NULL);
+			return 0;
+		}
+
+		/* Stop retransmitting, a separate response follows. The
+		 * transfer times out if it gets lost.
+		 */
+		pending->t0 = k_uptime_get_32();
+		pending->timeout = CONFIG_COAP_TRANSFER_EXCHANGE_LIFETIME_MS;
+		pending->retries = 0U;
+
+		return 0;
+	}
+
+	tkl = coap_header_get_token(&response, token);
+	if (tkl != sizeof(xfer->token) ||
+	    memcmp(token, xfer->token, sizeof(xfer->token))) {
+		return -ENOENT;
+	}
+
+	if (type == COAP_TYPE_ACK) {
+		pending = coap_pending_received(&response, xfer->pending,
+						ARRAY_SIZE(xfer->pending));
+		if (!pending) {
+			/* Duplicate response to a retransmission */
+			return 0;
+		}
+
+		slot = pending - xfer->pending;
+	} else {
+		if (type == COAP_TYPE_CON) {
+			send_ack(xfer, coap_header_get_id(&response));
+		}
+
+		slot = find_block(xfer, &response);
+		if (slot < 0) {
+			return 0;
+		}
+	}
+
+	handle_response(xfer, slot, &response);
+
+	return 0;
+}
+
+int32_t coap_transfer_process(struct coap_transfer *xfer)
+{
+	uint32_t now = k_uptime_get_32();
+	struct coap_pending *pending;
+	int32_t remaining;
+	int slot, r;
+
+	if (!xfer->active) {
+		return SYS_FOREVER_MS;
+	}
+
+	for (slot = 0; slot < ARRAY_SIZE(xfer->pending); slot++) {
+		pending = &xfer->pending[slot];
+
+		if (!(xfer->in_flight & BIT(slot)) || !pending->timeout ||
+		    (int32_t)(pending->t0 + pending->timeout - now) > 0) {
+			continue;
+		}
+
+		if (!coap_pending_cycle(pending)) {
+			LOG_DBG("Block %u timed out", xfer->block_num[slot]);
+			transfer_finish(xfer, -ETIMEDOUT, NULL);
+			return SYS_FOREVER_MS;
+		}
+
+		r = retransmit_block(xfer, slot);
+		if (r < 0) {
+			transfer_finish(xfer, r, NULL);
+			return SYS_FOREVER_MS;
+		}
+	}
+
+	pending = coap_pending_next_to_expire(xfer->pending,
+					      ARRAY_SIZE(xfer->pending));
+	if (!pending) {
+		return SYS_FOREVER_MS;
+	}
+
+	remaining = pending->t0 + pending->timeout - now;
+
+	return MAX(remaining, 0);
+}
+
+void coap_transfer_cancel(struct coap_transfer *xfer)
+{
+	xfer->active = false;
+	xfer->in_flight = 0U;
+	coap_pendings_clear(xfer->pending, ARRAY_SIZE(xfer->pending));
+}
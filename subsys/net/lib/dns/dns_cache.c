@@ -0,0 +1,284 @@
+/** @file
+ * @brief DNS resolver cache
+ *
+ * Answers received by the resolver are kept here until their TTL expires.
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#include <net/net_core.h>
+#include <net/dns_resolve.h>
+#include "dns_cache.h"
+
+#define MAX_NAME_LEN CONFIG_DNS_RESOLVER_CACHE_MAX_NAME_LEN
+#define MAX_ADDRESSES CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRESSES
+
+struct dns_cache_entry {
+	/** Cached addresses, unused for a negative entry */
+	struct sockaddr addrs[MAX_ADDRESSES];
+
+	/** Uptime in ms when the entry expires */
+	int64_t expires;
+
+	/** Value of the LRU clock when the entry was last used */
+	uint32_t last_used;
+
+	enum dns_query_type type;
+	uint8_t count;
+	bool in_use;
+	bool negative;
+
+	char query[MAX_NAME_LEN + 1];
+};
+
+static struct dns_cache_entry cache[CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES];
+static struct dns_resolve_cache_stats cache_stats;
+static uint32_t lru_clock;
+
+static K_MUTEX_DEFINE(cache_lock);
+
+/* Must be invoked with cache lock held */
+static struct dns_cache_entry *find_entry(const char *query,
+					  enum dns_query_type type)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].in_use && cache[i].type == type &&
+		    !strncasecmp(cache[i].query, query, sizeof(cache[i].query))) {
+			return &cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Must be invoked with cache lock held */
+static struct dns_cache_entry *alloc_entry(const char *query, size_t len,
+					   enum dns_query_type type,
+					   int64_t now)
+{
+	struct dns_cache_entry *entry = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (!cache[i].in_use || cache[i].expires <= now) {
+			entry = &cache[i];
+			break;
+		}
+
+		if (!entry || (int32_t)(cache[i].last_used -
+					entry->last_used) < 0) {
+			entry = &cache[i];
+		}
+	}
+
+	if (entry->in_use && entry->expires > now) {
+		NET_DBG("Evicting %s from DNS cache",
+			log_strdup(entry->query));
+		cache_stats.evictions++;
+	}
+
+	memcpy(entry->query, query, len);
+	entry->query[len] = '\0';
+	entry->type = type;
+	entry->in_use = true;
+
+	return entry;
+}
+
+int dns_cache_find(const char *query, enum dns_query_type type,
+		   struct sockaddr *addrs, int max_count)
+{
+	struct dns_cache_entry *entry;
+	int ret;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	entry = find_entry(query, type);
+	if (entry && entry->expires <= k_uptime_get()) {
+		entry->in_use = false;
+		entry = NULL;
+	}
+
+	if (!entry) {
+		cache_stats.misses++;
+		ret = -ENOENT;
+		goto out;
+	}
+
+	entry->last_used = ++lru_clock;
+
+	if (entry->negative) {
+		cache_stats.negative_hits++;
+		ret = 0;
+		goto out;
+	}
+
+	cache_stats.hits++;
+
+	ret = MIN(entry->count, max_count);
+	memcpy(addrs, entry->addrs, ret * sizeof(struct sockaddr));
+
+out:
+	k_mutex_unlock(&cache_lock);
+
+	return ret;
+}
+
+void dns_cache_add(const char *query, enum dns_query_type type,
+		   const struct sockaddr *addr, uint32_t ttl, bool first)
+{
+	struct dns_cache_entry *entry;
+	size_t len = strlen(query);
+	int64_t now, expires;
+
+	if (len > MAX_NAME_LEN) {
+		return;
+	}
+
+	ttl = MIN(ttl, CONFIG_DNS_RESOLVER_CACHE_MAX_TTL);
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+	expires = now + (int64_t)ttl * MSEC_PER_SEC;
+
+	entry = find_entry(query, type);
+
+	/* A zero TTL means that the answer must not be cached. If it is only
+	 * given for some of the addresses, do not cache the others either so
+	 * that a cache hit never returns a partial answer.
+	 */
+	if (ttl == 0U) {
+		if (entry) {
+			entry->in_use = false;
+		}
+
+		goto out;
+	}
+
+	if (first) {
+		if (!entry) {
+			entry = alloc_entry(query, len, type, now);
+		}
+
+		entry->negative = false;
+		entry->count = 0U;
+		entry->expires = expires;
+		entry->last_used = ++lru_clock;
+	} else if (!entry || entry->negative) {
+		goto out;
+	}
+
+	if (entry->count >= MAX_ADDRESSES) {
+		goto out;
+	}
+
+	memcpy(&entry->addrs[entry->count++], addr, sizeof(*addr));
+
+	/* The entry is valid as long as all of its addresses are */
+	if (expires < entry->expires) {
+		entry->expires = expires;
+	}
+
+	NET_DBG("Cached %s type %d ttl %u (%u addresses)", log_strdup(query),
+		type, ttl, entry->count);
+
+out:
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_cache_add_negative(const char *query, enum dns_query_type type)
+{
+	struct dns_cache_entry *entry;
+	size_t len = strlen(query);
+	int64_t now;
+
+	if (CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL == 0 ||
+	    len > MAX_NAME_LEN) {
+		return;
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	entry = find_entry(query, type);
+	if (!entry) {
+		entry = alloc_entry(query, len, type, now);
+	}
+
+	entry->negative = true;
+	entry->count = 0U;
+	entry->expires = now + CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL *
+							MSEC_PER_SEC;
+	entry->last_used = ++lru_clock;
+
+	NET_DBG("Cached %s type %d as not found", log_strdup(query), type);
+
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_cache_count_shared(void)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	cache_stats.shared++;
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_resolve_cache_stats_get(struct dns_resolve_cache_stats *stats)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	memcpy(stats, &cache_stats, sizeof(*stats));
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_resolve_cache_flush(void)
+{
+	int i;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		cache[i].in_use = false;
+	}
+
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data)
+{
+	int64_t now;
+	int i;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (!cache[i].in_use || cache[i].expires <= now) {
+			continue;
+		}
+
+		cb(cache[i].query, cache[i].type, cache[i].addrs,
+		   cache[i].count,
+		   (uint32_t)((cache[i].expires - now + MSEC_PER_SEC - 1) /
+			      MSEC_PER_SEC),
+		   user_data);
+	}
+
+	k_mutex_unlock(&cache_lock);
+}
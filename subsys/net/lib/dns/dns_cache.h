@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _DNS_CACHE_H_
+#define _DNS_CACHE_H_
+
+#include <stdbool.h>
+#include <zephyr/types.h>
+#include <net/net_ip.h>
+#include <net/dns_resolve.h>
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * @brief Look up a name from the DNS cache.
+ *
+ * @param query Name to look up
+ * @param type Query type
+ * @param addrs Cached addresses are copied here
+ * @param max_count Size of @a addrs
+ *
+ * @return Number of addresses copied, 0 if the name is known not to
+ *         exist, -ENOENT if there is no valid entry for the name.
+ */
+int dns_cache_find(const char *query, enum dns_query_type type,
+		   struct sockaddr *addrs, int max_count);
+
+/**
+ * @brief Store an address received for a name in the DNS cache.
+ *
+ * @param query Name the address belongs to
+ * @param type Query type
+ * @param addr Received address
+ * @param ttl TTL of the resource record in seconds
+ * @param first True for the first address of a response, this replaces the
+ *        addresses cached earlier for the name.
+ */
+void dns_cache_add(const char *query, enum dns_query_type type,
+		   const struct sockaddr *addr, uint32_t ttl, bool first);
+
+/**
+ * @brief Remember that a name does not exist.
+ *
+ * @param query Name that was not found
+ * @param type Query type
+ */
+void dns_cache_add_negative(const char *query, enum dns_query_type type);
+
+/**
+ * @brief Count a lookup that shared the request of a pending query.
+ */
+void dns_cache_count_shared(void);
+#else
+#define dns_cache_find(...) -ENOENT
+#define dns_cache_add(...)
+#define dns_cache_add_negative(...)
+#define dns_cache_count_shared(...)
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+#endif /* _DNS_CACHE_H_ */
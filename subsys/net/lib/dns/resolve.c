@@ -16,6 +16,7 @@ LOG_MODULE_REGISTER(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 #include <zephyr/types.h>
 #include <random/rand32.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <stdlib.h>
 
@@ -26,6 +27,7 @@ LOG_MODULE_REGISTER(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 #include <net/dns_resolve.h>
 #include "dns_pack.h"
 #include "dns_internal.h"
+#include "dns_cache.h"
 
 #define DNS_SERVER_COUNT CONFIG_DNS_RESOLVER_MAX_SERVERS
 #define SERVER_COUNT     (DNS_SERVER_COUNT + DNS_MAX_MCAST_SERVERS)
@@ -394,12 +396,28 @@ static inline void invoke_query_callback(int status,
 					 struct dns_addrinfo *info,
 					 struct dns_pending_query *pending_query)
 {
+	struct dns_resolve_context *ctx = pending_query->ctx;
+	int i;
+
 	/* Only notify if the slot is neither released nor in the process of
 	 * being released.
 	 */
 	if (pending_query->query != NULL)  {
 		pending_query->cb(status, info, pending_query->user_data);
 	}
+
+	if (ctx == NULL || pending_query->owner != NULL) {
+		return;
+	}
+
+	/* The queries sharing the request get the same results */
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		struct dns_pending_query *shared = &ctx->queries[i];
+
+		if (shared->owner == pending_query && shared->query != NULL) {
+			shared->cb(status, info, shared->user_data);
+		}
+	}
 }
 
 /* Release a query slot reserved by get_cb_slot().
@@ -410,7 +428,9 @@ static inline void invoke_query_callback(int status,
  */
 static void release_query(struct dns_pending_query *pending_query)
 {
+	struct dns_resolve_context *ctx = pending_query->ctx;
 	int busy = k_work_cancel_delayable(&pending_query->timer);
+	int i;
 
 	/* If the work item is no longer pending we're done. */
 	if (busy == 0) {
@@ -423,6 +443,51 @@ static void release_query(struct dns_pending_query *pending_query)
 		 */
 		pending_query->query = NULL;
 	}
+
+	if (ctx == NULL || pending_query->owner != NULL) {
+		pending_query->owner = NULL;
+		return;
+	}
+
+	/* The queries sharing the request are done as well */
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (ctx->queries[i].owner == pending_query &&
+		    check_query_active(&ctx->queries[i], false)) {
+			release_query(&ctx->queries[i]);
+		}
+	}
+}
+
+/* Find a pending query whose request can be shared by a new query for
+ * the same name and type. mDNS requests are not shared: their responses
+ * have id 0, so the request could not be handed over to a query with an
+ * id of its own.
+ *
+ * Must be invoked with context lock held.
+ */
+static struct dns_pending_query *get_query_to_share(
+					struct dns_resolve_context *ctx,
+					const char *query,
+					enum dns_query_type type)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		struct dns_pending_query *pending_query = &ctx->queries[i];
+
+		if (check_query_active(pending_query, false) &&
+		    pending_query->query != NULL &&
+		    pending_query->owner == NULL &&
+		    pending_query->id != 0 &&
+		    pending_query->query_hash != 0 &&
+		    pending_query->query_type == type &&
+		    !strncasecmp(pending_query->query, query,
+				 DNS_MAX_NAME_LEN + 1)) {
+			return pending_query;
+		}
+	}
+
+	return NULL;
 }
 
 /* Must be invoked with context lock held */
@@ -456,7 +521,7 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 		     uint16_t *query_hash)
 {
 	struct dns_addrinfo info = { 0 };
-	uint32_t ttl; /* RR ttl, so far it is not passed to caller */
+	uint32_t ttl; /* RR ttl, only used by the cache */
 	uint8_t *src, *addr;
 	const char *query_name;
 	int address_size;
@@ -493,8 +558,12 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 		goto quit;
 	}
 
+	/* A positive value is the rcode of an error response. Only a name
+	 * that does not exist is a negative answer, other errors such as a
+	 * server failure must not be cached.
+	 */
 	ret = dns_unpack_response_header(dns_msg, *dns_id);
-	if (ret < 0) {
+	if (ret < 0 || (ret > 0 && ret != DNS_HEADER_NAMEERROR)) {
 		ret = DNS_EAI_FAIL;
 		goto quit;
 	}
@@ -616,6 +685,12 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 			memcpy(addr, src, address_size);
 
 		query_known:
+			if (ctx->queries[*query_idx].query != NULL) {
+				dns_cache_add(ctx->queries[*query_idx].query,
+					      ctx->queries[*query_idx].query_type,
+					      &info.ai_addr, ttl, items == 0);
+			}
+
 			invoke_query_callback(DNS_EAI_INPROGRESS, &info,
 					      &ctx->queries[*query_idx]);
 			items++;
@@ -684,6 +759,11 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 	}
 
 	if (items == 0) {
+		if (ctx->queries[*query_idx].query != NULL) {
+			dns_cache_add_negative(ctx->queries[*query_idx].query,
+					ctx->queries[*query_idx].query_type);
+		}
+
 		ret = DNS_EAI_NODATA;
 	} else {
 		ret = DNS_EAI_ALLDONE;
@@ -719,6 +799,7 @@ static int dns_read(struct dns_resolve_context *ctx,
 
 	dns_msg.msg = dns_data->data;
 	dns_msg.msg_size = data_len;
+	dns_msg.response_type = DNS_RESPONSE_INVALID;
 
 	ret = dns_validate_msg(ctx, &dns_msg, dns_id, &query_idx,
 			       dns_cname, query_hash);
@@ -925,6 +1006,153 @@ static int dns_write(struct dns_resolve_context *ctx,
 	return 0;
 }
 
+/* Send the request of a query slot to the DNS servers.
+ *
+ * Must be invoked with context lock held.
+ */
+static int dns_send_query(struct dns_resolve_context *ctx, int query_idx,
+			  bool mdns_query)
+{
+	struct net_buf *dns_data = NULL;
+	struct net_buf *dns_qname = NULL;
+	int failure = 0;
+	uint8_t hop_limit;
+	int ret, j;
+
+	dns_data = net_buf_alloc(&dns_msg_pool, ctx->buf_timeout);
+	if (!dns_data) {
+		ret = -ENOMEM;
+		goto quit;
+	}
+
+	dns_qname = net_buf_alloc(&dns_qname_pool, ctx->buf_timeout);
+	if (!dns_qname) {
+		ret = -ENOMEM;
+		goto quit;
+	}
+
+	ret = dns_msg_pack_qname(&dns_qname->len, dns_qname->data,
+				 DNS_MAX_NAME_LEN,
+				 ctx->queries[query_idx].query);
+	if (ret < 0) {
+		goto quit;
+	}
+
+	for (j = 0; j < SERVER_COUNT; j++) {
+		hop_limit = 0U;
+
+		if (!ctx->servers[j].net_ctx) {
+			continue;
+		}
+
+		/* If mDNS is enabled, then send .local queries only to
+		 * a well known multicast mDNS server address.
+		 */
+		if (IS_ENABLED(CONFIG_MDNS_RESOLVER) && mdns_query &&
+		    !ctx->servers[j].is_mdns) {
+			continue;
+		}
+
+		/* If llmnr is enabled, then all the queries are sent to
+		 * LLMNR multicast address unless it is a mDNS query.
+		 */
+		if (!mdns_query && IS_ENABLED(CONFIG_LLMNR_RESOLVER)) {
+			if (!ctx->servers[j].is_llmnr) {
+				continue;
+			}
+
+			hop_limit = 1U;
+		}
+
+		ret = dns_write(ctx, j, query_idx, dns_data, dns_qname,
+				hop_limit);
+		if (ret < 0) {
+			failure++;
+			continue;
+		}
+
+		/* Do one concurrent query only for each name resolve.
+		 * TODO: Change the i (query index) to do multiple concurrent
+		 *       to each server.
+		 */
+		break;
+	}
+
+	if (failure) {
+		NET_DBG("DNS query failed %d times", failure);
+
+		if (failure == j) {
+			ret = -ENOENT;
+			goto quit;
+		}
+	}
+
+	ret = 0;
+
+quit:
+	if (dns_data) {
+		net_buf_unref(dns_data);
+	}
+
+	if (dns_qname) {
+		net_buf_unref(dns_qname);
+	}
+
+	return ret;
+}
+
+/* Hand the request of a query that is cancelled or has timed out over to
+ * the first query sharing it. The request is sent again with the id of the
+ * new owner, and the queries sharing it keep waiting until their own
+ * timeout.
+ *
+ * Must be invoked with context lock held.
+ */
+static void hand_over_query(struct dns_resolve_context *ctx,
+			    struct dns_pending_query *pending_query)
+{
+	struct dns_pending_query *owner = NULL;
+	int owner_idx = -1;
+	int ret, i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		struct dns_pending_query *shared = &ctx->queries[i];
+
+		if (shared->owner != pending_query ||
+		    shared->query == NULL ||
+		    !check_query_active(shared, false)) {
+			continue;
+		}
+
+		if (owner == NULL) {
+			owner = shared;
+			owner_idx = i;
+			owner->owner = NULL;
+		} else {
+			shared->owner = owner;
+		}
+	}
+
+	if (owner == NULL) {
+		return;
+	}
+
+	/* Sending the request restarts the timer, keep the deadline */
+	owner->timeout =
+		K_TICKS(k_work_delayable_remaining_get(&owner->timer));
+
+	NET_DBG("DNS id %u takes over the request of id %u", owner->id,
+		pending_query->id);
+
+	ret = dns_send_query(ctx, owner_idx, false);
+	if (ret < 0) {
+		NET_DBG("Cannot send query (%d)", ret);
+
+		invoke_query_callback(DNS_EAI_SYSTEM, NULL, owner);
+		release_query(owner);
+	}
+}
+
 static int dns_resolve_cancel_with_hash(struct dns_resolve_context *ctx,
 					uint16_t dns_id,
 					uint16_t query_hash,
@@ -945,6 +1173,10 @@ static int dns_resolve_cancel_with_hash(struct dns_resolve_context *ctx,
 		log_strdup(query_name), ctx->queries[i].query_type,
 		query_hash);
 
+	if (ctx->queries[i].owner == NULL) {
+		hand_over_query(ctx, &ctx->queries[i]);
+	}
+
 	invoke_query_callback(DNS_EAI_CANCELED, NULL, &ctx->queries[i]);
 
 	release_query(&ctx->queries[i]);
@@ -1047,6 +1279,53 @@ static void query_timeout(struct k_work *work)
 	k_mutex_unlock(&pending_query->ctx->lock);
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/* Give the answer from the cache to the caller if there is one */
+static bool resolve_from_cache(const char *query,
+			       enum dns_query_type type,
+			       uint16_t *dns_id,
+			       dns_resolve_cb_t cb,
+			       void *user_data)
+{
+	struct sockaddr addrs[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRESSES];
+	struct dns_addrinfo info = { 0 };
+	int count, i;
+
+	count = dns_cache_find(query, type, addrs, ARRAY_SIZE(addrs));
+	if (count < 0) {
+		return false;
+	}
+
+	if (dns_id) {
+		*dns_id = 0U;
+	}
+
+	if (count == 0) {
+		cb(DNS_EAI_NODATA, NULL, user_data);
+		return true;
+	}
+
+	for (i = 0; i < count; i++) {
+		memcpy(&info.ai_addr, &addrs[i], sizeof(info.ai_addr));
+		info.ai_family = addrs[i].sa_family;
+
+		if (info.ai_family == AF_INET) {
+			info.ai_addrlen = sizeof(struct sockaddr_in);
+		} else {
+			info.ai_addrlen = sizeof(struct sockaddr_in6);
+		}
+
+		cb(DNS_EAI_INPROGRESS, &info, user_data);
+	}
+
+	cb(DNS_EAI_ALLDONE, NULL, user_data);
+
+	return true;
+}
+#else
+#define resolve_from_cache(...) false
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 int dns_resolve_name(struct dns_resolve_context *ctx,
 		     const char *query,
 		     enum dns_query_type type,
@@ -1056,13 +1335,10 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 		     int32_t timeout)
 {
 	k_timeout_t tout;
-	struct net_buf *dns_data = NULL;
-	struct net_buf *dns_qname = NULL;
+	struct dns_pending_query *owner;
 	struct sockaddr addr;
-	int ret, i = -1, j = 0;
-	int failure = 0;
+	int ret, i = -1;
 	bool mdns_query = false;
-	uint8_t hop_limit;
 
 	if (!ctx || !ctx->is_used || !query || !cb) {
 		return -EINVAL;
@@ -1124,6 +1400,10 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 	}
 
 try_resolve:
+	if (resolve_from_cache(query, type, dns_id, cb, user_data)) {
+		return 0;
+	}
+
 	k_mutex_lock(&ctx->lock, K_FOREVER);
 
 	i = get_cb_slot(ctx);
@@ -1132,6 +1412,8 @@ try_resolve:
 		goto fail;
 	}
 
+	owner = get_query_to_share(ctx, query, type);
+
 	ctx->queries[i].cb = cb;
 	ctx->queries[i].timeout = tout;
 	ctx->queries[i].query = query;
@@ -1139,24 +1421,38 @@ try_resolve:
 	ctx->queries[i].user_data = user_data;
 	ctx->queries[i].ctx = ctx;
 	ctx->queries[i].query_hash = 0;
+	ctx->queries[i].owner = NULL;
 
 	k_work_init_delayable(&ctx->queries[i].timer, query_timeout);
 
-	dns_data = net_buf_alloc(&dns_msg_pool, ctx->buf_timeout);
-	if (!dns_data) {
-		ret = -ENOMEM;
-		goto quit;
-	}
+	if (owner) {
+		/* The same name is already being resolved, so wait for the
+		 * results of that request instead of sending a new one. The
+		 * query still gets an id of its own so that it can be
+		 * cancelled separately.
+		 */
+		do {
+			ctx->queries[i].id = sys_rand32_get();
+		} while (ctx->queries[i].id == owner->id);
 
-	dns_qname = net_buf_alloc(&dns_qname_pool, ctx->buf_timeout);
-	if (!dns_qname) {
-		ret = -ENOMEM;
-		goto quit;
-	}
+		ctx->queries[i].query_hash = owner->query_hash;
+		ctx->queries[i].owner = owner;
 
-	ret = dns_msg_pack_qname(&dns_qname->len, dns_qname->data,
-				DNS_MAX_NAME_LEN, ctx->queries[i].query);
-	if (ret < 0) {
+		if (dns_id) {
+			*dns_id = ctx->queries[i].id;
+		}
+
+		ret = k_work_reschedule(&ctx->queries[i].timer, tout);
+		if (ret < 0) {
+			goto quit;
+		}
+
+		NET_DBG("DNS id %u shares the request of id %u",
+			ctx->queries[i].id, owner->id);
+
+		dns_cache_count_shared();
+
+		ret = 0;
 		goto quit;
 	}
 
@@ -1186,55 +1482,7 @@ try_resolve:
 		NET_DBG("DNS id will be %u", *dns_id);
 	}
 
-	for (j = 0; j < SERVER_COUNT; j++) {
-		hop_limit = 0U;
-
-		if (!ctx->servers[j].net_ctx) {
-			continue;
-		}
-
-		/* If mDNS is enabled, then send .local queries only to
-		 * a well known multicast mDNS server address.
-		 */
-		if (IS_ENABLED(CONFIG_MDNS_RESOLVER) && mdns_query &&
-		    !ctx->servers[j].is_mdns) {
-			continue;
-		}
-
-		/* If llmnr is enabled, then all the queries are sent to
-		 * LLMNR multicast address unless it is a mDNS query.
-		 */
-		if (!mdns_query && IS_ENABLED(CONFIG_LLMNR_RESOLVER)) {
-			if (!ctx->servers[j].is_llmnr) {
-				continue;
-			}
-
-			hop_limit = 1U;
-		}
-
-		ret = dns_write(ctx, j, i, dns_data, dns_qname, hop_limit);
-		if (ret < 0) {
-			failure++;
-			continue;
-		}
-
-		/* Do one concurrent query only for each name resolve.
-		 * TODO: Change the i (query index) to do multiple concurrent
-		 *       to each server.
-		 */
-		break;
-	}
-
-	if (failure) {
-		NET_DBG("DNS query failed %d times", failure);
-
-		if (failure == j) {
-			ret = -ENOENT;
-			goto quit;
-		}
-	}
-
-	ret = 0;
+	ret = dns_send_query(ctx, i, mdns_query);
 
 quit:
 	if (ret < 0) {
@@ -1247,14 +1495,6 @@ quit:
 		}
 	}
 
-	if (dns_data) {
-		net_buf_unref(dns_data);
-	}
-
-	if (dns_qname) {
-		net_buf_unref(dns_qname);
-	}
-
 fail:
 	k_mutex_unlock(&ctx->lock);
 
@@ -1292,6 +1532,11 @@ int dns_resolve_close(struct dns_resolve_context *ctx)
 		}
 	}
 
+	/* The servers may change, so forget what they told us */
+	if (IS_ENABLED(CONFIG_DNS_RESOLVER_CACHE)) {
+		dns_resolve_cache_flush();
+	}
+
 	ctx->is_used = false;
 
 	k_mutex_unlock(&ctx->lock);
@@ -0,0 +1,954 @@
+/** @file
+ * @brief HTTP server API
+ *
+ * An API for applications to serve HTTP/1.1 requests
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_http_server, CONFIG_NET_HTTP_SERVER_LOG_LEVEL);
+
+#include <kernel.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <sys/printk.h>
+
+#include <net/net_core.h>
+#include <net/net_ip.h>
+#include <net/socket.h>
+#include <net/http_server.h>
+
+#if defined(CONFIG_HTTP_SERVER_WEBSOCKET)
+#include <sys/base64.h>
+#include <mbedtls/sha1.h>
+
+#define WS_MAGIC "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define WS_SHA1_OUTPUT_LEN 20
+#define WS_KEY_FIELD "Sec-WebSocket-Key"
+#endif
+
+#define NO_FIELD_MATCH UINT8_MAX
+
+/* Time between attempts to send to a client whose window is full */
+#define SEND_RETRY_MS 10
+
+static const struct http_parser_settings parser_settings;
+
+static const char *status_str(uint16_t status)
+{
+	switch (status) {
+	case 101:
+		return "Switching Protocols";
+	case 200:
+		return "OK";
+	case 201:
+		return "Created";
+	case 204:
+		return "No Content";
+	case 400:
+		return "Bad Request";
+	case 403:
+		return "Forbidden";
+	case 404:
+		return "Not Found";
+	case 405:
+		return "Method Not Allowed";
+	case 413:
+		return "Payload Too Large";
+	case 414:
+		return "URI Too Long";
+	case 426:
+		return "Upgrade Required";
+	case 500:
+		return "Internal Server Error";
+	case 503:
+		return "Service Unavailable";
+	default:
+		return "";
+	}
+}
+
+/* The server thread serves all the clients, so a client that does not
+ * read its responses must not hold it up for long. Sockets always poll
+ * as writable, so a full send window is only seen when sending, and the
+ * send is retried until the deadline of the current client.
+ */
+static int sendall(struct http_server_ctx *ctx, const void *buf, size_t len)
+{
+	int sock = ctx->tx_client->sock;
+
+	while (len) {
+		ssize_t out_len = zsock_send(sock, buf, len,
+					     ZSOCK_MSG_DONTWAIT);
+
+		if (out_len < 0) {
+			if (errno != EAGAIN && errno != ENOBUFS) {
+				return -errno;
+			}
+
+			if (k_uptime_get() >= ctx->tx_deadline) {
+				return -ETIMEDOUT;
+			}
+
+			k_msleep(SEND_RETRY_MS);
+			continue;
+		}
+
+		buf = (const char *)buf + out_len;
+		len -= out_len;
+	}
+
+	return 0;
+}
+
+static int tx_flush(struct http_server_ctx *ctx)
+{
+	struct http_server_client *client = ctx->tx_client;
+	int ret;
+
+	if (ctx->tx_len == 0U) {
+		return 0;
+	}
+
+	ret = sendall(ctx, ctx->tx_buf, ctx->tx_len);
+	ctx->tx_len = 0U;
+
+	if (ret < 0) {
+		NET_DBG("Cannot send to sock %d (%d)", client->sock, ret);
+		client->closing = 1U;
+	}
+
+	return ret;
+}
+
+/* Responses are collected in the send buffer and sent once all the
+ * requests received in one go are handled, so that the responses to
+ * pipelined requests share segments.
+ */
+static int tx_append(struct http_server_ctx *ctx, const void *data,
+		     size_t len)
+{
+	int ret;
+
+	if (len > sizeof(ctx->tx_buf) - ctx->tx_len) {
+		ret = tx_flush(ctx);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (len > sizeof(ctx->tx_buf)) {
+			ret = sendall(ctx, data, len);
+			if (ret < 0) {
+				ctx->tx_client->closing = 1U;
+			}
+
+			return ret;
+		}
+	}
+
+	memcpy(ctx->tx_buf + ctx->tx_len, data, len);
+	ctx->tx_len += len;
+
+	return 0;
+}
+
+static int tx_printf(struct http_server_ctx *ctx, const char *fmt, ...)
+{
+	va_list va;
+	size_t left;
+	int len, ret;
+
+	left = sizeof(ctx->tx_buf) - ctx->tx_len;
+
+	va_start(va, fmt);
+	len = vsnprintk((char *)ctx->tx_buf + ctx->tx_len, left, fmt, va);
+	va_end(va);
+
+	if (len < 0) {
+		return len;
+	}
+
+	if ((size_t)len >= left) {
+		ret = tx_flush(ctx);
+		if (ret < 0) {
+			return ret;
+		}
+
+		va_start(va, fmt);
+		len = vsnprintk((char *)ctx->tx_buf, sizeof(ctx->tx_buf), fmt,
+				va);
+		va_end(va);
+
+		if ((size_t)len >= sizeof(ctx->tx_buf)) {
+			return -EMSGSIZE;
+		}
+	}
+
+	ctx->tx_len += len;
+
+	return 0;
+}
+
+static bool rsp_has_body(struct http_server_response *rsp)
+{
+	return rsp->req->method != HTTP_HEAD;
+}
+
+/* Content length is SIZE_MAX when it is not known beforehand */
+static int send_headers(struct http_server_response *rsp, uint16_t status,
+			const char *content_type, size_t content_len)
+{
+	struct http_server_ctx *ctx = rsp->ctx;
+	struct http_server_client *client = rsp->client;
+	int ret;
+
+	if (rsp->started) {
+		return -EALREADY;
+	}
+
+	rsp->started = 1U;
+
+	ret = tx_printf(ctx, "HTTP/1.1 %u %s" HTTP_CRLF, status,
+			status_str(status));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (content_type) {
+		ret = tx_printf(ctx, "Content-Type: %s" HTTP_CRLF,
+				content_type);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (rsp->chunked) {
+		ret = tx_printf(ctx, "Transfer-Encoding: chunked" HTTP_CRLF);
+	} else if (content_len != SIZE_MAX) {
+		ret = tx_printf(ctx, "Content-Length: %zu" HTTP_CRLF,
+				content_len);
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* HTTP/1.1 connections are persistent by default, HTTP/1.0 ones
+	 * only when the client asked for it.
+	 */
+	if (client->closing) {
+		ret = tx_printf(ctx, "Connection: close" HTTP_CRLF HTTP_CRLF);
+	} else if (rsp->req->http_minor == 0U) {
+		ret = tx_printf(ctx, "Connection: keep-alive" HTTP_CRLF
+				HTTP_CRLF);
+	} else {
+		ret = tx_printf(ctx, HTTP_CRLF);
+	}
+
+	return ret;
+}
+
+int http_server_send_response(struct http_server_response *rsp,
+			      uint16_t status, const char *content_type,
+			      const void *body, size_t body_len)
+{
+	int ret;
+
+	if (rsp == NULL || (body == NULL && body_len > 0)) {
+		return -EINVAL;
+	}
+
+	ret = send_headers(rsp, status, content_type, body_len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	rsp->done = 1U;
+
+	if (!rsp_has_body(rsp) || body_len == 0) {
+		return 0;
+	}
+
+	return tx_append(rsp->ctx, body, body_len);
+}
+
+int http_server_send_chunked_begin(struct http_server_response *rsp,
+				   uint16_t status, const char *content_type)
+{
+	if (rsp == NULL) {
+		return -EINVAL;
+	}
+
+	/* HTTP/1.0 has no chunked encoding, the end of the body is told by
+	 * closing the connection.
+	 */
+	if (rsp->req->http_minor == 0U) {
+		rsp->client->closing = 1U;
+	} else {
+		rsp->chunked = 1U;
+	}
+
+	return send_headers(rsp, status, content_type, SIZE_MAX);
+}
+
+int http_server_send_chunk(struct http_server_response *rsp,
+			   const void *data, size_t len)
+{
+	int ret;
+
+	if (rsp == NULL || !rsp->started || rsp->done) {
+		return -EINVAL;
+	}
+
+	if (!rsp_has_body(rsp) || len == 0) {
+		return 0;
+	}
+
+	if (!rsp->chunked) {
+		return tx_append(rsp->ctx, data, len);
+	}
+
+	ret = tx_printf(rsp->ctx, "%zx" HTTP_CRLF, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = tx_append(rsp->ctx, data, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return tx_append(rsp->ctx, HTTP_CRLF, sizeof(HTTP_CRLF) - 1);
+}
+
+int http_server_send_chunked_end(struct http_server_response *rsp)
+{
+	if (rsp == NULL || !rsp->started || rsp->done) {
+		return -EINVAL;
+	}
+
+	rsp->done = 1U;
+
+	if (!rsp_has_body(rsp) || !rsp->chunked) {
+		return 0;
+	}
+
+	return tx_printf(rsp->ctx, "0" HTTP_CRLF HTTP_CRLF);
+}
+
+static void request_reset(struct http_server_client *client)
+{
+	client->url_len = 0U;
+	client->body_len = 0U;
+	client->status = 0U;
+	client->field_pos = 0U;
+	client->ws_key_len = 0U;
+	client->in_value = 0U;
+	client->ws_key_field = 0U;
+}
+
+static int send_status(struct http_server_response *rsp, uint16_t status)
+{
+	NET_DBG("[%d] %u %s", rsp->client->sock, status, status_str(status));
+
+	return http_server_send_response(rsp, status, NULL, NULL, 0);
+}
+
+static bool path_match(const char *route_path, const char *path)
+{
+	size_t len = strlen(route_path);
+
+	if (len > 0 && route_path[len - 1] == '*') {
+		return strncmp(route_path, path, len - 1) == 0;
+	}
+
+	return strcmp(route_path, path) == 0;
+}
+
+static const struct http_server_route *find_route(struct http_server_ctx *ctx,
+						  const char *path,
+						  enum http_method method,
+						  uint16_t *status)
+{
+	const struct http_server_route *route;
+	size_t i;
+
+	*status = 404U;
+
+	for (i = 0; i < ctx->num_routes; i++) {
+		route = &ctx->routes[i];
+
+		if (!path_match(route->path, path)) {
+			continue;
+		}
+
+		if (route->method == method ||
+		    (route->method == HTTP_GET && method == HTTP_HEAD)) {
+			return route;
+		}
+
+		*status = 405U;
+	}
+
+	return NULL;
+}
+
+#if defined(CONFIG_HTTP_SERVER_WEBSOCKET)
+static int websocket_upgrade(struct http_server_response *rsp,
+			     const struct http_server_route *route)
+{
+	struct http_server_client *client = rsp->client;
+	char key_accept[HTTP_SERVER_WS_KEY_LEN + sizeof(WS_MAGIC) - 1];
+	uint8_t sha1[WS_SHA1_OUTPUT_LEN];
+	uint8_t accept[32];
+	size_t olen;
+	int ret;
+
+	if (client->ws_key_len != HTTP_SERVER_WS_KEY_LEN) {
+		return send_status(rsp, 400U);
+	}
+
+	memcpy(key_accept, client->ws_key, HTTP_SERVER_WS_KEY_LEN);
+	memcpy(key_accept + HTTP_SERVER_WS_KEY_LEN, WS_MAGIC,
+	       sizeof(WS_MAGIC) - 1);
+
+	mbedtls_sha1_ret((const unsigned char *)key_accept, sizeof(key_accept),
+			 sha1);
+
+	ret = base64_encode(accept, sizeof(accept) - 1, &olen, sha1,
+			    sizeof(sha1));
+	if (ret) {
+		return -EINVAL;
+	}
+
+	accept[olen] = '\0';
+
+	rsp->started = 1U;
+	rsp->done = 1U;
+
+	ret = tx_printf(rsp->ctx, "HTTP/1.1 101 %s" HTTP_CRLF
+			"Upgrade: websocket" HTTP_CRLF
+			"Connection: Upgrade" HTTP_CRLF
+			"Sec-WebSocket-Accept: %s" HTTP_CRLF HTTP_CRLF,
+			status_str(101), accept);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = tx_flush(rsp->ctx);
+	if (ret < 0) {
+		return ret;
+	}
+
+	NET_DBG("[%d] Upgraded to Websocket", client->sock);
+
+	/* The client waits for the handshake response before sending
+	 * frames, so nothing received after the request is lost.
+	 */
+	client->upgraded = 1U;
+	route->websocket_cb(client->sock, rsp->req, route->user_data);
+
+	return 0;
+}
+#endif
+
+static int handle_request(struct http_server_ctx *ctx,
+			  struct http_server_client *client)
+{
+	struct http_server_request req = {
+		.path = client->url,
+		.body = client->body,
+		.body_len = client->body_len,
+		.method = client->parser.method,
+		.http_minor = client->parser.http_minor,
+	};
+	struct http_server_response rsp = {
+		.ctx = ctx,
+		.client = client,
+		.req = &req,
+	};
+	const struct http_server_route *route;
+	uint16_t status;
+	char *query;
+	int ret;
+
+	client->url[client->url_len] = '\0';
+
+	query = strchr(client->url, '?');
+	if (query) {
+		*query = '\0';
+		req.query = query + 1;
+	}
+
+	NET_DBG("[%d] %s %s", client->sock, http_method_str(req.method),
+		log_strdup(req.path));
+
+	if (!http_should_keep_alive(&client->parser)) {
+		client->closing = 1U;
+	}
+
+	if (client->status) {
+		return send_status(&rsp, client->status);
+	}
+
+	route = find_route(ctx, req.path, req.method, &status);
+	if (!route) {
+		return send_status(&rsp, status);
+	}
+
+	if (client->parser.upgrade && route->websocket_cb) {
+#if defined(CONFIG_HTTP_SERVER_WEBSOCKET)
+		return websocket_upgrade(&rsp, route);
+#endif
+	}
+
+	if (!route->handler) {
+		return send_status(&rsp, 426U);
+	}
+
+	ret = route->handler(&req, &rsp, route->user_data);
+	if (ret < 0) {
+		NET_DBG("[%d] Handler failed (%d)", client->sock, ret);
+
+		client->closing = 1U;
+
+		if (!rsp.started) {
+			(void)send_status(&rsp, 500U);
+		}
+
+		return 0;
+	}
+
+	if (!rsp.started) {
+		return send_status(&rsp, 204U);
+	}
+
+	if (!rsp.done) {
+		return http_server_send_chunked_end(&rsp);
+	}
+
+	return 0;
+}
+
+static int on_message_begin(struct http_parser *parser)
+{
+	struct http_server_client *client =
+		CONTAINER_OF(parser, struct http_server_client, parser);
+
+	/* Stop handling pipelined requests after the last one */
+	if (client->closing) {
+		return -1;
+	}
+
+	request_reset(client);
+
+	return 0;
+}
+
+static int on_url(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_client *client =
+		CONTAINER_OF(parser, struct http_server_client, parser);
+
+	/* Leave room for the terminating NUL */
+	if (length >= sizeof(client->url) - client->url_len) {
+		client->status = 414U;
+		return 0;
+	}
+
+	memcpy(client->url + client->url_len, at, length);
+	client->url_len += length;
+
+	return 0;
+}
+
+#if defined(CONFIG_HTTP_SERVER_WEBSOCKET)
+/* Header names and values can be split over several receives, the only
+ * field needed is matched as it arrives instead of storing the names.
+ */
+static int on_header_field(struct http_parser *parser, const char *at,
+			   size_t length)
+{
+	struct http_server_client *client =
+		CONTAINER_OF(parser, struct http_server_client, parser);
+	size_t i;
+
+	if (client->in_value) {
+		client->in_value = 0U;
+		client->field_pos = 0U;
+	}
+
+	for (i = 0; i < length && client->field_pos != NO_FIELD_MATCH; i++) {
+		if (client->field_pos < sizeof(WS_KEY_FIELD) - 1 &&
+		    tolower((unsigned char)at[i]) ==
+		    tolower((unsigned char)WS_KEY_FIELD[client->field_pos])) {
+			client->field_pos++;
+		} else {
+			client->field_pos = NO_FIELD_MATCH;
+		}
+	}
+
+	return 0;
+}
+
+static int on_header_value(struct http_parser *parser, const char *at,
+			   size_t length)
+{
+	struct http_server_client *client =
+		CONTAINER_OF(parser, struct http_server_client, parser);
+
+	if (!client->in_value) {
+		client->in_value = 1U;
+		client->ws_key_field =
+			client->field_pos == sizeof(WS_KEY_FIELD) - 1;
+		if (client->ws_key_field) {
+			client->ws_key_len = 0U;
+		}
+	}
+
+	if (!client->ws_key_field) {
+		return 0;
+	}
+
+	/* A key of the wrong length is left unusable */
+	if (length > sizeof(client->ws_key) - client->ws_key_len) {
+		client->ws_key_len = NO_FIELD_MATCH;
+		return 0;
+	}
+
+	memcpy(client->ws_key + client->ws_key_len, at, length);
+	client->ws_key_len += length;
+
+	return 0;
+}
+#endif
+
+static int on_body(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_client *client =
+		CONTAINER_OF(parser, struct http_server_client, parser);
+
+	if (length > sizeof(client->body) - client->body_len) {
+		client->status = 413U;
+		return 0;
+	}
+
+	memcpy(client->body + client->body_len, at, length);
+	client->body_len += length;
+
+	return 0;
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+	struct http_server_client *client =
+		CONTAINER_OF(parser, struct http_server_client, parser);
+	int ret;
+
+	ret = handle_request(parser->data, client);
+	if (ret < 0) {
+		client->closing = 1U;
+	}
+
+	return 0;
+}
+
+static const struct http_parser_settings parser_settings = {
+	.on_message_begin = on_message_begin,
+	.on_url = on_url,
+#if defined(CONFIG_HTTP_SERVER_WEBSOCKET)
+	.on_header_field = on_header_field,
+	.on_header_value = on_header_value,
+#endif
+	.on_body = on_body,
+	.on_message_complete = on_message_complete,
+};
+
+static void client_release(struct http_server_ctx *ctx,
+			   struct http_server_client *client)
+{
+	int idx = client - ctx->clients;
+
+	if (!client->upgraded) {
+		NET_DBG("[%d] Closing connection", client->sock);
+		(void)zsock_close(client->sock);
+	}
+
+	client->sock = -1;
+	ctx->fds[idx + 1].fd = -1;
+}
+
+static void client_accept(struct http_server_ctx *ctx)
+{
+	struct http_server_client *client = NULL;
+	int i, sock, one = 1;
+
+	sock = zsock_accept(ctx->sock, NULL, NULL);
+	if (sock < 0) {
+		NET_ERR("Cannot accept connection (%d)", -errno);
+		return;
+	}
+
+	/* Responses are already coalesced in the send buffer */
+	(void)zsock_setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one,
+			       sizeof(one));
+
+	for (i = 0; i < ARRAY_SIZE(ctx->clients); i++) {
+		if (ctx->clients[i].sock < 0) {
+			client = &ctx->clients[i];
+			break;
+		}
+	}
+
+	if (!client) {
+		NET_DBG("No free client slot");
+		(void)zsock_close(sock);
+		return;
+	}
+
+	http_parser_init(&client->parser, HTTP_REQUEST);
+	client->parser.data = ctx;
+	client->sock = sock;
+	client->closing = 0U;
+	client->upgraded = 0U;
+	client->last_activity = k_uptime_get();
+	request_reset(client);
+
+	ctx->fds[i + 1].fd = sock;
+	ctx->fds[i + 1].events = ZSOCK_POLLIN;
+
+	NET_DBG("[%d] New connection", sock);
+}
+
+static void client_recv(struct http_server_ctx *ctx,
+			struct http_server_client *client)
+{
+	struct http_server_request req = {
+		.method = HTTP_GET,
+		.http_minor = 1U,
+	};
+	struct http_server_response rsp = {
+		.ctx = ctx,
+		.client = client,
+		.req = &req,
+	};
+	size_t offset = 0, parsed;
+	ssize_t len;
+
+	len = zsock_recv(client->sock, ctx->rx_buf, sizeof(ctx->rx_buf), 0);
+	if (len <= 0) {
+		if (len < 0) {
+			NET_DBG("[%d] Receive error (%d)", client->sock,
+				-errno);
+		}
+
+		client_release(ctx, client);
+		return;
+	}
+
+	client->last_activity = k_uptime_get();
+	ctx->tx_client = client;
+	ctx->tx_deadline = client->last_activity +
+			   CONFIG_HTTP_SERVER_SEND_TIMEOUT;
+
+	/* All the requests in the received data are handled, and the
+	 * responses sent together afterwards.
+	 */
+	while (offset < (size_t)len && !client->closing) {
+		parsed = http_parser_execute(&client->parser, &parser_settings,
+					     (const char *)ctx->rx_buf + offset,
+					     len - offset);
+		offset += parsed;
+
+		if (client->upgraded || client->closing) {
+			break;
+		}
+
+		if (HTTP_PARSER_ERRNO(&client->parser) != HPE_OK) {
+			NET_DBG("[%d] Invalid request (%s)", client->sock,
+				http_errno_name(
+					HTTP_PARSER_ERRNO(&client->parser)));
+			client->closing = 1U;
+			(void)send_status(&rsp, 400U);
+			break;
+		}
+
+		/* An upgrade the server did not accept, the connection
+		 * goes on with HTTP.
+		 */
+		if (client->parser.upgrade) {
+			http_parser_init(&client->parser, HTTP_REQUEST);
+			client->parser.data = ctx;
+		} else if (parsed == 0U) {
+			break;
+		}
+	}
+
+	if (tx_flush(ctx) < 0 || client->closing || client->upgraded) {
+		client_release(ctx, client);
+	}
+}
+
+int http_server_init(struct http_server_ctx *ctx, const struct sockaddr *addr,
+		     socklen_t addrlen, const struct http_server_route *routes,
+		     size_t num_routes)
+{
+	int i, ret;
+
+	if (ctx == NULL || addr == NULL || (routes == NULL && num_routes)) {
+		return -EINVAL;
+	}
+
+	ctx->routes = routes;
+	ctx->num_routes = num_routes;
+	ctx->tx_client = NULL;
+	ctx->tx_len = 0U;
+	atomic_set(&ctx->stop, 0);
+
+	for (i = 0; i < ARRAY_SIZE(ctx->clients); i++) {
+		ctx->clients[i].sock = -1;
+		ctx->fds[i + 1].fd = -1;
+	}
+
+	ctx->sock = zsock_socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+	if (ctx->sock < 0) {
+		ret = -errno;
+		NET_ERR("Cannot create socket (%d)", ret);
+		return ret;
+	}
+
+	if (zsock_bind(ctx->sock, addr, addrlen) < 0) {
+		ret = -errno;
+		NET_ERR("Cannot bind (%d)", ret);
+		goto fail;
+	}
+
+	if (zsock_listen(ctx->sock, CONFIG_HTTP_SERVER_MAX_CLIENTS) < 0) {
+		ret = -errno;
+		NET_ERR("Cannot listen (%d)", ret);
+		goto fail;
+	}
+
+	ctx->fds[0].fd = ctx->sock;
+	ctx->fds[0].events = ZSOCK_POLLIN;
+
+	return 0;
+
+fail:
+	(void)zsock_close(ctx->sock);
+	ctx->sock = -1;
+
+	return ret;
+}
+
+int http_server_process(struct http_server_ctx *ctx, int timeout)
+{
+	int64_t now = k_uptime_get();
+	int i, ret, clients = 0;
+	int64_t left;
+
+	for (i = 0; i < ARRAY_SIZE(ctx->clients); i++) {
+		if (ctx->clients[i].sock < 0) {
+			continue;
+		}
+
+		clients++;
+
+		left = MAX(ctx->clients[i].last_activity +
+			   CONFIG_HTTP_SERVER_CLIENT_TIMEOUT - now, 0);
+		if (timeout == SYS_FOREVER_MS || left < timeout) {
+			timeout = left;
+		}
+	}
+
+	/* When all the slots are in use, new connections wait in the
+	 * listen backlog.
+	 */
+	ctx->fds[0].events =
+		clients < ARRAY_SIZE(ctx->clients) ? ZSOCK_POLLIN : 0;
+
+	ret = zsock_poll(ctx->fds, ARRAY_SIZE(ctx->fds), timeout);
+	if (ret < 0) {
+		ret = -errno;
+		NET_ERR("Cannot poll (%d)", ret);
+		return ret;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(ctx->clients) && ret > 0; i++) {
+		struct http_server_client *client = &ctx->clients[i];
+		short revents = ctx->fds[i + 1].revents;
+
+		if (client->sock < 0 || revents == 0) {
+			continue;
+		}
+
+		if (revents & ZSOCK_POLLIN) {
+			client_recv(ctx, client);
+		} else {
+			client_release(ctx, client);
+		}
+	}
+
+	if (ctx->fds[0].revents & ZSOCK_POLLIN) {
+		client_accept(ctx);
+	}
+
+	now = k_uptime_get();
+
+	for (i = 0; i < ARRAY_SIZE(ctx->clients); i++) {
+		if (ctx->clients[i].sock >= 0 &&
+		    now - ctx->clients[i].last_activity >=
+		    CONFIG_HTTP_SERVER_CLIENT_TIMEOUT) {
+			NET_DBG("[%d] Idle timeout", ctx->clients[i].sock);
+			client_release(ctx, &ctx->clients[i]);
+		}
+	}
+
+	return 0;
+}
+
+int http_server_run(struct http_server_ctx *ctx)
+{
+	int ret;
+
+	while (!atomic_get(&ctx->stop)) {
+		ret = http_server_process(ctx,
+					  CONFIG_HTTP_SERVER_CLIENT_TIMEOUT);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+void http_server_stop(struct http_server_ctx *ctx)
+{
+	atomic_set(&ctx->stop, 1);
+}
+
+void http_server_close(struct http_server_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ctx->clients); i++) {
+		if (ctx->clients[i].sock >= 0) {
+			client_release(ctx, &ctx->clients[i]);
+		}
+	}
+
+	if (ctx->sock >= 0) {
+		(void)zsock_close(ctx->sock);
+		ctx->sock = -1;
+		ctx->fds[0].fd = -1;
+	}
+}
@@ -46,6 +46,9 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #ifdef CONFIG_LWM2M_RW_JSON_SUPPORT
 #include "lwm2m_rw_json.h"
 #endif
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+#include "lwm2m_rw_senml_cbor.h"
+#endif
 #ifdef CONFIG_LWM2M_RD_CLIENT_SUPPORT
 #include "lwm2m_rd_client.h"
 #endif
@@ -80,6 +83,14 @@ struct observe_node {
 	uint32_t counter;
 	uint16_t format;
 	uint8_t  tkl;
+	/* resolved instance, valid while obj_gen matches engine_obj_gen */
+	struct lwm2m_engine_obj_inst *obj_inst;
+	uint32_t obj_gen;
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	/* Observe-Composite: paths read by each notification */
+	struct lwm2m_obj_path composite[CONFIG_LWM2M_COMPOSITE_PATH_LIST_SIZE];
+	uint8_t composite_count;
+#endif
 };
 
 struct notification_attrs {
@@ -107,6 +118,10 @@ static struct service_node service_node_data[MAX_PERIODIC_SERVICE];
 
 static sys_slist_t engine_obj_list;
 static sys_slist_t engine_obj_inst_list;
+static sys_slist_t engine_obj_hash[CONFIG_LWM2M_ENGINE_HASH_SIZE];
+static sys_slist_t engine_obj_inst_hash[CONFIG_LWM2M_ENGINE_HASH_SIZE];
+/* changed whenever an object or an instance is (un)registered */
+static uint32_t engine_obj_gen;
 static sys_slist_t engine_observer_list;
 static sys_slist_t engine_service_list;
 
@@ -342,6 +357,44 @@ static void clear_attrs(void *ref)
 	}
 }
 
+static inline bool observe_node_is_composite(struct observe_node *obs)
+{
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	return obs->composite_count > 0;
+#else
+	return false;
+#endif
+}
+
+static bool observe_path_match(struct lwm2m_obj_path *path, uint16_t obj_id,
+			       uint16_t obj_inst_id, uint16_t res_id)
+{
+	return path->obj_id == obj_id &&
+	       path->obj_inst_id == obj_inst_id &&
+	       (path->level < 3 || path->res_id == res_id);
+}
+
+static bool observe_node_match(struct observe_node *obs, uint16_t obj_id,
+			       uint16_t obj_inst_id, uint16_t res_id)
+{
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	int i;
+
+	for (i = 0; i < obs->composite_count; i++) {
+		if (observe_path_match(&obs->composite[i], obj_id,
+				       obj_inst_id, res_id)) {
+			return true;
+		}
+	}
+
+	if (observe_node_is_composite(obs)) {
+		return false;
+	}
+#endif
+
+	return observe_path_match(&obs->path, obj_id, obj_inst_id, res_id);
+}
+
 int lwm2m_notify_observer(uint16_t obj_id, uint16_t obj_inst_id, uint16_t res_id)
 {
 	struct observe_node *obs;
@@ -349,10 +402,7 @@ int lwm2m_notify_observer(uint16_t obj_id, uint16_t obj_inst_id, uint16_t res_id
 
 	/* look for observers which match our resource */
 	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
-		if (obs->path.obj_id == obj_id &&
-		    obs->path.obj_inst_id == obj_inst_id &&
-		    (obs->path.level < 3 ||
-		     obs->path.res_id == res_id)) {
+		if (observe_node_match(obs, obj_id, obj_inst_id, res_id)) {
 			/* update the event time for this observer */
 			obs->event_timestamp = k_uptime_get();
 
@@ -372,6 +422,43 @@ int lwm2m_notify_observer_path(struct lwm2m_obj_path *path)
 				     path->res_id);
 }
 
+static struct observe_node *observe_node_alloc(struct lwm2m_message *msg,
+						const uint8_t *token,
+						uint8_t tkl, uint16_t format,
+						struct notification_attrs *attrs)
+{
+	struct observe_node *obs;
+	int i;
+
+	/* find an unused observer index node */
+	for (i = 0; i < CONFIG_LWM2M_ENGINE_MAX_OBSERVER; i++) {
+		if (!observe_node_data[i].ctx) {
+			break;
+		}
+	}
+
+	/* couldn't find an index */
+	if (i == CONFIG_LWM2M_ENGINE_MAX_OBSERVER) {
+		return NULL;
+	}
+
+	/* copy the values and add it to the list */
+	obs = &observe_node_data[i];
+	obs->ctx = msg->ctx;
+	memcpy(&obs->path, &msg->path, sizeof(msg->path));
+	memcpy(obs->token, token, tkl);
+	obs->tkl = tkl;
+	obs->last_timestamp = k_uptime_get();
+	obs->event_timestamp = obs->last_timestamp;
+	obs->min_period_sec = attrs->pmin;
+	obs->max_period_sec = MAX(attrs->pmax, attrs->pmin);
+	obs->format = format;
+	obs->counter = OBSERVE_COUNTER_START;
+	sys_slist_append(&engine_observer_list, &obs->node);
+
+	return obs;
+}
+
 static int engine_add_observer(struct lwm2m_message *msg,
 			       const uint8_t *token, uint8_t tkl,
 			       uint16_t format)
@@ -405,7 +492,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	/* make sure this observer doesn't exist already */
 	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
 		/* TODO: distinguish server object */
-		if (obs->ctx == msg->ctx &&
+		if (obs->ctx == msg->ctx && !observe_node_is_composite(obs) &&
 		    memcmp(&obs->path, &msg->path, sizeof(msg->path)) == 0) {
 			/* quietly update the token information */
 			memcpy(obs->token, token, tkl);
@@ -485,33 +572,10 @@ static int engine_add_observer(struct lwm2m_message *msg,
 		}
 	}
 
-	/* find an unused observer index node */
-	for (i = 0; i < CONFIG_LWM2M_ENGINE_MAX_OBSERVER; i++) {
-		if (!observe_node_data[i].ctx) {
-			break;
-		}
-	}
-
-	/* couldn't find an index */
-	if (i == CONFIG_LWM2M_ENGINE_MAX_OBSERVER) {
+	if (!observe_node_alloc(msg, token, tkl, format, &attrs)) {
 		return -ENOMEM;
 	}
 
-	/* copy the values and add it to the list */
-	observe_node_data[i].ctx = msg->ctx;
-	memcpy(&observe_node_data[i].path, &msg->path, sizeof(msg->path));
-	memcpy(observe_node_data[i].token, token, tkl);
-	observe_node_data[i].tkl = tkl;
-	observe_node_data[i].last_timestamp = k_uptime_get();
-	observe_node_data[i].event_timestamp =
-			observe_node_data[i].last_timestamp;
-	observe_node_data[i].min_period_sec = attrs.pmin;
-	observe_node_data[i].max_period_sec = MAX(attrs.pmax, attrs.pmin);
-	observe_node_data[i].format = format;
-	observe_node_data[i].counter = OBSERVE_COUNTER_START;
-	sys_slist_append(&engine_observer_list,
-			 &observe_node_data[i].node);
-
 	LOG_DBG("OBSERVER ADDED %u/%u/%u(%u) token:'%s' addr:%s",
 		msg->path.obj_id, msg->path.obj_inst_id,
 		msg->path.res_id, msg->path.level,
@@ -521,6 +585,72 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	return 0;
 }
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+static int engine_add_composite_observer(struct lwm2m_message *msg,
+					 const uint8_t *token, uint8_t tkl,
+					 uint16_t format,
+					 struct lwm2m_obj_path *paths,
+					 uint8_t num_paths)
+{
+	struct observe_node *obs;
+	struct notification_attrs attrs = {
+		.flags = BIT(LWM2M_ATTR_PMIN) | BIT(LWM2M_ATTR_PMAX),
+	};
+
+	if (!msg || !msg->ctx) {
+		LOG_ERR("valid lwm2m message is required");
+		return -EINVAL;
+	}
+
+	if (!token || (tkl == 0U || tkl > MAX_TOKEN_LEN)) {
+		LOG_ERR("token(%p) and token length(%u) must be valid.",
+			token, tkl);
+		return -EINVAL;
+	}
+
+	if (num_paths == 0U ||
+	    num_paths > CONFIG_LWM2M_COMPOSITE_PATH_LIST_SIZE) {
+		return -EINVAL;
+	}
+
+	/* defaults from server object, composite paths carry no attributes */
+	attrs.pmin = lwm2m_server_get_pmin(msg->ctx->srv_obj_inst);
+	attrs.pmax = lwm2m_server_get_pmax(msg->ctx->srv_obj_inst);
+
+	/* make sure this observer doesn't exist already */
+	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
+		if (obs->ctx == msg->ctx && obs->composite_count == num_paths &&
+		    memcmp(obs->composite, paths,
+			   num_paths * sizeof(*paths)) == 0) {
+			/* quietly update the token information */
+			memcpy(obs->token, token, tkl);
+			obs->tkl = tkl;
+
+			LOG_DBG("COMPOSITE OBSERVER DUPLICATE (%u paths) [%s]",
+				num_paths,
+				log_strdup(
+				lwm2m_sprint_ip_addr(&msg->ctx->remote_addr)));
+
+			return 0;
+		}
+	}
+
+	obs = observe_node_alloc(msg, token, tkl, format, &attrs);
+	if (!obs) {
+		return -ENOMEM;
+	}
+
+	memcpy(obs->composite, paths, num_paths * sizeof(*paths));
+	obs->composite_count = num_paths;
+
+	LOG_DBG("COMPOSITE OBSERVER ADDED (%u paths) token:'%s' addr:%s",
+		num_paths, log_strdup(sprint_token(token, tkl)),
+		log_strdup(lwm2m_sprint_ip_addr(&msg->ctx->remote_addr)));
+
+	return 0;
+}
+#endif /* CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT */
+
 static int engine_remove_observer(const uint8_t *token, uint8_t tkl)
 {
 	struct observe_node *obs, *found_obj = NULL;
@@ -562,7 +692,9 @@ static void engine_remove_observer_by_id(uint16_t obj_id, int32_t obj_inst_id)
 	/* remove observer instances accordingly */
 	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(
 			&engine_observer_list, obs, tmp, node) {
-		if (!(obj_id == obs->path.obj_id &&
+		/* composite observers skip paths which no longer exist */
+		if (observe_node_is_composite(obs) ||
+		    !(obj_id == obs->path.obj_id &&
 		      obj_inst_id == obs->path.obj_inst_id)) {
 			prev_node = &obs->node;
 			continue;
@@ -575,22 +707,41 @@ static void engine_remove_observer_by_id(uint16_t obj_id, int32_t obj_inst_id)
 
 /* engine object */
 
+static inline sys_slist_t *engine_obj_bucket(int obj_id)
+{
+	return &engine_obj_hash[(uint16_t)obj_id %
+				CONFIG_LWM2M_ENGINE_HASH_SIZE];
+}
+
+static inline sys_slist_t *engine_obj_inst_bucket(int obj_id, int obj_inst_id)
+{
+	return &engine_obj_inst_hash[((uint16_t)obj_id * 31U +
+				      (uint16_t)obj_inst_id) %
+				     CONFIG_LWM2M_ENGINE_HASH_SIZE];
+}
+
 void lwm2m_register_obj(struct lwm2m_engine_obj *obj)
 {
 	sys_slist_append(&engine_obj_list, &obj->node);
+	sys_slist_append(engine_obj_bucket(obj->obj_id), &obj->hash_node);
+	engine_obj_gen++;
 }
 
 void lwm2m_unregister_obj(struct lwm2m_engine_obj *obj)
 {
 	engine_remove_observer_by_id(obj->obj_id, -1);
 	sys_slist_find_and_remove(&engine_obj_list, &obj->node);
+	sys_slist_find_and_remove(engine_obj_bucket(obj->obj_id),
+				  &obj->hash_node);
+	engine_obj_gen++;
 }
 
 static struct lwm2m_engine_obj *get_engine_obj(int obj_id)
 {
 	struct lwm2m_engine_obj *obj;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_list, obj, node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(engine_obj_bucket(obj_id), obj,
+				     hash_node) {
 		if (obj->obj_id == obj_id) {
 			return obj;
 		}
@@ -605,6 +756,12 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 	int i;
 
 	if (obj && obj->fields && obj->field_count > 0) {
+		/* fields are usually defined in resource id order */
+		if (res_id >= 0 && res_id < obj->field_count &&
+		    obj->fields[res_id].res_id == res_id) {
+			return &obj->fields[res_id];
+		}
+
 		for (i = 0; i < obj->field_count; i++) {
 			if (obj->fields[i].res_id == res_id) {
 				return &obj->fields[i];
@@ -617,9 +774,35 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 
 /* engine object instance */
 
+static bool obj_inst_after(struct lwm2m_engine_obj_inst *a,
+			   struct lwm2m_engine_obj_inst *b)
+{
+	if (a->obj->obj_id != b->obj->obj_id) {
+		return a->obj->obj_id > b->obj->obj_id;
+	}
+
+	return a->obj_inst_id > b->obj_inst_id;
+}
+
 static void engine_register_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 {
-	sys_slist_append(&engine_obj_inst_list, &obj_inst->node);
+	struct lwm2m_engine_obj_inst *iter, *prev = NULL;
+
+	/* keep the list sorted by object and instance id */
+	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, iter, node) {
+		if (obj_inst_after(iter, obj_inst)) {
+			break;
+		}
+
+		prev = iter;
+	}
+
+	sys_slist_insert(&engine_obj_inst_list, prev ? &prev->node : NULL,
+			 &obj_inst->node);
+	sys_slist_append(engine_obj_inst_bucket(obj_inst->obj->obj_id,
+						obj_inst->obj_inst_id),
+			 &obj_inst->hash_node);
+	engine_obj_gen++;
 }
 
 static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
@@ -627,6 +810,11 @@ static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 	engine_remove_observer_by_id(
 			obj_inst->obj->obj_id, obj_inst->obj_inst_id);
 	sys_slist_find_and_remove(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_find_and_remove(
+			engine_obj_inst_bucket(obj_inst->obj->obj_id,
+					       obj_inst->obj_inst_id),
+			&obj_inst->hash_node);
+	engine_obj_gen++;
 }
 
 static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
@@ -634,8 +822,9 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 {
 	struct lwm2m_engine_obj_inst *obj_inst;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
-				     node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(engine_obj_inst_bucket(obj_id,
+							    obj_inst_id),
+				     obj_inst, hash_node) {
 		if (obj_inst->obj->obj_id == obj_id &&
 		    obj_inst->obj_inst_id == obj_inst_id) {
 			return obj_inst;
@@ -648,18 +837,32 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 static struct lwm2m_engine_obj_inst *
 next_engine_obj_inst(int obj_id, int obj_inst_id)
 {
-	struct lwm2m_engine_obj_inst *obj_inst, *next = NULL;
+	struct lwm2m_engine_obj_inst *obj_inst;
+	sys_snode_t *node;
+
+	/* the list is sorted, the next instance follows the current one */
+	obj_inst = get_engine_obj_inst(obj_id, obj_inst_id);
+	if (obj_inst) {
+		node = sys_slist_peek_next(&obj_inst->node);
+		if (!node) {
+			return NULL;
+		}
+
+		obj_inst = CONTAINER_OF(node, struct lwm2m_engine_obj_inst,
+					node);
+
+		return obj_inst->obj->obj_id == obj_id ? obj_inst : NULL;
+	}
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
 				     node) {
 		if (obj_inst->obj->obj_id == obj_id &&
-		    obj_inst->obj_inst_id > obj_inst_id &&
-		    (!next || next->obj_inst_id > obj_inst->obj_inst_id)) {
-			next = obj_inst;
+		    obj_inst->obj_inst_id > obj_inst_id) {
+			return obj_inst;
 		}
 	}
 
-	return next;
+	return NULL;
 }
 
 int lwm2m_create_obj_inst(uint16_t obj_id, uint16_t obj_inst_id,
@@ -1156,6 +1359,12 @@ static int select_writer(struct lwm2m_output_context *out, uint16_t accept)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		out->writer = &senml_cbor_writer;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", accept);
 		return -ENOMSG;
@@ -1187,6 +1396,12 @@ static int select_reader(struct lwm2m_input_context *in, uint16_t format)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		in->reader = &senml_cbor_reader;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", format);
 		return -ENOMSG;
@@ -1296,10 +1511,18 @@ static int path_to_objs(const struct lwm2m_obj_path *path,
 		return -ENOENT;
 	}
 
-	for (i = 0; i < oi->resource_count; i++) {
-		if (oi->resources[i].res_id == path->res_id) {
-			r = &oi->resources[i];
-			break;
+	/* resources and their instances are usually initialized in id
+	 * order, try the direct index before scanning
+	 */
+	if (path->res_id < oi->resource_count &&
+	    oi->resources[path->res_id].res_id == path->res_id) {
+		r = &oi->resources[path->res_id];
+	} else {
+		for (i = 0; i < oi->resource_count; i++) {
+			if (oi->resources[i].res_id == path->res_id) {
+				r = &oi->resources[i];
+				break;
+			}
 		}
 	}
 
@@ -1308,10 +1531,17 @@ static int path_to_objs(const struct lwm2m_obj_path *path,
 		return -ENOENT;
 	}
 
-	for (i = 0; i < r->res_inst_count; i++) {
-		if (r->res_instances[i].res_inst_id == path->res_inst_id) {
-			ri = &r->res_instances[i];
-			break;
+	if (path->res_inst_id < r->res_inst_count &&
+	    r->res_instances[path->res_inst_id].res_inst_id ==
+	    path->res_inst_id) {
+		ri = &r->res_instances[path->res_inst_id];
+	} else {
+		for (i = 0; i < r->res_inst_count; i++) {
+			if (r->res_instances[i].res_inst_id ==
+			    path->res_inst_id) {
+				ri = &r->res_instances[i];
+				break;
+			}
 		}
 	}
 
@@ -3077,6 +3307,11 @@ static int do_read_op(struct lwm2m_message *msg, uint16_t content_format)
 		return do_read_op_json(msg, content_format);
 #endif
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_read_op_senml_cbor(msg, content_format);
+#endif
+
 	default:
 		LOG_ERR("Unsupported content-format: %u", content_format);
 		return -ENOMSG;
@@ -3084,26 +3319,24 @@ static int do_read_op(struct lwm2m_message *msg, uint16_t content_format)
 	}
 }
 
-int lwm2m_perform_read_op(struct lwm2m_message *msg, uint16_t content_format)
+static struct lwm2m_engine_obj_inst *
+read_op_first_obj_inst(struct lwm2m_obj_path *path)
 {
-	struct lwm2m_engine_obj_inst *obj_inst = NULL;
-	struct lwm2m_engine_res *res = NULL;
-	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_obj_path temp_path;
-	int ret = 0, index;
-	uint8_t num_read = 0U;
+	if (path->level >= 2U) {
+		return get_engine_obj_inst(path->obj_id, path->obj_inst_id);
+	}
 
-	if (msg->path.level >= 2U) {
-		obj_inst = get_engine_obj_inst(msg->path.obj_id,
-					       msg->path.obj_inst_id);
-	} else if (msg->path.level == 1U) {
+	if (path->level == 1U) {
 		/* find first obj_inst with path's obj_id */
-		obj_inst = next_engine_obj_inst(msg->path.obj_id, -1);
+		return next_engine_obj_inst(path->obj_id, -1);
 	}
 
-	if (!obj_inst) {
-		return -ENOENT;
-	}
+	return NULL;
+}
+
+static int read_op_begin(struct lwm2m_message *msg, uint16_t content_format)
+{
+	int ret;
 
 	/* set output content-format */
 	ret = coap_append_option_int(msg->out.out_cpkt,
@@ -3120,9 +3353,20 @@ int lwm2m_perform_read_op(struct lwm2m_message *msg, uint16_t content_format)
 		return ret;
 	}
 
-	/* store original path values so we can change them during processing */
-	memcpy(&temp_path, &msg->path, sizeof(temp_path));
-	engine_put_begin(&msg->out, &msg->path);
+	return 0;
+}
+
+/* Format the instances / resources selected by msg->path, starting at
+ * obj_inst. msg->path is modified along the way and has to be restored by
+ * the caller.
+ */
+static int read_op_path(struct lwm2m_message *msg,
+			struct lwm2m_engine_obj_inst *obj_inst)
+{
+	struct lwm2m_engine_res *res = NULL;
+	struct lwm2m_engine_obj_field *obj_field;
+	int ret = 0, index;
+	uint8_t num_read = 0U;
 
 	while (obj_inst) {
 		if (!obj_inst->resources || obj_inst->resource_count == 0U) {
@@ -3204,16 +3448,81 @@ move_forward:
 		}
 	}
 
+	/* did not read anything even if we should have - on single item */
+	if (ret == 0 && num_read == 0U && msg->path.level == 3U) {
+		return -ENOENT;
+	}
+
+	return ret;
+}
+
+int lwm2m_perform_read_op(struct lwm2m_message *msg, uint16_t content_format)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_obj_path temp_path;
+	int ret;
+
+	obj_inst = read_op_first_obj_inst(&msg->path);
+	if (!obj_inst) {
+		return -ENOENT;
+	}
+
+	ret = read_op_begin(msg, content_format);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* store original path values so we can change them during processing */
+	memcpy(&temp_path, &msg->path, sizeof(temp_path));
+	engine_put_begin(&msg->out, &msg->path);
+
+	ret = read_op_path(msg, obj_inst);
+
 	engine_put_end(&msg->out, &msg->path);
 
 	/* restore original path values */
 	memcpy(&msg->path, &temp_path, sizeof(temp_path));
 
-	/* did not read anything even if we should have - on single item */
-	if (ret == 0 && num_read == 0U && msg->path.level == 3U) {
-		return -ENOENT;
+	return ret;
+}
+
+int lwm2m_perform_composite_read_op(struct lwm2m_message *msg,
+				    uint16_t content_format,
+				    struct lwm2m_obj_path *paths,
+				    uint8_t num_paths)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_obj_path temp_path;
+	int ret, i;
+
+	ret = read_op_begin(msg, content_format);
+	if (ret < 0) {
+		return ret;
+	}
+
+	memcpy(&temp_path, &msg->path, sizeof(temp_path));
+	engine_put_begin(&msg->out, &msg->path);
+
+	for (i = 0; i < num_paths; i++) {
+		memcpy(&msg->path, &paths[i], sizeof(msg->path));
+
+		/* paths which do not exist are left out of the response */
+		obj_inst = read_op_first_obj_inst(&msg->path);
+		if (!obj_inst) {
+			continue;
+		}
+
+		ret = read_op_path(msg, obj_inst);
+		if (ret < 0 && ret != -ENOENT) {
+			break;
+		}
+
+		ret = 0;
 	}
 
+	engine_put_end(&msg->out, &msg->path);
+	memcpy(&msg->path, &temp_path, sizeof(temp_path));
+
 	return ret;
 }
 
@@ -3454,6 +3763,11 @@ static int do_write_op(struct lwm2m_message *msg,
 		return do_write_op_json(msg);
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_write_op_senml_cbor(msg);
+#endif
+
 	default:
 		LOG_ERR("Unsupported format: %u", format);
 		return -ENOMSG;
@@ -3537,6 +3851,61 @@ static int bootstrap_delete(struct lwm2m_message *msg)
 }
 #endif
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+static int do_read_composite_op(struct lwm2m_message *msg, uint16_t format,
+				uint16_t accept, int observe,
+				const uint8_t *token, uint8_t tkl)
+{
+	struct lwm2m_obj_path paths[CONFIG_LWM2M_COMPOSITE_PATH_LIST_SIZE];
+	int num_paths, r;
+
+	/* the path list and the response are both SenML CBOR */
+	if (format != LWM2M_FORMAT_APP_SENML_CBOR ||
+	    accept != LWM2M_FORMAT_APP_SENML_CBOR) {
+		LOG_ERR("Unsupported composite content-format: %u/%u",
+			format, accept);
+		return -ENOMSG;
+	}
+
+	num_paths = senml_cbor_parse_path_list(msg, paths, ARRAY_SIZE(paths));
+	if (num_paths < 0) {
+		LOG_ERR("Unable to parse composite path list: %d", num_paths);
+		return num_paths == -ENOMEM ? -EFBIG : -EINVAL;
+	}
+
+	if (observe == 0) {
+		/* add new composite observer */
+		if (!msg->token) {
+			LOG_ERR("OBSERVE request missing token");
+			return -EINVAL;
+		}
+
+		r = coap_append_option_int(msg->out.out_cpkt,
+					   COAP_OPTION_OBSERVE,
+					   OBSERVE_COUNTER_START);
+		if (r < 0) {
+			LOG_ERR("OBSERVE option error: %d", r);
+			return r;
+		}
+
+		r = engine_add_composite_observer(msg, token, tkl, accept,
+						  paths, num_paths);
+		if (r < 0) {
+			LOG_ERR("add OBSERVE error: %d", r);
+			return r;
+		}
+	} else if (observe == 1) {
+		/* remove observer */
+		r = engine_remove_observer(token, tkl);
+		if (r < 0) {
+			LOG_ERR("remove observe error: %d", r);
+		}
+	}
+
+	return do_composite_read_op_senml_cbor(msg, accept, paths, num_paths);
+}
+#endif /* CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT */
+
 static int handle_request(struct coap_packet *request,
 			  struct lwm2m_message *msg)
 {
@@ -3591,6 +3960,11 @@ static int handle_request(struct coap_packet *request,
 		 * bootstrap.
 		 */
 		switch (code & COAP_REQUEST_MASK) {
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+		/* Read-Composite / Observe-Composite target the root path */
+		case COAP_METHOD_FETCH:
+			break;
+#endif
 #if defined(CONFIG_LWM2M_RD_CLIENT_SUPPORT_BOOTSTRAP)
 		case COAP_METHOD_DELETE:
 		case COAP_METHOD_GET:
@@ -3646,6 +4020,9 @@ static int handle_request(struct coap_packet *request,
 	r = coap_find_options(msg->in.in_cpkt, COAP_OPTION_ACCEPT, options, 1);
 	if (r > 0) {
 		accept = coap_option_value_to_int(&options[0]);
+	} else if ((code & COAP_REQUEST_MASK) == COAP_METHOD_FETCH) {
+		/* composite responses default to the request format */
+		accept = format;
 	} else {
 		LOG_DBG("No accept option given. Assume OMA TLV.");
 		accept = LWM2M_FORMAT_OMA_TLV;
@@ -3656,7 +4033,8 @@ static int handle_request(struct coap_packet *request,
 		goto error;
 	}
 
-	if (!(msg->ctx->bootstrap_mode && msg->path.level == 0)) {
+	if (!(msg->ctx->bootstrap_mode && msg->path.level == 0) &&
+	    (code & COAP_REQUEST_MASK) != COAP_METHOD_FETCH) {
 		/* find registered obj */
 		obj = get_engine_obj(msg->path.obj_id);
 		if (!obj) {
@@ -3719,6 +4097,17 @@ static int handle_request(struct coap_packet *request,
 		msg->code = COAP_RESPONSE_CODE_DELETED;
 		break;
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	case COAP_METHOD_FETCH:
+		msg->operation = LWM2M_OP_READ_COMPOSITE;
+
+		/* check for observe */
+		observe = coap_get_option_int(msg->in.in_cpkt,
+					      COAP_OPTION_OBSERVE);
+		msg->code = COAP_RESPONSE_CODE_CONTENT;
+		break;
+#endif
+
 	default:
 		break;
 	}
@@ -3841,6 +4230,13 @@ static int handle_request(struct coap_packet *request,
 			r = do_discover_op(msg, accept);
 			break;
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+		case LWM2M_OP_READ_COMPOSITE:
+			r = do_read_composite_op(msg, format, accept, observe,
+						 token, tkl);
+			break;
+#endif
+
 		case LWM2M_OP_WRITE:
 		case LWM2M_OP_CREATE:
 			r = do_write_op(msg, format);
@@ -4213,6 +4609,21 @@ static int notify_message_reply_cb(const struct coap_packet *response,
 	return 0;
 }
 
+static struct lwm2m_engine_obj_inst *
+observe_node_obj_inst(struct observe_node *obs)
+{
+	/* notifications are frequent, resolve the path only when objects
+	 * or instances changed since the last one
+	 */
+	if (!obs->obj_inst || obs->obj_gen != engine_obj_gen) {
+		obs->obj_inst = get_engine_obj_inst(obs->path.obj_id,
+						    obs->path.obj_inst_id);
+		obs->obj_gen = engine_obj_gen;
+	}
+
+	return obs->obj_inst;
+}
+
 static int generate_notify_message(struct observe_node *obs,
 				   bool manual_trigger)
 {
@@ -4245,14 +4656,16 @@ static int generate_notify_message(struct observe_node *obs,
 		log_strdup(lwm2m_sprint_ip_addr(&obs->ctx->remote_addr)),
 		k_uptime_get());
 
-	obj_inst = get_engine_obj_inst(obs->path.obj_id,
-				       obs->path.obj_inst_id);
-	if (!obj_inst) {
-		LOG_ERR("unable to get engine obj for %u/%u",
-			obs->path.obj_id,
-			obs->path.obj_inst_id);
-		ret = -EINVAL;
-		goto cleanup;
+	/* composite observers may list paths which do not exist (yet) */
+	if (!observe_node_is_composite(obs)) {
+		obj_inst = observe_node_obj_inst(obs);
+		if (!obj_inst) {
+			LOG_ERR("unable to get engine obj for %u/%u",
+				obs->path.obj_id,
+				obs->path.obj_inst_id);
+			ret = -EINVAL;
+			goto cleanup;
+		}
 	}
 
 	msg->type = COAP_TYPE_CON;
@@ -4281,7 +4694,18 @@ static int generate_notify_message(struct observe_node *obs,
 	/* set the output writer */
 	select_writer(&msg->out, obs->format);
 
-	ret = do_read_op(msg, obs->format);
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	if (observe_node_is_composite(obs)) {
+		msg->operation = LWM2M_OP_READ_COMPOSITE;
+		ret = do_composite_read_op_senml_cbor(msg, obs->format,
+						      obs->composite,
+						      obs->composite_count);
+	} else
+#endif
+	{
+		ret = do_read_op(msg, obs->format);
+	}
+
 	if (ret < 0) {
 		LOG_ERR("error in multi-format read (err:%d)", ret);
 		goto cleanup;
@@ -73,6 +73,7 @@
 /* values >7 aren't used for permission checks */
 #define LWM2M_OP_DISCOVER	8
 #define LWM2M_OP_WRITE_ATTR	9
+#define LWM2M_OP_READ_COMPOSITE	10
 
 /* resource permissions */
 #define LWM2M_PERM_R		BIT(LWM2M_OP_READ)
@@ -184,6 +185,9 @@ struct lwm2m_engine_obj {
 	/* object list */
 	sys_snode_t node;
 
+	/* object hash table bucket */
+	sys_snode_t hash_node;
+
 	/* object field definitions */
 	struct lwm2m_engine_obj_field *fields;
 
@@ -371,9 +375,12 @@ struct lwm2m_engine_res {
 };
 
 struct lwm2m_engine_obj_inst {
-	/* instance list */
+	/* instance list, sorted by object and instance id */
 	sys_snode_t node;
 
+	/* instance hash table bucket */
+	sys_snode_t hash_node;
+
 	struct lwm2m_engine_obj *obj;
 	struct lwm2m_engine_res *resources;
 
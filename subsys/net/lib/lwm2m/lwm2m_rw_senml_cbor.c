@@ -0,0 +1,996 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * SenML CBOR (RFC 8428) reader / writer, as used by LwM2M 1.1.
+ *
+ * Each resource (instance) is one record of an array of maps. The base name
+ * carries the object instance path and is only repeated when it changes, so
+ * the records of an instance only carry the resource id as their name.
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_senml_cbor
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include <tinycbor/cbor.h>
+#include <tinycbor/cbor_buf_reader.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_senml_cbor.h"
+#include "lwm2m_engine.h"
+
+/* SenML labels, RFC 8428 section 6 */
+#define SENML_LABEL_BN		-2
+#define SENML_LABEL_N		0
+#define SENML_LABEL_V		2
+#define SENML_LABEL_VS		3
+#define SENML_LABEL_VB		4
+#define SENML_LABEL_VD		8
+
+/* Object link values use a text label, LwM2M 1.1 section 7.4.7 */
+#define SENML_LABEL_VLO_STR	"vlo"
+#define SENML_LABEL_VLO		0x100
+
+#define SENML_LABEL_UNKNOWN	0x101
+
+/* "65535:65535" + NULL */
+#define OBJLNK_LEN		12
+
+struct cbor_cpkt_writer {
+	struct cbor_encoder_writer enc;
+	struct coap_packet *cpkt;
+};
+
+struct senml_out_formatter_data {
+	struct cbor_cpkt_writer writer;
+	CborEncoder encoder;
+	CborEncoder array;
+
+	/* first encoding error, the output is incomplete if set */
+	CborError err;
+
+	/* object instance of the last base name written */
+	uint16_t base_obj_id;
+	uint16_t base_obj_inst_id;
+	bool base_written;
+
+	/* flags */
+	uint8_t writer_flags;
+};
+
+struct senml_in_formatter_data {
+	struct cbor_buf_reader reader;
+	CborParser parser;
+	CborValue records;
+
+	/* value of the current record */
+	CborValue value;
+	int value_label;
+
+	char base_name[MAX_RESOURCE_LEN];
+	char name[MAX_RESOURCE_LEN];
+};
+
+static int cbor_cpkt_write(struct cbor_encoder_writer *writer,
+			   const char *data, int len)
+{
+	struct cbor_cpkt_writer *ccw;
+
+	ccw = CONTAINER_OF(writer, struct cbor_cpkt_writer, enc);
+	if (buf_append(CPKT_BUF_WRITE(ccw->cpkt), (uint8_t *)data, len) < 0) {
+		return CborErrorOutOfMemory;
+	}
+
+	writer->bytes_written += len;
+
+	return CborNoError;
+}
+
+static inline void check_err(struct senml_out_formatter_data *fd,
+			     CborError err)
+{
+	if (fd->err == CborNoError) {
+		fd->err = err;
+	}
+}
+
+static size_t put_begin(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer.enc.write = cbor_cpkt_write;
+	fd->writer.enc.bytes_written = 0;
+	fd->writer.cpkt = out->out_cpkt;
+	cbor_encoder_init(&fd->encoder, &fd->writer.enc, 0);
+
+	/* the number of records is not known in advance */
+	check_err(fd, cbor_encoder_create_array(&fd->encoder, &fd->array,
+						CborIndefiniteLength));
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_end(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	check_err(fd, cbor_encoder_close_container(&fd->encoder, &fd->array));
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_begin_ri(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags |= WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_end_ri(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+/* Open the record map and write its names, the value label comes next */
+static struct senml_out_formatter_data *
+record_begin(struct lwm2m_output_context *out, struct lwm2m_obj_path *path,
+	     CborEncoder *map)
+{
+	struct senml_out_formatter_data *fd;
+	char name[MAX_RESOURCE_LEN];
+	bool base;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd || fd->err != CborNoError) {
+		return NULL;
+	}
+
+	base = !fd->base_written || fd->base_obj_id != path->obj_id ||
+	       fd->base_obj_inst_id != path->obj_inst_id;
+
+	check_err(fd, cbor_encoder_create_map(&fd->array, map,
+					      base ? 3 : 2));
+
+	if (base) {
+		snprintk(name, sizeof(name), "/%u/%u/", path->obj_id,
+			 path->obj_inst_id);
+		check_err(fd, cbor_encode_int(map, SENML_LABEL_BN));
+		check_err(fd, cbor_encode_text_stringz(map, name));
+
+		fd->base_obj_id = path->obj_id;
+		fd->base_obj_inst_id = path->obj_inst_id;
+		fd->base_written = true;
+	}
+
+	if (fd->writer_flags & WRITER_RESOURCE_INSTANCE) {
+		snprintk(name, sizeof(name), "%u/%u", path->res_id,
+			 path->res_inst_id);
+	} else {
+		snprintk(name, sizeof(name), "%u", path->res_id);
+	}
+
+	check_err(fd, cbor_encode_int(map, SENML_LABEL_N));
+	check_err(fd, cbor_encode_text_stringz(map, name));
+
+	return fd;
+}
+
+static size_t record_end(struct lwm2m_output_context *out,
+			 struct senml_out_formatter_data *fd,
+			 CborEncoder *map, uint16_t start)
+{
+	check_err(fd, cbor_encoder_close_container(&fd->array, map));
+	if (fd->err != CborNoError) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int64_t value)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	CborEncoder map;
+
+	fd = record_begin(out, path, &map);
+	if (!fd) {
+		return 0;
+	}
+
+	check_err(fd, cbor_encode_int(&map, SENML_LABEL_V));
+	check_err(fd, cbor_encode_int(&map, value));
+
+	return record_end(out, fd, &map, start);
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int32_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int16_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, int8_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	CborEncoder map;
+
+	fd = record_begin(out, path, &map);
+	if (!fd) {
+		return 0;
+	}
+
+	check_err(fd, cbor_encode_int(&map, SENML_LABEL_VS));
+	check_err(fd, cbor_encode_text_string(&map, buf, buflen));
+
+	return record_end(out, fd, &map, start);
+}
+
+/*
+ * Integers are shorter than floats, only use a float if there's a fraction,
+ * and a single precision one if that doesn't lose any digits.
+ */
+static size_t put_fixed(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path,
+			int64_t val1, int64_t val2, int64_t scale)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	CborEncoder map;
+	double d;
+
+	fd = record_begin(out, path, &map);
+	if (!fd) {
+		return 0;
+	}
+
+	check_err(fd, cbor_encode_int(&map, SENML_LABEL_V));
+
+	d = (double)val1 + (double)val2 / scale;
+
+	if (val2 == 0) {
+		check_err(fd, cbor_encode_int(&map, val1));
+	} else if ((double)(float)d == d) {
+		check_err(fd, cbor_encode_float(&map, (float)d));
+	} else {
+		check_err(fd, cbor_encode_double(&map, d));
+	}
+
+	return record_end(out, fd, &map, start);
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	return put_fixed(out, path, value->val1, value->val2,
+			 LWM2M_FLOAT32_DEC_MAX);
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	return put_fixed(out, path, value->val1, value->val2,
+			 LWM2M_FLOAT64_DEC_MAX);
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path,
+		       bool value)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	CborEncoder map;
+
+	fd = record_begin(out, path, &map);
+	if (!fd) {
+		return 0;
+	}
+
+	check_err(fd, cbor_encode_int(&map, SENML_LABEL_VB));
+	check_err(fd, cbor_encode_boolean(&map, value));
+
+	return record_end(out, fd, &map, start);
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	CborEncoder map;
+
+	fd = record_begin(out, path, &map);
+	if (!fd) {
+		return 0;
+	}
+
+	check_err(fd, cbor_encode_int(&map, SENML_LABEL_VD));
+	check_err(fd, cbor_encode_byte_string(&map, (uint8_t *)buf, buflen));
+
+	return record_end(out, fd, &map, start);
+}
+
+static size_t put_objlnk(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 struct lwm2m_objlnk *value)
+{
+	struct senml_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	char objlnk[OBJLNK_LEN];
+	CborEncoder map;
+
+	fd = record_begin(out, path, &map);
+	if (!fd) {
+		return 0;
+	}
+
+	snprintk(objlnk, sizeof(objlnk), "%u:%u", value->obj_id,
+		 value->obj_inst);
+
+	check_err(fd, cbor_encode_text_stringz(&map, SENML_LABEL_VLO_STR));
+	check_err(fd, cbor_encode_text_stringz(&map, objlnk));
+
+	return record_end(out, fd, &map, start);
+}
+
+static CborValue *get_value(struct lwm2m_input_context *in, int label)
+{
+	struct senml_in_formatter_data *fd;
+
+	fd = engine_get_in_user_data(in);
+	if (!fd || fd->value_label != label) {
+		return NULL;
+	}
+
+	return &fd->value;
+}
+
+/* Numbers may be sent as integers or floats, whatever the resource type */
+static size_t get_fixed(struct lwm2m_input_context *in,
+			int64_t *val1, int64_t *val2, int64_t scale)
+{
+	CborValue *value;
+	double d, frac;
+	float f;
+
+	value = get_value(in, SENML_LABEL_V);
+	if (!value) {
+		return 0;
+	}
+
+	*val2 = 0;
+
+	if (cbor_value_is_integer(value)) {
+		if (cbor_value_get_int64(value, val1) != CborNoError) {
+			return 0;
+		}
+
+		return sizeof(*val1);
+	}
+
+	if (cbor_value_is_double(value)) {
+		if (cbor_value_get_double(value, &d) != CborNoError) {
+			return 0;
+		}
+	} else if (cbor_value_is_float(value)) {
+		if (cbor_value_get_float(value, &f) != CborNoError) {
+			return 0;
+		}
+
+		d = f;
+	} else {
+		return 0;
+	}
+
+	*val1 = (int64_t)d;
+	frac = (d - *val1) * scale;
+	*val2 = (int64_t)(frac < 0 ? frac - 0.5 : frac + 0.5);
+
+	return sizeof(d);
+}
+
+static size_t get_s64(struct lwm2m_input_context *in, int64_t *value)
+{
+	int64_t frac;
+
+	return get_fixed(in, value, &frac, 1);
+}
+
+static size_t get_s32(struct lwm2m_input_context *in, int32_t *value)
+{
+	int64_t tmp, frac;
+	size_t len;
+
+	len = get_fixed(in, &tmp, &frac, 1);
+	if (len > 0) {
+		*value = (int32_t)tmp;
+	}
+
+	return len;
+}
+
+static size_t get_float32fix(struct lwm2m_input_context *in,
+			     float32_value_t *value)
+{
+	int64_t tmp1, tmp2;
+	size_t len;
+
+	len = get_fixed(in, &tmp1, &tmp2, LWM2M_FLOAT32_DEC_MAX);
+	if (len > 0) {
+		value->val1 = (int32_t)tmp1;
+		value->val2 = (int32_t)tmp2;
+	}
+
+	return len;
+}
+
+static size_t get_float64fix(struct lwm2m_input_context *in,
+			     float64_value_t *value)
+{
+	int64_t tmp1, tmp2;
+	size_t len;
+
+	len = get_fixed(in, &tmp1, &tmp2, LWM2M_FLOAT64_DEC_MAX);
+	if (len > 0) {
+		value->val1 = tmp1;
+		value->val2 = tmp2;
+	}
+
+	return len;
+}
+
+static size_t get_string(struct lwm2m_input_context *in,
+			 uint8_t *buf, size_t buflen)
+{
+	CborValue *value;
+	size_t len;
+
+	value = get_value(in, SENML_LABEL_VS);
+	if (!value || !cbor_value_is_text_string(value) || buflen == 0) {
+		return 0;
+	}
+
+	/* keep room for the terminating NULL */
+	len = buflen - 1;
+	if (cbor_value_copy_text_string(value, (char *)buf, &len,
+					NULL) != CborNoError) {
+		LOG_WRN("String too long");
+		return 0;
+	}
+
+	buf[len] = '\0';
+
+	return len;
+}
+
+static size_t get_bool(struct lwm2m_input_context *in, bool *value)
+{
+	CborValue *val;
+
+	val = get_value(in, SENML_LABEL_VB);
+	if (!val || !cbor_value_is_boolean(val) ||
+	    cbor_value_get_boolean(val, value) != CborNoError) {
+		return 0;
+	}
+
+	return sizeof(*value);
+}
+
+static size_t get_opaque(struct lwm2m_input_context *in,
+			 uint8_t *buf, size_t buflen,
+			 struct lwm2m_opaque_context *opaque,
+			 bool *last_block)
+{
+	CborValue *value;
+	size_t len = buflen;
+
+	/* the whole value is in the record, no block transfer */
+	*last_block = true;
+	opaque->remaining = 0U;
+
+	value = get_value(in, SENML_LABEL_VD);
+	if (!value || !cbor_value_is_byte_string(value) ||
+	    cbor_value_copy_byte_string(value, buf, &len,
+					NULL) != CborNoError) {
+		return 0;
+	}
+
+	opaque->len = len;
+
+	return len;
+}
+
+static size_t get_objlnk(struct lwm2m_input_context *in,
+			 struct lwm2m_objlnk *value)
+{
+	char objlnk[OBJLNK_LEN];
+	CborValue *val;
+	size_t len = sizeof(objlnk) - 1;
+	char *end;
+
+	val = get_value(in, SENML_LABEL_VLO);
+	if (!val || !cbor_value_is_text_string(val) ||
+	    cbor_value_copy_text_string(val, objlnk, &len,
+					NULL) != CborNoError) {
+		return 0;
+	}
+
+	objlnk[len] = '\0';
+
+	value->obj_id = (uint16_t)strtoul(objlnk, &end, 10);
+	if (*end != ':') {
+		return 0;
+	}
+
+	value->obj_inst = (uint16_t)strtoul(end + 1, &end, 10);
+	if (*end != '\0') {
+		return 0;
+	}
+
+	return len;
+}
+
+const struct lwm2m_writer senml_cbor_writer = {
+	.put_begin = put_begin,
+	.put_end = put_end,
+	.put_begin_ri = put_begin_ri,
+	.put_end_ri = put_end_ri,
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+	.put_objlnk = put_objlnk,
+};
+
+const struct lwm2m_reader senml_cbor_reader = {
+	.get_s32 = get_s32,
+	.get_s64 = get_s64,
+	.get_string = get_string,
+	.get_float32fix = get_float32fix,
+	.get_float64fix = get_float64fix,
+	.get_bool = get_bool,
+	.get_opaque = get_opaque,
+	.get_objlnk = get_objlnk,
+};
+
+int do_read_op_senml_cbor(struct lwm2m_message *msg, int content_format)
+{
+	struct senml_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	ret = lwm2m_perform_read_op(msg, content_format);
+	engine_clear_out_user_data(&msg->out);
+
+	if (ret == 0 && fd.err != CborNoError) {
+		LOG_ERR("SenML CBOR encoding error: %d", fd.err);
+		return -ENOMEM;
+	}
+
+	return ret;
+}
+
+int do_composite_read_op_senml_cbor(struct lwm2m_message *msg,
+				    int content_format,
+				    struct lwm2m_obj_path *paths,
+				    uint8_t num_paths)
+{
+	struct senml_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	ret = lwm2m_perform_composite_read_op(msg, content_format, paths,
+					      num_paths);
+	engine_clear_out_user_data(&msg->out);
+
+	if (ret == 0 && fd.err != CborNoError) {
+		LOG_ERR("SenML CBOR encoding error: %d", fd.err);
+		return -ENOMEM;
+	}
+
+	return ret;
+}
+
+static int parser_init(struct lwm2m_input_context *in,
+		       struct senml_in_formatter_data *fd)
+{
+	const uint8_t *payload;
+	uint16_t payload_len;
+	CborValue root;
+
+	payload = coap_packet_get_payload(in->in_cpkt, &payload_len);
+	if (!payload || payload_len == 0U) {
+		return -EINVAL;
+	}
+
+	cbor_buf_reader_init(&fd->reader, payload, payload_len);
+
+	if (cbor_parser_init(&fd->reader.r, 0, &fd->parser,
+			     &root) != CborNoError ||
+	    !cbor_value_is_array(&root) ||
+	    cbor_value_enter_container(&root, &fd->records) != CborNoError) {
+		LOG_ERR("Invalid SenML CBOR payload");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int read_label(CborValue *it)
+{
+	char label[sizeof(SENML_LABEL_VLO_STR)];
+	size_t len = sizeof(label) - 1;
+	int value;
+
+	if (cbor_value_is_integer(it)) {
+		if (cbor_value_get_int(it, &value) != CborNoError) {
+			return SENML_LABEL_UNKNOWN;
+		}
+
+		return value;
+	}
+
+	if (cbor_value_is_text_string(it) &&
+	    cbor_value_copy_text_string(it, label, &len,
+					NULL) == CborNoError) {
+		label[len] = '\0';
+		if (strcmp(label, SENML_LABEL_VLO_STR) == 0) {
+			return SENML_LABEL_VLO;
+		}
+	}
+
+	return SENML_LABEL_UNKNOWN;
+}
+
+static int read_name(CborValue *it, char *buf, size_t buflen)
+{
+	size_t len = buflen - 1;
+
+	if (!cbor_value_is_text_string(it) ||
+	    cbor_value_copy_text_string(it, buf, &len, NULL) != CborNoError) {
+		return -EINVAL;
+	}
+
+	buf[len] = '\0';
+
+	return 0;
+}
+
+/* Parse "/obj/inst/res/ri", a trailing slash is allowed */
+static int parse_path(const char *buf, struct lwm2m_obj_path *path)
+{
+	uint16_t ids[4];
+	uint32_t val;
+	int level = 0;
+
+	(void)memset(path, 0, sizeof(*path));
+
+	if (*buf == '/') {
+		buf++;
+	}
+
+	while (*buf != '\0') {
+		if (level == ARRAY_SIZE(ids) || !isdigit((unsigned char)*buf)) {
+			return -EINVAL;
+		}
+
+		val = 0U;
+		while (isdigit((unsigned char)*buf)) {
+			val = val * 10U + (*buf++ - '0');
+			if (val > UINT16_MAX) {
+				return -EINVAL;
+			}
+		}
+
+		ids[level++] = val;
+
+		if (*buf == '/') {
+			buf++;
+		} else if (*buf != '\0') {
+			return -EINVAL;
+		}
+	}
+
+	path->obj_id = level > 0 ? ids[0] : 0U;
+	path->obj_inst_id = level > 1 ? ids[1] : 0U;
+	path->res_id = level > 2 ? ids[2] : 0U;
+	path->res_inst_id = level > 3 ? ids[3] : 0U;
+	path->level = level;
+
+	return 0;
+}
+
+/*
+ * Decode the next record and its path: the base name and the name are
+ * concatenated, the base name applying to the following records as well.
+ * Returns -ENOENT after the last record.
+ */
+static int next_record(struct senml_in_formatter_data *fd,
+		       struct lwm2m_obj_path *path)
+{
+	char full_name[MAX_RESOURCE_LEN];
+	CborValue map;
+	int label, ret = 0;
+
+	if (cbor_value_at_end(&fd->records)) {
+		return -ENOENT;
+	}
+
+	if (!cbor_value_is_map(&fd->records) ||
+	    cbor_value_enter_container(&fd->records, &map) != CborNoError) {
+		return -EINVAL;
+	}
+
+	fd->name[0] = '\0';
+	fd->value_label = SENML_LABEL_UNKNOWN;
+
+	while (!cbor_value_at_end(&map)) {
+		label = read_label(&map);
+
+		if (cbor_value_advance(&map) != CborNoError ||
+		    cbor_value_at_end(&map)) {
+			return -EINVAL;
+		}
+
+		switch (label) {
+		case SENML_LABEL_BN:
+			ret = read_name(&map, fd->base_name,
+					sizeof(fd->base_name));
+			break;
+
+		case SENML_LABEL_N:
+			ret = read_name(&map, fd->name, sizeof(fd->name));
+			break;
+
+		case SENML_LABEL_V:
+		case SENML_LABEL_VS:
+		case SENML_LABEL_VB:
+		case SENML_LABEL_VD:
+		case SENML_LABEL_VLO:
+			fd->value = map;
+			fd->value_label = label;
+			break;
+
+		default:
+			/* ignore times, units, etc. */
+			break;
+		}
+
+		if (ret < 0 || cbor_value_advance(&map) != CborNoError) {
+			return -EINVAL;
+		}
+	}
+
+	if (cbor_value_leave_container(&fd->records, &map) != CborNoError) {
+		return -EINVAL;
+	}
+
+	snprintk(full_name, sizeof(full_name), "%s%s", fd->base_name,
+		 fd->name);
+
+	return parse_path(full_name, path);
+}
+
+int senml_cbor_parse_path_list(struct lwm2m_message *msg,
+			       struct lwm2m_obj_path *paths,
+			       uint8_t max_paths)
+{
+	struct senml_in_formatter_data fd;
+	int ret, count = 0;
+
+	(void)memset(&fd, 0, sizeof(fd));
+
+	ret = parser_init(&msg->in, &fd);
+	if (ret < 0) {
+		return ret;
+	}
+
+	while (true) {
+		if (count == max_paths) {
+			if (cbor_value_at_end(&fd.records)) {
+				break;
+			}
+
+			LOG_ERR("Too many paths, max %u", max_paths);
+			return -ENOMEM;
+		}
+
+		ret = next_record(&fd, &paths[count]);
+		if (ret == -ENOENT) {
+			break;
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+int do_write_op_senml_cbor(struct lwm2m_message *msg)
+{
+	struct lwm2m_engine_obj_field *obj_field = NULL;
+	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_res *res = NULL;
+	struct lwm2m_engine_res_inst *res_inst = NULL;
+	struct lwm2m_obj_path orig_path;
+	struct senml_in_formatter_data fd;
+	int ret, index;
+	uint8_t created;
+
+	(void)memset(&fd, 0, sizeof(fd));
+
+	ret = parser_init(&msg->in, &fd);
+	if (ret < 0) {
+		return ret;
+	}
+
+	engine_set_in_user_data(&msg->in, &fd);
+
+	/* store a copy of the original path */
+	memcpy(&orig_path, &msg->path, sizeof(msg->path));
+
+	while (true) {
+		ret = next_record(&fd, &msg->path);
+		if (ret == -ENOENT) {
+			ret = 0;
+			break;
+		}
+
+		if (ret < 0) {
+			break;
+		}
+
+		if (msg->path.level < 3U ||
+		    fd.value_label == SENML_LABEL_UNKNOWN) {
+			LOG_ERR("Record without resource or value");
+			ret = -EINVAL;
+			break;
+		}
+
+		/* records must be inside the target of the write */
+		if (msg->path.obj_id != orig_path.obj_id ||
+		    (orig_path.level >= 2U &&
+		     msg->path.obj_inst_id != orig_path.obj_inst_id) ||
+		    (orig_path.level >= 3U &&
+		     msg->path.res_id != orig_path.res_id)) {
+			ret = -EINVAL;
+			break;
+		}
+
+		created = 0U;
+		ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, &created);
+		if (ret < 0) {
+			break;
+		}
+
+		obj_field = lwm2m_get_engine_obj_field(obj_inst->obj,
+						       msg->path.res_id);
+		if (!obj_field) {
+			ret = -ENOENT;
+			break;
+		}
+
+		if (!LWM2M_HAS_PERM(obj_field, LWM2M_PERM_W)) {
+			ret = -EPERM;
+			break;
+		}
+
+		if (!obj_inst->resources || obj_inst->resource_count == 0U) {
+			ret = -EINVAL;
+			break;
+		}
+
+		res = NULL;
+		for (index = 0; index < obj_inst->resource_count; index++) {
+			if (obj_inst->resources[index].res_id ==
+			    msg->path.res_id) {
+				res = &obj_inst->resources[index];
+				break;
+			}
+		}
+
+		if (!res) {
+			ret = -ENOENT;
+			break;
+		}
+
+		res_inst = NULL;
+		for (index = 0; index < res->res_inst_count; index++) {
+			if (res->res_instances[index].res_inst_id ==
+			    msg->path.res_inst_id) {
+				res_inst = &res->res_instances[index];
+				break;
+			}
+		}
+
+		if (!res_inst) {
+			ret = -ENOENT;
+			break;
+		}
+
+		ret = lwm2m_write_handler(obj_inst, res, res_inst, obj_field,
+					  msg);
+		if (orig_path.level >= 3U && ret < 0) {
+			/* return errors on a single write */
+			break;
+		}
+
+		ret = 0;
+	}
+
+	engine_clear_in_user_data(&msg->in);
+
+	return ret;
+}
@@ -25,6 +25,8 @@ static void client_reset(struct mqtt_client *client)
 	client->internal.last_activity = 0U;
 	client->internal.rx_buf_datalen = 0U;
 	client->internal.remaining_payload = 0U;
+	client->internal.tx_remaining_payload = 0U;
+	client->internal.rx_buf_pos = 0U;
 }
 
 /** @brief Initialize tx buffer. */
@@ -167,6 +169,199 @@ static int client_write_msg(struct mqtt_client *client,
 	return 0;
 }
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+static struct mqtt_inflight *inflight_find(struct mqtt_client *client,
+					   uint16_t message_id)
+{
+	struct mqtt_inflight *entry;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->expect != 0U &&
+		    entry->param.message_id == message_id) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static int inflight_add(struct mqtt_client *client,
+			const struct mqtt_publish_param *param)
+{
+	struct mqtt_inflight *entry = NULL;
+	int i;
+
+	if (param->message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+		return 0;
+	}
+
+	if (inflight_find(client, param->message_id) != NULL) {
+		return -EBUSY;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		if (client->internal.inflight[i].expect == 0U) {
+			entry = &client->internal.inflight[i];
+			break;
+		}
+	}
+
+	if (entry == NULL) {
+		return -EAGAIN;
+	}
+
+	memcpy(&entry->param, param, sizeof(entry->param));
+	entry->seq = client->internal.inflight_seq++;
+	entry->expect = (param->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) ?
+			MQTT_PKT_TYPE_PUBACK : MQTT_PKT_TYPE_PUBREC;
+
+	return 0;
+}
+
+static void inflight_remove(struct mqtt_client *client, uint16_t message_id)
+{
+	struct mqtt_inflight *entry = inflight_find(client, message_id);
+
+	if (entry != NULL) {
+		entry->expect = 0U;
+	}
+}
+
+static void inflight_clear(struct mqtt_client *client)
+{
+	memset(client->internal.inflight, 0,
+	       sizeof(client->internal.inflight));
+}
+
+void mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		       uint16_t message_id)
+{
+	struct mqtt_inflight *entry = inflight_find(client, message_id);
+
+	if (entry == NULL || entry->expect != type) {
+		MQTT_TRC("[CID %p]: Unexpected ack 0x%02x for message id 0x%04x",
+			 client, type, message_id);
+		return;
+	}
+
+	if (type == MQTT_PKT_TYPE_PUBREC) {
+		entry->expect = MQTT_PKT_TYPE_PUBCOMP;
+	} else {
+		entry->expect = 0U;
+	}
+}
+
+static int inflight_send(struct mqtt_client *client,
+			 struct mqtt_inflight *entry)
+{
+	int err_code;
+	struct buf_ctx packet;
+	struct iovec io_vector[2];
+	struct msghdr msg;
+
+	tx_buf_init(client, &packet);
+
+	/* PUBREC was received already, only the release is pending. */
+	if (entry->expect == MQTT_PKT_TYPE_PUBCOMP) {
+		const struct mqtt_pubrel_param param = {
+			.message_id = entry->param.message_id,
+		};
+
+		err_code = publish_release_encode(&param, &packet);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		return mqtt_transport_write(client, packet.cur,
+					    packet.end - packet.cur);
+	}
+
+	entry->param.dup_flag = 1U;
+
+	err_code = publish_encode(&entry->param, &packet);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	io_vector[0].iov_base = packet.cur;
+	io_vector[0].iov_len = packet.end - packet.cur;
+	io_vector[1].iov_base = entry->param.message.payload.data;
+	io_vector[1].iov_len = entry->param.message.payload.len;
+
+	memset(&msg, 0, sizeof(msg));
+
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+
+	return mqtt_transport_write_msg(client, &msg);
+}
+
+int mqtt_inflight_resend(struct mqtt_client *client)
+{
+	struct mqtt_inflight *next, *entry;
+	uint32_t seq = 0U;
+	bool first = true;
+	int err_code;
+	int i;
+
+	while (true) {
+		next = NULL;
+
+		/* Pick the oldest message not sent again yet. */
+		for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+			entry = &client->internal.inflight[i];
+
+			if (entry->expect == 0U ||
+			    (!first && (int32_t)(entry->seq - seq) < 0)) {
+				continue;
+			}
+
+			if (next == NULL ||
+			    (int32_t)(entry->seq - next->seq) < 0) {
+				next = entry;
+			}
+		}
+
+		if (next == NULL) {
+			break;
+		}
+
+		MQTT_TRC("[CID %p]: Resending message id 0x%04x", client,
+			 next->param.message_id);
+
+		err_code = inflight_send(client, next);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+
+		seq = next->seq + 1;
+		first = false;
+	}
+
+	return 0;
+}
+#else
+#define inflight_find(...) NULL
+#define inflight_add(...) 0
+#define inflight_remove(...)
+#define inflight_clear(...)
+#endif /* CONFIG_MQTT_INFLIGHT */
+
+static uint16_t message_id_alloc(struct mqtt_client *client)
+{
+	do {
+		client->internal.last_message_id++;
+	} while (client->internal.last_message_id == 0U ||
+		 inflight_find(client, client->internal.last_message_id) != NULL);
+
+	return client->internal.last_message_id;
+}
+
 void mqtt_client_init(struct mqtt_client *client)
 {
 	NULL_PARAM_CHECK_VOID(client);
@@ -215,6 +410,11 @@ int mqtt_connect(struct mqtt_client *client)
 		goto error;
 	}
 
+	/* Messages in flight are dropped with the session. */
+	if (client->clean_session) {
+		inflight_clear(client);
+	}
+
 	err_code = client_connect(client);
 
 error:
@@ -233,6 +433,11 @@ static int verify_tx_state(const struct mqtt_client *client)
 		return -ENOTCONN;
 	}
 
+	/* The payload of a message is being written. */
+	if (client->internal.tx_remaining_payload > 0U) {
+		return -EBUSY;
+	}
+
 	return 0;
 }
 
@@ -243,6 +448,7 @@ int mqtt_publish(struct mqtt_client *client,
 	struct buf_ctx packet;
 	struct iovec io_vector[2];
 	struct msghdr msg;
+	struct mqtt_publish_param publish;
 
 	NULL_PARAM_CHECK(client);
 	NULL_PARAM_CHECK(param);
@@ -261,15 +467,28 @@ int mqtt_publish(struct mqtt_client *client,
 		goto error;
 	}
 
-	err_code = publish_encode(param, &packet);
+	memcpy(&publish, param, sizeof(publish));
+
+	if (publish.message.topic.qos != MQTT_QOS_0_AT_MOST_ONCE &&
+	    publish.message_id == 0U) {
+		publish.message_id = message_id_alloc(client);
+	}
+
+	err_code = inflight_add(client, &publish);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	err_code = publish_encode(&publish, &packet);
 	if (err_code < 0) {
+		inflight_remove(client, publish.message_id);
 		goto error;
 	}
 
 	io_vector[0].iov_base = packet.cur;
 	io_vector[0].iov_len = packet.end - packet.cur;
-	io_vector[1].iov_base = param->message.payload.data;
-	io_vector[1].iov_len = param->message.payload.len;
+	io_vector[1].iov_base = publish.message.payload.data;
+	io_vector[1].iov_len = publish.message.payload.len;
 
 	memset(&msg, 0, sizeof(msg));
 
@@ -277,6 +496,9 @@ int mqtt_publish(struct mqtt_client *client,
 	msg.msg_iovlen = ARRAY_SIZE(io_vector);
 
 	err_code = client_write_msg(client, &msg);
+	if (err_code < 0) {
+		inflight_remove(client, publish.message_id);
+	}
 
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
@@ -287,6 +509,111 @@ error:
 	return err_code;
 }
 
+int mqtt_publish_begin(struct mqtt_client *client,
+		       const struct mqtt_publish_param *param)
+{
+	int err_code;
+	struct buf_ctx packet;
+	struct mqtt_publish_param publish;
+
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(param);
+
+	MQTT_TRC("[CID %p]:[State 0x%02x]: >> Topic size 0x%08x, "
+		 "Data size 0x%08x", client, client->internal.state,
+		 param->message.topic.topic.size,
+		 param->message.payload.len);
+
+	mqtt_mutex_lock(client);
+
+	tx_buf_init(client, &packet);
+
+	err_code = verify_tx_state(client);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	memcpy(&publish, param, sizeof(publish));
+
+	if (publish.message.topic.qos != MQTT_QOS_0_AT_MOST_ONCE &&
+	    publish.message_id == 0U) {
+		publish.message_id = message_id_alloc(client);
+	}
+
+	if (inflight_find(client, publish.message_id) != NULL) {
+		err_code = -EBUSY;
+		goto error;
+	}
+
+	/* Only the header is encoded, the payload follows. */
+	err_code = publish_encode(&publish, &packet);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	err_code = client_write(client, packet.cur, packet.end - packet.cur);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	client->internal.tx_remaining_payload = publish.message.payload.len;
+
+	err_code = (publish.message.topic.qos != MQTT_QOS_0_AT_MOST_ONCE) ?
+		   publish.message_id : 0;
+
+error:
+	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
+		 client, client->internal.state, err_code);
+
+	mqtt_mutex_unlock(client);
+
+	return err_code;
+}
+
+int mqtt_write_publish_payload(struct mqtt_client *client, const void *data,
+			       size_t length)
+{
+	int err_code;
+
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(data);
+
+	mqtt_mutex_lock(client);
+
+	if (!MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+		err_code = -ENOTCONN;
+		goto error;
+	}
+
+	if (length > client->internal.tx_remaining_payload) {
+		err_code = -EINVAL;
+		goto error;
+	}
+
+	err_code = client_write(client, data, length);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	client->internal.tx_remaining_payload -= length;
+
+error:
+	mqtt_mutex_unlock(client);
+
+	return err_code;
+}
+
+uint16_t mqtt_message_id_alloc(struct mqtt_client *client)
+{
+	uint16_t message_id;
+
+	mqtt_mutex_lock(client);
+	message_id = message_id_alloc(client);
+	mqtt_mutex_unlock(client);
+
+	return message_id;
+}
+
 int mqtt_publish_qos1_ack(struct mqtt_client *client,
 			  const struct mqtt_puback_param *param)
 {
@@ -449,6 +776,16 @@ int mqtt_disconnect(struct mqtt_client *client)
 
 	tx_buf_init(client, &packet);
 
+	/* The DISCONNECT message would be taken as a part of the payload
+	 * being written, so the connection is closed without it.
+	 */
+	if (MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED) &&
+	    client->internal.tx_remaining_payload > 0U) {
+		client_disconnect(client, -ECONNABORTED, true);
+		err_code = 0;
+		goto error;
+	}
+
 	err_code = verify_tx_state(client);
 	if (err_code < 0) {
 		goto error;
@@ -675,6 +1012,19 @@ static int read_publish_payload(struct mqtt_client *client, void *buffer,
 		length = client->internal.remaining_payload;
 	}
 
+	/* Part of the payload may have been received with the header. */
+	if (client->internal.rx_buf_pos < client->internal.rx_buf_datalen) {
+		ret = MIN(length, client->internal.rx_buf_datalen -
+				  client->internal.rx_buf_pos);
+
+		memcpy(buffer, client->rx_buf + client->internal.rx_buf_pos,
+		       ret);
+
+		client->internal.rx_buf_pos += ret;
+		client->internal.remaining_payload -= ret;
+		goto exit;
+	}
+
 	ret = mqtt_transport_read(client, buffer, length, shall_block);
 	if (!shall_block && ret == -EAGAIN) {
 		goto exit;
@@ -162,6 +162,29 @@ void event_notify(struct mqtt_client *client, const struct mqtt_evt *evt);
  */
 int mqtt_handle_rx(struct mqtt_client *client);
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+/**@brief Handles an acknowledgment for a message in flight.
+ *
+ * @param[in] client Identifies the client for which the packet was received.
+ * @param[in] type Type of the received packet, PUBACK, PUBREC or PUBCOMP.
+ * @param[in] message_id Message id of the received packet.
+ */
+void mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		       uint16_t message_id);
+
+/**@brief Sends again the messages in flight, in the order they were first
+ *        published.
+ *
+ * @param[in] client Identifies the client that reconnected.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+int mqtt_inflight_resend(struct mqtt_client *client);
+#else
+#define mqtt_inflight_ack(...)
+#define mqtt_inflight_resend(...) 0
+#endif /* CONFIG_MQTT_INFLIGHT */
+
 /**@brief Constructs/encodes Connect packet.
  *
  * @param[in] client Identifies the client for which the procedure is requested.
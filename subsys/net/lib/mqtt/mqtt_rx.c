@@ -42,6 +42,10 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 						MQTT_CONNECTION_ACCEPTED) {
 				/* Set state. */
 				MQTT_SET_STATE(client, MQTT_STATE_CONNECTED);
+
+				if (!client->clean_session) {
+					err_code = mqtt_inflight_resend(client);
+				}
 			} else {
 				err_code = -ECONNREFUSED;
 			}
@@ -64,6 +68,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		client->internal.remaining_payload =
 					evt.param.publish.message.payload.len;
 
+		/* The payload follows the variable header, the part of it
+		 * already received is left in the buffer.
+		 */
+		client->internal.rx_buf_pos = buf->cur - client->rx_buf;
+
 		MQTT_TRC("PUB QoS:%02x, message len %08x, topic len %08x",
 			 evt.param.publish.message.topic.qos,
 			 evt.param.publish.message.payload.len,
@@ -77,6 +86,10 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBACK;
 		err_code = publish_ack_decode(buf, &evt.param.puback);
 		evt.result = err_code;
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBACK,
+					  evt.param.puback.message_id);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_PUBREC:
@@ -85,6 +98,10 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBREC;
 		err_code = publish_receive_decode(buf, &evt.param.pubrec);
 		evt.result = err_code;
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBREC,
+					  evt.param.pubrec.message_id);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_PUBREL:
@@ -101,6 +118,10 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBCOMP;
 		err_code = publish_complete_decode(buf, &evt.param.pubcomp);
 		evt.result = err_code;
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+					  evt.param.pubcomp.message_id);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_SUBACK:
@@ -169,7 +190,12 @@ static int mqtt_read_message_chunk(struct mqtt_client *client,
 		return -ENOMEM;
 	}
 
-	len = mqtt_transport_read(client, buf->end, remaining, false);
+	/* Read whatever fits in the buffer, so that packets received back to
+	 * back are handled without reading the transport for each of them.
+	 */
+	len = mqtt_transport_read(client, buf->end,
+				  client->rx_buf + client->rx_buf_size - buf->end,
+				  false);
 	if (len < 0) {
 		MQTT_TRC("[CID %p]: Transport read error: %d", client, len);
 		return len;
@@ -251,20 +277,39 @@ static int mqtt_read_and_parse_fixed_header(struct mqtt_client *client,
 	return err_code;
 }
 
-int mqtt_handle_rx(struct mqtt_client *client)
+/* Drop the data processed already from the receive buffer. */
+static void mqtt_rx_buf_compact(struct mqtt_client *client)
+{
+	uint32_t pos = MIN(client->internal.rx_buf_pos,
+			   client->internal.rx_buf_datalen);
+
+	if (pos == 0U) {
+		return;
+	}
+
+	memmove(client->rx_buf, client->rx_buf + pos,
+		client->internal.rx_buf_datalen - pos);
+
+	client->internal.rx_buf_datalen -= pos;
+	client->internal.rx_buf_pos = 0U;
+}
+
+static int mqtt_handle_rx_packet(struct mqtt_client *client)
 {
 	int err_code;
 	uint8_t type_and_flags;
 	uint32_t var_length;
 	struct buf_ctx buf;
 
+	mqtt_rx_buf_compact(client);
+
 	buf.cur = client->rx_buf;
 	buf.end = client->rx_buf + client->internal.rx_buf_datalen;
 
 	err_code = mqtt_read_and_parse_fixed_header(client, &type_and_flags,
 						    &var_length, &buf);
 	if (err_code < 0) {
-		return (err_code == -EAGAIN) ? 0 : err_code;
+		return err_code;
 	}
 
 	if ((type_and_flags & 0xF0) == MQTT_PKT_TYPE_PUBLISH) {
@@ -275,16 +320,31 @@ int mqtt_handle_rx(struct mqtt_client *client)
 	}
 
 	if (err_code < 0) {
-		return (err_code == -EAGAIN) ? 0 : err_code;
+		return err_code;
 	}
 
+	/* The next packet starts after this one. For PUBLISH, this is
+	 * updated to the beginning of the payload once it is decoded.
+	 */
+	client->internal.rx_buf_pos = (buf.cur - client->rx_buf) + var_length;
+
 	/* At this point, packet is ready to be passed to the application. */
-	err_code = mqtt_handle_packet(client, type_and_flags, var_length, &buf);
-	if (err_code < 0) {
-		return err_code;
-	}
+	return mqtt_handle_packet(client, type_and_flags, var_length, &buf);
+}
+
+int mqtt_handle_rx(struct mqtt_client *client)
+{
+	int err_code;
 
-	client->internal.rx_buf_datalen = 0U;
+	/* Handle all the packets buffered or available from the transport,
+	 * stopping at a PUBLISH whose payload was not read by the
+	 * application.
+	 */
+	do {
+		err_code = mqtt_handle_rx_packet(client);
+	} while ((err_code == 0) &&
+		 (client->internal.remaining_payload == 0U) &&
+		 MQTT_HAS_STATE(client, MQTT_STATE_TCP_CONNECTED));
 
-	return 0;
+	return (err_code == -EAGAIN) ? 0 : err_code;
 }
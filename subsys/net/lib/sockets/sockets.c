@@ -171,6 +171,8 @@ int zsock_socket_internal(int family, int type, int proto)
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
 
+	zsock_epoll_sock_init(ctx);
+
 	/* TCP context is effectively owned by both application
 	 * and the stack: stack may detect that peer closed/aborted
 	 * connection, but it must not dispose of the context behind
@@ -238,6 +240,8 @@ int zsock_close_ctx(struct net_context *ctx)
 		(void)net_context_recv(ctx, NULL, K_NO_WAIT, NULL);
 	}
 
+	zsock_epoll_sock_close(ctx);
+
 	zsock_flush_queue(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
@@ -303,12 +307,15 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 	NET_DBG("parent=%p, ctx=%p, st=%d", parent, new_ctx, status);
 
 	if (status == 0) {
+		zsock_epoll_sock_init(new_ctx);
+
 		/* This just installs a callback, so cannot fail. */
 		(void)net_context_recv(new_ctx, zsock_received_cb, K_NO_WAIT,
 				       NULL);
 		k_fifo_init(&new_ctx->recv_q);
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		zsock_epoll_sock_notify(parent);
 	}
 }
 
@@ -338,6 +345,8 @@ static void zsock_received_cb(struct net_context *ctx,
 			net_pkt_set_eof(last_pkt, true);
 			NET_DBG("Set EOF flag on pkt %p", last_pkt);
 		}
+
+		zsock_epoll_sock_notify(ctx);
 		return;
 	}
 
@@ -351,6 +360,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_sock_notify(ctx);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -704,9 +714,8 @@ ssize_t z_impl_zsock_sendmsg(int sock, const struct msghdr *msg, int flags)
 }
 
 #ifdef CONFIG_USERSPACE
-static inline ssize_t z_vrfy_zsock_sendmsg(int sock,
-					   const struct msghdr *msg,
-					   int flags)
+static ssize_t zsock_sendmsg_user(int sock, const struct msghdr *msg,
+				  int flags)
 {
 	struct msghdr msg_copy;
 	size_t i;
@@ -789,9 +798,66 @@ fail:
 
 	return -1;
 }
+
+static inline ssize_t z_vrfy_zsock_sendmsg(int sock,
+					   const struct msghdr *msg,
+					   int flags)
+{
+	return zsock_sendmsg_user(sock, msg, flags);
+}
 #include <syscalls/zsock_sendmsg_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+int z_impl_zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+	ssize_t ret;
+
+	if (ctx == NULL || vtable->sendmsg == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ret = vtable->sendmsg(ctx, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+	}
+
+	/* Report an error only if no message could be sent */
+	return (i == 0U && vlen > 0U) ? -1 : (int)i;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	unsigned int i;
+	ssize_t ret;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(msgvec, vlen,
+					    sizeof(struct mmsghdr)));
+
+	for (i = 0; i < vlen; i++) {
+		ret = zsock_sendmsg_user(sock, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+	}
+
+	return (i == 0U && vlen > 0U) ? -1 : (int)i;
+}
+#include <syscalls/zsock_sendmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
 static int sock_get_pkt_src_addr(struct net_pkt *pkt,
 				 enum net_ip_protocol proto,
 				 struct sockaddr *addr,
@@ -895,6 +961,173 @@ error:
 	return ret;
 }
 
+static int sock_get_src_addr(struct net_context *ctx, struct net_pkt *pkt,
+			     struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
+	    net_if_is_ip_offloaded(net_context_get_iface(ctx))) {
+		/*
+		 * Packets from offloaded IP stack do not have IP
+		 * headers, so src address cannot be figured out at this
+		 * point. The best we can do is returning remote address
+		 * if that was set using connect() call.
+		 */
+		if (ctx->flags & NET_CONTEXT_REMOTE_ADDR_SET) {
+			memcpy(src_addr, &ctx->remote,
+			       MIN(*addrlen, sizeof(ctx->remote)));
+		} else {
+			return -ENOTSUP;
+		}
+	} else {
+		int rv;
+
+		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
+					   src_addr, *addrlen);
+		if (rv < 0) {
+			LOG_ERR("sock_get_pkt_src_addr %d", rv);
+			return rv;
+		}
+	}
+
+	/* addrlen is a value-result argument, set to actual
+	 * size of source address
+	 */
+	if (src_addr->sa_family == AF_INET) {
+		*addrlen = sizeof(struct sockaddr_in);
+	} else if (src_addr->sa_family == AF_INET6) {
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+static int sock_put_cmsg(struct msghdr *msg, size_t *offset, int level,
+			 int type, const void *data, size_t len)
+{
+	struct cmsghdr *cmsg;
+
+	if (*offset + CMSG_SPACE(len) > msg->msg_controllen) {
+		msg->msg_flags |= ZSOCK_MSG_CTRUNC;
+		return -ENOMEM;
+	}
+
+	cmsg = (struct cmsghdr *)((uint8_t *)msg->msg_control + *offset);
+	cmsg->cmsg_len = CMSG_LEN(len);
+	cmsg->cmsg_level = level;
+	cmsg->cmsg_type = type;
+	memcpy(CMSG_DATA(cmsg), data, len);
+
+	*offset += CMSG_SPACE(len);
+
+	return 0;
+}
+
+static int sock_put_pktinfo(struct net_pkt *pkt, struct msghdr *msg,
+			    size_t *offset)
+{
+	unsigned int ifindex = net_if_get_by_iface(net_pkt_iface(pkt));
+	struct net_pkt_cursor backup;
+	int ret = -ENOTSUP;
+
+	/* Packets from offloaded IP stack do not have IP headers */
+	if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
+	    net_if_is_ip_offloaded(net_pkt_iface(pkt))) {
+		return ret;
+	}
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) &&
+	    net_pkt_family(pkt) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *ipv4_hdr;
+		struct in_pktinfo info = {
+			.ipi_ifindex = ifindex,
+		};
+
+		ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(
+							pkt, &ipv4_access);
+		if (!ipv4_hdr) {
+			ret = -ENOBUFS;
+			goto out;
+		}
+
+		net_ipaddr_copy(&info.ipi_addr, &ipv4_hdr->dst);
+		net_ipaddr_copy(&info.ipi_spec_dst, &ipv4_hdr->dst);
+
+		ret = sock_put_cmsg(msg, offset, IPPROTO_IP, IP_PKTINFO,
+				    &info, sizeof(info));
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *ipv6_hdr;
+		struct in6_pktinfo info = {
+			.ipi6_ifindex = ifindex,
+		};
+
+		ipv6_hdr = (struct net_ipv6_hdr *)net_pkt_get_data(
+							pkt, &ipv6_access);
+		if (!ipv6_hdr) {
+			ret = -ENOBUFS;
+			goto out;
+		}
+
+		net_ipaddr_copy(&info.ipi6_addr, &ipv6_hdr->dst);
+
+		ret = sock_put_cmsg(msg, offset, IPPROTO_IPV6, IPV6_PKTINFO,
+				    &info, sizeof(info));
+	}
+
+out:
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return ret;
+}
+
+/* Fill in the ancillary data enabled by socket options. Data that does not
+ * fit into the control buffer is dropped and MSG_CTRUNC is set.
+ */
+static void sock_recv_cmsgs(struct net_context *ctx, struct net_pkt *pkt,
+			    struct msghdr *msg)
+{
+	size_t offset = 0;
+
+	if (!msg->msg_control) {
+		msg->msg_controllen = 0;
+		return;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_CONTEXT_RECV_PKTINFO)) {
+		bool pktinfo = false;
+
+		net_context_get_option(ctx, NET_OPT_RECV_PKTINFO, &pktinfo,
+				       NULL);
+		if (pktinfo) {
+			(void)sock_put_pktinfo(pkt, msg, &offset);
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_NET_CONTEXT_TIMESTAMP)) {
+		bool timestamp = false;
+
+		net_context_get_option(ctx, NET_OPT_TIMESTAMP, &timestamp,
+				       NULL);
+		if (timestamp) {
+			(void)sock_put_cmsg(msg, &offset, SOL_SOCKET,
+					    SO_TIMESTAMPING,
+					    net_pkt_timestamp(pkt),
+					    sizeof(struct net_ptp_time));
+		}
+	}
+
+	msg->msg_controllen = offset;
+}
+
 void net_socket_update_tc_rx_time(struct net_pkt *pkt, uint32_t end_tick)
 {
 	net_pkt_set_rx_stats_tick(pkt, end_tick);
@@ -925,7 +1158,9 @@ void net_socket_update_tc_rx_time(struct net_pkt *pkt, uint32_t end_tick)
 	}
 }
 
+/* If msg is not NULL, the data is read into its iovec and buf is not used */
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
+				       struct msghdr *msg,
 				       void *buf,
 				       size_t max_len,
 				       int flags,
@@ -937,6 +1172,7 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	size_t read_len;
 	struct net_pkt_cursor backup;
 	struct net_pkt *pkt;
+	size_t i;
 
 	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
 		timeout = K_NO_WAIT;
@@ -967,52 +1203,45 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	net_pkt_cursor_backup(pkt, &backup);
 
 	if (src_addr && addrlen) {
-		if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
-		    net_if_is_ip_offloaded(net_context_get_iface(ctx))) {
-			/*
-			 * Packets from offloaded IP stack do not have IP
-			 * headers, so src address cannot be figured out at this
-			 * point. The best we can do is returning remote address
-			 * if that was set using connect() call.
-			 */
-			if (ctx->flags & NET_CONTEXT_REMOTE_ADDR_SET) {
-				memcpy(src_addr, &ctx->remote,
-				       MIN(*addrlen, sizeof(ctx->remote)));
-			} else {
-				errno = ENOTSUP;
-				goto fail;
-			}
-		} else {
-			int rv;
+		int rv;
 
-			rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-						   src_addr, *addrlen);
-			if (rv < 0) {
-				errno = -rv;
-				LOG_ERR("sock_get_pkt_src_addr %d", rv);
+		rv = sock_get_src_addr(ctx, pkt, src_addr, addrlen);
+		if (rv < 0) {
+			errno = -rv;
+			goto fail;
+		}
+	}
+
+	recv_len = net_pkt_remaining_data(pkt);
+
+	if (msg) {
+		msg->msg_flags = 0;
+
+		for (i = 0, read_len = 0;
+		     i < msg->msg_iovlen && read_len < recv_len; i++) {
+			size_t len = MIN(msg->msg_iov[i].iov_len,
+					 recv_len - read_len);
+
+			if (net_pkt_read(pkt, msg->msg_iov[i].iov_base, len)) {
+				errno = ENOBUFS;
 				goto fail;
 			}
+
+			read_len += len;
 		}
 
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
-			goto fail;
+		if (read_len < recv_len) {
+			msg->msg_flags |= ZSOCK_MSG_TRUNC;
 		}
-	}
 
-	recv_len = net_pkt_remaining_data(pkt);
-	read_len = MIN(recv_len, max_len);
+		sock_recv_cmsgs(ctx, pkt, msg);
+	} else {
+		read_len = MIN(recv_len, max_len);
 
-	if (net_pkt_read(pkt, buf, read_len)) {
-		errno = ENOBUFS;
-		goto fail;
+		if (net_pkt_read(pkt, buf, read_len)) {
+			errno = ENOBUFS;
+			goto fail;
+		}
 	}
 
 	if (IS_ENABLED(CONFIG_NET_PKT_RXTIME_STATS) &&
@@ -1168,7 +1397,8 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 	}
 
 	if (sock_type == SOCK_DGRAM) {
-		return zsock_recv_dgram(ctx, buf, max_len, flags, src_addr, addrlen);
+		return zsock_recv_dgram(ctx, NULL, buf, max_len, flags,
+					src_addr, addrlen);
 	} else if (sock_type == SOCK_STREAM) {
 		return zsock_recv_stream(ctx, buf, max_len, flags);
 	} else {
@@ -1216,6 +1446,359 @@ ssize_t z_vrfy_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 #include <syscalls/zsock_recvfrom_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+static ssize_t zsock_recvmsg_stream(struct net_context *ctx,
+				    struct msghdr *msg, int flags)
+{
+	ssize_t recv_len = 0;
+	ssize_t ret;
+	size_t i;
+
+	msg->msg_namelen = 0;
+	msg->msg_controllen = 0;
+	msg->msg_flags = 0;
+
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		if (msg->msg_iov[i].iov_len == 0) {
+			continue;
+		}
+
+		ret = zsock_recv_stream(ctx, msg->msg_iov[i].iov_base,
+					msg->msg_iov[i].iov_len, flags);
+		if (ret < 0) {
+			return recv_len > 0 ? recv_len : ret;
+		}
+
+		recv_len += ret;
+
+		/* Peeking again would return the same data */
+		if ((size_t)ret < msg->msg_iov[i].iov_len ||
+		    (flags & ZSOCK_MSG_PEEK)) {
+			break;
+		}
+
+		/* Only wait for the data that fills the first buffer */
+		if (!(flags & ZSOCK_MSG_WAITALL)) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	return recv_len;
+}
+
+ssize_t zsock_recvmsg_ctx(struct net_context *ctx, struct msghdr *msg,
+			  int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+
+	if (msg == NULL || (msg->msg_iovlen > 0 && msg->msg_iov == NULL)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram(ctx, msg, NULL, 0, flags,
+					msg->msg_name,
+					msg->msg_name ? &msg->msg_namelen :
+							NULL);
+	} else if (sock_type == SOCK_STREAM) {
+		return zsock_recvmsg_stream(ctx, msg, flags);
+	} else {
+		__ASSERT(0, "Unknown socket type");
+	}
+
+	return 0;
+}
+
+ssize_t z_impl_zsock_recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	VTABLE_CALL(recvmsg, sock, msg, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+static ssize_t zsock_recvmsg_user(int sock, struct msghdr *msg, int flags)
+{
+	struct msghdr msg_copy;
+	struct iovec *iov = NULL;
+	ssize_t ret = -1;
+	size_t iov_size;
+	size_t i;
+
+	Z_OOPS(z_user_from_copy(&msg_copy, (void *)msg, sizeof(msg_copy)));
+	Z_OOPS(size_mul_overflow(msg_copy.msg_iovlen, sizeof(struct iovec),
+				 &iov_size));
+
+	if (msg_copy.msg_iovlen > 0) {
+		iov = z_user_alloc_from_copy(msg_copy.msg_iov, iov_size);
+		if (!iov) {
+			errno = ENOMEM;
+			return -1;
+		}
+	}
+
+	for (i = 0; i < msg_copy.msg_iovlen; i++) {
+		if (Z_SYSCALL_MEMORY_WRITE(iov[i].iov_base, iov[i].iov_len)) {
+			errno = EFAULT;
+			goto out;
+		}
+	}
+
+	if ((msg_copy.msg_name &&
+	     Z_SYSCALL_MEMORY_WRITE(msg_copy.msg_name,
+				    msg_copy.msg_namelen)) ||
+	    (msg_copy.msg_control &&
+	     Z_SYSCALL_MEMORY_WRITE(msg_copy.msg_control,
+				    msg_copy.msg_controllen))) {
+		errno = EFAULT;
+		goto out;
+	}
+
+	msg_copy.msg_iov = iov;
+
+	ret = z_impl_zsock_recvmsg(sock, &msg_copy, flags);
+
+	Z_OOPS(z_user_to_copy(&msg->msg_namelen, &msg_copy.msg_namelen,
+			      sizeof(msg_copy.msg_namelen)));
+	Z_OOPS(z_user_to_copy(&msg->msg_controllen, &msg_copy.msg_controllen,
+			      sizeof(msg_copy.msg_controllen)));
+	Z_OOPS(z_user_to_copy(&msg->msg_flags, &msg_copy.msg_flags,
+			      sizeof(msg_copy.msg_flags)));
+out:
+	k_free(iov);
+
+	return ret;
+}
+
+static inline ssize_t z_vrfy_zsock_recvmsg(int sock, struct msghdr *msg,
+					   int flags)
+{
+	return zsock_recvmsg_user(sock, msg, flags);
+}
+#include <syscalls/zsock_recvmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+	ssize_t ret;
+
+	if (ctx == NULL || vtable->recvmsg == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ret = vtable->recvmsg(ctx, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	/* Report an error only if no message was received */
+	return (i == 0U && vlen > 0U) ? -1 : (int)i;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	unsigned int i;
+	ssize_t ret;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(msgvec, vlen,
+					    sizeof(struct mmsghdr)));
+
+	for (i = 0; i < vlen; i++) {
+		ret = zsock_recvmsg_user(sock, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	return (i == 0U && vlen > 0U) ? -1 : (int)i;
+}
+#include <syscalls/zsock_recvmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+#if defined(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)
+/* Drop the data in front of the packet cursor, so that the packet
+ * fragments hold only the data that is handed to the application.
+ */
+static void sock_zc_trim_head(struct net_pkt *pkt)
+{
+	struct net_buf *buf = pkt->cursor.buf;
+
+	while (pkt->buffer && pkt->buffer != buf) {
+		pkt->buffer = net_buf_frag_del(NULL, pkt->buffer);
+	}
+
+	if (buf) {
+		net_buf_pull(buf, pkt->cursor.pos - buf->data);
+	}
+
+	net_pkt_cursor_init(pkt);
+}
+
+/* Returns 0 and sets *pkt to NULL if the peer closed the connection */
+static int sock_zc_get_stream(struct net_context *ctx, k_timeout_t timeout,
+			      struct net_pkt **pkt)
+{
+	int res;
+
+	*pkt = NULL;
+
+	if (net_context_get_state(ctx) != NET_CONTEXT_CONNECTED) {
+		return -ENOTCONN;
+	}
+
+	if (sock_is_eof(ctx)) {
+		return 0;
+	}
+
+	res = k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+	/* EAGAIN when timeout expired, EINTR when cancelled */
+	if (res && res != -EAGAIN && res != -EINTR) {
+		return res;
+	}
+
+	*pkt = k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+	if (!*pkt) {
+		/* Either timeout expired, or wait was cancelled
+		 * due to connection closure by peer.
+		 */
+		return sock_is_eof(ctx) ? 0 : -EAGAIN;
+	}
+
+	if (net_pkt_eof(*pkt)) {
+		sock_set_eof(ctx);
+	}
+
+	return 0;
+}
+
+static ssize_t zsock_recv_zc_ctx(struct net_context *ctx,
+				 struct net_pkt **pkt, int flags,
+				 struct sockaddr *src_addr,
+				 socklen_t *addrlen)
+{
+	k_timeout_t timeout = K_FOREVER;
+	struct net_pkt *rx;
+	ssize_t len;
+
+	if (!sock_get_flag(ctx, SOCK_RECV_ZEROCOPY)) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	if (flags & ~ZSOCK_MSG_DONTWAIT) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	} else {
+		net_context_get_option(ctx, NET_OPT_RCVTIMEO, &timeout, NULL);
+	}
+
+	if (net_context_get_type(ctx) == SOCK_STREAM) {
+		int rv;
+
+		rv = sock_zc_get_stream(ctx, timeout, &rx);
+		if (rv < 0) {
+			errno = -rv;
+			return -1;
+		}
+
+		if (!rx) {
+			return 0;
+		}
+	} else {
+		rx = k_fifo_get(&ctx->recv_q, timeout);
+		if (!rx) {
+			errno = EAGAIN;
+			return -1;
+		}
+
+		if (src_addr && addrlen) {
+			int rv;
+
+			rv = sock_get_src_addr(ctx, rx, src_addr, addrlen);
+			if (rv < 0) {
+				net_pkt_unref(rx);
+				errno = -rv;
+				return -1;
+			}
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_NET_PKT_RXTIME_STATS)) {
+		net_socket_update_tc_rx_time(rx, k_cycle_get_32());
+	}
+
+	len = net_pkt_remaining_data(rx);
+
+	sock_zc_trim_head(rx);
+
+	*pkt = rx;
+
+	return len;
+}
+
+ssize_t zsock_recv_zc(int sock, struct net_pkt **pkt, int flags,
+		      struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	struct net_context *ctx;
+
+	ctx = z_get_fd_obj(sock,
+			   (const struct fd_op_vtable *)&sock_fd_op_vtable,
+			   ENOTSUP);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	return zsock_recv_zc_ctx(ctx, pkt, flags, src_addr, addrlen);
+}
+
+int zsock_recv_zc_release(int sock, struct net_pkt *pkt)
+{
+	struct net_context *ctx;
+
+	ctx = z_get_fd_obj(sock,
+			   (const struct fd_op_vtable *)&sock_fd_op_vtable,
+			   ENOTSUP);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	/* Give the data back to the receive window like zsock_recv() does
+	 * when consuming it. The TCP stack does not currently adjust the
+	 * advertised window, so this has no effect on the connection.
+	 */
+	if (net_context_get_type(ctx) == SOCK_STREAM) {
+		net_context_update_recv_wnd(ctx, net_pkt_get_len(pkt));
+	}
+
+	net_pkt_unref(pkt);
+
+	return 0;
+}
+#endif /* CONFIG_NET_SOCKETS_RECV_ZEROCOPY */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -1532,6 +2115,52 @@ static inline int z_vrfy_zsock_inet_pton(sa_family_t family,
 #include <syscalls/zsock_inet_pton_mrsh.c>
 #endif
 
+static int sock_get_recv_pktinfo(struct net_context *ctx, void *optval,
+				 socklen_t *optlen)
+{
+	bool pktinfo;
+	int ret;
+
+	if (*optlen != sizeof(int)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = net_context_get_option(ctx, NET_OPT_RECV_PKTINFO, &pktinfo,
+				     NULL);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	*(int *)optval = pktinfo;
+
+	return 0;
+}
+
+static int sock_set_recv_pktinfo(struct net_context *ctx, const void *optval,
+				 socklen_t optlen)
+{
+	bool pktinfo;
+	int ret;
+
+	if (optlen != sizeof(int)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pktinfo = !!*(int *)optval;
+
+	ret = net_context_set_option(ctx, NET_OPT_RECV_PKTINFO, &pktinfo,
+				     sizeof(pktinfo));
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
 int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 void *optval, socklen_t *optlen)
 {
@@ -1567,6 +2196,34 @@ int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 			}
 			break;
 
+		case SO_RCVZEROCOPY:
+			if (IS_ENABLED(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)) {
+				if (*optlen != sizeof(int)) {
+					errno = EINVAL;
+					return -1;
+				}
+
+				*(int *)optval = !!sock_get_flag(
+						ctx, SOCK_RECV_ZEROCOPY);
+
+				return 0;
+			}
+			break;
+
+		case SO_MAX_PACING_RATE:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_PACING)) {
+				ret = net_context_get_option(
+						ctx, NET_OPT_MAX_PACING_RATE,
+						optval, optlen);
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				return 0;
+			}
+			break;
+
 		case SO_PROTOCOL: {
 			int proto = (int)net_context_get_ip_proto(ctx);
 
@@ -1581,6 +2238,63 @@ int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 		}
 		}
 
+		break;
+
+	case IPPROTO_TCP:
+		switch (optname) {
+		case TCP_QUICKACK:
+			if (IS_ENABLED(CONFIG_NET_TCP_DELAYED_ACK)) {
+				bool quickack;
+
+				if (*optlen != sizeof(int)) {
+					errno = EINVAL;
+					return -1;
+				}
+
+				ret = net_context_get_option(ctx,
+							NET_OPT_TCP_QUICKACK,
+							&quickack, NULL);
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				*(int *)optval = quickack;
+
+				return 0;
+			}
+
+			break;
+		}
+
+		break;
+
+	case IPPROTO_IP:
+		switch (optname) {
+		case IP_PKTINFO:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_RECV_PKTINFO) &&
+			    net_context_get_family(ctx) == AF_INET) {
+				return sock_get_recv_pktinfo(ctx, optval,
+							     optlen);
+			}
+
+			break;
+		}
+
+		break;
+
+	case IPPROTO_IPV6:
+		switch (optname) {
+		case IPV6_RECVPKTINFO:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_RECV_PKTINFO) &&
+			    net_context_get_family(ctx) == AF_INET6) {
+				return sock_get_recv_pktinfo(ctx, optval,
+							     optlen);
+			}
+
+			break;
+		}
+
 		break;
 	}
 
@@ -1670,6 +2384,22 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 
 			break;
 
+		case SO_RCVZEROCOPY:
+			if (IS_ENABLED(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)) {
+				if (optlen != sizeof(int)) {
+					errno = EINVAL;
+					return -1;
+				}
+
+				sock_set_flag(ctx, SOCK_RECV_ZEROCOPY,
+					      *(const int *)optval ?
+					      SOCK_RECV_ZEROCOPY : 0);
+
+				return 0;
+			}
+
+			break;
+
 		case SO_RCVTIMEO:
 			if (IS_ENABLED(CONFIG_NET_CONTEXT_RCVTIMEO)) {
 				const struct zsock_timeval *tv = optval;
@@ -1763,6 +2493,21 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 				return 0;
 			}
 
+			break;
+
+		case SO_MAX_PACING_RATE:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_PACING)) {
+				ret = net_context_set_option(
+						ctx, NET_OPT_MAX_PACING_RATE,
+						optval, optlen);
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				return 0;
+			}
+
 			break;
 		}
 
@@ -1775,6 +2520,45 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 * existing apps.
 			 */
 			return 0;
+
+		case TCP_QUICKACK:
+			if (IS_ENABLED(CONFIG_NET_TCP_DELAYED_ACK)) {
+				int ret;
+				bool quickack;
+
+				if (optlen != sizeof(int)) {
+					errno = EINVAL;
+					return -1;
+				}
+
+				quickack = !!*(int *)optval;
+
+				ret = net_context_set_option(ctx,
+							NET_OPT_TCP_QUICKACK,
+							&quickack,
+							sizeof(quickack));
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				return 0;
+			}
+
+			break;
+		}
+		break;
+
+	case IPPROTO_IP:
+		switch (optname) {
+		case IP_PKTINFO:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_RECV_PKTINFO) &&
+			    net_context_get_family(ctx) == AF_INET) {
+				return sock_set_recv_pktinfo(ctx, optval,
+							     optlen);
+			}
+
+			break;
 		}
 		break;
 
@@ -1785,6 +2569,15 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 * existing apps.
 			 */
 			return 0;
+
+		case IPV6_RECVPKTINFO:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_RECV_PKTINFO) &&
+			    net_context_get_family(ctx) == AF_INET6) {
+				return sock_set_recv_pktinfo(ctx, optval,
+							     optlen);
+			}
+
+			break;
 		}
 		break;
 	}
@@ -2013,6 +2806,11 @@ static ssize_t sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				  src_addr, addrlen);
 }
 
+static ssize_t sock_recvmsg_vmeth(void *obj, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg_ctx(obj, msg, flags);
+}
+
 static int sock_getsockopt_vmeth(void *obj, int level, int optname,
 				 void *optval, socklen_t *optlen)
 {
@@ -2050,6 +2848,7 @@ const struct socket_op_vtable sock_fd_op_vtable = {
 	.sendto = sock_sendto_vmeth,
 	.sendmsg = sock_sendmsg_vmeth,
 	.recvfrom = sock_recvfrom_vmeth,
+	.recvmsg = sock_recvmsg_vmeth,
 	.getsockopt = sock_getsockopt_vmeth,
 	.setsockopt = sock_setsockopt_vmeth,
 	.getsockname = sock_getsockname_vmeth,
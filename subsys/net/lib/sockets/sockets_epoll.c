@@ -0,0 +1,569 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_sock_epoll, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+#include <syscall_handler.h>
+#include <sys/fdtable.h>
+#include <sys/dlist.h>
+#include <sys/slist.h>
+
+#include "sockets_internal.h"
+
+/* Events that are always reported, even if not requested */
+#define EPOLL_ALWAYS (ZSOCK_EPOLLERR | ZSOCK_EPOLLHUP)
+
+struct epoll_item {
+	/* Node in the list of items watching the socket */
+	sys_snode_t sock_node;
+	/* Node in the interest list of the epoll instance */
+	sys_snode_t ep_node;
+	/* Node in the ready list of the epoll instance */
+	sys_dnode_t ready_node;
+	struct zsock_epoll *ep;
+	struct net_context *ctx;
+	struct zsock_epoll_event event;
+	bool ready;
+};
+
+struct zsock_epoll {
+	/* All the items of this instance */
+	sys_slist_t items;
+	/* Items that have become ready and are to be checked by wait */
+	sys_dlist_t ready_list;
+	/* Signaled when an item is added to the ready list */
+	struct k_sem ready_sem;
+	bool in_use;
+};
+
+#ifdef CONFIG_USERSPACE
+static int epoll_count;
+#else
+static struct zsock_epoll epolls[CONFIG_NET_SOCKETS_EPOLL_MAX];
+#endif
+
+K_MEM_SLAB_DEFINE(epoll_item_slab, sizeof(struct epoll_item),
+		  CONFIG_NET_SOCKETS_EPOLL_MAX_ITEMS, 8);
+
+/* Protects all the epoll instances and the socket item lists */
+static K_MUTEX_DEFINE(epoll_lock);
+
+static const struct socket_op_vtable epoll_fd_op_vtable;
+
+/* Same readiness rules as in zsock_poll() */
+static uint32_t epoll_sock_events(struct net_context *ctx)
+{
+	uint32_t events = ZSOCK_EPOLLOUT;
+
+	/* recv_q and accept_q are in union */
+	if (!k_fifo_is_empty(&ctx->recv_q) || sock_is_eof(ctx)) {
+		events |= ZSOCK_EPOLLIN;
+	}
+
+	return events;
+}
+
+static void epoll_item_set_ready(struct epoll_item *item)
+{
+	if (item->ready || !item->event.events) {
+		return;
+	}
+
+	sys_dlist_append(&item->ep->ready_list, &item->ready_node);
+	item->ready = true;
+
+	k_sem_give(&item->ep->ready_sem);
+}
+
+static void epoll_item_clear_ready(struct epoll_item *item)
+{
+	if (!item->ready) {
+		return;
+	}
+
+	sys_dlist_remove(&item->ready_node);
+	item->ready = false;
+}
+
+static void epoll_item_free(struct epoll_item *item)
+{
+	epoll_item_clear_ready(item);
+
+	sys_slist_find_and_remove(&item->ctx->epoll_items, &item->sock_node);
+	sys_slist_find_and_remove(&item->ep->items, &item->ep_node);
+
+	k_mem_slab_free(&epoll_item_slab, (void **)&item);
+}
+
+void zsock_epoll_sock_init(struct net_context *ctx)
+{
+	sys_slist_init(&ctx->epoll_items);
+}
+
+void zsock_epoll_sock_notify(struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	/* Nobody can be waiting for an event, if there are no items. An
+	 * item added concurrently checks the socket state itself.
+	 */
+	if (sys_slist_is_empty(&ctx->epoll_items)) {
+		return;
+	}
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, sock_node) {
+		if (epoll_sock_events(ctx) & item->event.events) {
+			epoll_item_set_ready(item);
+		}
+	}
+
+	k_mutex_unlock(&epoll_lock);
+}
+
+void zsock_epoll_sock_close(struct net_context *ctx)
+{
+	struct epoll_item *item, *next;
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&ctx->epoll_items, item, next,
+					  sock_node) {
+		epoll_item_free(item);
+	}
+
+	k_mutex_unlock(&epoll_lock);
+}
+
+static struct epoll_item *epoll_item_find(struct zsock_epoll *ep,
+					  struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	/* A socket is usually watched by one epoll instance only, so this
+	 * does not depend on the size of the interest list.
+	 */
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, sock_node) {
+		if (item->ep == ep) {
+			return item;
+		}
+	}
+
+	return NULL;
+}
+
+static int epoll_item_add(struct zsock_epoll *ep, struct net_context *ctx,
+			  const struct zsock_epoll_event *event)
+{
+	struct epoll_item *item;
+
+	if (epoll_item_find(ep, ctx)) {
+		return -EEXIST;
+	}
+
+	if (k_mem_slab_alloc(&epoll_item_slab, (void **)&item, K_NO_WAIT)) {
+		return -ENOMEM;
+	}
+
+	item->ep = ep;
+	item->ctx = ctx;
+	item->event = *event;
+	item->ready = false;
+
+	sys_slist_append(&ctx->epoll_items, &item->sock_node);
+	sys_slist_append(&ep->items, &item->ep_node);
+
+	if (epoll_sock_events(ctx) & event->events) {
+		epoll_item_set_ready(item);
+	}
+
+	return 0;
+}
+
+static int epoll_item_mod(struct zsock_epoll *ep, struct net_context *ctx,
+			  const struct zsock_epoll_event *event)
+{
+	struct epoll_item *item;
+
+	item = epoll_item_find(ep, ctx);
+	if (!item) {
+		return -ENOENT;
+	}
+
+	item->event = *event;
+
+	epoll_item_clear_ready(item);
+
+	if (epoll_sock_events(ctx) & event->events) {
+		epoll_item_set_ready(item);
+	}
+
+	return 0;
+}
+
+static int epoll_item_del(struct zsock_epoll *ep, struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	item = epoll_item_find(ep, ctx);
+	if (!item) {
+		return -ENOENT;
+	}
+
+	epoll_item_free(item);
+
+	return 0;
+}
+
+/* Check the items on the ready list and report the ones that are still
+ * ready. Level triggered items stay on the list, so that they are checked
+ * again by the next wait.
+ */
+static int epoll_collect(struct zsock_epoll *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	struct epoll_item *item, *next;
+	sys_dlist_t requeue;
+	uint32_t revents;
+	int count = 0;
+
+	sys_dlist_init(&requeue);
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&ep->ready_list, item, next,
+					  ready_node) {
+		if (count == maxevents) {
+			break;
+		}
+
+		sys_dlist_remove(&item->ready_node);
+
+		revents = epoll_sock_events(item->ctx) &
+			  (item->event.events | EPOLL_ALWAYS);
+		if (!revents) {
+			item->ready = false;
+			continue;
+		}
+
+		events[count].events = revents;
+		events[count].data = item->event.data;
+		count++;
+
+		if (item->event.events & ZSOCK_EPOLLONESHOT) {
+			/* Disabled until re-armed with EPOLL_CTL_MOD */
+			item->event.events = 0U;
+			item->ready = false;
+		} else if (item->event.events & ZSOCK_EPOLLET) {
+			item->ready = false;
+		} else {
+			sys_dlist_append(&requeue, &item->ready_node);
+		}
+	}
+
+	/* Requeued items go to the end for fairness */
+	while (!sys_dlist_is_empty(&requeue)) {
+		sys_dnode_t *node = sys_dlist_get(&requeue);
+
+		sys_dlist_append(&ep->ready_list, node);
+	}
+
+	/* Let other waiters see the remaining items */
+	if (!sys_dlist_is_empty(&ep->ready_list)) {
+		k_sem_give(&ep->ready_sem);
+	}
+
+	return count;
+}
+
+/* Called with epoll_lock held */
+static struct zsock_epoll *epoll_alloc(void)
+{
+#ifdef CONFIG_USERSPACE
+	struct z_object *zo;
+
+	if (epoll_count == CONFIG_NET_SOCKETS_EPOLL_MAX) {
+		return NULL;
+	}
+
+	/* As for socketpair(), use a socket kernel object so that the
+	 * instance can be closed with zsock_close() from user mode.
+	 */
+	zo = z_dynamic_object_create(sizeof(struct zsock_epoll));
+	if (zo == NULL) {
+		return NULL;
+	}
+
+	zo->type = K_OBJ_NET_SOCKET;
+	epoll_count++;
+
+	return zo->name;
+#else
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(epolls); i++) {
+		if (!epolls[i].in_use) {
+			return &epolls[i];
+		}
+	}
+
+	return NULL;
+#endif
+}
+
+/* Called with epoll_lock held */
+static void epoll_free(struct zsock_epoll *ep)
+{
+#ifdef CONFIG_USERSPACE
+	k_object_free(ep);
+	epoll_count--;
+#else
+	ep->in_use = false;
+#endif
+}
+
+int z_impl_zsock_epoll_create1(int flags)
+{
+	struct zsock_epoll *ep;
+	int fd = -1;
+
+	if (flags) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	ep = epoll_alloc();
+	if (!ep) {
+		errno = ENOMEM;
+		goto out;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		epoll_free(ep);
+		goto out;
+	}
+
+	sys_slist_init(&ep->items);
+	sys_dlist_init(&ep->ready_list);
+	k_sem_init(&ep->ready_sem, 0, 1);
+	ep->in_use = true;
+
+	z_finalize_fd(fd, ep,
+		      (const struct fd_op_vtable *)&epoll_fd_op_vtable);
+
+	NET_DBG("epoll: ep=%p, fd=%d", ep, fd);
+
+out:
+	k_mutex_unlock(&epoll_lock);
+
+	return fd;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_epoll_create1(int flags)
+{
+	return z_impl_zsock_epoll_create1(flags);
+}
+#include <syscalls/zsock_epoll_create1_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_epoll_ctl(int epfd, int op, int fd,
+			   struct zsock_epoll_event *event)
+{
+	struct net_context *ctx;
+	struct zsock_epoll *ep;
+	int ret;
+
+	ep = z_get_fd_obj(epfd,
+			  (const struct fd_op_vtable *)&epoll_fd_op_vtable,
+			  EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL && event == NULL) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	/* Only native sockets provide the readiness notification */
+	ctx = z_get_fd_obj(fd, (const struct fd_op_vtable *)&sock_fd_op_vtable,
+			   EPERM);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	/* Check the permissions of the calling thread */
+	if (z_impl_zsock_get_context_object(fd) == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		ret = epoll_item_add(ep, ctx, event);
+		break;
+	case ZSOCK_EPOLL_CTL_MOD:
+		ret = epoll_item_mod(ep, ctx, event);
+		break;
+	case ZSOCK_EPOLL_CTL_DEL:
+		ret = epoll_item_del(ep, ctx);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	k_mutex_unlock(&epoll_lock);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_epoll_ctl(int epfd, int op, int fd,
+					 struct zsock_epoll_event *event)
+{
+	struct zsock_epoll_event event_copy;
+
+	if (event != NULL) {
+		Z_OOPS(z_user_from_copy(&event_copy, (void *)event,
+					sizeof(event_copy)));
+		event = &event_copy;
+	}
+
+	return z_impl_zsock_epoll_ctl(epfd, op, fd, event);
+}
+#include <syscalls/zsock_epoll_ctl_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			    int maxevents, int timeout)
+{
+	struct zsock_epoll *ep;
+	k_timeout_t wait;
+	uint64_t end;
+	int count;
+
+	ep = z_get_fd_obj(epfd,
+			  (const struct fd_op_vtable *)&epoll_fd_op_vtable,
+			  EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout < 0) {
+		wait = K_FOREVER;
+	} else {
+		wait = K_MSEC(timeout);
+	}
+
+	end = sys_clock_timeout_end_calc(wait);
+
+	for (;;) {
+		k_mutex_lock(&epoll_lock, K_FOREVER);
+		count = epoll_collect(ep, events, maxevents);
+		k_mutex_unlock(&epoll_lock);
+
+		if (count > 0 || K_TIMEOUT_EQ(wait, K_NO_WAIT)) {
+			break;
+		}
+
+		if (k_sem_take(&ep->ready_sem, wait) == -EAGAIN) {
+			break;
+		}
+
+		if (!K_TIMEOUT_EQ(wait, K_FOREVER)) {
+			int64_t remaining = end - sys_clock_tick_get();
+
+			if (remaining <= 0) {
+				wait = K_NO_WAIT;
+			} else {
+				wait = Z_TIMEOUT_TICKS(remaining);
+			}
+		}
+	}
+
+	return count;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_epoll_wait(int epfd,
+					  struct zsock_epoll_event *events,
+					  int maxevents, int timeout)
+{
+	if (maxevents > 0) {
+		Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(events, maxevents,
+						    sizeof(*events)));
+	}
+
+	return z_impl_zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+#include <syscalls/zsock_epoll_wait_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_close_vmeth(void *obj)
+{
+	struct zsock_epoll *ep = obj;
+	struct epoll_item *item, *next;
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&ep->items, item, next, ep_node) {
+		epoll_item_free(item);
+	}
+
+	epoll_free(ep);
+
+	k_mutex_unlock(&epoll_lock);
+
+	return 0;
+}
+
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	errno = EOPNOTSUPP;
+	return -1;
+}
+
+/* Only the fd methods are provided, socket calls fail with EBADF */
+static const struct socket_op_vtable epoll_fd_op_vtable = {
+	.fd_vtable = {
+		.read = epoll_read_vmeth,
+		.write = epoll_write_vmeth,
+		.close = epoll_close_vmeth,
+		.ioctl = epoll_ioctl_vmeth,
+	},
+};
@@ -0,0 +1,873 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Asynchronous I/O rings
+ *
+ * Submitted operations are kept on a single pending list which is served
+ * by one kernel thread. On each iteration the thread asks every pending
+ * operation for the k_poll events it needs (through the fdtable
+ * ZFD_IOCTL_POLL_PREPARE/UPDATE protocol also used by poll()), waits for
+ * all of them at once together with a signal raised on new submissions,
+ * and then runs the operations whose descriptor became ready. As the
+ * thread is shared by all the rings, operations must not block it: socket
+ * calls are made with ZSOCK_MSG_DONTWAIT, and plain reads and writes are
+ * only run on descriptors in non-blocking mode. The object behind each
+ * descriptor is resolved at submit time and the operation fails if the
+ * descriptor refers to another object when it runs. Results are posted to
+ * the completion queue of the owning ring; while that queue is full,
+ * completions are parked on a per ring overflow list, which also stops a
+ * multishot operation from being re-armed until the application catches
+ * up.
+ */
+
+#include <fcntl.h>
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_sock_io_ring, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <net/socket.h>
+#include <syscall_handler.h>
+#include <sys/fdtable.h>
+#include <sys/dlist.h>
+#include <sys/io_ring.h>
+#include <sys/sys_io.h>
+#include <sys/util.h>
+
+#include "sockets_internal.h"
+
+struct io_ring_ctx {
+	/* Ring shared with the application */
+	struct io_ring *ring;
+	/* Kernel copies of the ring geometry, validated at setup */
+	struct io_ring_sqe *sqes;
+	struct io_ring_cqe *cqes;
+	uint32_t sq_mask;
+	uint32_t cq_mask;
+	uint32_t sq_head;
+	uint32_t cq_tail;
+	/* Completed operations waiting for free CQ entries */
+	sys_dlist_t overflow;
+	/* Given on every posted completion */
+	struct k_sem cq_sem;
+	struct k_thread *owner;
+	bool in_use;
+};
+
+struct io_ring_op {
+	sys_dnode_t node;
+	struct io_ring_ctx *ctx;
+	/* Kernel copy of the submission, never re-read from the ring */
+	struct io_ring_sqe sqe;
+	/* Object behind sqe.fd when the operation was submitted */
+	void *obj;
+	const struct fd_op_vtable *vtable;
+	struct zsock_pollfd pfd;
+	/* First k_poll event of the operation, NULL if always ready */
+	struct k_poll_event *pev;
+	/* Result waiting on the overflow list */
+	int32_t res;
+	/* Set when the events of the current iteration were prepared */
+	bool prepared;
+	/* Submitted from user mode */
+	bool from_user;
+};
+
+/* Protects all the rings and the pending list */
+static K_MUTEX_DEFINE(io_ring_lock);
+
+#ifdef CONFIG_USERSPACE
+static int io_ring_count;
+#else
+static struct io_ring_ctx rings[CONFIG_NET_SOCKETS_IO_RING_MAX];
+#endif
+K_MEM_SLAB_DEFINE(io_ring_ops, sizeof(struct io_ring_op),
+		  CONFIG_NET_SOCKETS_IO_RING_MAX_OPS, 8);
+
+static sys_dlist_t io_ring_pending = SYS_DLIST_STATIC_INIT(&io_ring_pending);
+static struct k_poll_signal io_ring_sig =
+	K_POLL_SIGNAL_INITIALIZER(io_ring_sig);
+/* One event for the submission signal and one per operation, as each
+ * operation waits for either POLLIN or POLLOUT.
+ */
+static struct k_poll_event
+	io_ring_events[1 + CONFIG_NET_SOCKETS_IO_RING_MAX_OPS];
+
+static const struct socket_op_vtable io_ring_fd_vtable;
+
+static bool io_ring_op_is_fs(struct io_ring_op *op)
+{
+	return op->sqe.opcode == IO_RING_OP_FS_READ ||
+	       op->sqe.opcode == IO_RING_OP_FS_WRITE;
+}
+
+static bool io_ring_op_is_rw(struct io_ring_op *op)
+{
+	return op->sqe.opcode == IO_RING_OP_READ ||
+	       op->sqe.opcode == IO_RING_OP_WRITE;
+}
+
+static bool io_ring_cq_post(struct io_ring_ctx *ctx, struct io_ring_op *op,
+			    int32_t res, uint32_t flags)
+{
+	uint32_t head = (uint32_t)atomic_get(&ctx->ring->cq_head);
+	struct io_ring_cqe *cqe;
+
+	/* Also catches a cq_head corrupted by the application */
+	if (ctx->cq_tail - head > ctx->cq_mask) {
+		return false;
+	}
+
+	cqe = &ctx->cqes[ctx->cq_tail & ctx->cq_mask];
+	cqe->user_data = op->sqe.user_data;
+	cqe->res = res;
+	cqe->flags = flags;
+
+	ctx->cq_tail++;
+	(void)atomic_set(&ctx->ring->cq_tail, ctx->cq_tail);
+	k_sem_give(&ctx->cq_sem);
+
+	return true;
+}
+
+static bool io_ring_op_more(struct io_ring_op *op, int32_t res)
+{
+	return (op->sqe.flags & IO_RING_SQE_MULTISHOT) && res >= 0;
+}
+
+/* Re-arm a multishot operation or release a completed one */
+static void io_ring_op_retire(struct io_ring_op *op, bool more)
+{
+	if (more) {
+		op->prepared = false;
+		sys_dlist_append(&io_ring_pending, &op->node);
+		k_poll_signal_raise(&io_ring_sig, 0);
+		return;
+	}
+
+	k_mem_slab_free(&io_ring_ops, (void **)&op);
+}
+
+/* Called with the operation removed from any list */
+static void io_ring_op_complete(struct io_ring_op *op, int32_t res)
+{
+	struct io_ring_ctx *ctx = op->ctx;
+	bool more = io_ring_op_more(op, res);
+
+	/* Keep completions in order once the CQ has overflowed */
+	if (!sys_dlist_is_empty(&ctx->overflow) ||
+	    !io_ring_cq_post(ctx, op, res, more ? IO_RING_CQE_F_MORE : 0)) {
+		op->res = res;
+		sys_dlist_append(&ctx->overflow, &op->node);
+		return;
+	}
+
+	io_ring_op_retire(op, more);
+}
+
+static void io_ring_flush_overflow(struct io_ring_ctx *ctx)
+{
+	struct io_ring_op *op, *next;
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&ctx->overflow, op, next, node) {
+		bool more = io_ring_op_more(op, op->res);
+
+		if (!io_ring_cq_post(ctx, op, op->res,
+				     more ? IO_RING_CQE_F_MORE : 0)) {
+			break;
+		}
+
+		sys_dlist_remove(&op->node);
+		io_ring_op_retire(op, more);
+	}
+}
+
+static int io_ring_op_check(struct io_ring_op *op, bool from_user)
+{
+	struct io_ring_sqe *sqe = &op->sqe;
+
+	switch (sqe->opcode) {
+	case IO_RING_OP_READ:
+	case IO_RING_OP_WRITE:
+	case IO_RING_OP_RECV:
+	case IO_RING_OP_SEND:
+	case IO_RING_OP_ACCEPT:
+		break;
+	case IO_RING_OP_FS_READ:
+	case IO_RING_OP_FS_WRITE:
+		if (!IS_ENABLED(CONFIG_FILE_SYSTEM)) {
+			return -ENOTSUP;
+		}
+
+		/* File objects are not kernel objects, so there is no way
+		 * to check that a user thread may access them.
+		 */
+		if (from_user) {
+			return -EPERM;
+		}
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if ((sqe->flags & IO_RING_SQE_MULTISHOT) &&
+	    sqe->opcode != IO_RING_OP_ACCEPT) {
+		return -EINVAL;
+	}
+
+	if (io_ring_op_is_fs(op)) {
+		return 0;
+	}
+
+	/* Only this object is used from now on, even if the descriptor
+	 * number gets reused before the operation runs.
+	 */
+	op->obj = z_get_fd_obj_and_vtable(sqe->fd, &op->vtable);
+	if (op->obj == NULL) {
+		return -EBADF;
+	}
+
+#if defined(CONFIG_USERSPACE)
+	if (from_user) {
+		bool write = sqe->opcode == IO_RING_OP_READ ||
+			     sqe->opcode == IO_RING_OP_RECV;
+		struct z_object *ko;
+
+		if (sqe->opcode != IO_RING_OP_ACCEPT &&
+		    Z_SYSCALL_MEMORY(sqe->buf, sqe->len, write)) {
+			return -EFAULT;
+		}
+
+		/* Objects which are not kernel objects cannot be checked,
+		 * and socket calls are only made on sockets.
+		 */
+		ko = z_object_find(op->obj);
+		if (ko == NULL ||
+		    z_object_validate(ko, io_ring_op_is_rw(op) ?
+				      K_OBJ_ANY : K_OBJ_NET_SOCKET,
+				      _OBJ_INIT_TRUE) != 0) {
+			return -EPERM;
+		}
+	}
+#endif
+
+	return 0;
+}
+
+static int io_ring_submit(struct io_ring_ctx *ctx, uint32_t to_submit,
+			  bool from_user)
+{
+	uint32_t tail = (uint32_t)atomic_get(&ctx->ring->sq_tail);
+	int submitted = 0;
+
+	while ((uint32_t)submitted < to_submit && ctx->sq_head != tail) {
+		struct io_ring_op *op;
+		int ret;
+
+		if (k_mem_slab_alloc(&io_ring_ops, (void **)&op,
+				     K_NO_WAIT) < 0) {
+			break;
+		}
+
+		op->ctx = ctx;
+		op->sqe = ctx->sqes[ctx->sq_head & ctx->sq_mask];
+		op->prepared = false;
+		op->from_user = from_user;
+
+		ctx->sq_head++;
+		submitted++;
+
+		ret = io_ring_op_check(op, from_user);
+		if (ret < 0) {
+			io_ring_op_complete(op, ret);
+			continue;
+		}
+
+		sys_dlist_append(&io_ring_pending, &op->node);
+	}
+
+	(void)atomic_set(&ctx->ring->sq_head, ctx->sq_head);
+
+	if (submitted == 0) {
+		return ctx->sq_head != tail && to_submit > 0 ? -EBUSY : 0;
+	}
+
+	k_poll_signal_raise(&io_ring_sig, 0);
+
+	return submitted;
+}
+
+#if defined(CONFIG_USERSPACE)
+/* Same check as z_object_validate(), but for the owner of the ring
+ * instead of the current thread.
+ */
+static bool io_ring_owner_has_access(struct io_ring_op *op)
+{
+	struct z_object *ko = z_object_find(op->obj);
+	struct z_object *thread_ko = z_object_find(op->ctx->owner);
+
+	if (ko == NULL || thread_ko == NULL) {
+		return false;
+	}
+
+	if ((ko->flags & K_OBJ_FLAG_PUBLIC) != 0U) {
+		return true;
+	}
+
+	return sys_bitfield_test_bit((mem_addr_t)&ko->perms,
+				     thread_ko->data.thread_id);
+}
+#endif
+
+/* Check that the operation can still run on the object resolved at submit
+ * time, called before polling and again before running it.
+ */
+static int io_ring_op_validate(struct io_ring_op *op)
+{
+	const struct fd_op_vtable *vtable;
+	void *obj;
+	int flags;
+
+	/* The descriptor was closed, and maybe reused, meanwhile */
+	obj = z_get_fd_obj_and_vtable(op->sqe.fd, &vtable);
+	if (obj != op->obj || vtable != op->vtable) {
+		return -EBADF;
+	}
+
+#if defined(CONFIG_USERSPACE)
+	/* A closed and re-created object at the same address is only
+	 * granted to the thread that created it again.
+	 */
+	if (op->from_user && !io_ring_owner_has_access(op)) {
+		return -EPERM;
+	}
+#endif
+
+	if (!io_ring_op_is_rw(op)) {
+		return 0;
+	}
+
+	/* read() and write() have no per call non-blocking flag */
+	if (vtable->ioctl == NULL) {
+		return -EINVAL;
+	}
+
+	flags = z_fdtable_call_ioctl(vtable, obj, F_GETFL);
+	if (flags < 0 || (flags & O_NONBLOCK) == 0) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int io_ring_op_prepare(struct io_ring_op *op,
+			      struct k_poll_event **pev,
+			      struct k_poll_event *pev_end)
+{
+	struct io_ring_sqe *sqe = &op->sqe;
+	int ret;
+
+	op->prepared = true;
+	op->pev = NULL;
+
+	if (io_ring_op_is_fs(op)) {
+		return -EALREADY;
+	}
+
+	ret = io_ring_op_validate(op);
+	if (ret < 0) {
+		return ret;
+	}
+
+	op->pfd.fd = sqe->fd;
+	op->pfd.revents = 0;
+	op->pfd.events = (sqe->opcode == IO_RING_OP_WRITE ||
+			  sqe->opcode == IO_RING_OP_SEND) ?
+			 ZSOCK_POLLOUT : ZSOCK_POLLIN;
+
+	if (op->vtable->ioctl == NULL) {
+		return -EALREADY;
+	}
+
+	op->pev = *pev;
+	ret = z_fdtable_call_ioctl(op->vtable, op->obj,
+				   ZFD_IOCTL_POLL_PREPARE,
+				   &op->pfd, pev, pev_end);
+	/* Some objects report errors through errno */
+	if (ret == -1) {
+		ret = -errno;
+	}
+
+	if (ret == -EOPNOTSUPP) {
+		/* Not pollable, treat as always ready */
+		op->pev = NULL;
+		return -EALREADY;
+	} else if (ret == -ENOMEM) {
+		/* Out of events, retry on the next iteration */
+		op->prepared = false;
+		return 0;
+	}
+
+	return ret;
+}
+
+static bool io_ring_op_ready(struct io_ring_op *op)
+{
+	struct k_poll_event *pev = op->pev;
+	int ret;
+
+	if (pev == NULL) {
+		return true;
+	}
+
+	ret = z_fdtable_call_ioctl(op->vtable, op->obj,
+				   ZFD_IOCTL_POLL_UPDATE, &op->pfd, &pev);
+	if (ret == -EAGAIN) {
+		return false;
+	} else if (ret != 0) {
+		/* Let the operation itself report the error */
+		return true;
+	}
+
+	return op->pfd.revents != 0;
+}
+
+static int io_ring_op_run(struct io_ring_op *op)
+{
+	const struct socket_op_vtable *vtable =
+		(const struct socket_op_vtable *)op->vtable;
+	struct io_ring_sqe *sqe = &op->sqe;
+	ssize_t ret;
+
+	if (!io_ring_op_is_fs(op)) {
+		ret = io_ring_op_validate(op);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	switch (sqe->opcode) {
+	case IO_RING_OP_READ:
+		if (op->vtable->read == NULL) {
+			return -EBADF;
+		}
+
+		ret = op->vtable->read(op->obj, sqe->buf, sqe->len);
+		break;
+	case IO_RING_OP_WRITE:
+		if (op->vtable->write == NULL) {
+			return -EBADF;
+		}
+
+		ret = op->vtable->write(op->obj, sqe->buf, sqe->len);
+		break;
+	case IO_RING_OP_RECV:
+		if (vtable->recvfrom == NULL) {
+			return -EBADF;
+		}
+
+		ret = vtable->recvfrom(op->obj, sqe->buf, sqe->len,
+				       sqe->op_flags | ZSOCK_MSG_DONTWAIT,
+				       NULL, NULL);
+		break;
+	case IO_RING_OP_SEND:
+		if (vtable->sendto == NULL) {
+			return -EBADF;
+		}
+
+		ret = vtable->sendto(op->obj, sqe->buf, sqe->len,
+				     sqe->op_flags | ZSOCK_MSG_DONTWAIT,
+				     NULL, 0);
+		break;
+	case IO_RING_OP_ACCEPT:
+		if (vtable->accept == NULL) {
+			return -EBADF;
+		}
+
+		/* Only run once the listening socket polled readable */
+		ret = vtable->accept(op->obj, NULL, NULL);
+#if defined(CONFIG_USERSPACE)
+		/* The new socket was granted to this thread only */
+		if (ret >= 0) {
+			k_object_access_grant(z_get_fd_obj(ret, NULL, 0),
+					      op->ctx->owner);
+		}
+#endif
+		break;
+#if defined(CONFIG_FILE_SYSTEM)
+	case IO_RING_OP_FS_READ:
+		return fs_read(sqe->file, sqe->buf, sqe->len);
+	case IO_RING_OP_FS_WRITE:
+		return fs_write(sqe->file, sqe->buf, sqe->len);
+#endif
+	default:
+		return -EINVAL;
+	}
+
+	if (ret < 0) {
+		return -errno;
+	}
+
+	return ret;
+}
+
+static void io_ring_service(void *p1, void *p2, void *p3)
+{
+	struct k_poll_event *pev_end = io_ring_events +
+				       ARRAY_SIZE(io_ring_events);
+	bool retry = false;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	k_poll_event_init(&io_ring_events[0], K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &io_ring_sig);
+
+	while (true) {
+		struct k_poll_event *pev = &io_ring_events[1];
+		struct io_ring_op *op, *next;
+		k_timeout_t timeout;
+		int ret;
+
+		/* Operations fail with EAGAIN rather than block, also when
+		 * polled as ready: writes on a full socket buffer do so even
+		 * though sockets always poll as writable. Retry those on the
+		 * next tick instead of spinning.
+		 */
+		timeout = retry ? K_TICKS(1) : K_FOREVER;
+
+		k_mutex_lock(&io_ring_lock, K_FOREVER);
+
+		SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&io_ring_pending, op, next,
+						  node) {
+			ret = io_ring_op_prepare(op, &pev, pev_end);
+			if (ret == -EALREADY) {
+				timeout = K_NO_WAIT;
+			} else if (ret < 0) {
+				sys_dlist_remove(&op->node);
+				io_ring_op_complete(op, ret);
+			}
+		}
+
+		k_mutex_unlock(&io_ring_lock);
+
+		/* EINTR is returned when a polled socket is closed */
+		(void)k_poll(io_ring_events, pev - io_ring_events, timeout);
+
+		io_ring_events[0].state = K_POLL_STATE_NOT_READY;
+		k_poll_signal_reset(&io_ring_sig);
+
+		k_mutex_lock(&io_ring_lock, K_FOREVER);
+
+		retry = false;
+
+		SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&io_ring_pending, op, next,
+						  node) {
+			/* Skip operations submitted or re-armed meanwhile */
+			if (!op->prepared || !io_ring_op_ready(op)) {
+				continue;
+			}
+
+			op->prepared = false;
+
+			ret = io_ring_op_run(op);
+			if (ret == -EAGAIN) {
+				retry = true;
+				continue;
+			}
+
+			sys_dlist_remove(&op->node);
+			io_ring_op_complete(op, ret);
+		}
+
+		k_mutex_unlock(&io_ring_lock);
+	}
+}
+
+K_THREAD_DEFINE(io_ring_thread, CONFIG_NET_SOCKETS_IO_RING_STACK_SIZE,
+		io_ring_service, NULL, NULL, NULL,
+		CONFIG_NET_SOCKETS_IO_RING_PRIORITY, 0, 0);
+
+/* Called with io_ring_lock held */
+static struct io_ring_ctx *io_ring_alloc(void)
+{
+#ifdef CONFIG_USERSPACE
+	struct z_object *zo;
+
+	if (io_ring_count == CONFIG_NET_SOCKETS_IO_RING_MAX) {
+		return NULL;
+	}
+
+	/* As for socketpair(), use a socket kernel object so that the
+	 * ring can be closed with zsock_close() from user mode.
+	 */
+	zo = z_dynamic_object_create(sizeof(struct io_ring_ctx));
+	if (zo == NULL) {
+		return NULL;
+	}
+
+	zo->type = K_OBJ_NET_SOCKET;
+	io_ring_count++;
+
+	return zo->name;
+#else
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(rings); i++) {
+		if (!rings[i].in_use) {
+			return &rings[i];
+		}
+	}
+
+	return NULL;
+#endif
+}
+
+/* Called with io_ring_lock held */
+static void io_ring_free(struct io_ring_ctx *ctx)
+{
+#ifdef CONFIG_USERSPACE
+	k_object_free(ctx);
+	io_ring_count--;
+#else
+	ctx->in_use = false;
+#endif
+}
+
+static int io_ring_create(struct io_ring *ring,
+			  struct io_ring_sqe *sqes, uint32_t sq_entries,
+			  struct io_ring_cqe *cqes, uint32_t cq_entries)
+{
+	struct io_ring_ctx *ctx;
+	int fd;
+
+	if (sqes == NULL || cqes == NULL ||
+	    sq_entries == 0 || !is_power_of_two(sq_entries) ||
+	    cq_entries == 0 || !is_power_of_two(cq_entries)) {
+		return -EINVAL;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		return -ENFILE;
+	}
+
+	k_mutex_lock(&io_ring_lock, K_FOREVER);
+
+	ctx = io_ring_alloc();
+	if (ctx == NULL) {
+		k_mutex_unlock(&io_ring_lock);
+		z_free_fd(fd);
+		return -ENOMEM;
+	}
+
+	ctx->ring = ring;
+	ctx->sqes = sqes;
+	ctx->cqes = cqes;
+	ctx->sq_mask = sq_entries - 1;
+	ctx->cq_mask = cq_entries - 1;
+	ctx->sq_head = 0;
+	ctx->cq_tail = 0;
+	ctx->owner = k_current_get();
+	ctx->in_use = true;
+	sys_dlist_init(&ctx->overflow);
+	k_sem_init(&ctx->cq_sem, 0, 1);
+
+	(void)atomic_set(&ring->sq_head, 0);
+	(void)atomic_set(&ring->sq_tail, 0);
+	(void)atomic_set(&ring->cq_head, 0);
+	(void)atomic_set(&ring->cq_tail, 0);
+	ring->fd = fd;
+
+	k_mutex_unlock(&io_ring_lock);
+
+	z_finalize_fd(fd, ctx,
+		      (const struct fd_op_vtable *)&io_ring_fd_vtable);
+
+	NET_DBG("io_ring: ctx=%p, fd=%d", ctx, fd);
+
+	return fd;
+}
+
+int z_impl_io_ring_setup(struct io_ring *ring)
+{
+	return io_ring_create(ring, ring->sqes, ring->sq_entries,
+			      ring->cqes, ring->cq_entries);
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_io_ring_setup(struct io_ring *ring)
+{
+	struct io_ring ring_copy;
+
+	Z_OOPS(z_user_from_copy(&ring_copy, ring, sizeof(ring_copy)));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(ring, sizeof(*ring)));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_READ(ring_copy.sqes,
+					   ring_copy.sq_entries,
+					   sizeof(struct io_ring_sqe)));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(ring_copy.cqes,
+					    ring_copy.cq_entries,
+					    sizeof(struct io_ring_cqe)));
+
+	return io_ring_create(ring, ring_copy.sqes, ring_copy.sq_entries,
+			      ring_copy.cqes, ring_copy.cq_entries);
+}
+#include <syscalls/io_ring_setup_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+static int io_ring_enter_fd(int ring_fd, uint32_t to_submit,
+			    uint32_t min_complete, k_timeout_t timeout,
+			    bool from_user)
+{
+	uint64_t end = sys_clock_timeout_end_calc(timeout);
+	struct io_ring_ctx *ctx;
+	int submitted;
+	int ret;
+
+	ctx = z_get_fd_obj(ring_fd,
+			   (const struct fd_op_vtable *)&io_ring_fd_vtable,
+			   EBADF);
+	if (ctx == NULL) {
+		return -EBADF;
+	}
+
+	if (from_user && ctx->owner != k_current_get()) {
+		return -EPERM;
+	}
+
+	k_mutex_lock(&io_ring_lock, K_FOREVER);
+
+	io_ring_flush_overflow(ctx);
+
+	submitted = io_ring_submit(ctx, to_submit, from_user);
+	if (submitted < 0) {
+		goto out;
+	}
+
+	min_complete = MIN(min_complete, ctx->cq_mask + 1);
+
+	while (ctx->cq_tail - (uint32_t)atomic_get(&ctx->ring->cq_head) <
+	       min_complete) {
+		k_timeout_t wait = timeout;
+
+		if (!K_TIMEOUT_EQ(timeout, K_NO_WAIT) &&
+		    !K_TIMEOUT_EQ(timeout, K_FOREVER)) {
+			int64_t remaining = end - sys_clock_tick_get();
+
+			if (remaining <= 0) {
+				wait = K_NO_WAIT;
+			} else {
+				wait = Z_TIMEOUT_TICKS(remaining);
+			}
+		}
+
+		k_mutex_unlock(&io_ring_lock);
+		ret = k_sem_take(&ctx->cq_sem, wait);
+		k_mutex_lock(&io_ring_lock, K_FOREVER);
+
+		if (ret < 0) {
+			if (submitted == 0) {
+				submitted = -EAGAIN;
+			}
+			break;
+		}
+	}
+
+out:
+	k_mutex_unlock(&io_ring_lock);
+
+	return submitted;
+}
+
+int z_impl_io_ring_enter(int ring_fd, uint32_t to_submit,
+			 uint32_t min_complete, k_timeout_t timeout)
+{
+	return io_ring_enter_fd(ring_fd, to_submit, min_complete, timeout,
+				false);
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_io_ring_enter(int ring_fd, uint32_t to_submit,
+				       uint32_t min_complete,
+				       k_timeout_t timeout)
+{
+	return io_ring_enter_fd(ring_fd, to_submit, min_complete, timeout,
+				true);
+}
+#include <syscalls/io_ring_enter_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+static ssize_t io_ring_read_op(void *obj, void *buf, size_t sz)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buf);
+	ARG_UNUSED(sz);
+
+	errno = ENOTSUP;
+	return -1;
+}
+
+static ssize_t io_ring_write_op(void *obj, const void *buf, size_t sz)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buf);
+	ARG_UNUSED(sz);
+
+	errno = ENOTSUP;
+	return -1;
+}
+
+static int io_ring_close_op(void *obj)
+{
+	struct io_ring_ctx *ctx = obj;
+	struct io_ring_op *op, *next;
+
+	k_mutex_lock(&io_ring_lock, K_FOREVER);
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&io_ring_pending, op, next, node) {
+		if (op->ctx == ctx) {
+			sys_dlist_remove(&op->node);
+			k_mem_slab_free(&io_ring_ops, (void **)&op);
+		}
+	}
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&ctx->overflow, op, next, node) {
+		/* Nobody will ever see these sockets */
+		if (op->sqe.opcode == IO_RING_OP_ACCEPT && op->res >= 0) {
+			(void)zsock_close(op->res);
+		}
+
+		sys_dlist_remove(&op->node);
+		k_mem_slab_free(&io_ring_ops, (void **)&op);
+	}
+
+	io_ring_free(ctx);
+
+	k_mutex_unlock(&io_ring_lock);
+
+	return 0;
+}
+
+static int io_ring_ioctl_op(void *obj, unsigned int request, va_list args)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(request);
+	ARG_UNUSED(args);
+
+	errno = EOPNOTSUPP;
+	return -1;
+}
+
+/* Only the fd methods are provided, socket calls fail with EBADF */
+static const struct socket_op_vtable io_ring_fd_vtable = {
+	.fd_vtable = {
+		.read = io_ring_read_op,
+		.write = io_ring_write_op,
+		.close = io_ring_close_op,
+		.ioctl = io_ring_ioctl_op,
+	},
+};
@@ -32,6 +32,8 @@ LOG_MODULE_REGISTER(net_sock_tls, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <mbedtls/x509_crt.h>
 #include <mbedtls/ssl.h>
 #include <mbedtls/ssl_cookie.h>
+#include <mbedtls/ssl_cache.h>
+#include <mbedtls/ssl_ticket.h>
 #include <mbedtls/error.h>
 #include <mbedtls/debug.h>
 #endif /* CONFIG_MBEDTLS */
@@ -120,6 +122,9 @@ __net_socket struct tls_context {
 		 * protocols.
 		 */
 		const char *alpn_list[ALPN_MAX_PROTOCOLS];
+
+		/** Information whether session caching is enabled. */
+		bool cache_enabled;
 	} options;
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -169,6 +174,49 @@ static struct tls_context tls_contexts[CONFIG_NET_SOCKETS_TLS_MAX_CONTEXTS];
 /* A mutex for protecting TLS context allocation. */
 static struct k_mutex context_lock;
 
+/* A mutex for protecting the session caches. */
+static struct k_mutex session_lock;
+
+#if defined(MBEDTLS_SSL_CLI_C)
+/** Client session stored for resumption. */
+struct tls_session_cache {
+	/** Information whether the entry holds a session. */
+	bool is_used;
+
+	/** Uptime of the last use, to replace the least recently used. */
+	uint32_t timestamp;
+
+	/** Address of the peer the session was established with. */
+	struct sockaddr peer_addr;
+
+	/** Peer address length. */
+	socklen_t peer_addrlen;
+
+	/** mbedTLS session. */
+	mbedtls_ssl_session session;
+};
+
+static struct tls_session_cache
+	client_cache[CONFIG_NET_SOCKETS_TLS_MAX_CLIENT_SESSION_COUNT];
+#endif /* MBEDTLS_SSL_CLI_C */
+
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_CACHE_C)
+static mbedtls_ssl_cache_context server_cache;
+#endif
+
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_TICKET_C) && \
+	defined(MBEDTLS_SSL_SESSION_TICKETS)
+#define TLS_SERVER_TICKETS 1
+static mbedtls_ssl_ticket_context server_ticket;
+static bool server_ticket_ready;
+
+#if defined(MBEDTLS_GCM_C)
+#define TLS_TICKET_CIPHER MBEDTLS_CIPHER_AES_256_GCM
+#else
+#define TLS_TICKET_CIPHER MBEDTLS_CIPHER_AES_256_CCM
+#endif
+#endif
+
 bool net_socket_is_tls(void *obj)
 {
 	return PART_OF_ARRAY(tls_contexts, (struct tls_context *)obj);
@@ -276,6 +324,39 @@ static int dtls_timing_get_delay(void *data)
 }
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_CACHE_C)
+static void server_cache_init(void)
+{
+	mbedtls_ssl_cache_init(&server_cache);
+	mbedtls_ssl_cache_set_max_entries(
+		&server_cache, CONFIG_NET_SOCKETS_TLS_MAX_SERVER_SESSION_COUNT);
+#if defined(MBEDTLS_HAVE_TIME)
+	mbedtls_ssl_cache_set_timeout(&server_cache,
+				      CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME);
+#endif
+}
+#endif
+
+#if defined(TLS_SERVER_TICKETS)
+static void server_ticket_init(void)
+{
+	int ret;
+
+	mbedtls_ssl_ticket_init(&server_ticket);
+
+	ret = mbedtls_ssl_ticket_setup(&server_ticket, mbedtls_ctr_drbg_random,
+				       &tls_ctr_drbg, TLS_TICKET_CIPHER,
+				       CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME);
+	if (ret != 0) {
+		NET_WARN("Session tickets not available: -%x", -ret);
+		mbedtls_ssl_ticket_free(&server_ticket);
+		return;
+	}
+
+	server_ticket_ready = true;
+}
+#endif
+
 /* Initialize TLS internals. */
 static int tls_init(const struct device *unused)
 {
@@ -298,6 +379,7 @@ static int tls_init(const struct device *unused)
 	(void)memset(tls_contexts, 0, sizeof(tls_contexts));
 
 	k_mutex_init(&context_lock);
+	k_mutex_init(&session_lock);
 
 	mbedtls_ctr_drbg_init(&tls_ctr_drbg);
 
@@ -309,6 +391,13 @@ static int tls_init(const struct device *unused)
 		return -EFAULT;
 	}
 
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_CACHE_C)
+	server_cache_init();
+#endif
+#if defined(TLS_SERVER_TICKETS)
+	server_ticket_init();
+#endif
+
 #if defined(MBEDTLS_DEBUG_C) && (CONFIG_NET_SOCKETS_LOG_LEVEL >= LOG_LEVEL_DBG)
 	mbedtls_debug_set_threshold(CONFIG_MBEDTLS_DEBUG_LEVEL);
 #endif
@@ -473,6 +562,230 @@ static int tls_release(struct tls_context *tls)
 	return 0;
 }
 
+#if defined(MBEDTLS_SSL_CLI_C)
+static struct tls_session_cache *tls_session_find(const struct sockaddr *addr,
+						  socklen_t addrlen)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client_cache); i++) {
+		if (client_cache[i].is_used &&
+		    client_cache[i].peer_addrlen == addrlen &&
+		    memcmp(&client_cache[i].peer_addr, addr, addrlen) == 0) {
+			return &client_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void tls_session_free(struct tls_session_cache *entry)
+{
+	mbedtls_ssl_session_free(&entry->session);
+	entry->is_used = false;
+}
+
+/* Store the session of an established client connection. */
+static void tls_session_store(struct tls_context *context,
+			      const struct sockaddr *addr, socklen_t addrlen)
+{
+	struct tls_session_cache *entry;
+	int ret, i;
+
+	if (!context->options.cache_enabled ||
+	    addrlen > sizeof(entry->peer_addr)) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(addr, addrlen);
+	if (!entry) {
+		entry = &client_cache[0];
+
+		for (i = 0; i < ARRAY_SIZE(client_cache); i++) {
+			if (!client_cache[i].is_used) {
+				entry = &client_cache[i];
+				break;
+			}
+
+			if ((int32_t)(client_cache[i].timestamp -
+				      entry->timestamp) < 0) {
+				entry = &client_cache[i];
+			}
+		}
+	}
+
+	if (entry->is_used) {
+		tls_session_free(entry);
+	}
+
+	mbedtls_ssl_session_init(&entry->session);
+
+	ret = mbedtls_ssl_get_session(&context->ssl, &entry->session);
+	if (ret != 0) {
+		NET_DBG("Failed to store TLS session: -%x", -ret);
+		mbedtls_ssl_session_free(&entry->session);
+		goto out;
+	}
+
+	memcpy(&entry->peer_addr, addr, addrlen);
+	entry->peer_addrlen = addrlen;
+	entry->timestamp = k_uptime_get_32();
+	entry->is_used = true;
+
+out:
+	k_mutex_unlock(&session_lock);
+}
+
+/* Offer the session stored for the peer in the next client handshake. */
+static void tls_session_restore(struct tls_context *context,
+				const struct sockaddr *addr, socklen_t addrlen)
+{
+	struct tls_session_cache *entry;
+	int ret;
+
+	if (!context->options.cache_enabled) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(addr, addrlen);
+	if (entry) {
+		ret = mbedtls_ssl_set_session(&context->ssl, &entry->session);
+		if (ret != 0) {
+			NET_DBG("Failed to restore TLS session: -%x", -ret);
+		}
+
+		entry->timestamp = k_uptime_get_32();
+	}
+
+	k_mutex_unlock(&session_lock);
+}
+
+/* Drop the session stored for the peer, e.g. after a failed handshake. */
+static void tls_session_delete(struct tls_context *context,
+			       const struct sockaddr *addr, socklen_t addrlen)
+{
+	struct tls_session_cache *entry;
+
+	if (!context->options.cache_enabled) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(addr, addrlen);
+	if (entry) {
+		tls_session_free(entry);
+	}
+
+	k_mutex_unlock(&session_lock);
+}
+#else
+#define tls_session_store(...)
+#define tls_session_restore(...)
+#define tls_session_delete(...)
+#endif /* MBEDTLS_SSL_CLI_C */
+
+static void tls_session_purge(void)
+{
+#if defined(MBEDTLS_SSL_CLI_C)
+	int i;
+#endif
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+#if defined(MBEDTLS_SSL_CLI_C)
+	for (i = 0; i < ARRAY_SIZE(client_cache); i++) {
+		if (client_cache[i].is_used) {
+			tls_session_free(&client_cache[i]);
+		}
+	}
+#endif
+
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_cache_free(&server_cache);
+	server_cache_init();
+#endif
+
+	k_mutex_unlock(&session_lock);
+}
+
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_CACHE_C)
+/* mbedTLS is not built with threading support, so the cache shared by all
+ * server contexts is accessed under the session lock.
+ */
+static int server_cache_get(void *data, mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_get(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int server_cache_set(void *data, const mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_set(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif
+
+#if defined(TLS_SERVER_TICKETS)
+static int server_ticket_write(void *p_ticket,
+			       const mbedtls_ssl_session *session,
+			       unsigned char *start, const unsigned char *end,
+			       size_t *tlen, uint32_t *lifetime)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_write(p_ticket, session, start, end, tlen,
+				       lifetime);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int server_ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+			       unsigned char *buf, size_t len)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif
+
+static void tls_session_server_setup(struct tls_context *context)
+{
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_conf_session_cache(&context->config, &server_cache,
+				       server_cache_get, server_cache_set);
+#endif
+
+#if defined(TLS_SERVER_TICKETS)
+	if (server_ticket_ready) {
+		mbedtls_ssl_conf_session_tickets_cb(&context->config,
+						    server_ticket_write,
+						    server_ticket_parse,
+						    &server_ticket);
+	}
+#endif
+}
+
 static inline int time_left(uint32_t start, uint32_t timeout)
 {
 	uint32_t elapsed = k_uptime_get_32() - start;
@@ -974,6 +1287,10 @@ static int tls_mbedtls_init(struct tls_context *context, bool is_server)
 			     mbedtls_ctr_drbg_random,
 			     &tls_ctr_drbg);
 
+	if (is_server && context->options.cache_enabled) {
+		tls_session_server_setup(context);
+	}
+
 	ret = tls_mbedtls_set_credentials(context);
 	if (ret != 0) {
 		return ret;
@@ -1263,6 +1580,57 @@ static int tls_opt_dtls_role_set(struct tls_context *context,
 	return 0;
 }
 
+static int tls_opt_session_cache_set(struct tls_context *context,
+				     const void *optval, socklen_t optlen)
+{
+	int *cache;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	cache = (int *)optval;
+	if (*cache != TLS_SESSION_CACHE_DISABLED &&
+	    *cache != TLS_SESSION_CACHE_ENABLED) {
+		return -EINVAL;
+	}
+
+	context->options.cache_enabled = (*cache == TLS_SESSION_CACHE_ENABLED);
+
+	return 0;
+}
+
+static int tls_opt_session_cache_get(struct tls_context *context,
+				     void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->options.cache_enabled ?
+			 TLS_SESSION_CACHE_ENABLED :
+			 TLS_SESSION_CACHE_DISABLED;
+
+	return 0;
+}
+
+static int tls_opt_session_cache_purge_set(struct tls_context *context,
+					   const void *optval,
+					   socklen_t optlen)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(optval);
+	ARG_UNUSED(optlen);
+
+	tls_session_purge();
+
+	return 0;
+}
+
 static int protocol_check(int family, int type, int *proto)
 {
 	if (family != AF_INET && family != AF_INET6) {
@@ -1380,6 +1748,8 @@ int ztls_connect_ctx(struct tls_context *ctx, const struct sockaddr *addr,
 			goto error;
 		}
 
+		tls_session_restore(ctx, addr, addrlen);
+
 		/* Do not use any socket flags during the handshake. */
 		ctx->flags = 0;
 
@@ -1388,8 +1758,11 @@ int ztls_connect_ctx(struct tls_context *ctx, const struct sockaddr *addr,
 		 */
 		ret = tls_mbedtls_handshake(ctx, true);
 		if (ret < 0) {
+			tls_session_delete(ctx, addr, addrlen);
 			goto error;
 		}
+
+		tls_session_store(ctx, addr, addrlen);
 	} else {
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 		/* Just store the address. */
@@ -1523,13 +1896,21 @@ static ssize_t sendto_dtls_client(struct tls_context *ctx, const void *buf,
 	}
 
 	if (!is_handshake_complete(ctx)) {
+		tls_session_restore(ctx, &ctx->dtls_peer_addr,
+				    ctx->dtls_peer_addrlen);
+
 		/* TODO For simplicity, TLS handshake blocks the socket even for
 		 * non-blocking socket.
 		 */
 		ret = tls_mbedtls_handshake(ctx, true);
 		if (ret < 0) {
+			tls_session_delete(ctx, &ctx->dtls_peer_addr,
+					   ctx->dtls_peer_addrlen);
 			goto error;
 		}
+
+		tls_session_store(ctx, &ctx->dtls_peer_addr,
+				  ctx->dtls_peer_addrlen);
 	}
 
 	return send_tls(ctx, buf, len, flags);
@@ -2142,6 +2523,10 @@ int ztls_getsockopt_ctx(struct tls_context *ctx, int level, int optname,
 		err = tls_opt_alpn_list_get(ctx, optval, optlen);
 		break;
 
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_get(ctx, optval, optlen);
+		break;
+
 	default:
 		/* Unknown or write-only option. */
 		err = -ENOPROTOOPT;
@@ -2191,6 +2576,14 @@ int ztls_setsockopt_ctx(struct tls_context *ctx, int level, int optname,
 		err = tls_opt_alpn_list_set(ctx, optval, optlen);
 		break;
 
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_set(ctx, optval, optlen);
+		break;
+
+	case TLS_SESSION_CACHE_PURGE:
+		err = tls_opt_session_cache_purge_set(ctx, optval, optlen);
+		break;
+
 	default:
 		/* Unknown or read-only option. */
 		err = -ENOPROTOOPT;
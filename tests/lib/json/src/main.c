@@ -539,6 +539,304 @@ static void test_json_encode_bounds_check(void)
 	zassert_equal(ret, -ENOMEM, "Bounds check rejected");
 }
 
+struct test_int64 {
+	int64_t big;
+	int64_t small;
+	int64_t list[4];
+	size_t list_len;
+	int32_t i32;
+};
+
+static const struct json_obj_descr int64_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct test_int64, big, JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct test_int64, small, JSON_TOK_INT64),
+	JSON_OBJ_DESCR_ARRAY(struct test_int64, list, 4, list_len,
+			     JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct test_int64, i32, JSON_TOK_NUMBER),
+};
+
+static void test_json_int64(void)
+{
+	struct test_int64 ti = {
+		.big = INT64_MAX,
+		.small = INT64_MIN,
+		.list = { 0, -1, 4294967296LL, -4294967296LL },
+		.list_len = 4,
+		.i32 = -7,
+	};
+	const char expected[] = "{\"big\":9223372036854775807,"
+		"\"small\":-9223372036854775808,"
+		"\"list\":[0,-1,4294967296,-4294967296],"
+		"\"i32\":-7}";
+	char buffer[sizeof(expected)];
+	struct test_int64 decoded;
+	int ret;
+
+	ret = json_obj_encode_buf(int64_descr, ARRAY_SIZE(int64_descr), &ti,
+				  buffer, sizeof(buffer));
+	zassert_equal(ret, 0, "Encoding 64-bit numbers returned no errors");
+	zassert_true(!strcmp(buffer, expected), "64-bit numbers encoded");
+
+	ret = json_obj_parse(buffer, strlen(buffer), int64_descr,
+			     ARRAY_SIZE(int64_descr), &decoded);
+	zassert_equal(ret, (1 << ARRAY_SIZE(int64_descr)) - 1,
+		      "64-bit numbers decoded");
+	zassert_equal(decoded.big, INT64_MAX, "Maximum decoded correctly");
+	zassert_equal(decoded.small, INT64_MIN, "Minimum decoded correctly");
+	zassert_equal(decoded.list_len, 4, "Array length decoded");
+	zassert_true(!memcmp(decoded.list, ti.list, sizeof(ti.list)),
+		     "Array decoded with expected values");
+	zassert_equal(decoded.i32, -7, "Integer decoded correctly");
+
+	strcpy(buffer, "{\"big\":9223372036854775808}");
+	ret = json_obj_parse(buffer, strlen(buffer), int64_descr,
+			     ARRAY_SIZE(int64_descr), &decoded);
+	zassert_equal(ret, -ERANGE, "Out of range number rejected");
+}
+
+/* Feed a document in chunks of a given size */
+static int stream_parse(const char *json, size_t len, size_t chunk,
+			const struct json_obj_descr *descr, size_t descr_len,
+			void *val, char *str_buf, size_t str_buf_size)
+{
+	struct json_obj_stream stream;
+	size_t pos;
+	int ret = -EAGAIN;
+
+	json_obj_stream_init(&stream, descr, descr_len, val, str_buf,
+			     str_buf_size);
+
+	for (pos = 0; pos < len && ret == -EAGAIN; pos += chunk) {
+		ret = json_obj_stream_feed(&stream, json + pos,
+					   MIN(chunk, len - pos));
+	}
+
+	return ret;
+}
+
+static void test_json_stream_decoding(void)
+{
+	/* no commas after some of the values, as in test_json_decoding() */
+	const char encoded[] = "{\"some_string\":\"zephyr 123\\uABCD456\","
+		"\"unknown\":{\"a\":[1,2.5,{\"b\":\"}\"}],\"c\":false},"
+		"\"some_int\":\t42\n,"
+		"\"some_bool\":true    \t  \n\r   ,"
+		"\"some_nested_struct\":{    "
+		"\"nested_int\":-1234,\n\n"
+		"\"nested_bool\":false,\t"
+		"\"nested_string\":\"this should be escaped: \\t\"},"
+		"\"some_array\":[11,22, 33,\t45,\n299]"
+		"\"another_b!@l\":true,"
+		"\"if\":false,"
+		"\"another-array\":[2,3,5,7],"
+		"\"4nother_ne$+\":{\"nested_int\":1234,"
+		"\"nested_bool\":true,"
+		"\"nested_string\":\"no escape necessary\"}"
+		"}trailing data";
+	const size_t chunks[] = { 1, 2, 3, 7, 64, sizeof(encoded) };
+	const int expected_array[] = { 11, 22, 33, 45, 299 };
+	struct test_struct ts;
+	char strings[128];
+	int i, ret;
+
+	for (i = 0; i < ARRAY_SIZE(chunks); i++) {
+		(void)memset(&ts, 0, sizeof(ts));
+
+		ret = stream_parse(encoded, sizeof(encoded) - 1, chunks[i],
+				   test_descr, ARRAY_SIZE(test_descr), &ts,
+				   strings, sizeof(strings));
+
+		zassert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+			      "All fields decoded in chunks of %u",
+			      chunks[i]);
+		zassert_true(!strcmp(ts.some_string, "zephyr 123\\uABCD456"),
+			     "String decoded correctly");
+		zassert_equal(ts.some_int, 42, "Integer decoded correctly");
+		zassert_equal(ts.some_bool, true, "Boolean decoded correctly");
+		zassert_equal(ts.some_nested_struct.nested_int, -1234,
+			      "Nested integer decoded correctly");
+		zassert_true(!strcmp(ts.some_nested_struct.nested_string,
+				     "this should be escaped: \\t"),
+			     "Nested string decoded correctly");
+		zassert_equal(ts.some_array_len, 5, "Array length decoded");
+		zassert_true(!memcmp(ts.some_array, expected_array,
+				     sizeof(expected_array)),
+			     "Array decoded with expected values");
+		zassert_true(ts.another_bxxl, "Named boolean decoded");
+		zassert_false(ts.if_, "Named boolean decoded");
+		zassert_equal(ts.another_array_len, 4, "Named array decoded");
+		zassert_equal(ts.xnother_nexx.nested_int, 1234,
+			      "Named nested integer decoded correctly");
+		zassert_true(!strcmp(ts.xnother_nexx.nested_string,
+				     "no escape necessary"),
+			     "Named nested string decoded correctly");
+	}
+}
+
+static void test_json_stream_errors(void)
+{
+	const struct {
+		const char *str;
+		size_t str_buf_size;
+		int result;
+	} tests[] = {
+		{ "{\"some_int\":42", 0, -EAGAIN },
+		{ "{\"some_int\":\"42\"}", 16, -EINVAL },
+		{ "{\"some_int\":4294967296}", 0, -ERANGE },
+		{ "{\"some_int\":4.2}", 0, -EINVAL },
+		{ "{\"some_int\":-}", 0, -EINVAL },
+		{ "{\"some_bool\":ture}", 0, -EINVAL },
+		{ "{\"some_bool\":null}", 0, -EINVAL },
+		{ "{\"some_string\":\"\\x\"}", 16, -EINVAL },
+		{ "{\"some_string\":\"too long\"}", 8, -ENOMEM },
+		{ "{\"some_array\":[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,"
+		  "17]}", 0, -ENOSPC },
+		{ "{\"a\":[[[[[[[[1]]]]]]]]}", 0, -ENOMEM },
+		{ "[]", 0, -EINVAL },
+	};
+	struct test_struct ts;
+	char strings[16];
+	int i, ret;
+
+	for (i = 0; i < ARRAY_SIZE(tests); i++) {
+		ret = stream_parse(tests[i].str, strlen(tests[i].str), 1,
+				   test_descr, ARRAY_SIZE(test_descr), &ts,
+				   strings, tests[i].str_buf_size);
+		zassert_equal(ret, tests[i].result,
+			      "Decoding '%s' result %d, expected %d",
+			      tests[i].str, ret, tests[i].result);
+	}
+}
+
+struct flushed {
+	char buf[512];
+	size_t len;
+	int count;
+};
+
+static int flush_to_buf(const char *bytes, size_t len, void *data)
+{
+	struct flushed *flushed = data;
+
+	if (len > sizeof(flushed->buf) - flushed->len) {
+		return -ENOMEM;
+	}
+
+	memcpy(flushed->buf + flushed->len, bytes, len);
+	flushed->len += len;
+	flushed->count++;
+
+	return 0;
+}
+
+static void test_json_out_stream(void)
+{
+	struct test_struct ts = {
+		.some_string = "escaped \"quotes\"\n",
+		.some_int = -1,
+		.some_nested_struct = {
+			.nested_string = "",
+		},
+		.some_array = { 1, 2, 3 },
+		.some_array_len = 3,
+		.xnother_nexx = {
+			.nested_string = "\t",
+		},
+	};
+	struct json_out_stream out;
+	struct flushed flushed = { 0 };
+	char expected[512];
+	char chunk[16];
+	int ret;
+
+	ret = json_obj_encode_buf(test_descr, ARRAY_SIZE(test_descr), &ts,
+				  expected, sizeof(expected));
+	zassert_equal(ret, 0, "Encoding returned no errors");
+
+	json_out_stream_init(&out, chunk, sizeof(chunk), flush_to_buf,
+			     &flushed);
+	ret = json_obj_encode_stream(test_descr, ARRAY_SIZE(test_descr), &ts,
+				     &out);
+	zassert_equal(ret, 0, "Stream encoding returned no errors");
+	zassert_equal(flushed.len, strlen(expected), "Whole object flushed");
+	zassert_true(!memcmp(flushed.buf, expected, flushed.len),
+		     "Stream encoding consistent");
+	zassert_equal(flushed.count,
+		      ceiling_fraction(flushed.len, sizeof(chunk)),
+		      "Only full chunks flushed");
+}
+
+#define BENCH_ROUNDS 200
+#define BENCH_CHUNK 64
+
+static void test_json_stream_bench(void)
+{
+	struct obj_array oa = {
+		.elements = {
+			[0] = { .name = "Simón Bolívar",   .height = 168 },
+			[1] = { .name = "Muggsy Bogues",   .height = 160 },
+			[2] = { .name = "Pelé",            .height = 173 },
+			[3] = { .name = "Hakeem Olajuwon", .height = 213 },
+			[4] = { .name = "Alex Honnold",    .height = 180 },
+			[5] = { .name = "Hazel Findlay",   .height = 157 },
+			[6] = { .name = "Daila Ojeda",     .height = 158 },
+			[7] = { .name = "Albert Einstein", .height = 172 },
+			[8] = { .name = "Usain Bolt",      .height = 195 },
+			[9] = { .name = "Paavo Nurmi",     .height = 174 },
+		},
+		.num_elements = 10,
+	};
+	static char encoded[512];
+	static char parsed[512];
+	static char strings[256];
+	struct obj_array decoded;
+	uint32_t start, parse_cycles = 0U, stream_cycles;
+	uint64_t parse_rate, stream_rate;
+	size_t len;
+	int i, ret;
+
+	ret = json_obj_encode_buf(obj_array_descr, ARRAY_SIZE(obj_array_descr),
+				  &oa, encoded, sizeof(encoded));
+	zassert_equal(ret, 0, "Encoding returned no errors");
+	len = strlen(encoded);
+
+	/* json_obj_parse() modifies its input, only the parsing is timed */
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		memcpy(parsed, encoded, len);
+
+		start = k_cycle_get_32();
+		ret = json_obj_parse(parsed, len, obj_array_descr,
+				     ARRAY_SIZE(obj_array_descr), &decoded);
+		parse_cycles += k_cycle_get_32() - start;
+
+		zassert_equal(ret, 1, "Parsing failed");
+	}
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		ret = stream_parse(encoded, len, BENCH_CHUNK, obj_array_descr,
+				   ARRAY_SIZE(obj_array_descr), &decoded,
+				   strings, sizeof(strings));
+		zassert_equal(ret, 1, "Stream parsing failed");
+	}
+
+	stream_cycles = k_cycle_get_32() - start;
+
+	zassert_equal(decoded.num_elements, 10, "Elements decoded");
+	zassert_true(!strcmp(decoded.elements[9].name, "Paavo Nurmi"),
+		     "Elements decoded correctly");
+
+	parse_rate = (uint64_t)len * BENCH_ROUNDS * NSEC_PER_SEC /
+		     MAX(k_cyc_to_ns_floor64(parse_cycles), 1U);
+	stream_rate = (uint64_t)len * BENCH_ROUNDS * NSEC_PER_SEC /
+		      MAX(k_cyc_to_ns_floor64(stream_cycles), 1U);
+
+	TC_PRINT("json_obj_parse: %u bytes/s, json_obj_stream_feed "
+		 "(%u byte chunks): %u bytes/s\n", (uint32_t)parse_rate,
+		 BENCH_CHUNK, (uint32_t)stream_rate);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(lib_json_test,
@@ -560,7 +858,12 @@ void test_main(void)
 			 ztest_unit_test(test_json_escape_empty),
 			 ztest_unit_test(test_json_escape_no_op),
 			 ztest_unit_test(test_json_escape_bounds_check),
-			 ztest_unit_test(test_json_encode_bounds_check)
+			 ztest_unit_test(test_json_encode_bounds_check),
+			 ztest_unit_test(test_json_int64),
+			 ztest_unit_test(test_json_stream_decoding),
+			 ztest_unit_test(test_json_stream_errors),
+			 ztest_unit_test(test_json_out_stream),
+			 ztest_unit_test(test_json_stream_bench)
 			 );
 
 	ztest_run_test_suite(lib_json_test);
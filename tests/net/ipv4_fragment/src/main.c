@@ -0,0 +1,399 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <sys/byteorder.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+
+#define TEST_MTU 576
+#define TEST_PORT 4242
+#define MAX_FRAGMENTS 8
+
+/* UDP header + user data does not fit into one TEST_MTU sized packet
+ * so it is split into three fragments: 552 + 552 + 304 bytes.
+ */
+#define TEST_DATA_LEN 1400
+#define TEST_FRAGMENT_COUNT 3
+
+#define WAIT_TIME K_MSEC(500)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+static struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+
+static uint8_t send_data[TEST_DATA_LEN];
+static uint8_t recv_data[TEST_DATA_LEN];
+static uint8_t frag_data[TEST_MTU];
+
+static struct net_pkt *pending[MAX_FRAGMENTS];
+static int pending_count;
+static int frag_count;
+static bool reverse_order;
+static bool drop_last;
+static bool test_failed;
+static bool data_ok;
+
+static struct k_sem wait_data;
+
+struct net_if_test {
+	uint8_t idx;
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+/* Verify the sent fragment and turn it into a received one by swapping
+ * the IPv4 addresses. The IPv4 header and UDP checksums stay valid as
+ * the sums do not depend on the order of the addresses.
+ */
+static struct net_pkt *loop_fragment(struct net_pkt *pkt, bool *last)
+{
+	struct net_ipv4_hdr *hdr = (struct net_ipv4_hdr *)frag_data;
+	size_t len = net_pkt_get_len(pkt);
+	struct net_pkt *rx;
+	struct in_addr addr;
+	uint16_t flag;
+
+	if (len > TEST_MTU) {
+		NET_DBG("Fragment len %zd larger than MTU", len);
+		return NULL;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_read(pkt, frag_data, len)) {
+		return NULL;
+	}
+
+	if (ntohs(hdr->len) != len) {
+		NET_DBG("Invalid IPv4 length %u", ntohs(hdr->len));
+		return NULL;
+	}
+
+	flag = sys_get_be16(hdr->offset);
+	if ((flag & NET_IPV4_MF) && ((len - NET_IPV4H_LEN) % 8)) {
+		NET_DBG("Fragment payload %zd is not multiple of 8", len);
+		return NULL;
+	}
+
+	*last = !(flag & NET_IPV4_MF);
+
+	net_ipaddr_copy(&addr, &hdr->src);
+	net_ipaddr_copy(&hdr->src, &hdr->dst);
+	net_ipaddr_copy(&hdr->dst, &addr);
+
+	rx = net_pkt_rx_alloc_with_buffer(net_pkt_iface(pkt), len, AF_UNSPEC,
+					  0, K_NO_WAIT);
+	if (!rx) {
+		return NULL;
+	}
+
+	if (net_pkt_write(rx, frag_data, len)) {
+		net_pkt_unref(rx);
+		return NULL;
+	}
+
+	return rx;
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	struct net_pkt *rx;
+	bool last = false;
+	int i;
+
+	if (!pkt->buffer) {
+		NET_DBG("No data to send!");
+		return -ENODATA;
+	}
+
+	frag_count++;
+
+	rx = loop_fragment(pkt, &last);
+	if (!rx) {
+		test_failed = true;
+		goto out;
+	}
+
+	if (drop_last && last) {
+		net_pkt_unref(rx);
+		goto out;
+	}
+
+	if (!reverse_order) {
+		if (net_recv_data(net_pkt_iface(rx), rx) < 0) {
+			net_pkt_unref(rx);
+			test_failed = true;
+		}
+
+		goto out;
+	}
+
+	pending[pending_count++] = rx;
+
+	if (!last && pending_count < MAX_FRAGMENTS) {
+		goto out;
+	}
+
+	for (i = pending_count - 1; i >= 0; i--) {
+		if (net_recv_data(net_pkt_iface(pending[i]), pending[i]) < 0) {
+			net_pkt_unref(pending[i]);
+			test_failed = true;
+		}
+
+		pending[i] = NULL;
+	}
+
+	pending_count = 0;
+
+out:
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 TEST_MTU);
+
+static struct net_if *iface;
+static struct net_context *send_ctx;
+static struct net_context *recv_ctx;
+
+static void recv_cb(struct net_context *context,
+		    struct net_pkt *pkt,
+		    union net_ip_header *ip_hdr,
+		    union net_proto_header *proto_hdr,
+		    int status,
+		    void *user_data)
+{
+	size_t len = net_pkt_remaining_data(pkt);
+
+	NET_DBG("Received %zd bytes", len);
+
+	data_ok = (len == sizeof(recv_data)) &&
+		!net_pkt_read(pkt, recv_data, len) &&
+		!memcmp(recv_data, send_data, len);
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_data);
+}
+
+static void test_setup(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(TEST_PORT),
+	};
+	struct net_if_addr *ifaddr;
+	int ret, i;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	/* The loopback interface is also a dummy one if it is enabled */
+	iface = net_if_lookup_by_dev(device_get_binding("iface1"));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	for (i = 0; i < sizeof(send_data); i++) {
+		send_data[i] = (uint8_t)i;
+	}
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &recv_ctx);
+	zassert_equal(ret, 0, "Cannot get receive context (%d)", ret);
+
+	net_ipaddr_copy(&addr.sin_addr, &my_addr);
+
+	ret = net_context_bind(recv_ctx, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	zassert_equal(ret, 0, "Cannot bind receive context (%d)", ret);
+
+	ret = net_context_recv(recv_ctx, recv_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot set receive callback (%d)", ret);
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &send_ctx);
+	zassert_equal(ret, 0, "Cannot get send context (%d)", ret);
+}
+
+static void send_large_datagram(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(TEST_PORT),
+	};
+	int ret;
+
+	net_ipaddr_copy(&addr.sin_addr, &peer_addr);
+
+	frag_count = 0;
+	data_ok = false;
+	test_failed = false;
+
+	ret = net_context_sendto(send_ctx, send_data, sizeof(send_data),
+				 (struct sockaddr *)&addr, sizeof(addr),
+				 NULL, K_NO_WAIT, NULL);
+	zassert_equal(ret, sizeof(send_data), "Send failed (%d)", ret);
+}
+
+static void test_send_recv_ipv4_fragment(void)
+{
+	reverse_order = false;
+	drop_last = false;
+
+	send_large_datagram();
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Timeout while waiting reassembled data");
+	zassert_false(test_failed, "Fragment verify failed");
+	zassert_equal(frag_count, TEST_FRAGMENT_COUNT,
+		      "Invalid number of fragments (%d)", frag_count);
+	zassert_true(data_ok, "Reassembled data mismatch");
+}
+
+static void test_recv_ipv4_fragment_reverse_order(void)
+{
+	reverse_order = true;
+	drop_last = false;
+
+	send_large_datagram();
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Timeout while waiting reassembled data");
+	zassert_false(test_failed, "Fragment verify failed");
+	zassert_true(data_ok, "Reassembled data mismatch");
+}
+
+static int pending_cb_count;
+
+static void pending_cb(struct net_ipv4_reassembly *reass, void *user_data)
+{
+	pending_cb_count++;
+}
+
+static void test_recv_ipv4_fragment_timeout(void)
+{
+	reverse_order = false;
+	drop_last = true;
+
+	send_large_datagram();
+
+	zassert_not_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			  "Incomplete datagram should not be delivered");
+	zassert_false(test_failed, "Fragment verify failed");
+
+	pending_cb_count = 0;
+	net_ipv4_frag_foreach(pending_cb, NULL);
+	zassert_equal(pending_cb_count, 1, "Reassembly should be pending");
+
+	/* The incomplete datagram is discarded after the timeout */
+	k_sleep(K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT));
+
+	pending_cb_count = 0;
+	net_ipv4_frag_foreach(pending_cb, NULL);
+	zassert_equal(pending_cb_count, 0, "Reassembly was not cancelled");
+
+	drop_last = false;
+}
+
+static void test_cleanup(void)
+{
+	net_context_put(send_ctx);
+	net_context_put(recv_ctx);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_recv_ipv4_fragment),
+			 ztest_unit_test(
+				test_recv_ipv4_fragment_reverse_order),
+			 ztest_unit_test(test_recv_ipv4_fragment_timeout),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
@@ -2043,6 +2043,104 @@ static void test_recv_ipv6_fragment(void)
 	zassert_true(ret == NET_OK, "IPv6 frag2 reassembly failed");
 }
 
+#define REASSEMBLY_BENCH_COUNT 200
+
+static struct net_pkt *prepare_reass_frag(const uint8_t *frag,
+					  size_t frag_len,
+					  uint16_t payload_len,
+					  uint32_t id)
+{
+	struct net_pkt_cursor backup;
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface1, frag_len + payload_len,
+					AF_UNSPEC, 0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	net_pkt_set_family(pkt, AF_INET6);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv6_hdr));
+	net_pkt_cursor_init(pkt);
+
+	/* IPv6 header and the next header field of the fragment header */
+	ret = net_pkt_write(pkt, frag, sizeof(struct net_ipv6_hdr) + 1);
+	zassert_true(ret == 0, "IPv6 header append failed");
+
+	net_pkt_cursor_backup(pkt, &backup);
+
+	/* Reserved and fragment offset fields, then a unique id so that
+	 * every datagram is reassembled separately.
+	 */
+	ret = net_pkt_write(pkt, frag + sizeof(struct net_ipv6_hdr) + 1, 3);
+	zassert_true(ret == 0, "IPv6 fragment header append failed");
+
+	ret = net_pkt_write_be32(pkt, id);
+	zassert_true(ret == 0, "IPv6 fragment id append failed");
+
+	/* The payload is not a valid ICMPv6 message so the reassembled
+	 * packet is dropped without generating any reply traffic.
+	 */
+	ret = net_pkt_memset(pkt, 0, payload_len);
+	zassert_true(ret == 0, "IPv6 payload append failed");
+
+	net_pkt_set_ipv6_fragment_start(pkt, sizeof(struct net_ipv6_hdr));
+	net_pkt_set_overwrite(pkt, true);
+
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return pkt;
+}
+
+static void test_recv_ipv6_fragment_bench(void)
+{
+	uint16_t payload1_len = NET_IPV6_MTU - sizeof(ipv6_reass_frag1);
+	uint16_t payload2_len = 1300U - payload1_len;
+	struct net_ipv6_hdr ipv6_hdr;
+	struct net_pkt *pkt1;
+	struct net_pkt *pkt2;
+	uint32_t cycles = 0U;
+	uint64_t ns;
+	int ret1, ret2;
+	int i;
+
+	test_started = false;
+
+	memcpy(&ipv6_hdr, ipv6_reass_frag1, sizeof(struct net_ipv6_hdr));
+
+	for (i = 0; i < REASSEMBLY_BENCH_COUNT; i++) {
+		uint32_t start;
+
+		pkt1 = prepare_reass_frag(ipv6_reass_frag1,
+					  sizeof(ipv6_reass_frag1),
+					  payload1_len, i);
+		pkt2 = prepare_reass_frag(ipv6_reass_frag2,
+					  sizeof(ipv6_reass_frag2),
+					  payload2_len, i);
+
+		start = k_cycle_get_32();
+
+		ret1 = net_ipv6_handle_fragment_hdr(pkt1, &ipv6_hdr,
+						    NET_IPV6_NEXTHDR_FRAG);
+		ret2 = net_ipv6_handle_fragment_hdr(pkt2, &ipv6_hdr,
+						    NET_IPV6_NEXTHDR_FRAG);
+
+		cycles += k_cycle_get_32() - start;
+
+		zassert_true(ret1 == NET_OK, "IPv6 frag1 reassembly failed");
+		zassert_true(ret2 == NET_OK, "IPv6 frag2 reassembly failed");
+
+		/* Let the RX thread consume the reassembled packet */
+		k_sleep(K_MSEC(1));
+	}
+
+	ns = k_cyc_to_ns_floor64(cycles);
+
+	TC_PRINT("Reassembled %d datagrams in %u us, %u datagrams/s\n",
+		 REASSEMBLY_BENCH_COUNT, (uint32_t)(ns / NSEC_PER_USEC),
+		 ns ? (uint32_t)((uint64_t)REASSEMBLY_BENCH_COUNT *
+				 NSEC_PER_SEC / ns) : 0U);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(net_ipv6_fragment_test,
@@ -2059,7 +2157,8 @@ void test_main(void)
 			 ztest_unit_test(test_send_ipv6_fragment),
 			 ztest_unit_test(test_send_ipv6_fragment_large_hbho),
 			 ztest_unit_test(test_send_ipv6_fragment_without_hbho),
-			 ztest_unit_test(test_recv_ipv6_fragment)
+			 ztest_unit_test(test_recv_ipv6_fragment),
+			 ztest_unit_test(test_recv_ipv6_fragment_bench)
 			 );
 
 	ztest_run_test_suite(net_ipv6_fragment_test);
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_COAP_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/coap.h>
+#include <random/rand32.h>
+#include <sys/printk.h>
+
+#include <string.h>
+#include <errno.h>
+
+/* LwM2M like table: objects, instances and resources */
+#define NUM_OBJECTS 10
+#define NUM_INSTANCES 3
+#define NUM_RESOURCES 10
+#define NUM_PLAIN (NUM_OBJECTS * NUM_INSTANCES * NUM_RESOURCES)
+
+/* Wildcard resources, see test_setup() */
+#define NUM_WILDCARDS 3
+
+#define MAX_DEPTH 4
+#define NUM_NODES (1 + NUM_PLAIN * 3 + NUM_WILDCARDS * 3)
+#define NUM_OPTIONS 16
+#define REQUEST_SIZE 64
+
+#define RANDOM_REQUESTS 2000
+#define BENCH_ROUNDS 10
+
+#define NUM_OBSERVERS 64
+#define NUM_BUCKETS 16
+
+static const char * const numbers[] = {
+	"0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+};
+
+static char object_names[NUM_OBJECTS][5];
+static const char *paths[NUM_PLAIN + NUM_WILDCARDS][MAX_DEPTH + 1];
+static struct coap_resource resources[NUM_PLAIN + NUM_WILDCARDS + 1];
+static struct coap_resource_index_node nodes[NUM_NODES];
+static struct coap_resource_index resource_index;
+
+static struct coap_resource *invoked;
+
+static uint8_t requests[NUM_PLAIN][REQUEST_SIZE];
+static uint16_t request_lens[NUM_PLAIN];
+
+static struct coap_observer observers[NUM_OBSERVERS];
+static sys_slist_t buckets[NUM_BUCKETS];
+static struct coap_observer_table table;
+
+static int resource_get(struct coap_resource *resource,
+			struct coap_packet *request,
+			struct sockaddr *addr, socklen_t addr_len)
+{
+	invoked = resource;
+
+	return 0;
+}
+
+static uint16_t build_request(uint8_t *buf, const char * const *path)
+{
+	struct coap_packet request;
+	int r;
+
+	r = coap_packet_init(&request, buf, REQUEST_SIZE, COAP_VERSION_1,
+			     COAP_TYPE_CON, 0, NULL, COAP_METHOD_GET,
+			     coap_next_id());
+	zassert_equal(r, 0, "Failed to init request");
+
+	for (; *path; path++) {
+		r = coap_packet_append_option(&request, COAP_OPTION_URI_PATH,
+					      (const uint8_t *)*path,
+					      strlen(*path));
+		zassert_equal(r, 0, "Failed to append path");
+	}
+
+	/* Options after the path must be skipped */
+	r = coap_append_option_int(&request, COAP_OPTION_ACCEPT, 60);
+	zassert_equal(r, 0, "Failed to append option");
+
+	return request.offset;
+}
+
+static int handle(uint8_t *buf, uint16_t len, bool indexed)
+{
+	struct coap_option options[NUM_OPTIONS];
+	struct coap_packet request;
+	int r;
+
+	r = coap_packet_parse(&request, buf, len, options, NUM_OPTIONS);
+	zassert_equal(r, 0, "Failed to parse request");
+
+	invoked = NULL;
+
+	if (indexed) {
+		return coap_handle_request_index(&request, &resource_index,
+						 options, NUM_OPTIONS, NULL, 0);
+	}
+
+	return coap_handle_request(&request, resources, options, NUM_OPTIONS,
+				   NULL, 0);
+}
+
+static void check_same_resource(const char * const *path)
+{
+	uint8_t buf[REQUEST_SIZE];
+	struct coap_resource *expected;
+	uint16_t len;
+	int r;
+
+	len = build_request(buf, path);
+
+	r = handle(buf, len, false);
+	expected = invoked;
+
+	zassert_equal(handle(buf, len, true), r, "Different result");
+	zassert_equal_ptr(invoked, expected, "Different resource");
+}
+
+static void test_setup(void)
+{
+	struct coap_resource *resource = resources;
+	const char **path;
+	int i, o, n, r;
+
+	/* The first match of the table wins: this one hides the plain
+	 * resources 7 of object 3301.
+	 */
+	paths[0][0] = "3301";
+	paths[0][1] = "+";
+	paths[0][2] = "7";
+
+	for (o = 0; o < NUM_OBJECTS; o++) {
+		snprintk(object_names[o], sizeof(object_names[o]), "%d",
+			 3300 + o);
+	}
+
+	for (i = 0; i < NUM_PLAIN; i++) {
+		path = paths[1 + i];
+		path[0] = object_names[i / (NUM_INSTANCES * NUM_RESOURCES)];
+		path[1] = numbers[(i / NUM_RESOURCES) % NUM_INSTANCES];
+		path[2] = numbers[i % NUM_RESOURCES];
+	}
+
+	paths[1 + NUM_PLAIN][0] = "led";
+	paths[1 + NUM_PLAIN][1] = "+";
+	paths[1 + NUM_PLAIN][2] = "set";
+
+	paths[2 + NUM_PLAIN][0] = "3302";
+	paths[2 + NUM_PLAIN][1] = "#";
+
+	for (i = 0; i < ARRAY_SIZE(paths); i++) {
+		resource->get = resource_get;
+		resource->path = (const char * const *)paths[i];
+		resource++;
+	}
+
+	r = coap_resource_index_init(&resource_index, resources, nodes, 8);
+	zassert_equal(r, -ENOMEM, "Too few nodes accepted");
+
+	r = coap_resource_index_init(&resource_index, resources, nodes,
+				     NUM_NODES);
+	zassert_equal(r, 0, "Failed to build index (%d)", r);
+
+	for (n = 0; n < NUM_PLAIN; n++) {
+		request_lens[n] = build_request(requests[n],
+						(const char * const *)
+						paths[1 + n]);
+	}
+}
+
+static void test_dispatch(void)
+{
+	static const char * const led[] = { "led", "1", "set", NULL };
+	static const char * const led_short[] = { "led", "1", NULL };
+	static const char * const hidden[] = { "3301", "2", "7", NULL };
+	static const char * const deep[] = { "3302", "0", "1", "2", NULL };
+	static const char * const object[] = { "3302", NULL };
+	static const char * const none[] = { NULL };
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(paths); i++) {
+		check_same_resource((const char * const *)paths[i]);
+	}
+
+	check_same_resource(led);
+	zassert_equal_ptr(invoked, &resources[1 + NUM_PLAIN], "No match");
+
+	check_same_resource(hidden);
+	zassert_equal_ptr(invoked, &resources[0], "First match not used");
+
+	check_same_resource(deep);
+	zassert_equal_ptr(invoked, &resources[2 + NUM_PLAIN], "No match");
+
+	check_same_resource(led_short);
+	zassert_is_null(invoked, "Unexpected match");
+
+	check_same_resource(object);
+	zassert_is_null(invoked, "Unexpected match");
+
+	check_same_resource(none);
+	zassert_is_null(invoked, "Unexpected match");
+}
+
+static void test_dispatch_random(void)
+{
+	static const char * const segments[] = {
+		"3300", "3301", "3302", "3309", "3310", "led", "set", "+",
+		"#", "0", "1", "2", "7", "9", "x",
+	};
+	const char *path[MAX_DEPTH + 1];
+	int i, depth, j;
+
+	for (i = 0; i < RANDOM_REQUESTS; i++) {
+		depth = sys_rand32_get() % (MAX_DEPTH + 1);
+
+		for (j = 0; j < depth; j++) {
+			path[j] = segments[sys_rand32_get() %
+					   ARRAY_SIZE(segments)];
+		}
+
+		path[depth] = NULL;
+
+		check_same_resource(path);
+	}
+}
+
+static uint32_t bench(bool indexed)
+{
+	uint32_t start, cycles;
+	int round, n;
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (n = 0; n < NUM_PLAIN; n++) {
+			zassert_equal(handle(requests[n], request_lens[n],
+					     indexed),
+				      0, "Request not handled");
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (uint64_t)BENCH_ROUNDS * NUM_PLAIN *
+	       sys_clock_hw_cycles_per_sec() / MAX(cycles, 1U);
+}
+
+static void test_dispatch_bench(void)
+{
+	uint32_t linear, indexed;
+
+	linear = bench(false);
+	indexed = bench(true);
+
+	TC_PRINT("%d resources: table scan %u requests/s, "
+		 "index %u requests/s\n", (int)ARRAY_SIZE(paths), linear,
+		 indexed);
+
+	zassert_true(indexed > linear, "Index slower than table scan");
+}
+
+static void observer_addr(struct sockaddr *addr, int i)
+{
+	struct sockaddr_in6 *addr6 = net_sin6(addr);
+
+	memset(addr, 0, sizeof(*addr));
+
+	addr6->sin6_family = AF_INET6;
+	addr6->sin6_port = htons(5683);
+	addr6->sin6_addr.s6_addr[0] = 0x20;
+	addr6->sin6_addr.s6_addr[1] = 0x01;
+	addr6->sin6_addr.s6_addr[2] = 0x0d;
+	addr6->sin6_addr.s6_addr[3] = 0xb8;
+	addr6->sin6_addr.s6_addr[15] = i + 1;
+}
+
+static void test_observer_table(void)
+{
+	struct coap_observer *o;
+	struct sockaddr addr;
+	uint8_t token;
+	int i;
+
+	coap_observer_table_init(&table, buckets, NUM_BUCKETS);
+
+	for (i = 0; i < NUM_OBSERVERS; i++) {
+		observer_addr(&observers[i].addr, i);
+		observers[i].token[0] = i;
+		observers[i].tkl = 1U;
+
+		coap_observer_table_add(&table, &observers[i]);
+	}
+
+	for (i = 0; i < NUM_OBSERVERS; i++) {
+		observer_addr(&addr, i);
+		token = i;
+
+		o = coap_observer_table_find(&table, &addr, &token, 1);
+		zassert_equal_ptr(o, &observers[i], "Observer not found");
+
+		o = coap_observer_table_find(&table, &addr, NULL, 0);
+		zassert_equal_ptr(o, &observers[i], "Observer not found");
+
+		token = i + 1;
+		o = coap_observer_table_find(&table, &addr, &token, 1);
+		zassert_is_null(o, "Token not checked");
+	}
+
+	for (i = 0; i < NUM_OBSERVERS; i += 2) {
+		coap_observer_table_remove(&table, &observers[i]);
+	}
+
+	for (i = 0; i < NUM_OBSERVERS; i++) {
+		observer_addr(&addr, i);
+
+		o = coap_observer_table_find(&table, &addr, NULL, 0);
+		if (i % 2) {
+			zassert_equal_ptr(o, &observers[i],
+					  "Observer not found");
+		} else {
+			zassert_is_null(o, "Observer not removed");
+		}
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(coap_dispatch,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_dispatch),
+			 ztest_unit_test(test_dispatch_random),
+			 ztest_unit_test(test_dispatch_bench),
+			 ztest_unit_test(test_observer_table)
+			 );
+
+	ztest_run_test_suite(coap_dispatch);
+}
@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_COAP_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/coap.h>
+#include <net/coap_transfer.h>
+
+#include <string.h>
+#include <errno.h>
+
+/* Simulated round trip time to the server */
+#define RTT_MS 20
+
+#define RESOURCE_SIZE 2048
+#define UPLOAD_SIZE 1000
+
+/* The first request of one block out of LOSS_INTERVAL is lost */
+#define LOSS_INTERVAL 8
+
+#define PATTERN(i) ((uint8_t)((i) % 251))
+
+#define MAX_MSG_SIZE 128
+#define QUEUE_LEN 16
+
+struct message {
+	uint32_t due;
+	uint16_t len;
+	uint8_t data[MAX_MSG_SIZE];
+};
+
+static const char * const resource_path[] = { "fw", "image", NULL };
+static uint8_t resource[RESOURCE_SIZE];
+
+/* Responses of the server, delivered after RTT_MS */
+static struct message queue[QUEUE_LEN];
+static int queue_head;
+static int queue_count;
+
+static enum coap_block_size server_szx;
+static int etag_change_at;
+static bool lossy;
+static bool separate_lost;
+static bool dropped[RESOURCE_SIZE / 16];
+static uint8_t upload_buf[UPLOAD_SIZE];
+static size_t upload_len;
+static int upload_size1;
+static int requests;
+
+static struct coap_transfer xfer;
+static uint8_t download_buf[RESOURCE_SIZE];
+static size_t download_len;
+static bool done;
+static int result;
+
+static void server_queue(const struct coap_packet *response)
+{
+	struct message *msg;
+
+	zassert_true(queue_count < QUEUE_LEN, "Queue full");
+
+	msg = &queue[(queue_head + queue_count++) % QUEUE_LEN];
+	msg->due = k_uptime_get_32() + RTT_MS;
+	msg->len = response->offset;
+	memcpy(msg->data, response->data, response->offset);
+}
+
+static void server_response_init(struct coap_packet *response, uint8_t *buf,
+				 const struct coap_packet *request,
+				 uint8_t code)
+{
+	uint8_t token[COAP_TOKEN_MAX_LEN];
+	uint8_t tkl;
+	int r;
+
+	tkl = coap_header_get_token(request, token);
+
+	r = coap_packet_init(response, buf, MAX_MSG_SIZE, COAP_VERSION_1,
+			     COAP_TYPE_ACK, tkl, token, code,
+			     coap_header_get_id(request));
+	zassert_equal(r, 0, "Failed to init response");
+}
+
+static void server_get(const struct coap_packet *request)
+{
+	struct coap_packet response;
+	uint8_t buf[MAX_MSG_SIZE];
+	uint8_t etag = 1U;
+	size_t offset;
+	uint16_t len;
+	int block, num, r;
+	uint8_t szx;
+	bool more;
+
+	block = coap_get_option_int(request, COAP_OPTION_BLOCK2);
+	zassert_true(block >= 0, "Block2 option missing");
+
+	szx = MIN(GET_BLOCK_SIZE(block), server_szx);
+	offset = GET_BLOCK_NUM(block) << (GET_BLOCK_SIZE(block) + 4);
+	zassert_true(offset < RESOURCE_SIZE, "Block past the end");
+
+	num = offset >> (szx + 4);
+	len = MIN(coap_block_size_to_bytes(szx), RESOURCE_SIZE - offset);
+	more = offset + len < RESOURCE_SIZE;
+
+	if (lossy && num % LOSS_INTERVAL == LOSS_INTERVAL - 1 &&
+	    !dropped[num]) {
+		dropped[num] = true;
+		return;
+	}
+
+	/* Promise a separate response and never send it */
+	if (separate_lost) {
+		r = coap_packet_init(&response, buf, MAX_MSG_SIZE,
+				     COAP_VERSION_1, COAP_TYPE_ACK, 0, NULL,
+				     COAP_CODE_EMPTY,
+				     coap_header_get_id(request));
+		zassert_equal(r, 0, "Failed to init empty ACK");
+
+		server_queue(&response);
+		return;
+	}
+
+	if (etag_change_at >= 0 && num >= etag_change_at) {
+		etag = 2U;
+	}
+
+	server_response_init(&response, buf, request,
+			     COAP_RESPONSE_CODE_CONTENT);
+
+	coap_packet_append_option(&response, COAP_OPTION_ETAG, &etag, 1);
+	coap_append_option_int(&response, COAP_OPTION_BLOCK2,
+			       (num << 4) | (more ? 0x08 : 0) | szx);
+
+	if (coap_get_option_int(request, COAP_OPTION_SIZE2) >= 0) {
+		coap_append_option_int(&response, COAP_OPTION_SIZE2,
+				       RESOURCE_SIZE);
+	}
+
+	coap_packet_append_payload_marker(&response);
+	zassert_equal(coap_packet_append_payload(&response, &resource[offset],
+						 len),
+		      0, "Failed to append payload");
+
+	server_queue(&response);
+}
+
+static void server_put(const struct coap_packet *request)
+{
+	struct coap_packet response;
+	uint8_t buf[MAX_MSG_SIZE];
+	const uint8_t *payload;
+	size_t offset;
+	uint16_t len;
+	int block;
+
+	block = coap_get_option_int(request, COAP_OPTION_BLOCK1);
+	zassert_true(block >= 0, "Block1 option missing");
+
+	/* Refuse blocks larger than what the server handles */
+	if (GET_BLOCK_SIZE(block) > server_szx) {
+		zassert_equal(GET_BLOCK_NUM(block), 0, "Block size changed");
+
+		server_response_init(&response, buf, request,
+				     COAP_RESPONSE_CODE_REQUEST_TOO_LARGE);
+		coap_append_option_int(&response, COAP_OPTION_BLOCK1,
+				       server_szx);
+		server_queue(&response);
+		return;
+	}
+
+	if (GET_BLOCK_NUM(block) == 0) {
+		upload_size1 = coap_get_option_int(request, COAP_OPTION_SIZE1);
+	}
+
+	offset = GET_BLOCK_NUM(block) << (GET_BLOCK_SIZE(block) + 4);
+	zassert_equal(offset, upload_len, "Block out of order");
+
+	payload = coap_packet_get_payload(request, &len);
+	zassert_true(offset + len <= UPLOAD_SIZE, "Upload too large");
+
+	memcpy(&upload_buf[offset], payload, len);
+	upload_len += len;
+
+	server_response_init(&response, buf, request,
+			     GET_MORE(block) ? COAP_RESPONSE_CODE_CONTINUE :
+					       COAP_RESPONSE_CODE_CHANGED);
+	coap_append_option_int(&response, COAP_OPTION_BLOCK1, block);
+	server_queue(&response);
+}
+
+static int transfer_send(struct coap_transfer *x, const uint8_t *data,
+			 uint16_t len)
+{
+	struct coap_packet request;
+	int r;
+
+	r = coap_packet_parse(&request, (uint8_t *)data, len, NULL, 0);
+	zassert_equal(r, 0, "Invalid request");
+
+	requests++;
+
+	switch (coap_header_get_code(&request)) {
+	case COAP_METHOD_GET:
+		server_get(&request);
+		break;
+	case COAP_METHOD_PUT:
+		server_put(&request);
+		break;
+	default:
+		zassert_unreachable("Unexpected request");
+	}
+
+	return 0;
+}
+
+static int transfer_data(struct coap_transfer *x, size_t offset,
+			 const uint8_t *data, uint16_t len)
+{
+	zassert_true(offset + len <= RESOURCE_SIZE, "Block past the end");
+
+	memcpy(&download_buf[offset], data, len);
+	download_len += len;
+
+	return 0;
+}
+
+static int transfer_read(struct coap_transfer *x, size_t offset,
+			 uint8_t *buf, uint16_t len)
+{
+	int i;
+
+	zassert_true(offset + len <= UPLOAD_SIZE, "Read past the end");
+
+	for (i = 0; i < len; i++) {
+		buf[i] = PATTERN(offset + i);
+	}
+
+	return len;
+}
+
+static void transfer_done(struct coap_transfer *x, int r,
+			  const struct coap_packet *response)
+{
+	done = true;
+	result = r;
+}
+
+static void transfer_reset(void)
+{
+	queue_head = 0;
+	queue_count = 0;
+	requests = 0;
+	done = false;
+	result = 1;
+
+	download_len = 0U;
+	memset(download_buf, 0, sizeof(download_buf));
+	memset(dropped, 0, sizeof(dropped));
+}
+
+/* Run the transfer to its end, returns its duration in milliseconds */
+static uint32_t transfer_run(void)
+{
+	uint32_t start = k_uptime_get_32();
+	struct message msg;
+	int32_t timeout, wait;
+
+	while (!done) {
+		while (!done && queue_count > 0 &&
+		       (int32_t)(queue[queue_head].due -
+				 k_uptime_get_32()) <= 0) {
+			/* Responses may be queued while handling this one */
+			memcpy(&msg, &queue[queue_head], sizeof(msg));
+			queue_head = (queue_head + 1) % QUEUE_LEN;
+			queue_count--;
+
+			zassert_equal(coap_transfer_input(&xfer, msg.data,
+							  msg.len),
+				      0, "Response not handled");
+		}
+
+		timeout = coap_transfer_process(&xfer);
+		if (done) {
+			break;
+		}
+
+		wait = SYS_FOREVER_MS;
+
+		if (queue_count > 0) {
+			wait = MAX((int32_t)(queue[queue_head].due -
+					     k_uptime_get_32()), 0);
+		}
+
+		if (timeout != SYS_FOREVER_MS &&
+		    (wait == SYS_FOREVER_MS || timeout < wait)) {
+			wait = timeout;
+		}
+
+		zassert_not_equal(wait, SYS_FOREVER_MS, "Transfer stalled");
+		k_sleep(K_MSEC(wait));
+	}
+
+	return k_uptime_get_32() - start;
+}
+
+static uint32_t download(uint8_t window)
+{
+	uint32_t elapsed;
+
+	transfer_reset();
+	xfer.window = window;
+
+	zassert_equal(coap_transfer_download(&xfer, resource_path,
+					     COAP_BLOCK_128),
+		      0, "Failed to start download");
+
+	elapsed = transfer_run();
+
+	zassert_equal(result, 0, "Download failed (%d)", result);
+	zassert_equal(download_len, RESOURCE_SIZE, "Invalid length");
+	zassert_mem_equal(download_buf, resource, RESOURCE_SIZE,
+			  "Invalid content");
+
+	return elapsed;
+}
+
+static void test_setup(void)
+{
+	int i;
+
+	for (i = 0; i < RESOURCE_SIZE; i++) {
+		resource[i] = PATTERN(i);
+	}
+
+	xfer.addr.sa_family = AF_INET6;
+	xfer.send = transfer_send;
+	xfer.data = transfer_data;
+	xfer.read = transfer_read;
+	xfer.done = transfer_done;
+	xfer.content_format = -1;
+
+	server_szx = COAP_BLOCK_64;
+	etag_change_at = -1;
+}
+
+static void test_download(void)
+{
+	uint32_t single, windowed;
+
+	lossy = false;
+
+	single = download(1);
+	zassert_equal(requests, RESOURCE_SIZE / 64, "Unexpected requests");
+
+	windowed = download(CONFIG_COAP_TRANSFER_MAX_BLOCKS_IN_FLIGHT);
+	zassert_equal(requests, RESOURCE_SIZE / 64, "Unexpected requests");
+	zassert_equal(xfer.retransmissions, 0, "Unexpected retransmissions");
+
+	TC_PRINT("%d bytes, RTT %d ms: 1 block in flight %u ms, "
+		 "%d blocks in flight %u ms\n", RESOURCE_SIZE, RTT_MS, single,
+		 CONFIG_COAP_TRANSFER_MAX_BLOCKS_IN_FLIGHT, windowed);
+
+	zassert_true(windowed < single, "No gain from the window");
+}
+
+static void test_download_lossy(void)
+{
+	const uint32_t losses = RESOURCE_SIZE / 64 / LOSS_INTERVAL;
+	uint32_t single, windowed;
+
+	lossy = true;
+
+	single = download(1);
+	zassert_equal(xfer.retransmissions, losses, "Unexpected retransmissions");
+
+	windowed = download(CONFIG_COAP_TRANSFER_MAX_BLOCKS_IN_FLIGHT);
+	zassert_equal(xfer.retransmissions, losses, "Unexpected retransmissions");
+
+	TC_PRINT("%d bytes, RTT %d ms, %u losses: 1 block in flight %u ms, "
+		 "%d blocks in flight %u ms\n", RESOURCE_SIZE, RTT_MS, losses,
+		 single, CONFIG_COAP_TRANSFER_MAX_BLOCKS_IN_FLIGHT, windowed);
+
+	zassert_true(windowed < single, "No gain from the window");
+
+	lossy = false;
+}
+
+static void test_download_etag_change(void)
+{
+	transfer_reset();
+	etag_change_at = 5;
+	xfer.window = 0U;
+
+	zassert_equal(coap_transfer_download(&xfer, resource_path,
+					     COAP_BLOCK_64),
+		      0, "Failed to start download");
+
+	transfer_run();
+
+	zassert_equal(result, -ECANCELED, "Change not detected (%d)", result);
+	zassert_false(coap_transfer_is_active(&xfer), "Transfer not stopped");
+
+	etag_change_at = -1;
+}
+
+static void test_download_separate_lost(void)
+{
+	uint32_t elapsed;
+
+	transfer_reset();
+	separate_lost = true;
+	xfer.window = 1U;
+
+	zassert_equal(coap_transfer_download(&xfer, resource_path,
+					     COAP_BLOCK_64),
+		      0, "Failed to start download");
+
+	elapsed = transfer_run();
+
+	zassert_equal(result, -ETIMEDOUT, "Transfer not failed (%d)", result);
+	zassert_true(elapsed >= CONFIG_COAP_TRANSFER_EXCHANGE_LIFETIME_MS,
+		     "Timed out after %u ms", elapsed);
+	zassert_equal(xfer.retransmissions, 0, "Unexpected retransmissions");
+
+	separate_lost = false;
+}
+
+static void test_upload(void)
+{
+	int i;
+
+	transfer_reset();
+	upload_len = 0U;
+	upload_size1 = -1;
+
+	zassert_equal(coap_transfer_upload(&xfer, COAP_METHOD_PUT,
+					   resource_path, COAP_BLOCK_256,
+					   UPLOAD_SIZE),
+		      0, "Failed to start upload");
+
+	transfer_run();
+
+	zassert_equal(result, 0, "Upload failed (%d)", result);
+	zassert_equal(upload_size1, UPLOAD_SIZE, "Invalid Size1");
+	zassert_equal(upload_len, UPLOAD_SIZE, "Invalid length");
+
+	/* One refused block, then 64 bytes blocks */
+	zassert_equal(requests, 1 + ceiling_fraction(UPLOAD_SIZE, 64),
+		      "Unexpected requests");
+
+	for (i = 0; i < UPLOAD_SIZE; i++) {
+		zassert_equal(upload_buf[i], PATTERN(i),
+			      "Invalid content at %d", i);
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(coap_transfer,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_download),
+			 ztest_unit_test(test_download_lossy),
+			 ztest_unit_test(test_download_etag_change),
+			 ztest_unit_test(test_download_separate_lost),
+			 ztest_unit_test(test_upload)
+			 );
+
+	ztest_run_test_suite(coap_transfer);
+}
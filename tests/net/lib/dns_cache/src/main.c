@@ -0,0 +1,560 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/dns_resolve.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define NAME1 "host1.zephyr.test"
+#define NAME2 "host2.zephyr.test"
+#define NAME3 "host3.zephyr.test"
+#define NAME_NX "nx.zephyr.test"
+
+#define DNS_PORT 53
+#define DNS_TIMEOUT 2000 /* ms */
+#define DNS_RCODE_SERVFAIL 2
+#define DNS_RCODE_NXDOMAIN 3
+
+#define WAIT_TIME K_MSEC(500)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr server_addr = { { { 192, 0, 2, 2 } } };
+static struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+
+static const struct in_addr answers[] = {
+	{ { { 198, 51, 100, 1 } } },
+	{ { { 198, 51, 100, 2 } } },
+};
+
+static struct net_if *iface;
+
+/* Last query sent to the DNS server */
+static struct k_sem query_sent;
+static uint16_t query_id;
+static uint16_t query_port;
+static int queries_sent;
+
+struct result {
+	struct k_sem done;
+	struct in_addr addr;
+	int count;
+	int status;
+	bool finished;
+};
+
+struct net_if_test {
+	uint8_t idx;
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+/* Remember the source port and DNS id of the query so that a reply can be
+ * generated for it.
+ */
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(udp_access, struct net_udp_hdr);
+	struct net_udp_hdr *udp_hdr;
+	uint16_t id;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, NET_IPV4H_LEN)) {
+		return 0;
+	}
+
+	udp_hdr = (struct net_udp_hdr *)net_pkt_get_data(pkt, &udp_access);
+	if (!udp_hdr || udp_hdr->dst_port != htons(DNS_PORT)) {
+		return 0;
+	}
+
+	query_port = ntohs(udp_hdr->src_port);
+
+	if (net_pkt_skip(pkt, NET_UDPH_LEN) ||
+	    net_pkt_read_be16(pkt, &id)) {
+		return 0;
+	}
+
+	query_id = id;
+	queries_sent++;
+
+	k_sem_give(&query_sent);
+
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 127);
+
+static void result_cb(enum dns_resolve_status status,
+		      struct dns_addrinfo *info,
+		      void *user_data)
+{
+	struct result *res = user_data;
+
+	if (status == DNS_EAI_INPROGRESS && info) {
+		if (res->count == 0) {
+			net_ipaddr_copy(&res->addr,
+					&net_sin(&info->ai_addr)->sin_addr);
+		}
+
+		res->count++;
+		return;
+	}
+
+	res->status = status;
+	res->finished = true;
+
+	k_sem_give(&res->done);
+}
+
+static int resolve_timeout(const char *name, struct result *res,
+			   uint16_t *dns_id, int32_t timeout)
+{
+	memset(res, 0, sizeof(*res));
+	k_sem_init(&res->done, 0, 1);
+
+	return dns_get_addr_info(name, DNS_QUERY_TYPE_A, dns_id, result_cb,
+				 res, timeout);
+}
+
+static int resolve(const char *name, struct result *res, uint16_t *dns_id)
+{
+	return resolve_timeout(name, res, dns_id, DNS_TIMEOUT);
+}
+
+static void wait_result(struct result *res, int status, int count)
+{
+	zassert_equal(k_sem_take(&res->done, WAIT_TIME), 0,
+		      "No result received");
+	zassert_equal(res->status, status, "Invalid status %d", res->status);
+	zassert_equal(res->count, count, "Invalid address count %d",
+		      res->count);
+}
+
+static void write_name(struct net_pkt *pkt, const char *name)
+{
+	while (*name) {
+		const char *dot = strchr(name, '.');
+		size_t len = dot ? dot - name : strlen(name);
+
+		net_pkt_write_u8(pkt, len);
+		net_pkt_write(pkt, name, len);
+
+		name += len;
+		if (*name == '.') {
+			name++;
+		}
+	}
+
+	net_pkt_write_u8(pkt, 0);
+}
+
+/* Answer the last query */
+static void reply(const char *name, uint8_t rcode, uint32_t ttl, int count)
+{
+	struct net_pkt *pkt;
+	int i;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, 128, AF_INET, IPPROTO_UDP,
+					   K_FOREVER);
+	zassert_not_null(pkt, "Cannot allocate reply");
+
+	zassert_equal(net_ipv4_create(pkt, &server_addr, &my_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_udp_create(pkt, htons(DNS_PORT), htons(query_port)),
+		      0, "Cannot create UDP header");
+
+	net_pkt_write_be16(pkt, query_id);
+	net_pkt_write_be16(pkt, 0x8180 | rcode);
+	net_pkt_write_be16(pkt, 1);
+	net_pkt_write_be16(pkt, count);
+	net_pkt_write_be16(pkt, 0);
+	net_pkt_write_be16(pkt, 0);
+
+	write_name(pkt, name);
+	net_pkt_write_be16(pkt, DNS_QUERY_TYPE_A);
+	net_pkt_write_be16(pkt, 1);
+
+	for (i = 0; i < count; i++) {
+		/* Pointer to the name in the question */
+		net_pkt_write_be16(pkt, 0xc00c);
+		net_pkt_write_be16(pkt, DNS_QUERY_TYPE_A);
+		net_pkt_write_be16(pkt, 1);
+		net_pkt_write_be32(pkt, ttl);
+		net_pkt_write_be16(pkt, sizeof(struct in_addr));
+		net_pkt_write(pkt, &answers[i], sizeof(struct in_addr));
+	}
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_ipv4_finalize(pkt, IPPROTO_UDP), 0,
+		      "Cannot finalize reply");
+
+	zassert_equal(net_recv_data(iface, pkt), 0, "Cannot receive reply");
+}
+
+/* Resolve a name through the server */
+static void resolve_remote(const char *name, uint8_t rcode, uint32_t ttl,
+			   int count)
+{
+	struct result res;
+	int sent = queries_sent;
+
+	zassert_equal(resolve(name, &res, NULL), 0, "Cannot start query");
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent");
+	zassert_equal(queries_sent, sent + 1, "Invalid number of queries");
+
+	reply(name, rcode, ttl, count);
+
+	wait_result(&res, count ? DNS_EAI_ALLDONE : DNS_EAI_NODATA, count);
+}
+
+/* Resolve a name that must be in the cache */
+static void resolve_cached(const char *name, int status, int count)
+{
+	struct result res;
+	uint16_t dns_id = 1U;
+	int sent = queries_sent;
+
+	zassert_equal(resolve(name, &res, &dns_id), 0, "Cannot start query");
+	zassert_true(res.finished, "Result not returned from cache");
+	zassert_equal(dns_id, 0, "DNS id set for cached result");
+	zassert_equal(res.status, status, "Invalid status %d", res.status);
+	zassert_equal(res.count, count, "Invalid address count %d",
+		      res.count);
+	zassert_equal(queries_sent, sent, "Query sent for cached name");
+
+	if (count) {
+		zassert_true(net_ipv4_addr_cmp(&res.addr, &answers[0]),
+			     "Invalid address");
+	}
+}
+
+/* Check that a name is not in the cache and drop the query */
+static void resolve_not_cached(const char *name)
+{
+	struct result res;
+	uint16_t dns_id;
+
+	zassert_equal(resolve(name, &res, &dns_id), 0, "Cannot start query");
+	zassert_false(res.finished, "Result returned from cache");
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent");
+
+	dns_cancel_addr_info(dns_id);
+	wait_result(&res, DNS_EAI_CANCELED, 0);
+}
+
+static void test_init(void)
+{
+	struct net_if_addr *ifaddr;
+
+	k_sem_init(&query_sent, 0, UINT_MAX);
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	net_if_up(iface);
+}
+
+static void test_cache_hit(void)
+{
+	struct dns_resolve_cache_stats before, after;
+
+	dns_resolve_cache_flush();
+
+	resolve_remote(NAME1, 0, 60, 2);
+
+	dns_resolve_cache_stats_get(&before);
+
+	resolve_cached(NAME1, DNS_EAI_ALLDONE, 2);
+
+	/* Names are case insensitive */
+	resolve_cached("HOST1.Zephyr.Test", DNS_EAI_ALLDONE, 2);
+
+	dns_resolve_cache_stats_get(&after);
+	zassert_equal(after.hits, before.hits + 2, "Invalid hit count");
+	zassert_equal(after.misses, before.misses, "Invalid miss count");
+}
+
+static void test_cache_ttl(void)
+{
+	dns_resolve_cache_flush();
+
+	resolve_remote(NAME1, 0, 1, 1);
+	resolve_cached(NAME1, DNS_EAI_ALLDONE, 1);
+
+	k_msleep(1100);
+
+	resolve_not_cached(NAME1);
+
+	/* Zero TTL answers are not cached at all */
+	resolve_remote(NAME2, 0, 0, 1);
+	resolve_not_cached(NAME2);
+}
+
+static void test_cache_negative(void)
+{
+	struct dns_resolve_cache_stats before, after;
+
+	dns_resolve_cache_flush();
+
+	resolve_remote(NAME_NX, DNS_RCODE_NXDOMAIN, 0, 0);
+
+	dns_resolve_cache_stats_get(&before);
+	resolve_cached(NAME_NX, DNS_EAI_NODATA, 0);
+	dns_resolve_cache_stats_get(&after);
+
+	zassert_equal(after.negative_hits, before.negative_hits + 1,
+		      "Invalid negative hit count");
+
+	k_msleep(CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL * MSEC_PER_SEC + 100);
+
+	resolve_not_cached(NAME_NX);
+}
+
+static void test_cache_servfail(void)
+{
+	struct result res;
+
+	dns_resolve_cache_flush();
+
+	/* A server failure is an error, not a negative answer */
+	zassert_equal(resolve(NAME_NX, &res, NULL), 0, "Cannot start query");
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent");
+
+	reply(NAME_NX, DNS_RCODE_SERVFAIL, 0, 0);
+	wait_result(&res, DNS_EAI_FAIL, 0);
+
+	resolve_not_cached(NAME_NX);
+}
+
+static void test_cache_lru(void)
+{
+	struct dns_resolve_cache_stats before, after;
+
+	dns_resolve_cache_flush();
+
+	/* The cache has room for two names */
+	resolve_remote(NAME1, 0, 60, 1);
+	resolve_remote(NAME2, 0, 60, 1);
+
+	/* Use the first name so that the second one is evicted */
+	resolve_cached(NAME1, DNS_EAI_ALLDONE, 1);
+
+	dns_resolve_cache_stats_get(&before);
+	resolve_remote(NAME3, 0, 60, 1);
+	dns_resolve_cache_stats_get(&after);
+
+	zassert_equal(after.evictions, before.evictions + 1,
+		      "Invalid eviction count");
+
+	resolve_cached(NAME1, DNS_EAI_ALLDONE, 1);
+	resolve_cached(NAME3, DNS_EAI_ALLDONE, 1);
+	resolve_not_cached(NAME2);
+}
+
+static void test_shared_query(void)
+{
+	struct dns_resolve_cache_stats before, after;
+	struct result res1, res2;
+	uint16_t id1, id2;
+	int sent;
+
+	dns_resolve_cache_flush();
+	dns_resolve_cache_stats_get(&before);
+
+	sent = queries_sent;
+
+	zassert_equal(resolve(NAME1, &res1, &id1), 0, "Cannot start query");
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent");
+
+	zassert_equal(resolve(NAME1, &res2, &id2), 0, "Cannot start query");
+	zassert_not_equal(id1, id2, "Shared query has the same id");
+
+	k_msleep(10);
+	zassert_equal(queries_sent, sent + 1, "Query was not shared");
+
+	dns_resolve_cache_stats_get(&after);
+	zassert_equal(after.shared, before.shared + 1,
+		      "Invalid shared query count");
+
+	reply(NAME1, 0, 60, 2);
+
+	wait_result(&res1, DNS_EAI_ALLDONE, 2);
+	wait_result(&res2, DNS_EAI_ALLDONE, 2);
+}
+
+static void test_shared_query_cancel(void)
+{
+	struct result res1, res2;
+	uint16_t id1, id2;
+
+	dns_resolve_cache_flush();
+
+	zassert_equal(resolve(NAME2, &res1, &id1), 0, "Cannot start query");
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent");
+	zassert_equal(resolve(NAME2, &res2, &id2), 0, "Cannot start query");
+
+	/* Cancelling the sharing query does not affect the original one */
+	zassert_equal(dns_cancel_addr_info(id2), 0, "Cannot cancel query");
+	wait_result(&res2, DNS_EAI_CANCELED, 0);
+
+	reply(NAME2, 0, 60, 1);
+	wait_result(&res1, DNS_EAI_ALLDONE, 1);
+}
+
+static void test_shared_query_owner_cancel(void)
+{
+	struct result res1, res2;
+	uint16_t id1, id2;
+
+	dns_resolve_cache_flush();
+
+	zassert_equal(resolve(NAME3, &res1, &id1), 0, "Cannot start query");
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent");
+	zassert_equal(resolve(NAME3, &res2, &id2), 0, "Cannot start query");
+
+	/* The sharing query sends the request again with its own id */
+	zassert_equal(dns_cancel_addr_info(id1), 0, "Cannot cancel query");
+	wait_result(&res1, DNS_EAI_CANCELED, 0);
+
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent again");
+	zassert_equal(query_id, id2, "Query sent with id %u", query_id);
+	zassert_false(res2.finished, "Sharing query was finished");
+
+	reply(NAME3, 0, 60, 1);
+	wait_result(&res2, DNS_EAI_ALLDONE, 1);
+}
+
+static void test_shared_query_owner_timeout(void)
+{
+	struct result res1, res2;
+	uint16_t id1, id2;
+
+	dns_resolve_cache_flush();
+
+	zassert_equal(resolve_timeout(NAME1, &res1, &id1, 100), 0,
+		      "Cannot start query");
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent");
+	zassert_equal(resolve(NAME1, &res2, &id2), 0, "Cannot start query");
+
+	/* The sharing query keeps waiting until its own timeout */
+	wait_result(&res1, DNS_EAI_CANCELED, 0);
+
+	zassert_equal(k_sem_take(&query_sent, WAIT_TIME), 0,
+		      "Query not sent again");
+	zassert_equal(query_id, id2, "Query sent with id %u", query_id);
+	zassert_false(res2.finished, "Sharing query timed out");
+
+	reply(NAME1, 0, 60, 1);
+	wait_result(&res2, DNS_EAI_ALLDONE, 1);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_cache_tests,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_cache_hit),
+			 ztest_unit_test(test_cache_ttl),
+			 ztest_unit_test(test_cache_negative),
+			 ztest_unit_test(test_cache_servfail),
+			 ztest_unit_test(test_cache_lru),
+			 ztest_unit_test(test_shared_query),
+			 ztest_unit_test(test_shared_query_cancel),
+			 ztest_unit_test(test_shared_query_owner_cancel),
+			 ztest_unit_test(test_shared_query_owner_timeout));
+
+	ztest_run_test_suite(dns_cache_tests);
+}
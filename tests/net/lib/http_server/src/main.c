@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_HTTP_SERVER_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/http_server.h>
+
+#include <string.h>
+#include <errno.h>
+
+#define SERVER_PORT 8080
+#define MAX_ROUNDS 100
+#define BENCH_REQUESTS 200
+#define BENCH_PIPELINE 8
+
+/* Much more than a client that does not read can take */
+#define BIG_CHUNK_LEN 1024
+#define BIG_CHUNKS 128
+
+#define HELLO_RSP "HTTP/1.1 200 OK\r\n"				\
+		  "Content-Type: text/plain\r\n"			\
+		  "Content-Length: 5\r\n\r\n"				\
+		  "Hello"
+
+static struct http_server_ctx server;
+static struct sockaddr_in server_addr;
+static char rsp_buf[1024];
+static int ws_sock = -1;
+static int handled;
+static int big_result;
+
+static int hello_handler(const struct http_server_request *req,
+			 struct http_server_response *rsp, void *user_data)
+{
+	handled++;
+
+	return http_server_send_response(rsp, 200, "text/plain", "Hello", 5);
+}
+
+static int echo_handler(const struct http_server_request *req,
+			struct http_server_response *rsp, void *user_data)
+{
+	handled++;
+
+	return http_server_send_response(rsp, 200, NULL, req->body,
+					 req->body_len);
+}
+
+/* The server ends the chunked response */
+static int stream_handler(const struct http_server_request *req,
+			  struct http_server_response *rsp, void *user_data)
+{
+	int ret;
+
+	handled++;
+
+	ret = http_server_send_chunked_begin(rsp, 200, NULL);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = http_server_send_chunk(rsp, "abc", 3);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return http_server_send_chunk(rsp, req->query, strlen(req->query));
+}
+
+static int big_handler(const struct http_server_request *req,
+		       struct http_server_response *rsp, void *user_data)
+{
+	static const char chunk[BIG_CHUNK_LEN];
+	int i, ret;
+
+	ret = http_server_send_chunked_begin(rsp, 200, NULL);
+
+	for (i = 0; i < BIG_CHUNKS && ret == 0; i++) {
+		ret = http_server_send_chunk(rsp, chunk, sizeof(chunk));
+	}
+
+	big_result = ret;
+
+	return ret;
+}
+
+static int fail_handler(const struct http_server_request *req,
+			struct http_server_response *rsp, void *user_data)
+{
+	return -EIO;
+}
+
+static void ws_connected(int sock, const struct http_server_request *req,
+			 void *user_data)
+{
+	ws_sock = sock;
+}
+
+static const struct http_server_route routes[] = {
+	HTTP_SERVER_ROUTE(HTTP_GET, "/hello", hello_handler, NULL),
+	HTTP_SERVER_ROUTE(HTTP_POST, "/echo", echo_handler, NULL),
+	HTTP_SERVER_ROUTE(HTTP_GET, "/stream*", stream_handler, NULL),
+	HTTP_SERVER_ROUTE(HTTP_GET, "/fail", fail_handler, NULL),
+	HTTP_SERVER_ROUTE(HTTP_GET, "/big", big_handler, NULL),
+	HTTP_SERVER_WEBSOCKET_ROUTE("/ws", NULL, ws_connected, NULL),
+};
+
+static int client_connect(void)
+{
+	int sock;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(sock >= 0, "socket open failed");
+
+	zassert_equal(connect(sock, (struct sockaddr *)&server_addr,
+			      sizeof(server_addr)),
+		      0, "connect failed (%d)", errno);
+
+	return sock;
+}
+
+/* Send a request and let the server run until the expected amount of
+ * response data or the end of the connection is received.
+ */
+static size_t exchange(int sock, const char *req, size_t expected)
+{
+	size_t got = 0U;
+	ssize_t ret;
+	int i;
+
+	if (req) {
+		zassert_equal(send(sock, req, strlen(req), 0), strlen(req),
+			      "send failed (%d)", errno);
+	}
+
+	for (i = 0; i < MAX_ROUNDS && got < expected; i++) {
+		zassert_equal(http_server_process(&server, 10), 0,
+			      "Server failed");
+
+		ret = recv(sock, rsp_buf + got, sizeof(rsp_buf) - 1 - got,
+			   MSG_DONTWAIT);
+		if (ret == 0) {
+			break;
+		}
+
+		if (ret > 0) {
+			got += ret;
+		}
+	}
+
+	rsp_buf[got] = '\0';
+
+	return got;
+}
+
+static void check_exchange(int sock, const char *req, const char *expected)
+{
+	exchange(sock, req, strlen(expected));
+
+	zassert_true(strcmp(rsp_buf, expected) == 0,
+		     "Unexpected response:\n%s", rsp_buf);
+}
+
+static void check_closed(int sock)
+{
+	zassert_equal(exchange(sock, NULL, 1), 0, "Connection not closed");
+	zassert_equal(close(sock), 0, "close failed");
+}
+
+static void test_setup(void)
+{
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&server_addr.sin_addr),
+		      1, "inet_pton failed");
+
+	zassert_equal(http_server_init(&server,
+				       (struct sockaddr *)&server_addr,
+				       sizeof(server_addr), routes,
+				       ARRAY_SIZE(routes)),
+		      0, "Server init failed");
+}
+
+static void test_keep_alive(void)
+{
+	int sock = client_connect();
+
+	handled = 0;
+
+	check_exchange(sock, "GET /hello HTTP/1.1\r\nHost: test\r\n\r\n",
+		       HELLO_RSP);
+	check_exchange(sock, "GET /hello HTTP/1.1\r\nHost: test\r\n\r\n",
+		       HELLO_RSP);
+	zassert_equal(handled, 2, "Requests not handled");
+
+	/* HTTP/1.0 persistent connections have to be asked for */
+	check_exchange(sock, "GET /hello HTTP/1.0\r\n"
+		       "Connection: keep-alive\r\n\r\n",
+		       "HTTP/1.1 200 OK\r\n"
+		       "Content-Type: text/plain\r\n"
+		       "Content-Length: 5\r\n"
+		       "Connection: keep-alive\r\n\r\n"
+		       "Hello");
+
+	check_exchange(sock, "GET /hello HTTP/1.1\r\n"
+		       "Connection: close\r\n\r\n",
+		       "HTTP/1.1 200 OK\r\n"
+		       "Content-Type: text/plain\r\n"
+		       "Content-Length: 5\r\n"
+		       "Connection: close\r\n\r\n"
+		       "Hello");
+	check_closed(sock);
+}
+
+static void test_pipelining(void)
+{
+	int sock = client_connect();
+
+	handled = 0;
+
+	/* The requests after the one closing the connection are ignored */
+	check_exchange(sock,
+		       "GET /hello HTTP/1.1\r\n\r\n"
+		       "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+		       "GET /missing HTTP/1.1\r\n\r\n"
+		       "DELETE /hello HTTP/1.1\r\n\r\n"
+		       "HEAD /hello HTTP/1.1\r\nConnection: close\r\n\r\n"
+		       "GET /hello HTTP/1.1\r\n\r\n",
+		       HELLO_RSP
+		       "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabc"
+		       "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n"
+		       "HTTP/1.1 405 Method Not Allowed\r\n"
+		       "Content-Length: 0\r\n\r\n"
+		       "HTTP/1.1 200 OK\r\n"
+		       "Content-Type: text/plain\r\n"
+		       "Content-Length: 5\r\n"
+		       "Connection: close\r\n\r\n");
+	zassert_equal(handled, 3, "Wrong number of requests handled");
+	check_closed(sock);
+}
+
+static void test_chunked(void)
+{
+	int sock = client_connect();
+
+	check_exchange(sock, "POST /echo HTTP/1.1\r\n"
+		       "Transfer-Encoding: chunked\r\n\r\n"
+		       "4\r\nWiki\r\n5\r\npedia\r\n0\r\n\r\n",
+		       "HTTP/1.1 200 OK\r\nContent-Length: 9\r\n\r\n"
+		       "Wikipedia");
+
+	check_exchange(sock, "GET /stream/x?defghijklmnopq HTTP/1.1\r\n\r\n",
+		       "HTTP/1.1 200 OK\r\n"
+		       "Transfer-Encoding: chunked\r\n\r\n"
+		       "3\r\nabc\r\n"
+		       "e\r\ndefghijklmnopq\r\n"
+		       "0\r\n\r\n");
+
+	/* HTTP/1.0 clients get the body as is, up to the end of connection */
+	check_exchange(sock, "GET /stream?def HTTP/1.0\r\n"
+		       "Connection: keep-alive\r\n\r\n",
+		       "HTTP/1.1 200 OK\r\n"
+		       "Connection: close\r\n\r\n"
+		       "abcdef");
+	check_closed(sock);
+}
+
+static void test_errors(void)
+{
+	int sock = client_connect();
+
+	check_exchange(sock, "GET /this/url/is/longer/than/allowed HTTP/1.1"
+		       "\r\n\r\n",
+		       "HTTP/1.1 414 URI Too Long\r\n"
+		       "Content-Length: 0\r\n\r\n");
+
+	check_exchange(sock, "POST /echo HTTP/1.1\r\nContent-Length: 65\r\n"
+		       "\r\n"
+		       "0123456789012345678901234567890123456789"
+		       "0123456789012345678901234",
+		       "HTTP/1.1 413 Payload Too Large\r\n"
+		       "Content-Length: 0\r\n\r\n");
+
+	check_exchange(sock, "GET /fail HTTP/1.1\r\n\r\n",
+		       "HTTP/1.1 500 Internal Server Error\r\n"
+		       "Content-Length: 0\r\n"
+		       "Connection: close\r\n\r\n");
+	check_closed(sock);
+
+	sock = client_connect();
+
+	check_exchange(sock, "GARBAGE\r\n\r\n",
+		       "HTTP/1.1 400 Bad Request\r\n"
+		       "Content-Length: 0\r\n"
+		       "Connection: close\r\n\r\n");
+	check_closed(sock);
+}
+
+static void test_slow_client(void)
+{
+	const char req[] = "GET /big HTTP/1.1\r\n\r\n";
+	int slow = client_connect();
+	int64_t start;
+	int sock;
+
+	big_result = 1;
+
+	zassert_equal(send(slow, req, strlen(req), 0), strlen(req),
+		      "send failed (%d)", errno);
+
+	/* The server gives up on the client instead of waiting for it */
+	start = k_uptime_get();
+
+	while (big_result > 0) {
+		zassert_equal(http_server_process(&server, 10), 0,
+			      "Server failed");
+		zassert_true(k_uptime_get() - start <
+			     2 * CONFIG_HTTP_SERVER_SEND_TIMEOUT,
+			     "Server blocked by the client");
+	}
+
+	zassert_true(big_result < 0, "Response sent to a client not reading");
+	zassert_equal(close(slow), 0, "close failed");
+
+	sock = client_connect();
+	check_exchange(sock, "GET /hello HTTP/1.1\r\n\r\n", HELLO_RSP);
+	zassert_equal(close(sock), 0, "close failed");
+}
+
+static void test_websocket(void)
+{
+	int sock = client_connect();
+
+	/* Upgrade requests are handled as HTTP by other routes */
+	check_exchange(sock, "GET /hello HTTP/1.1\r\n"
+		       "Upgrade: websocket\r\n"
+		       "Connection: Upgrade\r\n\r\n",
+		       HELLO_RSP);
+
+	check_exchange(sock, "GET /ws HTTP/1.1\r\n\r\n",
+		       "HTTP/1.1 426 Upgrade Required\r\n"
+		       "Content-Length: 0\r\n\r\n");
+
+	/* Sample handshake from RFC 6455 */
+	check_exchange(sock, "GET /ws HTTP/1.1\r\n"
+		       "Host: server.example.com\r\n"
+		       "Upgrade: websocket\r\n"
+		       "Connection: Upgrade\r\n"
+		       "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+		       "Sec-WebSocket-Version: 13\r\n\r\n",
+		       "HTTP/1.1 101 Switching Protocols\r\n"
+		       "Upgrade: websocket\r\n"
+		       "Connection: Upgrade\r\n"
+		       "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n"
+		       "\r\n");
+	zassert_true(ws_sock >= 0, "Connection not handed over");
+
+	/* The server no longer reads from the upgraded connection */
+	zassert_equal(send(sock, "ping", 4, 0), 4, "send failed");
+	zassert_equal(exchange(sock, NULL, 1), 0, "Unexpected response");
+	zassert_equal(recv(ws_sock, rsp_buf, sizeof(rsp_buf), 0), 4,
+		      "Data not received on the upgraded connection");
+
+	zassert_equal(close(ws_sock), 0, "close failed");
+	check_closed(sock);
+}
+
+static void test_bench(void)
+{
+	const char req[] = "GET /hello HTTP/1.1\r\nHost: test\r\n\r\n";
+	char batch[BENCH_PIPELINE * sizeof(req)] = "";
+	uint32_t sequential_ms, pipelined_ms;
+	int sock = client_connect();
+	int64_t start;
+	int i;
+
+	for (i = 0; i < BENCH_PIPELINE; i++) {
+		strcat(batch, req);
+	}
+
+	start = k_uptime_get();
+
+	for (i = 0; i < BENCH_REQUESTS; i++) {
+		zassert_equal(exchange(sock, req, strlen(HELLO_RSP)),
+			      strlen(HELLO_RSP), "Response not received");
+	}
+
+	sequential_ms = k_uptime_delta(&start);
+
+	for (i = 0; i < BENCH_REQUESTS / BENCH_PIPELINE; i++) {
+		zassert_equal(exchange(sock, batch,
+				       BENCH_PIPELINE * strlen(HELLO_RSP)),
+			      BENCH_PIPELINE * strlen(HELLO_RSP),
+			      "Responses not received");
+	}
+
+	pipelined_ms = k_uptime_delta(&start);
+
+	TC_PRINT("%u requests over one connection: %u requests/s, "
+		 "pipelined by %u: %u requests/s\n", BENCH_REQUESTS,
+		 BENCH_REQUESTS * MSEC_PER_SEC / MAX(sequential_ms, 1U),
+		 BENCH_PIPELINE,
+		 BENCH_REQUESTS * MSEC_PER_SEC / MAX(pipelined_ms, 1U));
+
+	zassert_equal(close(sock), 0, "close failed");
+}
+
+static void test_teardown(void)
+{
+	http_server_close(&server);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(http_server_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_keep_alive),
+			 ztest_unit_test(test_pipelining),
+			 ztest_unit_test(test_chunked),
+			 ztest_unit_test(test_errors),
+			 ztest_unit_test(test_slow_client),
+			 ztest_unit_test(test_websocket),
+			 ztest_unit_test(test_bench),
+			 ztest_unit_test(test_teardown)
+			 );
+
+	ztest_run_test_suite(http_server_test);
+}
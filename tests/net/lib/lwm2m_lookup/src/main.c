@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_LWM2M_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/lwm2m.h>
+#include <sys/printk.h>
+
+#include <string.h>
+#include <errno.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+
+#define TEST_OBJ_ID_BASE 32768
+#define NUM_OBJECTS 128
+#define NUM_RESOURCES 4
+
+/* Object counts to compare, the lookups hit the last objects registered */
+#define SMALL_COUNT 8
+#define MEDIUM_COUNT 32
+#define BENCH_OBJECTS SMALL_COUNT
+#define BENCH_ROUNDS 100
+
+#define PATH_LEN 24
+
+/* The last resource id leaves a gap, to exercise the scan fallback */
+static struct lwm2m_engine_obj_field fields[] = {
+	OBJ_FIELD_DATA(0, RW, U32),
+	OBJ_FIELD_DATA(1, RW, U32),
+	OBJ_FIELD_DATA(2, RW, U32),
+	OBJ_FIELD_DATA(5, RW, U32),
+};
+
+static struct lwm2m_engine_obj objects[NUM_OBJECTS];
+static struct lwm2m_engine_obj_inst inst[NUM_OBJECTS];
+static struct lwm2m_engine_res res[NUM_OBJECTS][NUM_RESOURCES];
+static struct lwm2m_engine_res_inst res_inst[NUM_OBJECTS][NUM_RESOURCES];
+static uint32_t values[NUM_OBJECTS][NUM_RESOURCES];
+
+static int num_objects;
+
+/* The create callback is not told which object the instance belongs to */
+static int creating;
+
+static struct lwm2m_engine_obj_inst *test_obj_create(uint16_t obj_inst_id)
+{
+	int index = creating;
+	int i = 0, j = 0, r;
+
+	(void)memset(res[index], 0, sizeof(res[index]));
+	init_res_instance(res_inst[index], ARRAY_SIZE(res_inst[index]));
+
+	for (r = 0; r < NUM_RESOURCES; r++) {
+		INIT_OBJ_RES_DATA(fields[r].res_id, res[index], i,
+				  res_inst[index], j, &values[index][r],
+				  sizeof(values[index][r]));
+	}
+
+	inst[index].resources = res[index];
+	inst[index].resource_count = i;
+
+	return &inst[index];
+}
+
+static void register_objects(int count)
+{
+	char path[PATH_LEN];
+	int i;
+
+	for (i = num_objects; i < count; i++) {
+		objects[i].obj_id = TEST_OBJ_ID_BASE + i;
+		objects[i].fields = fields;
+		objects[i].field_count = ARRAY_SIZE(fields);
+		objects[i].max_instance_count = 1U;
+		objects[i].create_cb = test_obj_create;
+		lwm2m_register_obj(&objects[i]);
+	}
+
+	num_objects = count;
+
+	for (i = 0; i < count; i++) {
+		if (inst[i].obj) {
+			continue;
+		}
+
+		creating = i;
+		snprintk(path, sizeof(path), "%d/0", TEST_OBJ_ID_BASE + i);
+		zassert_equal(lwm2m_engine_create_obj_inst(path), 0,
+			      "Failed to create %s", path);
+	}
+}
+
+static void resource_path(char *path, int obj, int r)
+{
+	snprintk(path, PATH_LEN, "%d/0/%d", TEST_OBJ_ID_BASE + obj,
+		 fields[r].res_id);
+}
+
+static void test_lookup(void)
+{
+	char path[PATH_LEN];
+	uint32_t value;
+	int i, r;
+
+	register_objects(SMALL_COUNT);
+
+	for (i = 0; i < num_objects; i++) {
+		for (r = 0; r < NUM_RESOURCES; r++) {
+			resource_path(path, i, r);
+			zassert_equal(lwm2m_engine_set_u32(path, i * 10 + r), 0,
+				      "Failed to set %s", path);
+		}
+	}
+
+	for (i = 0; i < num_objects; i++) {
+		for (r = 0; r < NUM_RESOURCES; r++) {
+			zassert_equal(values[i][r], i * 10 + r,
+				      "Wrong resource written");
+
+			resource_path(path, i, r);
+			zassert_equal(lwm2m_engine_get_u32(path, &value), 0,
+				      "Failed to get %s", path);
+			zassert_equal(value, i * 10 + r, "Wrong value");
+		}
+	}
+
+	snprintk(path, sizeof(path), "%d/0/3", TEST_OBJ_ID_BASE);
+	zassert_equal(lwm2m_engine_get_u32(path, &value), -ENOENT,
+		      "Missing resource found");
+
+	snprintk(path, sizeof(path), "%d/1/0", TEST_OBJ_ID_BASE);
+	zassert_equal(lwm2m_engine_get_u32(path, &value), -ENOENT,
+		      "Missing instance found");
+
+	snprintk(path, sizeof(path), "%d/0/0", TEST_OBJ_ID_BASE + NUM_OBJECTS);
+	zassert_equal(lwm2m_engine_get_u32(path, &value), -ENOENT,
+		      "Missing object found");
+}
+
+static void test_delete(void)
+{
+	char path[PATH_LEN];
+	uint32_t value;
+
+	zassert_equal(lwm2m_delete_obj_inst(TEST_OBJ_ID_BASE + 1, 0), 0,
+		      "Failed to delete instance");
+
+	resource_path(path, 1, 0);
+	zassert_equal(lwm2m_engine_get_u32(path, &value), -ENOENT,
+		      "Deleted instance found");
+
+	/* Neighbours in the hash table and the instance list are intact */
+	resource_path(path, 0, 0);
+	zassert_equal(lwm2m_engine_get_u32(path, &value), 0, "Lookup failed");
+	resource_path(path, 2, 0);
+	zassert_equal(lwm2m_engine_get_u32(path, &value), 0, "Lookup failed");
+
+	register_objects(num_objects);
+
+	resource_path(path, 1, 0);
+	zassert_equal(lwm2m_engine_get_u32(path, &value), 0,
+		      "Recreated instance not found");
+}
+
+/* Nanoseconds per lookup of the last BENCH_OBJECTS objects */
+static uint32_t bench(void)
+{
+	char paths[BENCH_OBJECTS][NUM_RESOURCES][PATH_LEN];
+	uint32_t start, cycles, value;
+	int round, i, r;
+
+	for (i = 0; i < BENCH_OBJECTS; i++) {
+		for (r = 0; r < NUM_RESOURCES; r++) {
+			resource_path(paths[i][r],
+				      num_objects - BENCH_OBJECTS + i, r);
+		}
+	}
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < BENCH_OBJECTS; i++) {
+			for (r = 0; r < NUM_RESOURCES; r++) {
+				zassert_equal(lwm2m_engine_get_u32(paths[i][r],
+								   &value),
+					      0, "Lookup failed");
+			}
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return k_cyc_to_ns_floor64(cycles) /
+	       (BENCH_ROUNDS * BENCH_OBJECTS * NUM_RESOURCES);
+}
+
+static void test_lookup_bench(void)
+{
+	uint32_t small, medium, large;
+
+	register_objects(SMALL_COUNT);
+	small = bench();
+
+	register_objects(MEDIUM_COUNT);
+	medium = bench();
+
+	register_objects(NUM_OBJECTS);
+	large = bench();
+
+	TC_PRINT("ns per lookup: %d objects %u, %d objects %u, "
+		 "%d objects %u\n", SMALL_COUNT, small, MEDIUM_COUNT, medium,
+		 NUM_OBJECTS, large);
+
+	/* The lookup cost must not grow with the number of objects */
+	zassert_true(large < 2 * MAX(small, 1U),
+		     "Lookup cost grows with the object count");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_lookup,
+			 ztest_unit_test(test_lookup),
+			 ztest_unit_test(test_delete),
+			 ztest_unit_test(test_lookup_bench)
+			 );
+
+	ztest_run_test_suite(lwm2m_lookup);
+}
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_LWM2M_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/lwm2m.h>
+#include <sys/printk.h>
+
+#include <string.h>
+#include <errno.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_rw_oma_tlv.h"
+#include "lwm2m_rw_json.h"
+#include "lwm2m_rw_senml_cbor.h"
+
+#define TEST_OBJ_ID 32769
+#define NUM_INSTANCES 2
+#define NUM_RESOURCES 6
+
+#define STRING_LEN 16
+#define BENCH_ROUNDS 100
+
+struct test_values {
+	uint32_t u32;
+	int64_t s64;
+	char string[STRING_LEN];
+	bool boolean;
+	float32_value_t float32;
+	struct lwm2m_objlnk objlnk;
+};
+
+static struct lwm2m_engine_obj_field fields[] = {
+	OBJ_FIELD_DATA(0, RW, U32),
+	OBJ_FIELD_DATA(1, RW, S64),
+	OBJ_FIELD_DATA(2, RW, STRING),
+	OBJ_FIELD_DATA(3, RW, BOOL),
+	OBJ_FIELD_DATA(4, RW, FLOAT32),
+	OBJ_FIELD_DATA(5, RW, OBJLNK),
+};
+
+static struct lwm2m_engine_obj test_obj;
+static struct lwm2m_engine_obj_inst inst[NUM_INSTANCES];
+static struct lwm2m_engine_res res[NUM_INSTANCES][NUM_RESOURCES];
+static struct lwm2m_engine_res_inst res_inst[NUM_INSTANCES][NUM_RESOURCES];
+static struct test_values values[NUM_INSTANCES];
+
+static struct lwm2m_ctx ctx;
+static struct lwm2m_message msg;
+static struct coap_packet in_cpkt;
+
+static struct lwm2m_engine_obj_inst *test_obj_create(uint16_t obj_inst_id)
+{
+	struct test_values *v = &values[obj_inst_id];
+	int i = 0, j = 0;
+
+	init_res_instance(res_inst[obj_inst_id],
+			  ARRAY_SIZE(res_inst[obj_inst_id]));
+
+	INIT_OBJ_RES_DATA(0, res[obj_inst_id], i, res_inst[obj_inst_id], j,
+			  &v->u32, sizeof(v->u32));
+	INIT_OBJ_RES_DATA(1, res[obj_inst_id], i, res_inst[obj_inst_id], j,
+			  &v->s64, sizeof(v->s64));
+	INIT_OBJ_RES_DATA(2, res[obj_inst_id], i, res_inst[obj_inst_id], j,
+			  v->string, sizeof(v->string));
+	INIT_OBJ_RES_DATA(3, res[obj_inst_id], i, res_inst[obj_inst_id], j,
+			  &v->boolean, sizeof(v->boolean));
+	INIT_OBJ_RES_DATA(4, res[obj_inst_id], i, res_inst[obj_inst_id], j,
+			  &v->float32, sizeof(v->float32));
+	INIT_OBJ_RES_DATA(5, res[obj_inst_id], i, res_inst[obj_inst_id], j,
+			  &v->objlnk, sizeof(v->objlnk));
+
+	inst[obj_inst_id].resources = res[obj_inst_id];
+	inst[obj_inst_id].resource_count = i;
+
+	return &inst[obj_inst_id];
+}
+
+static void set_values(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_INSTANCES; i++) {
+		values[i].u32 = 1000U + i;
+		values[i].s64 = -5000000000LL - i;
+		snprintk(values[i].string, sizeof(values[i].string),
+			 "instance %d", i);
+		values[i].boolean = i % 2;
+		values[i].float32.val1 = 3 + i;
+		values[i].float32.val2 = 250000;
+		values[i].objlnk.obj_id = 3U;
+		values[i].objlnk.obj_inst = i;
+	}
+}
+
+static void setup(void)
+{
+	char path[16];
+	int i;
+
+	test_obj.obj_id = TEST_OBJ_ID;
+	test_obj.fields = fields;
+	test_obj.field_count = ARRAY_SIZE(fields);
+	test_obj.max_instance_count = NUM_INSTANCES;
+	test_obj.create_cb = test_obj_create;
+	lwm2m_register_obj(&test_obj);
+
+	for (i = 0; i < NUM_INSTANCES; i++) {
+		snprintk(path, sizeof(path), "%d/%d", TEST_OBJ_ID, i);
+		zassert_equal(lwm2m_engine_create_obj_inst(path), 0,
+			      "Failed to create %s", path);
+	}
+
+	set_values();
+}
+
+static void init_msg(const struct lwm2m_writer *writer)
+{
+	int ret;
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.ctx = &ctx;
+	msg.out.writer = writer;
+	msg.out.out_cpkt = &msg.cpkt;
+
+	ret = coap_packet_init(&msg.cpkt, msg.msg_data, sizeof(msg.msg_data),
+			       COAP_VERSION_1, COAP_TYPE_ACK, 0, NULL,
+			       COAP_RESPONSE_CODE_CONTENT, 0);
+	zassert_equal(ret, 0, "Failed to init packet");
+
+	msg.path.obj_id = TEST_OBJ_ID;
+	msg.path.level = 1U;
+}
+
+/* Parse the encoded response, so its payload can be read back */
+static const uint8_t *msg_payload(uint16_t *len)
+{
+	const uint8_t *payload;
+	int ret;
+
+	ret = coap_packet_parse(&in_cpkt, msg.msg_data, msg.cpkt.offset,
+				NULL, 0);
+	zassert_equal(ret, 0, "Failed to parse packet");
+
+	payload = coap_packet_get_payload(&in_cpkt, len);
+	zassert_not_null(payload, "No payload");
+
+	return payload;
+}
+
+/* Use the encoded response as the incoming packet */
+static void set_input(void)
+{
+	uint16_t len;
+
+	(void)msg_payload(&len);
+	msg.in.in_cpkt = &in_cpkt;
+	msg.in.offset = in_cpkt.hdr_len + in_cpkt.opt_len;
+}
+
+typedef int (*read_op_t)(struct lwm2m_message *msg, int content_format);
+
+/* Payload size of the whole object, and nanoseconds per encoding */
+static uint16_t encode(const char *name, const struct lwm2m_writer *writer,
+		       read_op_t read_op, uint16_t format)
+{
+	uint32_t start, cycles;
+	uint16_t len;
+	int round;
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		init_msg(writer);
+		zassert_equal(read_op(&msg, format), 0, "%s read failed",
+			      name);
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	(void)msg_payload(&len);
+
+	TC_PRINT("%s: %u bytes, %u ns per encoding\n", name, len,
+		 (uint32_t)(k_cyc_to_ns_floor64(cycles) / BENCH_ROUNDS));
+
+	return len;
+}
+
+static void test_format_size(void)
+{
+	uint16_t tlv, json, cbor;
+
+	tlv = encode("OMA TLV", &oma_tlv_writer, do_read_op_tlv,
+		     LWM2M_FORMAT_OMA_TLV);
+	json = encode("OMA JSON", &json_writer, do_read_op_json,
+		      LWM2M_FORMAT_OMA_JSON);
+	cbor = encode("SenML CBOR", &senml_cbor_writer, do_read_op_senml_cbor,
+		      LWM2M_FORMAT_APP_SENML_CBOR);
+
+	/* TLV is printed for reference only, it can't carry composite reads */
+	zassert_true(tlv > 0, "Empty TLV payload");
+	zassert_true(cbor < json, "SenML CBOR not smaller than JSON");
+}
+
+static void test_write(void)
+{
+	int i;
+
+	init_msg(&senml_cbor_writer);
+	zassert_equal(do_read_op_senml_cbor(&msg, LWM2M_FORMAT_APP_SENML_CBOR),
+		      0, "Read failed");
+
+	/* write the read payload back to the cleared object */
+	(void)memset(values, 0, sizeof(values));
+
+	set_input();
+	msg.in.reader = &senml_cbor_reader;
+	zassert_equal(do_write_op_senml_cbor(&msg), 0, "Write failed");
+
+	for (i = 0; i < NUM_INSTANCES; i++) {
+		zassert_equal(values[i].u32, 1000U + i, "Wrong u32");
+		zassert_equal(values[i].s64, -5000000000LL - i, "Wrong s64");
+		zassert_equal(values[i].boolean, i % 2, "Wrong bool");
+		zassert_equal(values[i].float32.val1, 3 + i, "Wrong float");
+		zassert_equal(values[i].float32.val2, 250000, "Wrong float");
+		zassert_equal(values[i].objlnk.obj_id, 3U, "Wrong objlnk");
+		zassert_equal(values[i].objlnk.obj_inst, i, "Wrong objlnk");
+	}
+
+	zassert_equal(strcmp(values[0].string, "instance 0"), 0,
+		      "Wrong string");
+	zassert_equal(strcmp(values[1].string, "instance 1"), 0,
+		      "Wrong string");
+
+	set_values();
+}
+
+/* [{0: "/32769/0/1"}, {0: "/32769/1/2"}, {0: "/40000/0"}] */
+static const uint8_t composite_request[] =
+	"\x83"
+	"\xa1\x00\x6a/32769/0/1"
+	"\xa1\x00\x6a/32769/1/2"
+	"\xa1\x00\x68/40000/0";
+
+static void test_composite_read(void)
+{
+	struct lwm2m_obj_path paths[CONFIG_LWM2M_COMPOSITE_PATH_LIST_SIZE];
+	int num_paths, ret;
+
+	/* the request path list, as received in a FETCH payload */
+	init_msg(&senml_cbor_writer);
+	zassert_equal(coap_packet_append_payload_marker(&msg.cpkt), 0,
+		      "Failed to append marker");
+	zassert_equal(coap_packet_append_payload(&msg.cpkt, composite_request,
+						 sizeof(composite_request) - 1),
+		      0, "Failed to append payload");
+
+	set_input();
+
+	num_paths = senml_cbor_parse_path_list(&msg, paths, ARRAY_SIZE(paths));
+	zassert_equal(num_paths, 3, "Wrong path count");
+	zassert_equal(paths[0].level, 3U, "Wrong path level");
+	zassert_equal(paths[1].res_id, 2U, "Wrong path");
+	zassert_equal(paths[2].level, 2U, "Wrong path level");
+
+	ret = senml_cbor_parse_path_list(&msg, paths, 2U);
+	zassert_equal(ret, -ENOMEM, "Too many paths accepted");
+
+	/* the missing object is left out of the response */
+	init_msg(&senml_cbor_writer);
+	ret = do_composite_read_op_senml_cbor(&msg,
+					      LWM2M_FORMAT_APP_SENML_CBOR,
+					      paths, num_paths);
+	zassert_equal(ret, 0, "Composite read failed");
+
+	set_input();
+	ret = senml_cbor_parse_path_list(&msg, paths, ARRAY_SIZE(paths));
+	zassert_equal(ret, 2, "Wrong record count");
+	zassert_equal(paths[0].obj_inst_id, 0U, "Wrong record");
+	zassert_equal(paths[0].res_id, 1U, "Wrong record");
+	zassert_equal(paths[1].obj_inst_id, 1U, "Wrong record");
+	zassert_equal(paths[1].res_id, 2U, "Wrong record");
+}
+
+void test_main(void)
+{
+	setup();
+
+	ztest_test_suite(lwm2m_senml_cbor,
+			 ztest_unit_test(test_format_size),
+			 ztest_unit_test(test_write),
+			 ztest_unit_test(test_composite_read)
+			 );
+
+	ztest_run_test_suite(lwm2m_senml_cbor);
+}
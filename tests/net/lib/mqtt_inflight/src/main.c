@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_MQTT_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/mqtt.h>
+
+#include <string.h>
+#include <errno.h>
+
+#define SERVER_PORT 1883
+#define TIMEOUT_MS 1000
+
+/* Round trip time simulated by the broker before acknowledging */
+#define RTT_MS 20
+
+#define MSG_COUNT 16
+#define WINDOW CONFIG_MQTT_INFLIGHT_MAX
+
+#define PKT_CONNECT 0x10
+#define PKT_CONNACK 0x20
+#define PKT_PUBLISH 0x30
+#define PKT_PUBACK  0x40
+#define PKT_PUBREC  0x50
+#define PKT_PUBREL  0x60
+#define PKT_PUBCOMP 0x70
+
+#define PUBLISH_DUP 0x08
+
+static uint8_t rx_buffer[128];
+static uint8_t tx_buffer[128];
+static struct mqtt_client client_ctx;
+static struct sockaddr_in server_addr;
+static int server_sock;
+static int broker_sock = -1;
+
+static uint8_t topic[] = "sensors";
+static uint8_t payload[] = "0123456789abcdef";
+
+static bool connected;
+static bool release;
+static int pubacks;
+static int pubrecs;
+static int pubcomps;
+
+static void mqtt_evt_handler(struct mqtt_client *const client,
+			     const struct mqtt_evt *evt)
+{
+	switch (evt->type) {
+	case MQTT_EVT_CONNACK:
+		connected = (evt->result == 0);
+		break;
+
+	case MQTT_EVT_DISCONNECT:
+		connected = false;
+		break;
+
+	case MQTT_EVT_PUBACK:
+		pubacks++;
+		break;
+
+	case MQTT_EVT_PUBREC:
+		pubrecs++;
+
+		if (release) {
+			const struct mqtt_pubrel_param rel_param = {
+				.message_id = evt->param.pubrec.message_id
+			};
+
+			(void)mqtt_publish_qos2_release(client, &rel_param);
+		}
+
+		break;
+
+	case MQTT_EVT_PUBCOMP:
+		pubcomps++;
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void recv_all(int sock, uint8_t *buf, size_t len)
+{
+	struct pollfd fds = {
+		.fd = sock,
+		.events = POLLIN,
+	};
+	ssize_t ret;
+
+	while (len > 0) {
+		zassert_equal(poll(&fds, 1, TIMEOUT_MS), 1,
+			      "Timeout waiting for data");
+
+		ret = recv(sock, buf, len, 0);
+		zassert_true(ret > 0, "recv failed (%d)", errno);
+
+		buf += ret;
+		len -= ret;
+	}
+}
+
+/* Read one packet from the client, returns the length of its body */
+static size_t broker_recv(uint8_t *type_and_flags, uint8_t *body,
+			  size_t size)
+{
+	size_t length = 0U;
+	int shift = 0;
+	uint8_t byte;
+
+	recv_all(broker_sock, type_and_flags, 1);
+
+	do {
+		recv_all(broker_sock, &byte, 1);
+		length |= (byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	zassert_true(length <= size, "Packet too long");
+	recv_all(broker_sock, body, length);
+
+	return length;
+}
+
+/* Read a PUBLISH or PUBREL packet, returns its message id */
+static uint16_t broker_recv_msg(uint8_t expected, uint8_t *type_and_flags)
+{
+	uint8_t body[64];
+	size_t pos = 0U;
+
+	broker_recv(type_and_flags, body, sizeof(body));
+	zassert_equal(*type_and_flags & 0xF0, expected,
+		      "Unexpected packet 0x%02x", *type_and_flags);
+
+	if (expected == PKT_PUBLISH) {
+		/* Skip the topic */
+		pos = sizeof(uint16_t) + ((body[0] << 8) | body[1]);
+	}
+
+	return (body[pos] << 8) | body[pos + 1];
+}
+
+/* Acknowledge all the messages in a single write */
+static void broker_send_acks(const uint8_t *types, const uint16_t *ids,
+			     int count)
+{
+	uint8_t buf[4 * WINDOW];
+	int i;
+
+	zassert_true(count <= WINDOW, "Too many acks");
+
+	for (i = 0; i < count; i++) {
+		buf[4 * i] = types[i];
+		buf[4 * i + 1] = 2U;
+		buf[4 * i + 2] = ids[i] >> 8;
+		buf[4 * i + 3] = ids[i];
+	}
+
+	zassert_equal(send(broker_sock, buf, 4 * count, 0), 4 * count,
+		      "send failed (%d)", errno);
+}
+
+static void client_input(void)
+{
+	struct pollfd fds = {
+		.fd = client_ctx.transport.tcp.sock,
+		.events = POLLIN,
+	};
+
+	zassert_equal(poll(&fds, 1, TIMEOUT_MS), 1,
+		      "Timeout waiting for the broker");
+	zassert_equal(mqtt_input(&client_ctx), 0, "mqtt_input failed");
+}
+
+static void client_init(bool clean_session)
+{
+	mqtt_client_init(&client_ctx);
+
+	client_ctx.broker = &server_addr;
+	client_ctx.evt_cb = mqtt_evt_handler;
+	client_ctx.client_id.utf8 = (uint8_t *)"inflight";
+	client_ctx.client_id.size = strlen("inflight");
+	client_ctx.protocol_version = MQTT_VERSION_3_1_1;
+	client_ctx.transport.type = MQTT_TRANSPORT_NON_SECURE;
+	client_ctx.clean_session = clean_session;
+
+	client_ctx.rx_buf = rx_buffer;
+	client_ctx.rx_buf_size = sizeof(rx_buffer);
+	client_ctx.tx_buf = tx_buffer;
+	client_ctx.tx_buf_size = sizeof(tx_buffer);
+
+	pubacks = 0;
+	pubrecs = 0;
+	pubcomps = 0;
+	release = true;
+}
+
+static void client_connect(bool session_present)
+{
+	const uint8_t connack[] = { PKT_CONNACK, 2U, session_present, 0U };
+	uint8_t type_and_flags;
+	uint8_t body[64];
+
+	zassert_equal(mqtt_connect(&client_ctx), 0, "mqtt_connect failed");
+
+	broker_sock = accept(server_sock, NULL, NULL);
+	zassert_true(broker_sock >= 0, "accept failed (%d)", errno);
+
+	broker_recv(&type_and_flags, body, sizeof(body));
+	zassert_equal(type_and_flags, PKT_CONNECT, "CONNECT expected");
+
+	zassert_equal(send(broker_sock, connack, sizeof(connack), 0),
+		      sizeof(connack), "send failed (%d)", errno);
+
+	client_input();
+	zassert_true(connected, "Client not connected");
+}
+
+static void client_disconnect(void)
+{
+	zassert_equal(mqtt_disconnect(&client_ctx), 0,
+		      "mqtt_disconnect failed");
+	zassert_equal(close(broker_sock), 0, "close failed");
+	broker_sock = -1;
+}
+
+static int publish(enum mqtt_qos qos, uint16_t message_id)
+{
+	struct mqtt_publish_param param;
+
+	memset(&param, 0, sizeof(param));
+
+	param.message.topic.qos = qos;
+	param.message.topic.topic.utf8 = topic;
+	param.message.topic.topic.size = sizeof(topic) - 1;
+	param.message.payload.data = payload;
+	param.message.payload.len = sizeof(payload) - 1;
+	param.message_id = message_id;
+
+	return mqtt_publish(&client_ctx, &param);
+}
+
+/* Publish MSG_COUNT QoS 1 messages, with at most @a window of them
+ * waiting for an acknowledgment. Returns the number of round trips.
+ */
+static int publish_rounds(int window)
+{
+	uint8_t types[WINDOW];
+	uint16_t ids[WINDOW];
+	uint8_t type_and_flags;
+	int sent = 0;
+	int rounds = 0;
+	int i, count;
+
+	pubacks = 0;
+
+	while (pubacks < MSG_COUNT) {
+		for (count = 0; count < window && sent < MSG_COUNT; count++) {
+			zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+				      "publish failed");
+			sent++;
+		}
+
+		for (i = 0; i < count; i++) {
+			types[i] = PKT_PUBACK;
+			ids[i] = broker_recv_msg(PKT_PUBLISH, &type_and_flags);
+		}
+
+		k_msleep(RTT_MS);
+		broker_send_acks(types, ids, count);
+
+		/* All the acks are handled by a single call */
+		client_input();
+		zassert_equal(pubacks, sent, "Acks not handled at once");
+
+		rounds++;
+	}
+
+	return rounds;
+}
+
+static void test_setup(void)
+{
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&server_addr.sin_addr),
+		      1, "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(server_sock >= 0, "socket open failed");
+
+	zassert_equal(bind(server_sock, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)),
+		      0, "bind failed");
+	zassert_equal(listen(server_sock, 1), 0, "listen failed");
+}
+
+static void test_message_id_alloc(void)
+{
+	uint8_t type_and_flags;
+	uint16_t id;
+
+	client_init(true);
+	client_connect(false);
+
+	zassert_equal(mqtt_message_id_alloc(&client_ctx), 1, "Invalid id");
+	zassert_equal(mqtt_message_id_alloc(&client_ctx), 2, "Invalid id");
+
+	/* Message id 0 is replaced with an allocated one */
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+		      "publish failed");
+	id = broker_recv_msg(PKT_PUBLISH, &type_and_flags);
+	zassert_equal(id, 3, "Invalid id %d", id);
+
+	/* Ids in flight are skipped */
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 5), 0,
+		      "publish failed");
+	(void)broker_recv_msg(PKT_PUBLISH, &type_and_flags);
+
+	zassert_equal(mqtt_message_id_alloc(&client_ctx), 4, "Invalid id");
+	zassert_equal(mqtt_message_id_alloc(&client_ctx), 6, "Invalid id");
+
+	/* Zero is never allocated */
+	client_ctx.internal.last_message_id = UINT16_MAX;
+	zassert_equal(mqtt_message_id_alloc(&client_ctx), 1, "Invalid id");
+
+	client_disconnect();
+}
+
+static void test_window_limit(void)
+{
+	uint8_t types[WINDOW];
+	uint16_t ids[WINDOW];
+	uint8_t type_and_flags;
+	int i;
+
+	client_init(true);
+	client_connect(false);
+
+	for (i = 0; i < WINDOW; i++) {
+		zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+			      "publish failed");
+	}
+
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), -EAGAIN,
+		      "Window should be full");
+
+	/* QoS 0 messages are not tracked */
+	zassert_equal(publish(MQTT_QOS_0_AT_MOST_ONCE, 0), 0,
+		      "publish failed");
+
+	for (i = 0; i < WINDOW; i++) {
+		ids[i] = broker_recv_msg(PKT_PUBLISH, &type_and_flags);
+	}
+
+	(void)broker_recv_msg(PKT_PUBLISH, &type_and_flags);
+
+	types[0] = PKT_PUBACK;
+	broker_send_acks(types, ids, 1);
+	client_input();
+	zassert_equal(pubacks, 1, "PUBACK not received");
+
+	/* A message with the same id as one in flight is refused */
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, ids[1]), -EBUSY,
+		      "Duplicate id accepted");
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+		      "publish failed");
+
+	client_disconnect();
+}
+
+static void test_pipelined_publish(void)
+{
+	uint32_t start, serial_ms, pipelined_ms;
+	int serial, pipelined;
+
+	client_init(true);
+	client_connect(false);
+
+	start = k_uptime_get_32();
+	serial = publish_rounds(1);
+	serial_ms = k_uptime_get_32() - start;
+
+	start = k_uptime_get_32();
+	pipelined = publish_rounds(WINDOW);
+	pipelined_ms = k_uptime_get_32() - start;
+
+	client_disconnect();
+
+	TC_PRINT("%d messages, window 1: %d round trips, %u ms\n",
+		 MSG_COUNT, serial, serial_ms);
+	TC_PRINT("%d messages, window %d: %d round trips, %u ms\n",
+		 MSG_COUNT, WINDOW, pipelined, pipelined_ms);
+
+	zassert_equal(serial, MSG_COUNT, "Invalid round trip count");
+	zassert_equal(pipelined, ceiling_fraction(MSG_COUNT, WINDOW),
+		      "Invalid round trip count");
+	zassert_true(pipelined_ms < serial_ms / 2,
+		     "Pipelined publishing not faster");
+}
+
+static void test_resend_on_reconnect(void)
+{
+	struct pollfd fds;
+	uint8_t types[WINDOW];
+	uint16_t ids[WINDOW];
+	uint16_t acks[WINDOW];
+	uint8_t type_and_flags;
+	int i;
+
+	client_init(false);
+	client_connect(false);
+
+	for (i = 0; i < 3; i++) {
+		zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+			      "publish failed");
+	}
+
+	zassert_equal(publish(MQTT_QOS_2_EXACTLY_ONCE, 0), 0,
+		      "publish failed");
+
+	for (i = 0; i < 4; i++) {
+		ids[i] = broker_recv_msg(PKT_PUBLISH, &type_and_flags);
+		zassert_false(type_and_flags & PUBLISH_DUP, "DUP flag set");
+	}
+
+	/* The first message is acknowledged and the QoS 2 one received,
+	 * then the connection is lost before PUBREL is sent.
+	 */
+	release = false;
+	types[0] = PKT_PUBACK;
+	acks[0] = ids[0];
+	types[1] = PKT_PUBREC;
+	acks[1] = ids[3];
+	broker_send_acks(types, acks, 2);
+	client_input();
+	zassert_equal(pubacks, 1, "PUBACK not received");
+	zassert_equal(pubrecs, 1, "PUBREC not received");
+
+	zassert_equal(close(broker_sock), 0, "close failed");
+	broker_sock = -1;
+
+	fds.fd = client_ctx.transport.tcp.sock;
+	fds.events = POLLIN;
+	zassert_equal(poll(&fds, 1, TIMEOUT_MS), 1, "Timeout waiting for close");
+	zassert_equal(mqtt_input(&client_ctx), -ENOTCONN,
+		      "Connection loss not detected");
+	zassert_false(connected, "Client still connected");
+
+	/* The session is resumed, pending messages are sent again in
+	 * order with the same ids.
+	 */
+	client_connect(true);
+
+	for (i = 1; i < 3; i++) {
+		zassert_equal(broker_recv_msg(PKT_PUBLISH, &type_and_flags),
+			      ids[i], "Invalid id");
+		zassert_true(type_and_flags & PUBLISH_DUP, "DUP flag not set");
+	}
+
+	zassert_equal(broker_recv_msg(PKT_PUBREL, &type_and_flags), ids[3],
+		      "Invalid id");
+
+	for (i = 0; i < 3; i++) {
+		types[i] = (i < 2) ? PKT_PUBACK : PKT_PUBCOMP;
+		acks[i] = ids[i + 1];
+	}
+
+	broker_send_acks(types, acks, 3);
+	client_input();
+	zassert_equal(pubacks, 3, "PUBACK not received");
+	zassert_equal(pubcomps, 1, "PUBCOMP not received");
+
+	/* The whole window is available again */
+	for (i = 0; i < WINDOW; i++) {
+		zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0), 0,
+			      "publish failed");
+	}
+
+	client_disconnect();
+}
+
+static void test_cleanup(void)
+{
+	zassert_equal(close(server_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mqtt_inflight,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_message_id_alloc),
+			 ztest_unit_test(test_window_limit),
+			 ztest_unit_test(test_pipelined_publish),
+			 ztest_unit_test(test_resend_on_reconnect),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(mqtt_inflight);
+}
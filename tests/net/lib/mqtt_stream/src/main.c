@@ -0,0 +1,453 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_MQTT_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/mqtt.h>
+
+#include <string.h>
+#include <errno.h>
+
+#define SERVER_PORT 1883
+#define TIMEOUT_MS 1000
+
+/* Payloads much larger than the client buffers */
+#define LARGE_PAYLOAD 1000
+#define SMALL_PAYLOAD 10
+#define CHUNK_SIZE 64
+
+#define PKT_CONNECT 0x10
+#define PKT_CONNACK 0x20
+#define PKT_PUBLISH 0x30
+#define PKT_PUBACK  0x40
+
+#define PATTERN(i) ((uint8_t)((i) % 251))
+
+static uint8_t rx_buffer[128];
+static uint8_t tx_buffer[128];
+static struct mqtt_client client_ctx;
+static struct sockaddr_in server_addr;
+static int server_sock;
+static int broker_sock = -1;
+
+static uint8_t topic[] = "firmware";
+static uint8_t broker_buf[2 * (LARGE_PAYLOAD + 16)];
+
+static bool connected;
+static int disconnect_result;
+static bool read_in_callback;
+static int publishes;
+static int pubacks;
+static size_t payload_len;
+
+static void read_payload(struct mqtt_client *const client)
+{
+	uint8_t chunk[CHUNK_SIZE];
+	size_t offset = 0U;
+	int ret, i;
+
+	while (offset < payload_len) {
+		ret = mqtt_read_publish_payload_blocking(
+				client, chunk, MIN(sizeof(chunk),
+						   payload_len - offset));
+		zassert_true(ret > 0, "Failed to read payload (%d)", ret);
+
+		for (i = 0; i < ret; i++) {
+			zassert_equal(chunk[i], PATTERN(offset + i),
+				      "Invalid payload at %d",
+				      (int)(offset + i));
+		}
+
+		offset += ret;
+	}
+
+	/* Nothing left to read */
+	zassert_equal(mqtt_read_publish_payload(client, chunk, sizeof(chunk)),
+		      0, "Payload too long");
+}
+
+static void mqtt_evt_handler(struct mqtt_client *const client,
+			     const struct mqtt_evt *evt)
+{
+	switch (evt->type) {
+	case MQTT_EVT_CONNACK:
+		connected = (evt->result == 0);
+		break;
+
+	case MQTT_EVT_DISCONNECT:
+		connected = false;
+		disconnect_result = evt->result;
+		break;
+
+	case MQTT_EVT_PUBLISH:
+		publishes++;
+		payload_len = evt->param.publish.message.payload.len;
+
+		if (read_in_callback) {
+			read_payload(client);
+		}
+
+		break;
+
+	case MQTT_EVT_PUBACK:
+		pubacks++;
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void recv_all(int sock, uint8_t *buf, size_t len)
+{
+	struct pollfd fds = {
+		.fd = sock,
+		.events = POLLIN,
+	};
+	ssize_t ret;
+
+	while (len > 0) {
+		zassert_equal(poll(&fds, 1, TIMEOUT_MS), 1,
+			      "Timeout waiting for data");
+
+		ret = recv(sock, buf, len, 0);
+		zassert_true(ret > 0, "recv failed (%d)", errno);
+
+		buf += ret;
+		len -= ret;
+	}
+}
+
+/* Read one packet from the client, returns the length of its body */
+static size_t broker_recv(uint8_t *type_and_flags, uint8_t *body,
+			  size_t size)
+{
+	size_t length = 0U;
+	int shift = 0;
+	uint8_t byte;
+
+	recv_all(broker_sock, type_and_flags, 1);
+
+	do {
+		recv_all(broker_sock, &byte, 1);
+		length |= (byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	zassert_true(length <= size, "Packet too long");
+	recv_all(broker_sock, body, length);
+
+	return length;
+}
+
+/* Encode a QoS 0 PUBLISH message, returns its length */
+static size_t broker_encode_publish(uint8_t *buf, size_t len)
+{
+	size_t body_len = sizeof(uint16_t) + sizeof(topic) - 1 + len;
+	size_t pos = 0U;
+	size_t i;
+
+	buf[pos++] = PKT_PUBLISH;
+
+	do {
+		buf[pos] = body_len & 0x7F;
+		body_len >>= 7;
+
+		if (body_len > 0) {
+			buf[pos] |= 0x80;
+		}
+
+		pos++;
+	} while (body_len > 0);
+
+	buf[pos++] = 0U;
+	buf[pos++] = sizeof(topic) - 1;
+	memcpy(&buf[pos], topic, sizeof(topic) - 1);
+	pos += sizeof(topic) - 1;
+
+	for (i = 0; i < len; i++) {
+		buf[pos++] = PATTERN(i);
+	}
+
+	return pos;
+}
+
+/* Send a large and a small message in a single write */
+static void broker_send_publishes(void)
+{
+	size_t len;
+
+	len = broker_encode_publish(broker_buf, LARGE_PAYLOAD);
+	len += broker_encode_publish(broker_buf + len, SMALL_PAYLOAD);
+
+	zassert_equal(send(broker_sock, broker_buf, len, 0), len,
+		      "send failed (%d)", errno);
+}
+
+static void client_input(void)
+{
+	struct pollfd fds = {
+		.fd = client_ctx.transport.tcp.sock,
+		.events = POLLIN,
+	};
+
+	zassert_equal(poll(&fds, 1, TIMEOUT_MS), 1,
+		      "Timeout waiting for the broker");
+	zassert_equal(mqtt_input(&client_ctx), 0, "mqtt_input failed");
+}
+
+static void client_connect(void)
+{
+	const uint8_t connack[] = { PKT_CONNACK, 2U, 0U, 0U };
+	uint8_t type_and_flags;
+	uint8_t body[64];
+
+	mqtt_client_init(&client_ctx);
+
+	client_ctx.broker = &server_addr;
+	client_ctx.evt_cb = mqtt_evt_handler;
+	client_ctx.client_id.utf8 = (uint8_t *)"stream";
+	client_ctx.client_id.size = strlen("stream");
+	client_ctx.protocol_version = MQTT_VERSION_3_1_1;
+	client_ctx.transport.type = MQTT_TRANSPORT_NON_SECURE;
+
+	client_ctx.rx_buf = rx_buffer;
+	client_ctx.rx_buf_size = sizeof(rx_buffer);
+	client_ctx.tx_buf = tx_buffer;
+	client_ctx.tx_buf_size = sizeof(tx_buffer);
+
+	publishes = 0;
+	pubacks = 0;
+
+	zassert_equal(mqtt_connect(&client_ctx), 0, "mqtt_connect failed");
+
+	broker_sock = accept(server_sock, NULL, NULL);
+	zassert_true(broker_sock >= 0, "accept failed (%d)", errno);
+
+	broker_recv(&type_and_flags, body, sizeof(body));
+	zassert_equal(type_and_flags, PKT_CONNECT, "CONNECT expected");
+
+	zassert_equal(send(broker_sock, connack, sizeof(connack), 0),
+		      sizeof(connack), "send failed (%d)", errno);
+
+	client_input();
+	zassert_true(connected, "Client not connected");
+}
+
+static void client_disconnect(void)
+{
+	zassert_equal(mqtt_disconnect(&client_ctx), 0,
+		      "mqtt_disconnect failed");
+	zassert_equal(close(broker_sock), 0, "close failed");
+	broker_sock = -1;
+}
+
+static void test_setup(void)
+{
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&server_addr.sin_addr),
+		      1, "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(server_sock >= 0, "socket open failed");
+
+	zassert_equal(bind(server_sock, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)),
+		      0, "bind failed");
+	zassert_equal(listen(server_sock, 1), 0, "listen failed");
+}
+
+static void test_publish_stream(void)
+{
+	struct mqtt_publish_param param;
+	uint8_t chunk[CHUNK_SIZE];
+	uint8_t type_and_flags;
+	size_t offset, len;
+	int message_id;
+	int i;
+
+	client_connect();
+
+	memset(&param, 0, sizeof(param));
+	param.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE;
+	param.message.topic.topic.utf8 = topic;
+	param.message.topic.topic.size = sizeof(topic) - 1;
+	param.message.payload.len = LARGE_PAYLOAD;
+
+	message_id = mqtt_publish_begin(&client_ctx, &param);
+	zassert_true(message_id > 0, "mqtt_publish_begin failed (%d)",
+		     message_id);
+
+	/* The payload is produced in chunks */
+	for (offset = 0U; offset < LARGE_PAYLOAD; offset += len) {
+		len = MIN(sizeof(chunk), LARGE_PAYLOAD - offset);
+
+		for (i = 0; i < len; i++) {
+			chunk[i] = PATTERN(offset + i);
+		}
+
+		/* Nothing else can be sent in the middle of the payload */
+		zassert_equal(mqtt_publish(&client_ctx, &param), -EBUSY,
+			      "Publish not refused");
+
+		zassert_equal(mqtt_write_publish_payload(&client_ctx, chunk,
+							 len),
+			      0, "Failed to write payload");
+	}
+
+	zassert_equal(mqtt_write_publish_payload(&client_ctx, chunk, 1),
+		      -EINVAL, "Payload too long");
+
+	len = broker_recv(&type_and_flags, broker_buf, sizeof(broker_buf));
+	zassert_equal(type_and_flags & 0xF0, PKT_PUBLISH, "PUBLISH expected");
+
+	offset = sizeof(uint16_t) + sizeof(topic) - 1;
+	zassert_equal((broker_buf[offset] << 8) | broker_buf[offset + 1],
+		      message_id, "Invalid message id");
+	offset += sizeof(uint16_t);
+
+	zassert_equal(len - offset, LARGE_PAYLOAD, "Invalid payload length");
+
+	for (i = 0; i < LARGE_PAYLOAD; i++) {
+		zassert_equal(broker_buf[offset + i], PATTERN(i),
+			      "Invalid payload at %d", i);
+	}
+
+	broker_buf[0] = PKT_PUBACK;
+	broker_buf[1] = 2U;
+	broker_buf[2] = message_id >> 8;
+	broker_buf[3] = message_id;
+	zassert_equal(send(broker_sock, broker_buf, 4, 0), 4,
+		      "send failed (%d)", errno);
+
+	client_input();
+	zassert_equal(pubacks, 1, "PUBACK not received");
+
+	/* Regular messages can be published again */
+	param.message.payload.data = chunk;
+	param.message.payload.len = sizeof(chunk);
+	zassert_equal(mqtt_publish(&client_ctx, &param), 0,
+		      "publish failed");
+
+	client_disconnect();
+}
+
+static void test_publish_stream_disconnect(void)
+{
+	struct mqtt_publish_param param;
+	uint8_t chunk[CHUNK_SIZE] = { 0 };
+	size_t len = 0U;
+	ssize_t ret;
+
+	client_connect();
+
+	memset(&param, 0, sizeof(param));
+	param.message.topic.qos = MQTT_QOS_0_AT_MOST_ONCE;
+	param.message.topic.topic.utf8 = topic;
+	param.message.topic.topic.size = sizeof(topic) - 1;
+	param.message.payload.len = LARGE_PAYLOAD;
+
+	zassert_equal(mqtt_publish_begin(&client_ctx, &param), 0,
+		      "mqtt_publish_begin failed");
+	zassert_equal(mqtt_write_publish_payload(&client_ctx, chunk,
+						 sizeof(chunk)),
+		      0, "Failed to write payload");
+
+	zassert_equal(mqtt_ping(&client_ctx), -EBUSY, "Ping not refused");
+
+	/* The message cannot be completed, give it up */
+	zassert_equal(mqtt_disconnect(&client_ctx), 0,
+		      "mqtt_disconnect failed");
+	zassert_false(connected, "Client still connected");
+	zassert_equal(disconnect_result, -ECONNABORTED,
+		      "Invalid disconnect result (%d)", disconnect_result);
+
+	/* Only the started message was sent, without a DISCONNECT */
+	do {
+		ret = recv(broker_sock, broker_buf + len,
+			   sizeof(broker_buf) - len, 0);
+		zassert_true(ret >= 0, "recv failed (%d)", errno);
+		len += ret;
+	} while (ret > 0);
+
+	zassert_equal(broker_buf[0], PKT_PUBLISH, "PUBLISH expected");
+	zassert_equal(len, 3 + sizeof(uint16_t) + sizeof(topic) - 1 +
+			   sizeof(chunk),
+		      "Invalid length sent (%d)", (int)len);
+
+	zassert_equal(close(broker_sock), 0, "close failed");
+	broker_sock = -1;
+}
+
+static void test_receive_in_callback(void)
+{
+	client_connect();
+
+	read_in_callback = true;
+	broker_send_publishes();
+
+	while (publishes < 2) {
+		client_input();
+	}
+
+	zassert_equal(payload_len, SMALL_PAYLOAD, "Invalid payload length");
+
+	client_disconnect();
+}
+
+static void test_receive_outside_callback(void)
+{
+	client_connect();
+
+	read_in_callback = false;
+	broker_send_publishes();
+
+	client_input();
+	zassert_equal(publishes, 1, "PUBLISH not received");
+	zassert_equal(payload_len, LARGE_PAYLOAD, "Invalid payload length");
+
+	/* The next message is not handled before the payload is read */
+	zassert_equal(mqtt_input(&client_ctx), -EBUSY, "Payload not pending");
+
+	read_payload(&client_ctx);
+
+	/* The next message may have been buffered already */
+	zassert_equal(mqtt_input(&client_ctx), 0, "mqtt_input failed");
+	if (publishes < 2) {
+		client_input();
+	}
+
+	zassert_equal(publishes, 2, "PUBLISH not received");
+	zassert_equal(payload_len, SMALL_PAYLOAD, "Invalid payload length");
+
+	read_payload(&client_ctx);
+
+	client_disconnect();
+}
+
+static void test_cleanup(void)
+{
+	zassert_equal(close(server_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mqtt_stream,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_publish_stream),
+			 ztest_unit_test(test_publish_stream_disconnect),
+			 ztest_unit_test(test_receive_in_callback),
+			 ztest_unit_test(test_receive_outside_callback),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(mqtt_stream);
+}
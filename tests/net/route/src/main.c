@@ -429,6 +429,95 @@ static void test_route_lookup_fail(void)
 			"Route lookup failed for peer address");
 }
 
+/* Prefixes used in the longest prefix match test. They are outside of
+ * the other test addresses and each prefix base address is not covered
+ * by the more specific routes so that net_route_add() does not reuse them.
+ */
+static struct in6_addr lpm_host = { { { 0x20, 0x01, 0x0d, 0xb8, 0x01, 0, 0, 0,
+					0, 0x01, 0, 0x02, 0, 0x03, 0, 0x04 } } };
+static struct in6_addr lpm_prefix96 = { { { 0x20, 0x01, 0x0d, 0xb8, 0x01, 0,
+					    0, 0, 0, 0x01, 0, 0x02,
+					    0, 0, 0, 0 } } };
+static struct in6_addr lpm_prefix64 = { { { 0x20, 0x01, 0x0d, 0xb8, 0x01, 0,
+					    0, 0, 0, 0, 0, 0,
+					    0, 0, 0, 0 } } };
+
+static void test_route_lookup_longest_prefix(void)
+{
+	struct in6_addr in96 = lpm_prefix96;
+	struct in6_addr in64 = lpm_prefix64;
+	struct in6_addr outside = lpm_prefix64;
+	struct net_route_entry *route_host, *route96, *route64;
+
+	in96.s6_addr[15] = 0x99;
+	in64.s6_addr[9] = 0x05;
+	outside.s6_addr[4] = 0x02;
+
+	/* Add the most specific route first, see above. */
+	route_host = net_route_add(my_iface, &lpm_host, 128, &peer_addr);
+	zassert_not_null(route_host, "Host route add failed");
+
+	route96 = net_route_add(my_iface, &lpm_prefix96, 96, &peer_addr);
+	zassert_not_null(route96, "/96 route add failed");
+	zassert_not_equal(route96, route_host, "/96 route not added");
+
+	route64 = net_route_add(my_iface, &lpm_prefix64, 64, &peer_addr);
+	zassert_not_null(route64, "/64 route add failed");
+	zassert_not_equal(route64, route96, "/64 route not added");
+
+	zassert_equal_ptr(net_route_lookup(my_iface, &lpm_host), route_host,
+			  "Host route not found");
+	zassert_equal_ptr(net_route_lookup(NULL, &in96), route96,
+			  "/96 route not found");
+	zassert_equal_ptr(net_route_lookup(my_iface, &in64), route64,
+			  "/64 route not found");
+	zassert_is_null(net_route_lookup(my_iface, &outside),
+			"Route found for address outside of prefixes");
+	zassert_is_null(net_route_lookup(peer_iface, &lpm_host),
+			"Route found for wrong interface");
+
+	/* Removing the /96 route makes the /64 route the best match */
+	zassert_equal(net_route_del(route96), 0, "/96 route del failed");
+	zassert_equal_ptr(net_route_lookup(my_iface, &in96), route64,
+			  "/64 route not used after /96 removal");
+	zassert_equal_ptr(net_route_lookup(my_iface, &lpm_host), route_host,
+			  "Host route not found after /96 removal");
+
+	zassert_equal(net_route_del(route64), 0, "/64 route del failed");
+	zassert_equal(net_route_del(route_host), 0, "Host route del failed");
+
+	zassert_is_null(net_route_lookup(my_iface, &in96),
+			"Route found after all routes removed");
+}
+
+#define ROUTE_LOOKUP_BENCH_COUNT 10000
+
+static void test_route_lookup_bench(void)
+{
+	struct net_route_entry *route;
+	uint32_t start, cycles;
+	uint64_t ns;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < ROUTE_LOOKUP_BENCH_COUNT; i++) {
+		route = net_route_lookup(my_iface,
+					 &dest_addresses[i % max_routes]);
+		zassert_equal_ptr(route, test_routes[i % max_routes],
+				  "Route lookup failed");
+	}
+
+	cycles = k_cycle_get_32() - start;
+	ns = k_cyc_to_ns_floor64(cycles);
+
+	TC_PRINT("%d lookups with %d routes in %u us, %u lookups/s\n",
+		 ROUTE_LOOKUP_BENCH_COUNT, max_routes,
+		 (uint32_t)(ns / NSEC_PER_USEC),
+		 ns ? (uint32_t)((uint64_t)ROUTE_LOOKUP_BENCH_COUNT *
+				 NSEC_PER_SEC / ns) : 0U);
+}
+
 static void test_route_del_nexthop(void)
 {
 	struct in6_addr *nexthop = &peer_addr;
@@ -485,6 +574,7 @@ void test_main(void)
 			ztest_unit_test(test_route_get_nexthop),
 			ztest_unit_test(test_route_lookup_ok),
 			ztest_unit_test(test_route_lookup_fail),
+			ztest_unit_test(test_route_lookup_longest_prefix),
 			ztest_unit_test(test_route_del),
 			ztest_unit_test(test_route_add),
 			ztest_unit_test(test_route_del_nexthop),
@@ -492,6 +582,7 @@ void test_main(void)
 			ztest_unit_test(test_route_del_nexthop_again),
 			ztest_unit_test(test_populate_nbr_cache),
 			ztest_unit_test(test_route_add_many),
+			ztest_unit_test(test_route_lookup_bench),
 			ztest_unit_test(test_route_del_many));
 	ztest_run_test_suite(test_route);
 }
@@ -0,0 +1,412 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_CORE_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define TEST_PORT 4242
+#define PEER_PORT 4343
+#define TEST_DATA_LEN 64
+
+#define BATCH_LEN 8
+#define POLL_PKTS (3 * CONFIG_NET_RX_BATCH_BUDGET + 1)
+#define BENCH_PKTS 2000
+
+#define WAIT_TIME K_MSEC(500)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+static struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+
+static uint8_t test_data[TEST_DATA_LEN];
+
+static struct k_sem wait_data;
+static int recv_count;
+
+struct net_if_test {
+	uint8_t idx;
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 127);
+
+static struct net_if *iface;
+static struct net_context *recv_ctx;
+
+static void recv_cb(struct net_context *context,
+		    struct net_pkt *pkt,
+		    union net_ip_header *ip_hdr,
+		    union net_proto_header *proto_hdr,
+		    int status,
+		    void *user_data)
+{
+	recv_count++;
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_data);
+}
+
+/* Create a UDP datagram as the stress driver would have received it */
+static struct net_pkt *prepare_udp_pkt(void)
+{
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(test_data), AF_INET,
+					   IPPROTO_UDP, K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	if (net_ipv4_create(pkt, &peer_addr, &my_addr) ||
+	    net_udp_create(pkt, htons(PEER_PORT), htons(TEST_PORT)) ||
+	    net_pkt_write(pkt, test_data, sizeof(test_data))) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_ipv4_finalize(pkt, IPPROTO_UDP)) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	return pkt;
+}
+
+static int prepare_batch(struct net_pkt **pkts, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		pkts[i] = prepare_udp_pkt();
+		if (!pkts[i]) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+static void unref_batch(struct net_pkt **pkts, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (pkts[i]) {
+			net_pkt_unref(pkts[i]);
+		}
+	}
+}
+
+static int wait_pkts(int count)
+{
+	while (count--) {
+		if (k_sem_take(&wait_data, WAIT_TIME)) {
+			return -ETIMEDOUT;
+		}
+	}
+
+	return 0;
+}
+
+static void test_setup(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(TEST_PORT),
+	};
+	struct net_if_addr *ifaddr;
+	int ret, i;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	for (i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = (uint8_t)i;
+	}
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &recv_ctx);
+	zassert_equal(ret, 0, "Cannot get receive context (%d)", ret);
+
+	net_ipaddr_copy(&addr.sin_addr, &my_addr);
+
+	ret = net_context_bind(recv_ctx, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	zassert_equal(ret, 0, "Cannot bind receive context (%d)", ret);
+
+	ret = net_context_recv(recv_ctx, recv_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot set receive callback (%d)", ret);
+}
+
+static void test_recv_batch(void)
+{
+	struct net_pkt *pkts[BATCH_LEN];
+	int ret;
+
+	zassert_equal(prepare_batch(pkts, BATCH_LEN), BATCH_LEN,
+		      "Cannot create packets");
+
+	recv_count = 0;
+
+	ret = net_recv_data_batch(iface, pkts, BATCH_LEN);
+	zassert_equal(ret, 0, "Batch receive failed (%d)", ret);
+
+	zassert_equal(wait_pkts(BATCH_LEN), 0, "Timeout while waiting data");
+	zassert_equal(recv_count, BATCH_LEN, "Invalid number of packets (%d)",
+		      recv_count);
+}
+
+static void test_recv_batch_invalid(void)
+{
+	struct net_pkt *pkts[BATCH_LEN];
+	int ret;
+
+	zassert_equal(prepare_batch(pkts, BATCH_LEN), BATCH_LEN,
+		      "Cannot create packets");
+
+	ret = net_recv_data_batch(iface, pkts, 0);
+	zassert_equal(ret, -EINVAL, "Empty batch accepted (%d)", ret);
+
+	/* One invalid packet rejects the whole batch */
+	net_pkt_unref(pkts[BATCH_LEN / 2]);
+	pkts[BATCH_LEN / 2] = NULL;
+
+	recv_count = 0;
+
+	ret = net_recv_data_batch(iface, pkts, BATCH_LEN);
+	zassert_equal(ret, -EINVAL, "Invalid batch accepted (%d)", ret);
+
+	zassert_not_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			  "Rejected batch should not be delivered");
+	zassert_equal(recv_count, 0, "Packets were queued");
+
+	unref_batch(pkts, BATCH_LEN);
+}
+
+static struct net_rx_poll rx_poll;
+static int poll_pending;
+static int poll_calls;
+static int poll_irq_enabled;
+static bool poll_failed;
+
+/* Simulated driver with poll_pending frames in its RX ring */
+static int rx_poll_cb(struct net_if *poll_iface, int budget)
+{
+	struct net_pkt *pkts[CONFIG_NET_RX_BATCH_BUDGET];
+	int count;
+
+	poll_calls++;
+
+	count = MIN(poll_pending, budget);
+	if (count > 0 &&
+	    (prepare_batch(pkts, count) != count ||
+	     net_recv_data_batch(poll_iface, pkts, count) < 0)) {
+		poll_failed = true;
+		return 0;
+	}
+
+	poll_pending -= count;
+
+	if (count < budget) {
+		poll_irq_enabled++;
+	}
+
+	return count;
+}
+
+static void test_rx_poll(void)
+{
+	int expected_calls = POLL_PKTS / CONFIG_NET_RX_BATCH_BUDGET + 1;
+
+	net_rx_poll_init(&rx_poll, iface, rx_poll_cb);
+
+	recv_count = 0;
+	poll_calls = 0;
+	poll_irq_enabled = 0;
+	poll_failed = false;
+	poll_pending = POLL_PKTS;
+
+	/* Simulate the RX interrupt */
+	net_rx_poll_schedule(&rx_poll);
+
+	zassert_equal(wait_pkts(POLL_PKTS), 0, "Timeout while waiting data");
+
+	/* Let the last poll round finish */
+	k_sleep(K_MSEC(10));
+
+	zassert_false(poll_failed, "Poll callback failed");
+	zassert_equal(recv_count, POLL_PKTS, "Invalid number of packets (%d)",
+		      recv_count);
+	zassert_equal(poll_calls, expected_calls,
+		      "Invalid number of poll calls (%d)", poll_calls);
+	zassert_equal(poll_irq_enabled, 1, "Interrupt not re-enabled once");
+}
+
+static uint64_t run_bench(bool batched)
+{
+	struct net_pkt *pkts[BATCH_LEN];
+	uint64_t cycles = 0;
+	uint32_t start;
+	int sent = 0;
+	int count, i;
+
+	recv_count = 0;
+
+	while (sent < BENCH_PKTS) {
+		count = prepare_batch(pkts, BATCH_LEN);
+		zassert_equal(count, BATCH_LEN, "Cannot create packets");
+
+		start = k_cycle_get_32();
+
+		if (batched) {
+			zassert_equal(net_recv_data_batch(iface, pkts, count),
+				      0, "Batch receive failed");
+		} else {
+			for (i = 0; i < count; i++) {
+				zassert_equal(net_recv_data(iface, pkts[i]), 0,
+					      "Receive failed");
+			}
+		}
+
+		zassert_equal(wait_pkts(count), 0,
+			      "Timeout while waiting data");
+
+		cycles += k_cycle_get_32() - start;
+		sent += count;
+	}
+
+	zassert_equal(recv_count, sent, "Packets lost");
+
+	return k_cyc_to_ns_floor64(cycles);
+}
+
+static void test_rx_batch_bench(void)
+{
+	uint64_t single_ns, batch_ns;
+
+	single_ns = run_bench(false);
+	batch_ns = run_bench(true);
+
+	TC_PRINT("RX %d pkts: single %llu ns (%llu pps), "
+		 "batch %llu ns (%llu pps), budget %d\n", BENCH_PKTS,
+		 single_ns, single_ns ? BENCH_PKTS * 1000000000ULL / single_ns : 0,
+		 batch_ns, batch_ns ? BENCH_PKTS * 1000000000ULL / batch_ns : 0,
+		 CONFIG_NET_RX_BATCH_BUDGET);
+}
+
+static void test_cleanup(void)
+{
+	net_context_put(recv_ctx);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_rx_batch_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_recv_batch),
+			 ztest_unit_test(test_recv_batch_invalid),
+			 ztest_unit_test(test_rx_poll),
+			 ztest_unit_test(test_rx_batch_bench),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(net_rx_batch_test);
+}
@@ -0,0 +1,495 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_CORE_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define TEST_PORT 4242
+#define PEER_PORT 5000
+#define TEST_DATA_LEN 64
+
+/* Each flow uses its own source port */
+#define FLOWS 8
+#define PKTS_PER_FLOW 20
+#define BENCH_ROUNDS 250
+
+/* Simulated per packet processing cost of the application */
+#define BENCH_WORK_US 20
+
+#define WAIT_TIME K_MSEC(500)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+static struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+
+static struct k_sem wait_data;
+
+struct flow_data {
+	uint32_t next_seq;
+	k_tid_t thread;
+	bool error;
+};
+
+static struct flow_data flows[FLOWS];
+static bool bench_running;
+
+struct net_if_test {
+	uint8_t idx;
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 127);
+
+static struct net_if *iface;
+static struct net_context *recv_ctx;
+
+static void recv_cb(struct net_context *context,
+		    struct net_pkt *pkt,
+		    union net_ip_header *ip_hdr,
+		    union net_proto_header *proto_hdr,
+		    int status,
+		    void *user_data)
+{
+	struct flow_data *flow;
+	uint32_t seq;
+	uint8_t id;
+
+	if (net_pkt_read_u8(pkt, &id) || id >= FLOWS ||
+	    net_pkt_read_be32(pkt, &seq)) {
+		goto out;
+	}
+
+	/* A flow is only ever processed by one worker thread at a time so
+	 * its data does not need locking.
+	 */
+	flow = &flows[id];
+
+	if (flow->thread == NULL) {
+		flow->thread = k_current_get();
+	} else if (flow->thread != k_current_get()) {
+		flow->error = true;
+	}
+
+	if (seq != flow->next_seq) {
+		flow->error = true;
+	}
+
+	flow->next_seq = seq + 1;
+
+	if (bench_running) {
+		k_busy_wait(BENCH_WORK_US);
+	}
+
+out:
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_data);
+}
+
+static struct net_pkt *prepare_udp_pkt(uint8_t id, uint32_t seq)
+{
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, TEST_DATA_LEN, AF_INET,
+					   IPPROTO_UDP, K_FOREVER);
+	if (!pkt) {
+		return NULL;
+	}
+
+	if (net_ipv4_create(pkt, &peer_addr, &my_addr) ||
+	    net_udp_create(pkt, htons(PEER_PORT + id), htons(TEST_PORT)) ||
+	    net_pkt_write_u8(pkt, id) ||
+	    net_pkt_write_be32(pkt, seq) ||
+	    net_pkt_memset(pkt, 0, TEST_DATA_LEN - 5)) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_ipv4_finalize(pkt, IPPROTO_UDP)) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	return pkt;
+}
+
+/* IPv4 fragment of a UDP datagram, only the first one has the UDP header.
+ * The others have a different port number where the ports would be.
+ */
+static struct net_pkt *prepare_frag_pkt(uint16_t id, uint16_t offset,
+					bool more)
+{
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, TEST_DATA_LEN, AF_INET,
+					   IPPROTO_UDP, K_FOREVER);
+	if (!pkt) {
+		return NULL;
+	}
+
+	ret = net_ipv4_create(pkt, &peer_addr, &my_addr);
+	if (!ret && offset == 0U) {
+		ret = net_udp_create(pkt, htons(PEER_PORT), htons(TEST_PORT));
+	} else if (!ret) {
+		ret = net_pkt_write_be16(pkt, PEER_PORT + offset) ||
+			net_pkt_write_be16(pkt, TEST_PORT + offset);
+	}
+
+	if (ret || net_pkt_memset(pkt, 0, TEST_DATA_LEN - 8)) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = NET_IPV4_HDR(pkt);
+	hdr->proto = IPPROTO_UDP;
+	sys_put_be16(id, hdr->id);
+	sys_put_be16((more ? NET_IPV4_MF : 0U) | (offset / 8U), hdr->offset);
+
+	return pkt;
+}
+
+/* Inject one packet of every flow in a batch */
+static int recv_round(uint32_t seq)
+{
+	struct net_pkt *pkts[FLOWS];
+	int i, ret;
+
+	for (i = 0; i < FLOWS; i++) {
+		pkts[i] = prepare_udp_pkt(i, seq);
+		if (!pkts[i]) {
+			ret = -ENOMEM;
+			goto fail;
+		}
+	}
+
+	ret = net_recv_data_batch(iface, pkts, FLOWS);
+	if (ret == 0) {
+		return 0;
+	}
+
+fail:
+	while (i-- > 0) {
+		net_pkt_unref(pkts[i]);
+	}
+
+	return ret;
+}
+
+static void reset_flows(void)
+{
+	memset(flows, 0, sizeof(flows));
+	k_sem_reset(&wait_data);
+}
+
+static int wait_pkts(int count)
+{
+	while (count--) {
+		if (k_sem_take(&wait_data, WAIT_TIME)) {
+			return -ETIMEDOUT;
+		}
+	}
+
+	return 0;
+}
+
+static int count_threads(void)
+{
+	k_tid_t threads[FLOWS];
+	int count = 0;
+	int i, j;
+
+	for (i = 0; i < FLOWS; i++) {
+		for (j = 0; j < count; j++) {
+			if (threads[j] == flows[i].thread) {
+				break;
+			}
+		}
+
+		if (j == count) {
+			threads[count++] = flows[i].thread;
+		}
+	}
+
+	return count;
+}
+
+static void check_flows(int pkts_per_flow)
+{
+	int i;
+
+	for (i = 0; i < FLOWS; i++) {
+		zassert_false(flows[i].error, "Flow %d out of order", i);
+		zassert_equal(flows[i].next_seq, pkts_per_flow,
+			      "Flow %d lost packets (%u)", i,
+			      flows[i].next_seq);
+	}
+}
+
+static void test_setup(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(TEST_PORT),
+	};
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &recv_ctx);
+	zassert_equal(ret, 0, "Cannot get receive context (%d)", ret);
+
+	net_ipaddr_copy(&addr.sin_addr, &my_addr);
+
+	ret = net_context_bind(recv_ctx, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	zassert_equal(ret, 0, "Cannot bind receive context (%d)", ret);
+
+	ret = net_context_recv(recv_ctx, recv_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot set receive callback (%d)", ret);
+}
+
+static void test_steering_flow_order(void)
+{
+	int seq;
+
+	net_if_flag_set(iface, NET_IF_RX_STEERING);
+
+	reset_flows();
+
+	for (seq = 0; seq < PKTS_PER_FLOW; seq++) {
+		zassert_equal(recv_round(seq), 0, "Receive failed");
+		zassert_equal(wait_pkts(FLOWS), 0,
+			      "Timeout while waiting data");
+	}
+
+	check_flows(PKTS_PER_FLOW);
+
+	zassert_equal(count_threads(), CONFIG_NET_RX_STEERING_WORKERS,
+		      "Flows not spread to all workers");
+}
+
+static void test_steering_disabled(void)
+{
+	int seq;
+
+	net_if_flag_clear(iface, NET_IF_RX_STEERING);
+
+	reset_flows();
+
+	for (seq = 0; seq < PKTS_PER_FLOW; seq++) {
+		zassert_equal(recv_round(seq), 0, "Receive failed");
+		zassert_equal(wait_pkts(FLOWS), 0,
+			      "Timeout while waiting data");
+	}
+
+	check_flows(PKTS_PER_FLOW);
+
+	zassert_equal(count_threads(), 1,
+		      "All flows should be processed in RX queue");
+}
+
+static uint64_t run_bench(bool steering)
+{
+	uint32_t start;
+	int seq;
+
+	if (steering) {
+		net_if_flag_set(iface, NET_IF_RX_STEERING);
+	} else {
+		net_if_flag_clear(iface, NET_IF_RX_STEERING);
+	}
+
+	reset_flows();
+	bench_running = true;
+
+	start = k_cycle_get_32();
+
+	/* Keep at most two rounds in flight to stay within the packet
+	 * pool limits.
+	 */
+	for (seq = 0; seq < BENCH_ROUNDS; seq++) {
+		zassert_equal(recv_round(seq), 0, "Receive failed");
+
+		if (seq > 0) {
+			zassert_equal(wait_pkts(FLOWS), 0,
+				      "Timeout while waiting data");
+		}
+	}
+
+	zassert_equal(wait_pkts(FLOWS), 0, "Timeout while waiting data");
+
+	bench_running = false;
+
+	check_flows(BENCH_ROUNDS);
+
+	return k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+}
+
+static void test_steering_bench(void)
+{
+	uint64_t single_ns, steered_ns;
+	uint64_t pkts = BENCH_ROUNDS * FLOWS;
+
+	single_ns = run_bench(false);
+	steered_ns = run_bench(true);
+
+	TC_PRINT("RX %llu pkts on %d CPU(s): RX queue %llu pps, "
+		 "%d workers %llu pps\n", pkts, CONFIG_MP_NUM_CPUS,
+		 single_ns ? pkts * 1000000000ULL / single_ns : 0,
+		 CONFIG_NET_RX_STEERING_WORKERS,
+		 steered_ns ? pkts * 1000000000ULL / steered_ns : 0);
+}
+
+static void test_steering_fragment_hash(void)
+{
+	struct net_pkt *pkt;
+	uint32_t hash[3];
+	uint16_t id;
+	int i;
+
+	/* All the fragments of a datagram must go to the same worker, as
+	 * the datagram is reassembled there.
+	 */
+	for (id = 1U; id <= FLOWS; id++) {
+		for (i = 0; i < ARRAY_SIZE(hash); i++) {
+			pkt = prepare_frag_pkt(id, i * TEST_DATA_LEN,
+					       i < ARRAY_SIZE(hash) - 1);
+			zassert_not_null(pkt, "Cannot create fragment");
+
+			hash[i] = net_pkt_flow_hash(pkt);
+
+			net_pkt_unref(pkt);
+		}
+
+		zassert_equal(hash[0], hash[1],
+			      "Fragments of datagram %u hashed differently",
+			      id);
+		zassert_equal(hash[0], hash[2],
+			      "Fragments of datagram %u hashed differently",
+			      id);
+	}
+}
+
+static void test_cleanup(void)
+{
+	net_if_flag_clear(iface, NET_IF_RX_STEERING);
+	net_context_put(recv_ctx);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_rx_steering_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_steering_flow_order),
+			 ztest_unit_test(test_steering_disabled),
+			 ztest_unit_test(test_steering_fragment_hash),
+			 ztest_unit_test(test_steering_bench),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(net_rx_steering_test);
+}
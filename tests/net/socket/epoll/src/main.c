@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+
+#include "../../socket_helpers.h"
+
+#define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
+#define STRLEN(buf) (sizeof(buf) - 1)
+
+#define TEST_STR_SMALL "test"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+#define BENCH_PORT 5000
+
+#define WAIT_MS 100
+
+static void send_small(int sock)
+{
+	ssize_t len;
+
+	len = send(sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+}
+
+static void recv_small(int sock)
+{
+	char buf[10];
+	ssize_t len;
+
+	len = recv(sock, buf, sizeof(buf), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid recv len");
+}
+
+static void prepare_udp_pair(int *c_sock, int *s_sock)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	int res;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    c_sock, &c_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    s_sock, &s_addr);
+
+	res = bind(*s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = connect(*c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+}
+
+void test_epoll_level_triggered(void)
+{
+	struct epoll_event ev, events[2];
+	int c_sock, s_sock, epfd;
+	int res;
+
+	prepare_udp_pair(&c_sock, &s_sock);
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed (%d)", errno);
+
+	ev.events = EPOLLIN;
+	ev.data.fd = s_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, -1, "socket added twice");
+	zassert_equal(errno, EEXIST, "unexpected errno %d", errno);
+
+	/* Only sockets can be watched */
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, epfd, &ev);
+	zassert_equal(res, -1, "epoll fd added");
+	zassert_equal(errno, EPERM, "unexpected errno %d", errno);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "unexpected event");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 0, "unexpected event");
+
+	send_small(c_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 1, "no event (%d)", errno);
+	zassert_equal(events[0].events, EPOLLIN, "unexpected events");
+	zassert_equal(events[0].data.fd, s_sock, "unexpected data");
+
+	/* Still readable, so reported again */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "no event");
+
+	recv_small(s_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "unexpected event");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL);
+	zassert_equal(res, -1, "socket removed twice");
+	zassert_equal(errno, ENOENT, "unexpected errno %d", errno);
+
+	send_small(c_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 0, "event from removed socket");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_epoll_edge_triggered(void)
+{
+	struct epoll_event ev, events[2];
+	int c_sock, s_sock, epfd;
+	int res;
+
+	prepare_udp_pair(&c_sock, &s_sock);
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed (%d)", errno);
+
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.u32 = 0x1234;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	send_small(c_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 1, "no event");
+	zassert_equal(events[0].data.u32, 0x1234, "unexpected data");
+
+	/* Not reported again before new data arrives */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "unexpected event");
+
+	send_small(c_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 1, "no event");
+
+	recv_small(s_sock);
+	recv_small(s_sock);
+
+	/* One shot is disabled after the first event until re-armed */
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	send_small(c_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 1, "no event");
+
+	send_small(c_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 0, "unexpected event");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "no event after re-arm");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_epoll_close_socket(void)
+{
+	struct epoll_event ev, events[2];
+	int c_sock, s_sock, epfd;
+	int res;
+
+	prepare_udp_pair(&c_sock, &s_sock);
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed (%d)", errno);
+
+	ev.events = EPOLLIN | EPOLLOUT;
+	ev.data.fd = c_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, c_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	/* Sockets are always writable */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "no event");
+	zassert_equal(events[0].events, EPOLLOUT, "unexpected events");
+
+	/* Closing the socket removes it from the interest list */
+	zassert_equal(close(c_sock), 0, "close failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "event from closed socket");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_epoll_accept(void)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	struct epoll_event ev, events[2];
+	int c_sock, s_sock, new_sock, epfd;
+	int res;
+
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+	res = listen(s_sock, 0);
+	zassert_equal(res, 0, "listen failed");
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed (%d)", errno);
+
+	ev.events = EPOLLIN;
+	ev.data.fd = s_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 1, "no connection event");
+	zassert_equal(events[0].data.fd, s_sock, "unexpected data");
+
+	new_sock = accept(s_sock, NULL, NULL);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	ev.events = EPOLLIN;
+	ev.data.fd = new_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, new_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+
+	send_small(c_sock);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 1, "no data event");
+	zassert_equal(events[0].data.fd, new_sock, "unexpected data");
+
+	recv_small(new_sock);
+
+	/* Peer close is reported as readable */
+	zassert_equal(close(c_sock), 0, "close failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+	zassert_equal(res, 1, "no close event");
+	zassert_equal(events[0].data.fd, new_sock, "unexpected data");
+
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+	zassert_equal(close(epfd), 0, "close failed");
+
+	/* Let the network stack finish the connection teardown */
+	k_msleep(10);
+}
+
+#define BENCH_MAX_SOCKS CONFIG_NET_SOCKETS_POLL_MAX
+#define BENCH_ROUNDS 32
+
+static int bench_socks[BENCH_MAX_SOCKS];
+static struct pollfd bench_pollfds[BENCH_MAX_SOCKS];
+
+/* Wait for a datagram sent to one of the n sockets at a time, with poll()
+ * and with epoll_wait(). Only the time spent in finding the ready socket
+ * is measured.
+ */
+static void bench_wait(int n)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	struct epoll_event ev, events[4];
+	uint64_t poll_cycles = 0U, epoll_cycles = 0U;
+	uint32_t start;
+	int c_sock, epfd;
+	int i, j, res;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &c_sock, &c_addr);
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed (%d)", errno);
+
+	for (i = 0; i < n; i++) {
+		prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR,
+				    BENCH_PORT + i, &bench_socks[i], &s_addr);
+
+		res = bind(bench_socks[i], (struct sockaddr *)&s_addr,
+			   sizeof(s_addr));
+		zassert_equal(res, 0, "bind failed");
+
+		bench_pollfds[i].fd = bench_socks[i];
+		bench_pollfds[i].events = POLLIN;
+
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		res = epoll_ctl(epfd, EPOLL_CTL_ADD, bench_socks[i], &ev);
+		zassert_equal(res, 0, "epoll_ctl failed (%d)", errno);
+	}
+
+	for (j = 0; j < BENCH_ROUNDS; j++) {
+		int ready = -1;
+
+		s_addr.sin6_port = htons(BENCH_PORT + (j * 7) % n);
+
+		res = sendto(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0,
+			     (struct sockaddr *)&s_addr, sizeof(s_addr));
+		zassert_equal(res, STRLEN(TEST_STR_SMALL), "sendto failed");
+
+		/* Let the datagram reach the socket */
+		k_msleep(1);
+
+		start = k_cycle_get_32();
+
+		res = poll(bench_pollfds, n, WAIT_MS);
+
+		for (i = 0; i < n; i++) {
+			if (bench_pollfds[i].revents & POLLIN) {
+				ready = i;
+				break;
+			}
+		}
+
+		poll_cycles += k_cycle_get_32() - start;
+
+		zassert_equal(res, 1, "poll failed");
+		zassert_equal(ready, (j * 7) % n, "wrong socket ready");
+
+		/* epoll reports the same datagram as it is not read yet */
+		start = k_cycle_get_32();
+
+		res = epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_MS);
+
+		epoll_cycles += k_cycle_get_32() - start;
+
+		zassert_equal(res, 1, "epoll_wait failed");
+		zassert_equal(events[0].data.u32, ready, "wrong socket ready");
+
+		recv_small(bench_socks[ready]);
+	}
+
+	TC_PRINT("%3d sockets: poll %llu ns, epoll_wait %llu ns per wait\n",
+		 n, k_cyc_to_ns_floor64(poll_cycles) / BENCH_ROUNDS,
+		 k_cyc_to_ns_floor64(epoll_cycles) / BENCH_ROUNDS);
+
+	for (i = 0; i < n; i++) {
+		zassert_equal(close(bench_socks[i]), 0, "close failed");
+	}
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+}
+
+void test_epoll_bench(void)
+{
+	static const int counts[] = { 10, 50, 100, 250, 500 };
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(counts); i++) {
+		if (counts[i] > BENCH_MAX_SOCKS) {
+			TC_PRINT("Skipping %d sockets, increase "
+				 "CONFIG_NET_SOCKETS_POLL_MAX\n", counts[i]);
+			continue;
+		}
+
+		bench_wait(counts[i]);
+	}
+}
+
+void test_main(void)
+{
+	k_thread_system_pool_assign(k_current_get());
+
+	ztest_test_suite(socket_epoll,
+			 ztest_unit_test(test_epoll_level_triggered),
+			 ztest_user_unit_test(test_epoll_level_triggered),
+			 ztest_unit_test(test_epoll_edge_triggered),
+			 ztest_unit_test(test_epoll_close_socket),
+			 ztest_unit_test(test_epoll_accept),
+			 ztest_unit_test(test_epoll_bench));
+
+	ztest_run_test_suite(socket_epoll);
+}
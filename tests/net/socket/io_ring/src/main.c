@@ -0,0 +1,696 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest_assert.h>
+
+#include <fcntl.h>
+#include <net/socket.h>
+#include <sys/io_ring.h>
+
+#if defined(CONFIG_FILE_SYSTEM)
+#include <fs/fs.h>
+#include <ff.h>
+#endif
+
+#include "../../socket_helpers.h"
+
+#define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
+#define STRLEN(buf) (sizeof(buf) - 1)
+
+#define TEST_STR_SMALL "test"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+#define BENCH_PORT 5000
+
+#define RING_ENTRIES 8
+
+#define WAIT_MS 100
+
+#define FS_MNTP "/RAM:"
+#define FS_TEST_FILE FS_MNTP "/io_ring.txt"
+/* Bytes left free on the volume before the short write */
+#define FS_FREE_LEFT 2
+
+#define BENCH_CONNS 4
+#define BENCH_ROUNDS 200
+#define BENCH_STACK_SIZE 1024
+
+struct test_ring {
+	struct io_ring ring;
+	struct io_ring_sqe sqes[RING_ENTRIES];
+	struct io_ring_cqe cqes[RING_ENTRIES];
+};
+
+static void ring_setup(struct test_ring *r, uint32_t cq_entries)
+{
+	int fd;
+
+	r->ring.sqes = r->sqes;
+	r->ring.sq_entries = ARRAY_SIZE(r->sqes);
+	r->ring.cqes = r->cqes;
+	r->ring.cq_entries = cq_entries;
+
+	fd = io_ring_setup(&r->ring);
+	zassert_true(fd >= 0, "io_ring_setup failed (%d)", fd);
+	zassert_equal(r->ring.fd, fd, "ring fd not set");
+}
+
+static void ring_prep(struct test_ring *r, uint8_t opcode, int fd,
+		      void *buf, size_t len, uint64_t user_data)
+{
+	struct io_ring_sqe *sqe = io_ring_get_sqe(&r->ring);
+
+	zassert_not_null(sqe, "SQ full");
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->buf = buf;
+	sqe->len = len;
+	sqe->user_data = user_data;
+
+	io_ring_sqe_commit(&r->ring);
+}
+
+static void ring_prep_file(struct test_ring *r, uint8_t opcode,
+			   struct fs_file_t *file, void *buf, size_t len,
+			   uint64_t user_data)
+{
+	struct io_ring_sqe *sqe = io_ring_get_sqe(&r->ring);
+
+	zassert_not_null(sqe, "SQ full");
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->file = file;
+	sqe->buf = buf;
+	sqe->len = len;
+	sqe->user_data = user_data;
+
+	io_ring_sqe_commit(&r->ring);
+}
+
+static struct io_ring_cqe ring_reap(struct test_ring *r)
+{
+	struct io_ring_cqe *cqe;
+	struct io_ring_cqe ret;
+
+	cqe = io_ring_peek_cqe(&r->ring);
+	zassert_not_null(cqe, "no completion");
+
+	ret = *cqe;
+	io_ring_cqe_seen(&r->ring);
+
+	return ret;
+}
+
+static void prepare_udp_pair(int *c_sock, int *s_sock, uint16_t port)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	int res;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    c_sock, &c_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, port,
+			    s_sock, &s_addr);
+
+	res = bind(*s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = connect(*c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+}
+
+void test_io_ring_send_recv(void)
+{
+	struct test_ring r;
+	struct io_ring_cqe cqe;
+	char buf[10];
+	int c_sock, s_sock;
+	int res;
+
+	prepare_udp_pair(&c_sock, &s_sock, SERVER_PORT);
+	ring_setup(&r, RING_ENTRIES);
+
+	/* Nothing to receive yet, the operation stays pending */
+	ring_prep(&r, IO_RING_OP_RECV, s_sock, buf, sizeof(buf), 1);
+	res = io_ring_submit_and_wait(&r.ring, 1, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+	zassert_is_null(io_ring_peek_cqe(&r.ring), "unexpected completion");
+
+	ring_prep(&r, IO_RING_OP_SEND, c_sock, BUF_AND_SIZE(TEST_STR_SMALL),
+		  2);
+	res = io_ring_submit_and_wait(&r.ring, 2, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 2, "send should complete first");
+	zassert_equal(cqe.res, STRLEN(TEST_STR_SMALL), "invalid send len");
+	zassert_equal(cqe.flags, 0, "unexpected flags");
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 1, "invalid user data");
+	zassert_equal(cqe.res, STRLEN(TEST_STR_SMALL), "invalid recv len");
+	zassert_mem_equal(buf, TEST_STR_SMALL, STRLEN(TEST_STR_SMALL),
+			  "invalid data");
+
+	zassert_is_null(io_ring_peek_cqe(&r.ring), "unexpected completion");
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_io_ring_read_write(void)
+{
+	struct sockaddr_in6 u_addr;
+	struct test_ring r;
+	struct io_ring_cqe cqe;
+	char buf[10];
+	int sv[2], u_sock;
+	int i, res;
+
+	res = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+	zassert_equal(res, 0, "socketpair failed (%d)", errno);
+
+	ring_setup(&r, RING_ENTRIES);
+
+	/* read() would block the service thread on a blocking socket */
+	ring_prep(&r, IO_RING_OP_READ, sv[1], buf, sizeof(buf), 1);
+	res = io_ring_submit_and_wait(&r.ring, 1, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.res, -EINVAL, "blocking read accepted");
+
+	zassert_equal(fcntl(sv[0], F_SETFL, O_NONBLOCK), 0, "fcntl failed");
+	zassert_equal(fcntl(sv[1], F_SETFL, O_NONBLOCK), 0, "fcntl failed");
+
+	ring_prep(&r, IO_RING_OP_READ, sv[1], buf, sizeof(buf), 1);
+	ring_prep(&r, IO_RING_OP_WRITE, sv[0], BUF_AND_SIZE(TEST_STR_SMALL),
+		  2);
+	res = io_ring_submit_and_wait(&r.ring, 2, K_MSEC(WAIT_MS));
+	zassert_equal(res, 2, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 2, "write should complete first");
+	zassert_equal(cqe.res, STRLEN(TEST_STR_SMALL), "invalid write len");
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 1, "invalid user data");
+	zassert_equal(cqe.res, STRLEN(TEST_STR_SMALL), "invalid read len");
+	zassert_mem_equal(buf, TEST_STR_SMALL, STRLEN(TEST_STR_SMALL),
+			  "invalid data");
+
+	/* A pending operation does not follow a reused descriptor */
+	ring_prep(&r, IO_RING_OP_READ, sv[1], buf, sizeof(buf), 3);
+	res = io_ring_submit_and_wait(&r.ring, 0, K_NO_WAIT);
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	zassert_equal(close(sv[1]), 0, "close failed");
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT, &u_sock,
+			    &u_addr);
+	zassert_equal(u_sock, sv[1], "descriptor not reused");
+
+	/* Any submission makes the service thread check the operation */
+	ring_prep(&r, IO_RING_OP_READ, -1, buf, sizeof(buf), 4);
+	res = io_ring_submit_and_wait(&r.ring, 2, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	/* Closing the socket may already have completed the first one */
+	for (i = 0; i < 2; i++) {
+		cqe = ring_reap(&r);
+		zassert_equal(cqe.res, -EBADF, "read ran on a reused descriptor");
+	}
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+	zassert_equal(close(sv[0]), 0, "close failed");
+	zassert_equal(close(u_sock), 0, "close failed");
+}
+
+void test_io_ring_accept_multishot(void)
+{
+	struct sockaddr_in6 s_addr, c_addr;
+	int c_sock[2], s_sock;
+	struct io_ring_sqe *sqe;
+	struct io_ring_cqe cqe;
+	struct test_ring r;
+	int i, res;
+
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = listen(s_sock, 2);
+	zassert_equal(res, 0, "listen failed");
+
+	ring_setup(&r, RING_ENTRIES);
+
+	sqe = io_ring_get_sqe(&r.ring);
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IO_RING_OP_ACCEPT;
+	sqe->flags = IO_RING_SQE_MULTISHOT;
+	sqe->fd = s_sock;
+	sqe->user_data = 42;
+	io_ring_sqe_commit(&r.ring);
+
+	res = io_ring_submit_and_wait(&r.ring, 0, K_NO_WAIT);
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	for (i = 0; i < ARRAY_SIZE(c_sock); i++) {
+		prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+				    &c_sock[i], &c_addr);
+
+		res = connect(c_sock[i], (struct sockaddr *)&s_addr,
+			      sizeof(s_addr));
+		zassert_equal(res, 0, "connect failed");
+	}
+
+	/* A single submission accepts both connections */
+	res = io_ring_submit_and_wait(&r.ring, 2, K_MSEC(WAIT_MS));
+	zassert_equal(res, 0, "wait failed (%d)", res);
+
+	for (i = 0; i < ARRAY_SIZE(c_sock); i++) {
+		cqe = ring_reap(&r);
+		zassert_equal(cqe.user_data, 42, "invalid user data");
+		zassert_true(cqe.res >= 0, "accept failed (%d)", cqe.res);
+		zassert_equal(cqe.flags, IO_RING_CQE_F_MORE,
+			      "accept not re-armed");
+		zassert_equal(close(cqe.res), 0, "close failed");
+	}
+
+	/* Closing the ring cancels the pending accept */
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+
+	for (i = 0; i < ARRAY_SIZE(c_sock); i++) {
+		zassert_equal(close(c_sock[i]), 0, "close failed");
+	}
+
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	/* Let the TCP connections close */
+	k_msleep(WAIT_MS);
+}
+
+void test_io_ring_errors(void)
+{
+	struct test_ring r;
+	struct io_ring_cqe cqe;
+	struct io_ring_sqe *sqe;
+	char buf[10];
+	int res;
+
+	ring_setup(&r, RING_ENTRIES);
+
+	ring_prep(&r, 0xff, 0, NULL, 0, 1);
+	ring_prep(&r, IO_RING_OP_READ, -1, buf, sizeof(buf), 2);
+
+	sqe = io_ring_get_sqe(&r.ring);
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IO_RING_OP_RECV;
+	sqe->flags = IO_RING_SQE_MULTISHOT;
+	sqe->user_data = 3;
+	io_ring_sqe_commit(&r.ring);
+
+	res = io_ring_submit_and_wait(&r.ring, 3, K_MSEC(WAIT_MS));
+	zassert_equal(res, 3, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 1, "invalid user data");
+	zassert_equal(cqe.res, -EINVAL, "invalid opcode accepted");
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 2, "invalid user data");
+	zassert_equal(cqe.res, -EBADF, "invalid fd accepted");
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 3, "invalid user data");
+	zassert_equal(cqe.res, -EINVAL, "multishot recv accepted");
+
+	res = io_ring_enter(r.ring.fd + 100, 0, 0, K_NO_WAIT);
+	zassert_equal(res, -EBADF, "invalid ring fd accepted");
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+}
+
+void test_io_ring_cq_overflow(void)
+{
+	struct test_ring r;
+	struct io_ring_cqe cqe;
+	int i, res;
+
+	/* Completions that do not fit are held back, in order */
+	ring_setup(&r, 2);
+
+	for (i = 0; i < 4; i++) {
+		ring_prep(&r, 0xff, 0, NULL, 0, i);
+	}
+
+	res = io_ring_submit_and_wait(&r.ring, 2, K_NO_WAIT);
+	zassert_equal(res, 4, "submit failed (%d)", res);
+
+	for (i = 0; i < 2; i++) {
+		cqe = ring_reap(&r);
+		zassert_equal(cqe.user_data, i, "invalid user data");
+	}
+
+	zassert_is_null(io_ring_peek_cqe(&r.ring), "CQ overrun");
+
+	res = io_ring_submit_and_wait(&r.ring, 2, K_NO_WAIT);
+	zassert_equal(res, 0, "wait failed (%d)", res);
+
+	for (i = 2; i < 4; i++) {
+		cqe = ring_reap(&r);
+		zassert_equal(cqe.user_data, i, "invalid user data");
+	}
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+}
+
+#if defined(CONFIG_FILE_SYSTEM)
+static FATFS fat_fs;
+
+static struct fs_mount_t fatfs_mnt = {
+	.type = FS_FATFS,
+	.mnt_point = FS_MNTP,
+	.fs_data = &fat_fs,
+};
+
+/* Leave only FS_FREE_LEFT bytes free on the volume */
+static void fs_fill(struct fs_file_t *file)
+{
+	static char fill[512];
+	struct fs_statvfs stat;
+	size_t left, len;
+	int res;
+
+	res = fs_statvfs(FS_MNTP, &stat);
+	zassert_equal(res, 0, "statvfs failed (%d)", res);
+
+	left = stat.f_bfree * stat.f_frsize - FS_FREE_LEFT;
+
+	while (left > 0) {
+		len = MIN(left, sizeof(fill));
+
+		res = fs_write(file, fill, len);
+		zassert_equal(res, len, "fill failed (%d)", res);
+
+		left -= len;
+	}
+}
+#endif /* CONFIG_FILE_SYSTEM */
+
+void test_io_ring_fs(void)
+{
+	struct test_ring r;
+	struct io_ring_cqe cqe;
+	char buf[10];
+	int res;
+#if defined(CONFIG_FILE_SYSTEM)
+	struct fs_file_t file;
+
+	res = fs_mount(&fatfs_mnt);
+	zassert_equal(res, 0, "mount failed (%d)", res);
+
+	fs_file_t_init(&file);
+	res = fs_open(&file, FS_TEST_FILE, FS_O_CREATE | FS_O_RDWR);
+	zassert_equal(res, 0, "open failed (%d)", res);
+
+	fs_fill(&file);
+
+	ring_setup(&r, RING_ENTRIES);
+
+	/* The volume fills up in the middle of the write */
+	ring_prep_file(&r, IO_RING_OP_FS_WRITE, &file,
+		       BUF_AND_SIZE(TEST_STR_SMALL), 1);
+	res = io_ring_submit_and_wait(&r.ring, 1, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 1, "invalid user data");
+	zassert_equal(cqe.res, FS_FREE_LEFT, "write not cut short (%d)",
+		      cqe.res);
+
+	res = fs_seek(&file, -FS_FREE_LEFT, FS_SEEK_END);
+	zassert_equal(res, 0, "seek failed (%d)", res);
+
+	/* Reads stop at the end of the file */
+	ring_prep_file(&r, IO_RING_OP_FS_READ, &file, buf, sizeof(buf), 2);
+	ring_prep_file(&r, IO_RING_OP_FS_READ, &file, buf, sizeof(buf), 3);
+	res = io_ring_submit_and_wait(&r.ring, 2, K_MSEC(WAIT_MS));
+	zassert_equal(res, 2, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 2, "invalid user data");
+	zassert_equal(cqe.res, FS_FREE_LEFT, "invalid read len (%d)",
+		      cqe.res);
+	zassert_mem_equal(buf, TEST_STR_SMALL, FS_FREE_LEFT, "invalid data");
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.user_data, 3, "invalid user data");
+	zassert_equal(cqe.res, 0, "read past the end (%d)", cqe.res);
+
+	zassert_equal(fs_close(&file), 0, "close failed");
+
+	ring_prep_file(&r, IO_RING_OP_FS_READ, &file, buf, sizeof(buf), 4);
+	res = io_ring_submit_and_wait(&r.ring, 1, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.res, -EBADF, "read from a closed file (%d)",
+		      cqe.res);
+
+	res = fs_open(&file, FS_TEST_FILE, FS_O_READ);
+	zassert_equal(res, 0, "open failed (%d)", res);
+
+	ring_prep_file(&r, IO_RING_OP_FS_WRITE, &file,
+		       BUF_AND_SIZE(TEST_STR_SMALL), 5);
+	res = io_ring_submit_and_wait(&r.ring, 1, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.res, -EACCES, "write to a read-only file (%d)",
+		      cqe.res);
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+	zassert_equal(fs_close(&file), 0, "close failed");
+	zassert_equal(fs_unlink(FS_TEST_FILE), 0, "unlink failed");
+	zassert_equal(fs_unmount(&fatfs_mnt), 0, "unmount failed");
+#else
+	ring_setup(&r, RING_ENTRIES);
+
+	ring_prep_file(&r, IO_RING_OP_FS_READ, NULL, buf, sizeof(buf), 1);
+	ring_prep_file(&r, IO_RING_OP_FS_WRITE, NULL,
+		       BUF_AND_SIZE(TEST_STR_SMALL), 2);
+	res = io_ring_submit_and_wait(&r.ring, 2, K_MSEC(WAIT_MS));
+	zassert_equal(res, 2, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.res, -ENOTSUP, "file read accepted");
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.res, -ENOTSUP, "file write accepted");
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+#endif /* CONFIG_FILE_SYSTEM */
+}
+
+void test_io_ring_fs_user(void)
+{
+	struct test_ring r;
+	struct io_ring_cqe cqe;
+	char buf[10];
+	int res;
+
+	ring_setup(&r, RING_ENTRIES);
+
+	ring_prep_file(&r, IO_RING_OP_FS_READ, NULL, buf, sizeof(buf), 1);
+	res = io_ring_submit_and_wait(&r.ring, 1, K_MSEC(WAIT_MS));
+	zassert_equal(res, 1, "submit failed (%d)", res);
+
+	cqe = ring_reap(&r);
+	zassert_equal(cqe.res,
+		      IS_ENABLED(CONFIG_FILE_SYSTEM) ? -EPERM : -ENOTSUP,
+		      "file read accepted from user mode (%d)", cqe.res);
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+}
+
+static K_THREAD_STACK_ARRAY_DEFINE(bench_stacks, BENCH_CONNS,
+				   BENCH_STACK_SIZE);
+static struct k_thread bench_threads[BENCH_CONNS];
+static K_SEM_DEFINE(bench_sem, 0, BENCH_CONNS);
+static int bench_c_socks[BENCH_CONNS];
+static int bench_s_socks[BENCH_CONNS];
+
+static void bench_receiver(void *p1, void *p2, void *p3)
+{
+	int sock = POINTER_TO_INT(p1);
+	char buf[10];
+	int i;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		if (recv(sock, buf, sizeof(buf), 0) < 0) {
+			break;
+		}
+
+		k_sem_give(&bench_sem);
+	}
+}
+
+static void bench_send_round(void)
+{
+	int i, res;
+
+	for (i = 0; i < BENCH_CONNS; i++) {
+		res = send(bench_c_socks[i], BUF_AND_SIZE(TEST_STR_SMALL), 0);
+		zassert_equal(res, STRLEN(TEST_STR_SMALL), "send failed");
+	}
+}
+
+static uint64_t bench_threads_run(void)
+{
+	uint64_t cycles = 0;
+	uint32_t start;
+	int i, j;
+
+	for (i = 0; i < BENCH_CONNS; i++) {
+		k_thread_create(&bench_threads[i], bench_stacks[i],
+				K_THREAD_STACK_SIZEOF(bench_stacks[i]),
+				bench_receiver, INT_TO_POINTER(bench_s_socks[i]),
+				NULL, NULL,
+				k_thread_priority_get(k_current_get()), 0,
+				K_NO_WAIT);
+	}
+
+	for (j = 0; j < BENCH_ROUNDS; j++) {
+		start = k_cycle_get_32();
+
+		bench_send_round();
+
+		for (i = 0; i < BENCH_CONNS; i++) {
+			zassert_equal(k_sem_take(&bench_sem, K_MSEC(WAIT_MS)),
+				      0, "datagram lost");
+		}
+
+		cycles += k_cycle_get_32() - start;
+	}
+
+	for (i = 0; i < BENCH_CONNS; i++) {
+		k_thread_join(&bench_threads[i], K_FOREVER);
+	}
+
+	return cycles;
+}
+
+static uint64_t bench_ring_run(void)
+{
+	static char bufs[BENCH_CONNS][10];
+	static struct test_ring r;
+	struct io_ring_cqe *cqe;
+	uint64_t cycles = 0;
+	uint32_t start;
+	int i, j, res;
+
+	ring_setup(&r, RING_ENTRIES);
+
+	for (i = 0; i < BENCH_CONNS; i++) {
+		ring_prep(&r, IO_RING_OP_RECV, bench_s_socks[i], bufs[i],
+			  sizeof(bufs[i]), i);
+	}
+
+	for (j = 0; j < BENCH_ROUNDS; j++) {
+		int reaped = 0;
+
+		start = k_cycle_get_32();
+
+		bench_send_round();
+
+		while (reaped < BENCH_CONNS) {
+			/* Submits the re-armed receives of the last round */
+			res = io_ring_submit_and_wait(&r.ring, 1,
+						      K_MSEC(WAIT_MS));
+			zassert_true(res >= 0, "datagram lost (%d)", res);
+
+			while ((cqe = io_ring_peek_cqe(&r.ring)) != NULL) {
+				i = cqe->user_data;
+				zassert_equal(cqe->res, STRLEN(TEST_STR_SMALL),
+					      "invalid recv len");
+				io_ring_cqe_seen(&r.ring);
+
+				ring_prep(&r, IO_RING_OP_RECV,
+					  bench_s_socks[i], bufs[i],
+					  sizeof(bufs[i]), i);
+				reaped++;
+			}
+		}
+
+		cycles += k_cycle_get_32() - start;
+	}
+
+	zassert_equal(close(r.ring.fd), 0, "close failed");
+
+	return cycles;
+}
+
+void test_io_ring_bench(void)
+{
+	uint64_t threads_ns, ring_ns;
+	int i;
+
+	for (i = 0; i < BENCH_CONNS; i++) {
+		prepare_udp_pair(&bench_c_socks[i], &bench_s_socks[i],
+				 BENCH_PORT + i);
+	}
+
+	threads_ns = k_cyc_to_ns_floor64(bench_threads_run());
+	ring_ns = k_cyc_to_ns_floor64(bench_ring_run());
+
+	TC_PRINT("%d connections, %d rounds:\n", BENCH_CONNS, BENCH_ROUNDS);
+	TC_PRINT("thread per connection: %llu ns per round, %llu datagrams/s\n",
+		 threads_ns / BENCH_ROUNDS,
+		 (uint64_t)BENCH_CONNS * BENCH_ROUNDS * NSEC_PER_SEC /
+		 MAX(threads_ns, 1));
+	TC_PRINT("I/O ring: %llu ns per round, %llu datagrams/s\n",
+		 ring_ns / BENCH_ROUNDS,
+		 (uint64_t)BENCH_CONNS * BENCH_ROUNDS * NSEC_PER_SEC /
+		 MAX(ring_ns, 1));
+
+	for (i = 0; i < BENCH_CONNS; i++) {
+		zassert_equal(close(bench_c_socks[i]), 0, "close failed");
+		zassert_equal(close(bench_s_socks[i]), 0, "close failed");
+	}
+}
+
+void test_main(void)
+{
+	k_thread_system_pool_assign(k_current_get());
+
+	ztest_test_suite(socket_io_ring,
+			 ztest_unit_test(test_io_ring_send_recv),
+			 ztest_user_unit_test(test_io_ring_send_recv),
+			 ztest_unit_test(test_io_ring_read_write),
+			 ztest_unit_test(test_io_ring_accept_multishot),
+			 ztest_unit_test(test_io_ring_errors),
+			 ztest_unit_test(test_io_ring_cq_overflow),
+			 ztest_unit_test(test_io_ring_fs),
+			 ztest_user_unit_test(test_io_ring_fs_user),
+			 ztest_unit_test(test_io_ring_bench));
+
+	ztest_run_test_suite(socket_io_ring);
+}
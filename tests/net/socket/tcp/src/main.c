@@ -10,6 +10,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <ztest_assert.h>
 #include <fcntl.h>
 #include <net/socket.h>
+#include <net/net_pkt.h>
 
 #include "../../socket_helpers.h"
 
@@ -23,6 +24,15 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
 #define THREAD_SLEEP 50 /* ms */
 
+/* Larger than the MSS so that the data is sent in several segments, or in
+ * one GSO segment if CONFIG_NET_TCP_GSO is enabled. Over the loopback that
+ * segment is delivered as is, without being split.
+ */
+#define TEST_LARGE_LEN (3 * NET_IPV6_MTU)
+
+static uint8_t large_tx_buf[TEST_LARGE_LEN];
+static uint8_t large_rx_buf[TEST_LARGE_LEN];
+
 static void test_bind(int sock, struct sockaddr *addr, socklen_t addrlen)
 {
 	zassert_equal(bind(sock, addr, addrlen),
@@ -399,6 +409,103 @@ void _test_recv_enotconn(int c_sock, int s_sock)
 	k_sleep(TCP_TEARDOWN_TIMEOUT);
 }
 
+static void test_send_recv_large(int c_sock, int new_sock)
+{
+	size_t sent = 0;
+	ssize_t ret;
+	int i;
+
+	for (i = 0; i < sizeof(large_tx_buf); i++) {
+		large_tx_buf[i] = (uint8_t)i;
+	}
+
+	memset(large_rx_buf, 0, sizeof(large_rx_buf));
+
+	while (sent < sizeof(large_tx_buf)) {
+		ret = send(c_sock, large_tx_buf + sent,
+			   sizeof(large_tx_buf) - sent, 0);
+		zassert_true(ret > 0, "send failed (%d)", errno);
+
+		sent += ret;
+	}
+
+	ret = recv(new_sock, large_rx_buf, sizeof(large_rx_buf), MSG_WAITALL);
+	zassert_equal(ret, sizeof(large_rx_buf), "Invalid length received");
+	zassert_mem_equal(large_rx_buf, large_tx_buf, sizeof(large_rx_buf),
+			  "Invalid data received");
+}
+
+void test_v4_send_recv_large(void)
+{
+	/* Test that data larger than the MSS is sent over the loopback
+	 * correctly.
+	 */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+	zassert_equal(addrlen, sizeof(struct sockaddr_in), "wrong addrlen");
+
+	test_send_recv_large(c_sock, new_sock);
+
+	test_close(c_sock);
+	test_eof(new_sock);
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v6_send_recv_large(void)
+{
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in6 c_saddr;
+	struct sockaddr_in6 s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+	zassert_equal(addrlen, sizeof(struct sockaddr_in6), "wrong addrlen");
+
+	test_send_recv_large(c_sock, new_sock);
+
+	test_close(c_sock);
+	test_eof(new_sock);
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
 void test_v4_recv_enotconn(void)
 {
 	/* For a stream socket, recv() without connect() or accept()
@@ -873,6 +980,76 @@ void test_v6_msg_waitall(void)
 	test_close(c_sock);
 }
 
+void test_v4_recv_zc(void)
+{
+#if defined(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)
+	/* Test zero-copy receive on a ipv4 stream socket. */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	char rx_buf[sizeof(TEST_STR_SMALL) - 1];
+	struct net_pkt *pkt;
+	ssize_t recved;
+	int optval = 1;
+	int ret;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_send(c_sock, TEST_STR_SMALL, strlen(TEST_STR_SMALL), 0);
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	/* Zero-copy receive must be enabled first */
+	recved = zsock_recv_zc(new_sock, &pkt, 0, NULL, NULL);
+	zassert_equal(recved, -1, "zero-copy recv should have failed");
+	zassert_equal(errno, ENOTSUP, "unexpected errno %d", errno);
+
+	ret = setsockopt(new_sock, SOL_SOCKET, SO_RCVZEROCOPY, &optval,
+			 sizeof(optval));
+	zassert_equal(ret, 0, "setsockopt failed (%d)", errno);
+
+	recved = zsock_recv_zc(new_sock, &pkt, 0, NULL, NULL);
+	zassert_equal(recved, strlen(TEST_STR_SMALL),
+		      "unexpected received bytes (%d)", errno);
+
+	/* Only the payload is left in the packet */
+	zassert_equal(net_pkt_get_len(pkt), recved, "headers not dropped");
+	zassert_equal(net_pkt_read(pkt, rx_buf, recved), 0, "read failed");
+	zassert_mem_equal(rx_buf, TEST_STR_SMALL, recved,
+			  "unexpected data");
+
+	ret = zsock_recv_zc_release(new_sock, pkt);
+	zassert_equal(ret, 0, "release failed");
+
+	recved = zsock_recv_zc(new_sock, &pkt, MSG_DONTWAIT, NULL, NULL);
+	zassert_equal(recved, -1, "zero-copy recv should have failed");
+	zassert_equal(errno, EAGAIN, "unexpected errno %d", errno);
+
+	test_close(c_sock);
+
+	recved = zsock_recv_zc(new_sock, &pkt, 0, NULL, NULL);
+	zassert_equal(recved, 0, "EOF not detected");
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+#else
+	ztest_test_skip();
+#endif /* CONFIG_NET_SOCKETS_RECV_ZEROCOPY */
+}
+
 #ifdef CONFIG_USERSPACE
 #define CHILD_STACK_SZ		(2048 + CONFIG_TEST_EXTRA_STACKSIZE)
 struct k_thread child_thread;
@@ -955,6 +1132,8 @@ void test_main(void)
 		ztest_user_unit_test(test_v6_sendto_recvfrom),
 		ztest_user_unit_test(test_v4_sendto_recvfrom_null_dest),
 		ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest),
+		ztest_unit_test(test_v4_send_recv_large),
+		ztest_unit_test(test_v6_send_recv_large),
 		ztest_user_unit_test(test_v4_recv_enotconn),
 		ztest_user_unit_test(test_v6_recv_enotconn),
 		ztest_unit_test(test_open_close_immediately),
@@ -965,6 +1144,7 @@ void test_main(void)
 		ztest_unit_test(test_v6_so_rcvtimeo),
 		ztest_unit_test(test_v4_msg_waitall),
 		ztest_unit_test(test_v6_msg_waitall),
+		ztest_unit_test(test_v4_recv_zc),
 		ztest_user_unit_test(test_socket_permission)
 		);
 
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+
+#include "../../socket_helpers.h"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+
+#define PSK_TAG 1
+
+/* One full handshake followed by resumed ones */
+#define ROUNDS 5
+
+#define SERVER_STACK_SIZE 4096
+
+static const unsigned char psk[] = {
+	0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const char psk_id[] = "test_identity";
+
+/* The full handshake includes an ECDHE key exchange */
+static const int ciphersuites[] = {
+	0xC037, /* TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 */
+};
+
+static const sec_tag_t sec_tag_list[] = {
+	PSK_TAG
+};
+
+static struct sockaddr_in server_addr;
+static int server_sock;
+
+K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+
+static void set_cache(int sock, int cache)
+{
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE,
+				 &cache, sizeof(cache)),
+		      0, "Failed to set session cache (%d)", errno);
+}
+
+static void server_thread_fn(void *p1, void *p2, void *p3)
+{
+	int count = POINTER_TO_INT(p1);
+	int sock;
+	char byte;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (count--) {
+		sock = accept(server_sock, NULL, NULL);
+		zassert_true(sock >= 0, "accept failed (%d)", errno);
+
+		zassert_equal(recv(sock, &byte, sizeof(byte), 0), sizeof(byte),
+			      "recv failed (%d)", errno);
+
+		zassert_equal(close(sock), 0, "close failed");
+	}
+}
+
+static void start_server(int count)
+{
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack),
+			server_thread_fn, INT_TO_POINTER(count), NULL, NULL,
+			K_PRIO_PREEMPT(8), 0, K_NO_WAIT);
+}
+
+/* Connect a client and return the handshake time in microseconds */
+static uint32_t client_connect(int cache)
+{
+	struct sockaddr_in addr;
+	uint32_t start, elapsed;
+	int sock;
+
+	prepare_sock_tls_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &sock, &addr, IPPROTO_TLS_1_2);
+
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST,
+				 sec_tag_list, sizeof(sec_tag_list)),
+		      0, "Failed to set PSK on client socket");
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_CIPHERSUITE_LIST,
+				 ciphersuites, sizeof(ciphersuites)),
+		      0, "Failed to set ciphersuites");
+	set_cache(sock, cache);
+
+	start = k_cycle_get_32();
+
+	zassert_equal(connect(sock, (struct sockaddr *)&server_addr,
+			      sizeof(server_addr)),
+		      0, "connect failed (%d)", errno);
+
+	elapsed = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	zassert_equal(send(sock, "x", 1, 0), 1, "send failed (%d)", errno);
+	zassert_equal(close(sock), 0, "close failed");
+
+	return elapsed;
+}
+
+static void test_setup(void)
+{
+	zassert_equal(tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK,
+					 psk, sizeof(psk)),
+		      0, "Failed to register PSK");
+	zassert_equal(tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK_ID,
+					 psk_id, strlen(psk_id)),
+		      0, "Failed to register PSK ID");
+
+	prepare_sock_tls_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr, IPPROTO_TLS_1_2);
+
+	zassert_equal(setsockopt(server_sock, SOL_TLS, TLS_SEC_TAG_LIST,
+				 sec_tag_list, sizeof(sec_tag_list)),
+		      0, "Failed to set PSK on server socket");
+	set_cache(server_sock, TLS_SESSION_CACHE_ENABLED);
+
+	zassert_equal(bind(server_sock, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)),
+		      0, "bind failed");
+	zassert_equal(listen(server_sock, 1), 0, "listen failed");
+}
+
+static void test_session_cache_option(void)
+{
+	socklen_t optlen = sizeof(int);
+	int optval = 2;
+	int sock, ret;
+	struct sockaddr_in addr;
+
+	prepare_sock_tls_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &sock, &addr, IPPROTO_TLS_1_2);
+
+	ret = getsockopt(sock, SOL_TLS, TLS_SESSION_CACHE, &optval, &optlen);
+	zassert_equal(ret, 0, "getsockopt failed (%d)", errno);
+	zassert_equal(optval, TLS_SESSION_CACHE_DISABLED,
+		      "Session cache should be disabled by default");
+
+	optval = 2;
+	ret = setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE, &optval,
+			 sizeof(optval));
+	zassert_equal(ret, -1, "setsockopt should fail");
+	zassert_equal(errno, EINVAL, "Invalid errno %d", errno);
+
+	set_cache(sock, TLS_SESSION_CACHE_ENABLED);
+
+	ret = getsockopt(sock, SOL_TLS, TLS_SESSION_CACHE, &optval, &optlen);
+	zassert_equal(ret, 0, "getsockopt failed (%d)", errno);
+	zassert_equal(optval, TLS_SESSION_CACHE_ENABLED,
+		      "Session cache should be enabled");
+
+	zassert_equal(close(sock), 0, "close failed");
+}
+
+static void test_session_resumption(void)
+{
+	uint32_t full, resumed = 0U, purged, uncached;
+	int i, sock;
+
+	start_server(ROUNDS + 2);
+
+	/* Only the first connection needs a full handshake */
+	full = client_connect(TLS_SESSION_CACHE_ENABLED);
+
+	for (i = 1; i < ROUNDS; i++) {
+		resumed += client_connect(TLS_SESSION_CACHE_ENABLED);
+	}
+
+	resumed /= ROUNDS - 1;
+
+	/* A client without the cache enabled does not resume the session */
+	uncached = client_connect(TLS_SESSION_CACHE_DISABLED);
+
+	/* After purging the caches, a full handshake is needed again */
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(sock >= 0, "socket open failed");
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE_PURGE,
+				 NULL, 0),
+		      0, "Failed to purge session cache (%d)", errno);
+	zassert_equal(close(sock), 0, "close failed");
+
+	purged = client_connect(TLS_SESSION_CACHE_ENABLED);
+
+	k_thread_join(&server_thread, K_FOREVER);
+
+	TC_PRINT("Handshake time full %u us, resumed %u us\n", full, resumed);
+	TC_PRINT("Handshake time without cache %u us, after purge %u us\n",
+		 uncached, purged);
+
+	zassert_true(resumed < full / 2,
+		     "Resumed handshake not faster than full one");
+	zassert_true(resumed < uncached / 2,
+		     "Resumed handshake not faster than uncached one");
+	zassert_true(resumed < purged / 2,
+		     "Resumed handshake not faster than purged one");
+}
+
+static void test_cleanup(void)
+{
+	zassert_equal(close(server_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(tls_session,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_session_cache_option),
+			 ztest_unit_test(test_session_resumption),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(tls_session);
+}
@@ -14,6 +14,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 
 #include <net/socket.h>
 #include <net/ethernet.h>
+#include <net/net_pkt.h>
 
 #include "ipv6.h"
 #include "../../socket_helpers.h"
@@ -1201,6 +1202,486 @@ void test_v6_msg_trunc(void)
 		       (struct sockaddr *)&server_addr, sizeof(server_addr));
 }
 
+static void comm_sendto_recvmsg(int client_sock, int server_sock,
+				struct sockaddr *server_addr,
+				socklen_t server_addrlen,
+				int level, int type)
+{
+	ZTEST_BMEM static char rx_buf2[8];
+	struct sockaddr_storage addr;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	struct iovec io_vector[2];
+	union {
+		struct cmsghdr hdr;
+		unsigned char  buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+	} cmsgbuf;
+	ssize_t sent;
+	ssize_t recved;
+	int optval = 1;
+	int rv;
+
+	rv = setsockopt(server_sock, level, type == IPV6_PKTINFO ?
+			IPV6_RECVPKTINFO : IP_PKTINFO, &optval,
+			sizeof(optval));
+	zassert_equal(rv, 0, "setsockopt failed (%d)", errno);
+
+	sent = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0, server_addr,
+		      server_addrlen);
+	zassert_equal(sent, STRLEN(TEST_STR2), "sendto failed");
+
+	/* Scatter the datagram to two buffers */
+	clear_buf(rx_buf);
+	clear_buf(rx_buf2);
+	io_vector[0].iov_base = rx_buf2;
+	io_vector[0].iov_len = sizeof(rx_buf2);
+	io_vector[1].iov_base = rx_buf;
+	io_vector[1].iov_len = sizeof(rx_buf);
+
+	memset(&msg, 0, sizeof(msg));
+	memset(&cmsgbuf, 0, sizeof(cmsgbuf));
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = 2;
+	msg.msg_name = &addr;
+	msg.msg_namelen = sizeof(addr);
+	msg.msg_control = &cmsgbuf.buf;
+	msg.msg_controllen = sizeof(cmsgbuf.buf);
+
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, STRLEN(TEST_STR2), "recvmsg failed (%d)",
+		      errno);
+	zassert_mem_equal(rx_buf2, TEST_STR2, sizeof(rx_buf2), "wrong data");
+	zassert_mem_equal(rx_buf, TEST_STR2 + sizeof(rx_buf2),
+			  STRLEN(TEST_STR2) - sizeof(rx_buf2), "wrong data");
+	zassert_equal(msg.msg_namelen, server_addrlen, "unexpected addrlen");
+	zassert_equal(msg.msg_flags, 0, "unexpected flags 0x%x",
+		      msg.msg_flags);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	zassert_not_null(cmsg, "No ancillary data");
+	zassert_equal(cmsg->cmsg_level, level, "Invalid cmsg level");
+	zassert_equal(cmsg->cmsg_type, type, "Invalid cmsg type");
+
+	if (type == IPV6_PKTINFO) {
+		struct in6_pktinfo *info = (void *)CMSG_DATA(cmsg);
+
+		zassert_mem_equal(&info->ipi6_addr,
+				  &net_sin6(server_addr)->sin6_addr,
+				  sizeof(struct in6_addr),
+				  "Invalid destination address");
+		zassert_true(info->ipi6_ifindex > 0, "Invalid ifindex");
+	} else {
+		struct in_pktinfo *info = (void *)CMSG_DATA(cmsg);
+
+		zassert_mem_equal(&info->ipi_addr,
+				  &net_sin(server_addr)->sin_addr,
+				  sizeof(struct in_addr),
+				  "Invalid destination address");
+		zassert_true(info->ipi_ifindex > 0, "Invalid ifindex");
+	}
+
+	/* Too small buffers, both data and ancillary data are truncated */
+	sent = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0, server_addr,
+		      server_addrlen);
+	zassert_equal(sent, STRLEN(TEST_STR2), "sendto failed");
+
+	msg.msg_iovlen = 1;
+	msg.msg_namelen = sizeof(addr);
+	msg.msg_controllen = sizeof(struct cmsghdr);
+
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, sizeof(rx_buf2), "recvmsg failed (%d)", errno);
+	zassert_equal(msg.msg_flags, ZSOCK_MSG_TRUNC | ZSOCK_MSG_CTRUNC,
+		      "unexpected flags 0x%x", msg.msg_flags);
+	zassert_equal(msg.msg_controllen, 0, "unexpected controllen");
+}
+
+void test_v4_recvmsg_pktinfo(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	comm_sendto_recvmsg(client_sock, server_sock,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr), IPPROTO_IP, IP_PKTINFO);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v6_recvmsg_pktinfo(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in6 client_addr;
+	struct sockaddr_in6 server_addr;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	comm_sendto_recvmsg(client_sock, server_sock,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr), IPPROTO_IPV6, IPV6_PKTINFO);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define MMSG_COUNT 4
+#define MMSG_LEN 16
+
+static ZTEST_BMEM char mmsg_buf[MMSG_COUNT][MMSG_LEN];
+
+static void prepare_mmsg(struct mmsghdr *msgs, struct iovec *iov,
+			 struct sockaddr *addr, socklen_t addrlen, bool tx)
+{
+	int i;
+
+	memset(msgs, 0, sizeof(*msgs) * MMSG_COUNT);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		if (tx) {
+			memset(mmsg_buf[i], 'a' + i, MMSG_LEN);
+		} else {
+			memset(mmsg_buf[i], 0, MMSG_LEN);
+		}
+
+		iov[i].iov_base = mmsg_buf[i];
+		iov[i].iov_len = MMSG_LEN;
+
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = addr;
+		msgs[i].msg_hdr.msg_namelen = addrlen;
+	}
+}
+
+void test_v4_sendmmsg_recvmmsg(void)
+{
+	struct mmsghdr msgs[MMSG_COUNT];
+	struct iovec iov[MMSG_COUNT];
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	int client_sock;
+	int server_sock;
+	int rv, i;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	prepare_mmsg(msgs, iov, (struct sockaddr *)&server_addr,
+		     sizeof(server_addr), true);
+
+	rv = sendmmsg(client_sock, msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "sendmmsg failed (%d)", errno);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, MMSG_LEN, "invalid msg_len");
+	}
+
+	prepare_mmsg(msgs, iov, NULL, 0, false);
+
+	/* All the sent messages are queued, so MSG_WAITFORONE returns them
+	 * all in one call.
+	 */
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, MSG_WAITFORONE, NULL);
+	zassert_equal(rv, MMSG_COUNT, "recvmmsg failed (%d)", errno);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, MMSG_LEN, "invalid msg_len");
+		zassert_equal(mmsg_buf[i][0], 'a' + i, "wrong data");
+		zassert_equal(mmsg_buf[i][MMSG_LEN - 1], 'a' + i,
+			      "wrong data");
+	}
+
+	/* Nothing is left, so a non-blocking call fails instead of
+	 * blocking.
+	 */
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, MSG_DONTWAIT, NULL);
+	zassert_equal(rv, -1, "recvmmsg should have failed");
+	zassert_equal(errno, EAGAIN, "incorrect errno value");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define PPS_BENCH_ROUNDS 64
+
+/* Compare the datagram rate of one call per datagram with the batched
+ * calls, all datagrams go through the loopback path of the IP stack.
+ */
+void test_udp_pps_bench(void)
+{
+	struct mmsghdr msgs[MMSG_COUNT];
+	struct iovec iov[MMSG_COUNT];
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	uint64_t single_ns, batch_ns;
+	uint32_t start;
+	int client_sock;
+	int server_sock;
+	int rv, i, j;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < PPS_BENCH_ROUNDS; i++) {
+		for (j = 0; j < MMSG_COUNT; j++) {
+			rv = sendto(client_sock, mmsg_buf[j], MMSG_LEN, 0,
+				    (struct sockaddr *)&server_addr,
+				    sizeof(server_addr));
+			zassert_equal(rv, MMSG_LEN, "sendto failed");
+		}
+
+		for (j = 0; j < MMSG_COUNT; j++) {
+			rv = recv(server_sock, mmsg_buf[j], MMSG_LEN, 0);
+			zassert_equal(rv, MMSG_LEN, "recv failed");
+		}
+	}
+
+	single_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < PPS_BENCH_ROUNDS; i++) {
+		prepare_mmsg(msgs, iov, (struct sockaddr *)&server_addr,
+			     sizeof(server_addr), true);
+
+		rv = sendmmsg(client_sock, msgs, MMSG_COUNT, 0);
+		zassert_equal(rv, MMSG_COUNT, "sendmmsg failed");
+
+		prepare_mmsg(msgs, iov, NULL, 0, false);
+
+		for (j = 0; j < MMSG_COUNT; j += rv) {
+			rv = recvmmsg(server_sock, &msgs[j], MMSG_COUNT - j,
+				      MSG_WAITFORONE, NULL);
+			zassert_true(rv > 0, "recvmmsg failed");
+		}
+	}
+
+	batch_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	TC_PRINT("UDP %d datagrams: per datagram calls %llu ns, "
+		 "batched calls %llu ns\n", PPS_BENCH_ROUNDS * MMSG_COUNT,
+		 single_ns, batch_ns);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v6_recv_zc(void)
+{
+#if defined(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)
+	struct sockaddr_in6 client_addr;
+	struct sockaddr_in6 server_addr;
+	struct sockaddr_in6 addr;
+	socklen_t addrlen = sizeof(addr);
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	int client_sock;
+	int server_sock;
+	ssize_t recved;
+	size_t len = 0;
+	int optval = 1;
+	int rv;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = setsockopt(server_sock, SOL_SOCKET, SO_RCVZEROCOPY, &optval,
+			sizeof(optval));
+	zassert_equal(rv, 0, "setsockopt failed (%d)", errno);
+
+	optval = 0;
+	addrlen = sizeof(optval);
+	rv = getsockopt(server_sock, SOL_SOCKET, SO_RCVZEROCOPY, &optval,
+			&addrlen);
+	zassert_equal(rv, 0, "getsockopt failed (%d)", errno);
+	zassert_equal(optval, 1, "zero-copy receive not enabled");
+
+	rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, STRLEN(TEST_STR2), "sendto failed");
+
+	addrlen = sizeof(addr);
+	recved = zsock_recv_zc(server_sock, &pkt, 0,
+			       (struct sockaddr *)&addr, &addrlen);
+	zassert_equal(recved, STRLEN(TEST_STR2), "zero-copy recv failed (%d)",
+		      errno);
+	zassert_equal(addrlen, sizeof(struct sockaddr_in6),
+		      "unexpected addrlen");
+
+	/* The data spans several fragments, check it in place */
+	for (frag = pkt->buffer; frag; frag = frag->frags) {
+		zassert_true(len + frag->len <= recved, "too much data");
+		zassert_mem_equal(frag->data, TEST_STR2 + len, frag->len,
+				  "unexpected data");
+		len += frag->len;
+	}
+
+	zassert_equal(len, recved, "unexpected data length");
+
+	rv = zsock_recv_zc_release(server_sock, pkt);
+	zassert_equal(rv, 0, "release failed");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+#else
+	ztest_test_skip();
+#endif /* CONFIG_NET_SOCKETS_RECV_ZEROCOPY */
+}
+
+#define ZC_BENCH_ROUNDS 64
+#define ZC_BENCH_BATCH 4
+#define ZC_BENCH_LEN 256
+
+/* Compare the receive bandwidth of the copying recv() and the zero-copy
+ * receive. Only the time spent in receiving the data is measured.
+ */
+void test_recv_zc_bench(void)
+{
+#if defined(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	uint64_t copy_cycles = 0U, zc_cycles = 0U;
+	uint64_t copy_ns, zc_ns;
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	size_t total = 0;
+	uint32_t start;
+	int client_sock;
+	int server_sock;
+	int optval = 1;
+	int rv, i, j;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = setsockopt(server_sock, SOL_SOCKET, SO_RCVZEROCOPY, &optval,
+			sizeof(optval));
+	zassert_equal(rv, 0, "setsockopt failed (%d)", errno);
+
+	for (i = 0; i < ZC_BENCH_ROUNDS; i++) {
+		for (j = 0; j < ZC_BENCH_BATCH; j++) {
+			rv = sendto(client_sock, TEST_STR2, ZC_BENCH_LEN, 0,
+				    (struct sockaddr *)&server_addr,
+				    sizeof(server_addr));
+			zassert_equal(rv, ZC_BENCH_LEN, "sendto failed");
+		}
+
+		start = k_cycle_get_32();
+
+		for (j = 0; j < ZC_BENCH_BATCH; j++) {
+			rv = recv(server_sock, rx_buf, sizeof(rx_buf), 0);
+			zassert_equal(rv, ZC_BENCH_LEN, "recv failed");
+		}
+
+		copy_cycles += k_cycle_get_32() - start;
+
+		for (j = 0; j < ZC_BENCH_BATCH; j++) {
+			rv = sendto(client_sock, TEST_STR2, ZC_BENCH_LEN, 0,
+				    (struct sockaddr *)&server_addr,
+				    sizeof(server_addr));
+			zassert_equal(rv, ZC_BENCH_LEN, "sendto failed");
+		}
+
+		start = k_cycle_get_32();
+
+		for (j = 0; j < ZC_BENCH_BATCH; j++) {
+			rv = zsock_recv_zc(server_sock, &pkt, 0, NULL, NULL);
+			zassert_equal(rv, ZC_BENCH_LEN, "zero-copy recv failed");
+
+			for (frag = pkt->buffer; frag; frag = frag->frags) {
+				total += frag->len;
+			}
+
+			zsock_recv_zc_release(server_sock, pkt);
+		}
+
+		zc_cycles += k_cycle_get_32() - start;
+	}
+
+	zassert_equal(total, ZC_BENCH_ROUNDS * ZC_BENCH_BATCH * ZC_BENCH_LEN,
+		      "unexpected amount of data");
+
+	copy_ns = k_cyc_to_ns_floor64(copy_cycles);
+	zc_ns = k_cyc_to_ns_floor64(zc_cycles);
+
+	TC_PRINT("Received %zu bytes: copy %llu ns (%llu kB/s), "
+		 "zero-copy %llu ns (%llu kB/s)\n", total,
+		 copy_ns, copy_ns ? total * 1000000ULL / copy_ns : 0ULL,
+		 zc_ns, zc_ns ? total * 1000000ULL / zc_ns : 0ULL);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+#else
+	ztest_test_skip();
+#endif /* CONFIG_NET_SOCKETS_RECV_ZEROCOPY */
+}
+
 void test_main(void)
 {
 	k_thread_system_pool_assign(k_current_get());
@@ -1231,7 +1712,17 @@ void test_main(void)
 			 ztest_unit_test(test_v6_sendmsg_with_txtime),
 			 ztest_user_unit_test(test_v6_sendmsg_with_txtime),
 			 ztest_unit_test(test_v4_msg_trunc),
-			 ztest_unit_test(test_v6_msg_trunc)
+			 ztest_unit_test(test_v6_msg_trunc),
+			 ztest_unit_test(test_v4_recvmsg_pktinfo),
+			 ztest_user_unit_test(test_v4_recvmsg_pktinfo),
+			 ztest_unit_test(test_v6_recvmsg_pktinfo),
+			 ztest_user_unit_test(test_v6_recvmsg_pktinfo),
+			 ztest_unit_test(test_v4_sendmmsg_recvmmsg),
+			 ztest_user_unit_test(test_v4_sendmmsg_recvmmsg),
+			 ztest_unit_test(test_udp_pps_bench),
+			 ztest_user_unit_test(test_udp_pps_bench),
+			 ztest_unit_test(test_v6_recv_zc),
+			 ztest_unit_test(test_recv_zc_bench)
 		);
 
 	ztest_run_test_suite(socket_udp);
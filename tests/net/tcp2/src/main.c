@@ -24,7 +24,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
 #include "ipv4.h"
 #include "ipv6.h"
 #include "tcp2.h"
-#include "tcp2_priv.h"
+#include "tcp_internal.h"
 #include "net_stats.h"
 
 #include <ztest.h>
@@ -108,6 +108,12 @@ enum test_state {
 
 static enum test_state t_state;
 
+static struct net_context *accepted_ctx;
+
+static uint16_t test_win = NET_IPV6_MTU;
+static size_t recv_count;
+static size_t recv_len;
+
 static struct k_delayed_work test_server;
 static void test_server_timeout(struct k_work *work);
 
@@ -119,6 +125,8 @@ static void handle_syn_resend(void);
 static void handle_client_fin_wait_2_test(sa_family_t af, struct tcphdr *th);
 static void handle_client_closing_test(sa_family_t af, struct tcphdr *th);
 static void handle_server_recv_out_of_order(struct net_pkt *pkt);
+static void handle_server_delayed_ack(struct net_pkt *pkt);
+static void handle_server_gso(struct net_pkt *pkt);
 
 static void verify_flags(struct tcphdr *th, uint8_t flags,
 			 const char *fun, int line)
@@ -263,7 +271,7 @@ static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 	}
 
 	th->th_flags = flags;
-	th->th_win = NET_IPV6_MTU;
+	th->th_win = test_win;
 	th->th_seq = htonl(seq);
 
 	if (ACK & flags) {
@@ -414,6 +422,14 @@ static int tester_send(const struct device *dev, struct net_pkt *pkt)
 	case 9:
 		handle_server_recv_out_of_order(pkt);
 		break;
+	case 10:
+	case 11:
+	case 13:
+		handle_server_delayed_ack(pkt);
+		break;
+	case 12:
+		handle_server_gso(pkt);
+		break;
 	default:
 		zassert_true(false, "Undefined test case");
 	}
@@ -705,6 +721,11 @@ static void test_tcp_recv_cb(struct net_context *context,
 	if (status && status != -ECONNRESET) {
 		zassert_true(false, "failed to recv the data");
 	}
+
+	if (pkt) {
+		recv_count++;
+		recv_len += net_pkt_get_len(pkt);
+	}
 }
 
 static void test_tcp_accept_cb(struct net_context *ctx,
@@ -719,6 +740,7 @@ static void test_tcp_accept_cb(struct net_context *ctx,
 
 	/* set callback on newly created context */
 	ctx->recv_cb = test_tcp_recv_cb;
+	accepted_ctx = ctx;
 
 	test_sem_give();
 }
@@ -1328,6 +1350,398 @@ static void test_client_invalid_rst(void)
 	net_tcp_put(ctx);
 }
 
+static int delayed_ack_count;
+static uint32_t delayed_ack_value;
+
+static void handle_server_delayed_ack(struct net_pkt *pkt)
+{
+	struct tcphdr th;
+	int ret;
+
+	ret = read_tcp_header(pkt, &th);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	test_verify_flags(&th, ACK);
+
+	delayed_ack_count++;
+	delayed_ack_value = ntohl(th.th_ack);
+
+	test_sem_give();
+
+	return;
+
+fail:
+	zassert_true(false, "%s failed", __func__);
+	net_pkt_unref(pkt);
+}
+
+static void send_delayed_ack_data(uint8_t flags, size_t len)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = tester_prepare_tcp_pkt(AF_INET6, htons(MY_PORT),
+				     htons(PEER_PORT), flags,
+				     lorem_ipsum, len);
+	zassert_not_null(pkt, "Cannot create pkt");
+
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	seq += len;
+}
+
+static void ack_rate_recv_cb(struct net_context *context,
+			     struct net_pkt *pkt,
+			     union net_ip_header *ip_hdr,
+			     union net_proto_header *proto_hdr,
+			     int status,
+			     void *user_data)
+{
+	if (pkt) {
+		net_pkt_unref(pkt);
+	}
+}
+
+/* Test case scenario IPv6
+ *   send one full-sized data segment,
+ *   expect no ACK for it,
+ *   send a second full-sized data segment,
+ *   expect one ACK for both of them,
+ *   send a short data segment with PSH flag,
+ *   expect no immediate ACK for it but an ACK after the delayed ACK
+ *   timeout.
+ */
+static void test_server_delayed_ack(void)
+{
+	struct net_context *ctx;
+	struct net_pkt *pkt;
+	struct tcp *conn;
+	size_t mss;
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_DELAYED_ACK)) {
+		return;
+	}
+
+	ctx = create_server_socket(0, 0);
+
+	/* Leave quick-ack mode so that ACKs are delayed from the start */
+	conn = accepted_ctx->tcp;
+	zassert_not_null(conn, "Accepted connection not found");
+	conn->quickack_segs = 0U;
+
+	mss = net_tcp_get_recv_mss(conn);
+	zassert_true(mss < sizeof(lorem_ipsum), "MSS %zd too large", mss);
+
+	accepted_ctx->recv_cb = ack_rate_recv_cb;
+
+	k_sem_reset(&test_sem);
+	delayed_ack_count = 0;
+	test_case_no = 10;
+
+	send_delayed_ack_data(ACK, mss);
+
+	/* Let the IP stack to process the packet properly */
+	k_msleep(10);
+	zassert_equal(delayed_ack_count, 0, "First segment acked immediately");
+
+	send_delayed_ack_data(ACK, mss);
+
+	test_sem_take(K_MSEC(100), __LINE__);
+	zassert_equal(delayed_ack_count, 1, "Expected one ACK for 2 segments");
+	zassert_equal(delayed_ack_value, seq, "Invalid ACK %u, expected %u",
+		      delayed_ack_value, seq);
+
+	send_delayed_ack_data(PSH | ACK, 10);
+
+	k_msleep(10);
+	zassert_equal(delayed_ack_count, 1, "PSH segment acked immediately");
+
+	test_sem_take(K_MSEC(CONFIG_NET_TCP_DELAYED_ACK_TIMEOUT + 100),
+		      __LINE__);
+	zassert_equal(delayed_ack_count, 2, "Delayed ACK not sent");
+	zassert_equal(delayed_ack_value, seq, "Invalid ACK %u, expected %u",
+		      delayed_ack_value, seq);
+
+	/* Close the accepted connection */
+	pkt = prepare_rst_packet(AF_INET6, htons(MY_PORT), htons(PEER_PORT));
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	k_msleep(50);
+
+	net_tcp_put(ctx);
+}
+
+#define ACK_RATE_SEGMENTS 32
+
+/* Send full-sized segments with PSH flag, as a tcp2 peer does, and wait
+ * for the ACK after every segs_per_ack segments. No ACK depends on the
+ * delayed ACK timer, so the count does not depend on timing.
+ */
+static int ack_rate_send(size_t mss, int segs_per_ack)
+{
+	int i;
+
+	k_sem_reset(&test_sem);
+	delayed_ack_count = 0;
+
+	for (i = 0; i < ACK_RATE_SEGMENTS; i++) {
+		send_delayed_ack_data(PSH | ACK, mss);
+
+		if ((i + 1) % segs_per_ack == 0) {
+			test_sem_take(K_MSEC(100), __LINE__);
+			zassert_equal(delayed_ack_value, seq,
+				      "Invalid ACK %u, expected %u",
+				      delayed_ack_value, seq);
+		}
+	}
+
+	/* Let the IP stack to process any extra ACKs */
+	k_msleep(10);
+
+	return delayed_ack_count;
+}
+
+/* Test case scenario IPv6
+ *   send a stream of full-sized data segments with PSH flag, first with
+ *   quick-ack forced on (one ACK per segment) and then with delayed ACKs,
+ *   print the number of packets per MB of data for both,
+ *   expect delayed ACKs to send exactly one ACK per two segments.
+ */
+static void test_server_delayed_ack_rate(void)
+{
+	int quick_acks, delayed_acks;
+	struct net_context *ctx;
+	struct net_pkt *pkt;
+	uint32_t bytes;
+	bool quickack;
+	size_t mss;
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_DELAYED_ACK)) {
+		return;
+	}
+
+	ctx = create_server_socket(0, 0);
+
+	accepted_ctx->recv_cb = ack_rate_recv_cb;
+	test_case_no = 13;
+
+	mss = net_tcp_get_recv_mss(accepted_ctx->tcp);
+	zassert_true(mss < sizeof(lorem_ipsum), "MSS %zd too large", mss);
+	bytes = ACK_RATE_SEGMENTS * mss;
+
+	quickack = true;
+	ret = net_context_set_option(accepted_ctx, NET_OPT_TCP_QUICKACK,
+				     &quickack, sizeof(quickack));
+	zassert_equal(ret, 0, "Cannot set quick-ack (%d)", ret);
+
+	quick_acks = ack_rate_send(mss, 1);
+
+	quickack = false;
+	ret = net_context_set_option(accepted_ctx, NET_OPT_TCP_QUICKACK,
+				     &quickack, sizeof(quickack));
+	zassert_equal(ret, 0, "Cannot clear quick-ack (%d)", ret);
+	accepted_ctx->tcp->quickack_segs = 0U;
+
+	delayed_acks = ack_rate_send(mss, 2);
+
+	TC_PRINT("Packets per MB: %u with quick-ack, %u with delayed ACK\n",
+		 (ACK_RATE_SEGMENTS + quick_acks) * 1048576U / bytes,
+		 (ACK_RATE_SEGMENTS + delayed_acks) * 1048576U / bytes);
+
+	zassert_equal(quick_acks, ACK_RATE_SEGMENTS,
+		      "Expected one ACK per segment (%d)", quick_acks);
+	zassert_equal(delayed_acks, ACK_RATE_SEGMENTS / 2,
+		      "Expected one ACK per two segments (%d)", delayed_acks);
+
+	/* Close the accepted connection */
+	pkt = prepare_rst_packet(AF_INET6, htons(MY_PORT), htons(PEER_PORT));
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	k_msleep(50);
+
+	net_tcp_put(ctx);
+}
+
+#define GRO_SEGMENTS 4
+#define GRO_SEGMENT_LEN 100
+
+/* Test case scenario IPv6
+ *   send data segments without PSH flag and a final one with PSH flag
+ *   in one receive batch,
+ *   expect the data to be delivered to the application at once,
+ *   expect one ACK for all of the segments.
+ */
+static void test_server_gro(void)
+{
+	struct net_pkt *pkts[GRO_SEGMENTS];
+	struct net_context *ctx;
+	struct net_pkt *pkt;
+	uint8_t flags;
+	int ret, i;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_GRO)) {
+		return;
+	}
+
+	ctx = create_server_socket(0, 0);
+
+	k_sem_reset(&test_sem);
+	delayed_ack_count = 0;
+	recv_count = 0;
+	recv_len = 0;
+	test_case_no = 11;
+
+	for (i = 0; i < GRO_SEGMENTS; i++) {
+		flags = (i == GRO_SEGMENTS - 1) ? (PSH | ACK) : ACK;
+
+		pkts[i] = tester_prepare_tcp_pkt(AF_INET6, htons(MY_PORT),
+						 htons(PEER_PORT), flags,
+						 lorem_ipsum +
+						 i * GRO_SEGMENT_LEN,
+						 GRO_SEGMENT_LEN);
+		zassert_not_null(pkts[i], "Cannot create pkt");
+
+		seq += GRO_SEGMENT_LEN;
+	}
+
+	ret = net_recv_data_batch(iface, pkts, GRO_SEGMENTS);
+	zassert_true(ret == 0, "recv data batch failed (%d)", ret);
+
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	/* Let the IP stack to process any extra ACKs */
+	k_msleep(10);
+
+	zassert_equal(delayed_ack_count, 1, "Expected one ACK for %d segments",
+		      GRO_SEGMENTS);
+	zassert_equal(delayed_ack_value, seq, "Invalid ACK %u, expected %u",
+		      delayed_ack_value, seq);
+	zassert_equal(recv_count, 1, "Segments were not merged (%zd)",
+		      recv_count);
+	zassert_equal(recv_len, GRO_SEGMENTS * GRO_SEGMENT_LEN,
+		      "Invalid data length %zd", recv_len);
+
+	/* Close the accepted connection */
+	pkt = prepare_rst_packet(AF_INET6, htons(MY_PORT), htons(PEER_PORT));
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	k_msleep(50);
+
+	net_tcp_put(ctx);
+}
+
+#define GSO_DATA_LEN 3000
+
+static uint8_t gso_data[GSO_DATA_LEN];
+static size_t gso_sent;
+static uint32_t gso_seq;
+static int gso_segments;
+
+static void handle_server_gso(struct net_pkt *pkt)
+{
+	struct tcphdr th;
+	size_t len;
+	int ret;
+
+	ret = read_tcp_header(pkt, &th);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		net_pkt_ip_opts_len(pkt) - th.th_off * 4U;
+
+	zassert_true(len <= NET_IPV6_MTU, "Segment %zd larger than MSS", len);
+
+	if (gso_segments) {
+		zassert_equal(ntohl(th.th_seq), gso_seq,
+			      "Invalid seq %u, expected %u",
+			      ntohl(th.th_seq), gso_seq);
+	}
+
+	gso_segments++;
+	gso_seq = ntohl(th.th_seq) + len;
+	gso_sent += len;
+
+	if (gso_sent < sizeof(gso_data)) {
+		test_verify_flags(&th, ACK);
+		return;
+	}
+
+	test_verify_flags(&th, PSH | ACK);
+	test_sem_give();
+
+	return;
+
+fail:
+	zassert_true(false, "%s failed", __func__);
+	net_pkt_unref(pkt);
+}
+
+/* Test case scenario IPv6
+ *   send data larger than the MSS from the server,
+ *   expect it to be split into MSS sized segments with consecutive
+ *   sequence numbers and PSH flag only in the last segment.
+ */
+static void test_server_gso(void)
+{
+	struct net_context *ctx;
+	struct net_pkt *pkt;
+	int ret, i;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_GSO)) {
+		return;
+	}
+
+	for (i = 0; i < sizeof(gso_data); i++) {
+		gso_data[i] = lorem_ipsum[i % (sizeof(lorem_ipsum) - 1)];
+	}
+
+	/* Advertise a window that allows sending all the data at once */
+	test_win = htons(8192);
+
+	ctx = create_server_socket(0, 0);
+
+	k_sem_reset(&test_sem);
+	gso_sent = 0;
+	gso_segments = 0;
+	test_case_no = 12;
+
+	ret = net_context_send(accepted_ctx, gso_data, sizeof(gso_data), NULL,
+			       K_NO_WAIT, NULL);
+	zassert_equal(ret, sizeof(gso_data), "Send failed (%d)", ret);
+
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	zassert_equal(gso_segments,
+		      DIV_ROUND_UP(sizeof(gso_data), NET_IPV6_MTU),
+		      "Invalid number of segments (%d)", gso_segments);
+
+	/* Acknowledge the data and close the accepted connection */
+	ack = gso_seq;
+	pkt = prepare_ack_packet(AF_INET6, htons(MY_PORT), htons(PEER_PORT));
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	pkt = prepare_rst_packet(AF_INET6, htons(MY_PORT), htons(PEER_PORT));
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	k_msleep(50);
+
+	test_win = NET_IPV6_MTU;
+
+	net_tcp_put(ctx);
+}
+
 #define MAX_DATA 100
 static uint32_t expected_ack = MAX_DATA + 1 - 15;
 static struct net_context *ooo_ctx;
@@ -1492,6 +1906,10 @@ void test_main(void)
 			 ztest_unit_test(test_client_fin_wait_2_ipv4),
 			 ztest_unit_test(test_client_closing_ipv6),
 			 ztest_unit_test(test_client_invalid_rst),
+			 ztest_unit_test(test_server_delayed_ack),
+			 ztest_unit_test(test_server_delayed_ack_rate),
+			 ztest_unit_test(test_server_gro),
+			 ztest_unit_test(test_server_gso),
 			 ztest_unit_test(test_server_recv_out_of_order_data),
 			 ztest_unit_test(test_server_timeout_out_of_order_data)
 			 );
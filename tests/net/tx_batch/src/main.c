@@ -0,0 +1,217 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IF_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#define TEST_PORT 4242
+#define TEST_DATA_LEN 64
+
+#define BURST_LEN 20
+
+#define WAIT_TIME K_MSEC(500)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+static struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+
+static uint8_t test_data[TEST_DATA_LEN];
+
+static struct k_sem wait_data;
+static bool sent_more[BURST_LEN];
+static int sent_count;
+
+struct net_if_test {
+	uint8_t idx;
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	if (sent_count < BURST_LEN) {
+		sent_more[sent_count] = net_pkt_tx_more(pkt);
+	}
+
+	sent_count++;
+
+	k_sem_give(&wait_data);
+
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 127);
+
+static struct net_if *iface;
+static struct net_context *send_ctx;
+
+static void test_setup(void)
+{
+	struct net_if_addr *ifaddr;
+	int ret, i;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	for (i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = (uint8_t)i;
+	}
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &send_ctx);
+	zassert_equal(ret, 0, "Cannot get send context (%d)", ret);
+}
+
+static void test_send_batch(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(TEST_PORT),
+	};
+	int i, ret, last = 0;
+
+	net_ipaddr_copy(&addr.sin_addr, &peer_addr);
+
+	sent_count = 0;
+
+	/* Keep the TX thread from running until the whole burst is queued */
+	k_sched_lock();
+
+	for (i = 0; i < BURST_LEN; i++) {
+		ret = net_context_sendto(send_ctx, test_data, sizeof(test_data),
+					 (struct sockaddr *)&addr,
+					 sizeof(addr), NULL, K_NO_WAIT, NULL);
+		if (ret != sizeof(test_data)) {
+			break;
+		}
+	}
+
+	k_sched_unlock();
+
+	zassert_equal(i, BURST_LEN, "Send failed (%d)", ret);
+
+	for (i = 0; i < BURST_LEN; i++) {
+		zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			      "Timeout while waiting sent data");
+	}
+
+	zassert_equal(sent_count, BURST_LEN, "Invalid number of packets (%d)",
+		      sent_count);
+
+	/* Only the last packet of each batch lets the driver start the
+	 * transmission.
+	 */
+	for (i = 0; i < BURST_LEN; i++) {
+		bool batch_end = (i == BURST_LEN - 1) ||
+			(i - last + 1 == CONFIG_NET_TX_BATCH_BUDGET);
+
+		zassert_equal(sent_more[i], !batch_end,
+			      "Invalid more flag for packet %d", i);
+
+		if (batch_end) {
+			last = i + 1;
+		}
+	}
+}
+
+static void test_cleanup(void)
+{
+	net_context_put(send_ctx);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tx_batch_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_batch),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(net_tx_batch_test);
+}
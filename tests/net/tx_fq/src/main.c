@@ -0,0 +1,424 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IF_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#define BULK_PORT 4242
+#define PROBE_PORT 4243
+#define BULK_DATA_LEN 1000
+#define PROBE_DATA_LEN 16
+
+/* The dummy driver emulates a link of 500 kB/s */
+#define LINK_US_PER_BYTE 2
+#define BULK_TX_US ((BULK_DATA_LEN + 28) * LINK_US_PER_BYTE)
+
+#define PROBE_COUNT 10
+#define PACING_RATE 10000
+#define PACING_COUNT 5
+
+#define WAIT_TIME K_MSEC(500)
+
+#define LARGE_PKT_MSS 1460
+#if defined(CONFIG_NET_TCP_GSO)
+/* Two full GSO segments of the same connection */
+#define LARGE_PKT_LEN (CONFIG_NET_TCP_GSO_MAX_SEGMENTS * LARGE_PKT_MSS)
+#define LARGE_PKT_COUNT 2
+#else
+/* A single packet larger than the whole queue */
+#define LARGE_PKT_LEN (CONFIG_NET_TC_TX_QUEUE_LIMIT + BULK_DATA_LEN)
+#define LARGE_PKT_COUNT 1
+#endif
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+static struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+
+static uint8_t test_data[BULK_DATA_LEN];
+
+static struct k_sem wait_probe;
+static struct k_sem wait_data;
+static atomic_t bulk_sent;
+static volatile bool bulk_running;
+
+struct net_if_test {
+	uint8_t idx;
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	size_t len = net_pkt_get_len(pkt);
+
+	k_busy_wait(len * LINK_US_PER_BYTE);
+
+	if (len < BULK_DATA_LEN) {
+		k_sem_give(&wait_probe);
+	} else {
+		atomic_inc(&bulk_sent);
+	}
+
+	k_sem_give(&wait_data);
+
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 127);
+
+static struct net_if *iface;
+static struct net_context *bulk_ctx;
+static struct net_context *probe_ctx;
+
+static struct sockaddr_in bulk_addr = {
+	.sin_family = AF_INET,
+	.sin_port = htons(BULK_PORT),
+};
+
+static struct sockaddr_in probe_addr = {
+	.sin_family = AF_INET,
+	.sin_port = htons(PROBE_PORT),
+};
+
+static void test_setup(void)
+{
+	struct net_if_addr *ifaddr;
+	int ret, i;
+
+	k_sem_init(&wait_probe, 0, UINT_MAX);
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	for (i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = (uint8_t)i;
+	}
+
+	net_ipaddr_copy(&bulk_addr.sin_addr, &peer_addr);
+	net_ipaddr_copy(&probe_addr.sin_addr, &peer_addr);
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &bulk_ctx);
+	zassert_equal(ret, 0, "Cannot get bulk context (%d)", ret);
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &probe_ctx);
+	zassert_equal(ret, 0, "Cannot get probe context (%d)", ret);
+}
+
+/* Send probes one at a time and return the average time in microseconds
+ * from handing a probe to the stack until the driver has sent it.
+ */
+static uint32_t probe_latency(void)
+{
+	uint32_t total = 0U;
+	uint32_t start;
+	int i, ret;
+
+	for (i = 0; i < PROBE_COUNT; i++) {
+		start = k_cycle_get_32();
+
+		ret = net_context_sendto(probe_ctx, test_data, PROBE_DATA_LEN,
+					 (struct sockaddr *)&probe_addr,
+					 sizeof(probe_addr), NULL, K_FOREVER,
+					 NULL);
+		zassert_equal(ret, PROBE_DATA_LEN, "Send failed (%d)", ret);
+
+		zassert_equal(k_sem_take(&wait_probe, WAIT_TIME), 0,
+			      "Timeout while waiting probe");
+
+		total += k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+		k_sleep(K_MSEC(5));
+	}
+
+	return total / PROBE_COUNT;
+}
+
+/* Produce data several times faster than the link can send it */
+static void bulk_sender(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (bulk_running) {
+		int i;
+
+		for (i = 0; i < 4; i++) {
+			(void)net_context_sendto(bulk_ctx, test_data,
+						 BULK_DATA_LEN,
+						 (struct sockaddr *)&bulk_addr,
+						 sizeof(bulk_addr), NULL,
+						 K_NO_WAIT, NULL);
+		}
+
+		k_sleep(K_MSEC(1));
+	}
+}
+
+K_THREAD_STACK_DEFINE(bulk_stack, 1024);
+static struct k_thread bulk_thread;
+
+static void test_latency_under_load(void)
+{
+	uint32_t idle, loaded;
+	int queued;
+
+	idle = probe_latency();
+
+	atomic_clear(&bulk_sent);
+	bulk_running = true;
+
+	k_thread_create(&bulk_thread, bulk_stack,
+			K_THREAD_STACK_SIZEOF(bulk_stack),
+			bulk_sender, NULL, NULL, NULL,
+			K_PRIO_COOP(7), 0, K_NO_WAIT);
+
+	/* Let the queue fill up */
+	k_sleep(K_MSEC(100));
+
+	loaded = probe_latency();
+
+	bulk_running = false;
+	k_thread_join(&bulk_thread, K_FOREVER);
+
+	TC_PRINT("Probe latency idle %u us, during bulk upload %u us\n",
+		 idle, loaded);
+
+	/* A full queue holds this many bulk packets. Without fair
+	 * queueing a probe would wait for all of them.
+	 */
+	queued = CONFIG_NET_TC_TX_QUEUE_LIMIT / BULK_DATA_LEN;
+	TC_PRINT("Full queue delay %u us\n", queued * BULK_TX_US);
+
+	/* The probe waits at most for the packet being sent and the one
+	 * the Tx thread already picked as the next one.
+	 */
+	zassert_true(loaded < idle + 3 * BULK_TX_US,
+		     "Probe latency %u us too high", loaded);
+
+	/* Wait until the queue has drained */
+	while (k_sem_take(&wait_data, K_MSEC(100)) == 0) {
+	}
+}
+
+/* Build a TCP packet shaped like a queued GSO segment. The dummy L2
+ * does not split it, so it reaches the driver as is.
+ */
+static struct net_pkt *prepare_large_pkt(void)
+{
+	struct net_buf_pool *tx_data;
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+	size_t len = 0;
+
+	net_pkt_get_info(NULL, NULL, NULL, &tx_data);
+
+	pkt = net_pkt_alloc_on_iface(iface, K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	net_pkt_set_family(pkt, AF_INET);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv4_hdr));
+	net_pkt_set_gso_size(pkt, LARGE_PKT_MSS);
+
+	while (len < LARGE_PKT_LEN) {
+		size_t chunk = MIN(LARGE_PKT_LEN - len, BULK_DATA_LEN);
+		struct net_buf *frag;
+
+		frag = net_buf_alloc_len(tx_data, chunk, K_NO_WAIT);
+		zassert_not_null(frag, "Cannot allocate buffer");
+
+		memset(net_buf_add(frag, chunk), 0, chunk);
+		net_pkt_frag_add(pkt, frag);
+		len += chunk;
+	}
+
+	hdr = (struct net_ipv4_hdr *)pkt->buffer->data;
+	hdr->vhl = 0x45;
+	hdr->ttl = 64;
+	hdr->proto = IPPROTO_TCP;
+	hdr->len = htons(LARGE_PKT_LEN);
+	net_ipaddr_copy(&hdr->src, &my_addr);
+	net_ipaddr_copy(&hdr->dst, &peer_addr);
+
+	return pkt;
+}
+
+static void test_large_packets(void)
+{
+	int i, ret;
+
+	atomic_clear(&bulk_sent);
+
+	/* Queue all the packets before the Tx thread takes any */
+	k_sched_lock();
+
+	for (i = 0; i < LARGE_PKT_COUNT; i++) {
+		ret = net_send_data(prepare_large_pkt());
+		zassert_equal(ret, 0, "Send failed (%d)", ret);
+	}
+
+	k_sched_unlock();
+
+	for (i = 0; i < LARGE_PKT_COUNT; i++) {
+		zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			      "Timeout while waiting data");
+	}
+
+	zassert_equal(atomic_get(&bulk_sent), LARGE_PKT_COUNT,
+		      "Large packet dropped");
+}
+
+static void test_pacing(void)
+{
+	uint32_t rate = PACING_RATE;
+	uint32_t value = 0U;
+	size_t len = sizeof(value);
+	int64_t start, elapsed;
+	int i, ret;
+
+	ret = net_context_set_option(bulk_ctx, NET_OPT_MAX_PACING_RATE,
+				     &rate, sizeof(rate));
+	zassert_equal(ret, 0, "Cannot set pacing rate (%d)", ret);
+
+	ret = net_context_get_option(bulk_ctx, NET_OPT_MAX_PACING_RATE,
+				     &value, &len);
+	zassert_equal(ret, 0, "Cannot get pacing rate (%d)", ret);
+	zassert_equal(value, PACING_RATE, "Invalid pacing rate %u", value);
+
+	start = k_uptime_get();
+
+	for (i = 0; i < PACING_COUNT; i++) {
+		ret = net_context_sendto(bulk_ctx, test_data, BULK_DATA_LEN,
+					 (struct sockaddr *)&bulk_addr,
+					 sizeof(bulk_addr), NULL, K_FOREVER,
+					 NULL);
+		zassert_equal(ret, BULK_DATA_LEN, "Send failed (%d)", ret);
+	}
+
+	elapsed = k_uptime_get() - start;
+
+	/* The first send is not delayed */
+	zassert_true(elapsed >= (PACING_COUNT - 1) * BULK_DATA_LEN *
+		     MSEC_PER_SEC / PACING_RATE,
+		     "Sent too fast (%lld ms)", elapsed);
+
+	ret = net_context_sendto(bulk_ctx, test_data, BULK_DATA_LEN,
+				 (struct sockaddr *)&bulk_addr,
+				 sizeof(bulk_addr), NULL, K_NO_WAIT, NULL);
+	zassert_equal(ret, -EAGAIN, "Send should not be allowed (%d)", ret);
+
+	rate = 0U;
+	ret = net_context_set_option(bulk_ctx, NET_OPT_MAX_PACING_RATE,
+				     &rate, sizeof(rate));
+	zassert_equal(ret, 0, "Cannot clear pacing rate (%d)", ret);
+
+	ret = net_context_sendto(bulk_ctx, test_data, BULK_DATA_LEN,
+				 (struct sockaddr *)&bulk_addr,
+				 sizeof(bulk_addr), NULL, K_NO_WAIT, NULL);
+	zassert_equal(ret, BULK_DATA_LEN, "Send failed (%d)", ret);
+}
+
+static void test_cleanup(void)
+{
+	net_context_put(bulk_ctx);
+	net_context_put(probe_ctx);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tx_fq_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_latency_under_load),
+			 ztest_unit_test(test_large_packets),
+			 ztest_unit_test(test_pacing),
+			 ztest_unit_test(test_cleanup)
+			 );
+
+	ztest_run_test_suite(net_tx_fq_test);
+}
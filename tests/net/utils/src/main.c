@@ -19,6 +19,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_UTILS_LOG_LEVEL);
 #include <device.h>
 #include <init.h>
 #include <sys/printk.h>
+#include <random/rand32.h>
 #include <net/net_core.h>
 #include <net/net_ip.h>
 #include <net/ethernet.h>
@@ -848,11 +849,141 @@ void test_addr_parse(void)
 #endif
 }
 
+/* Straightforward byte pair implementation to compare against */
+static uint16_t ref_chksum(uint16_t sum, const uint8_t *data, size_t len)
+{
+	uint32_t acc = sum;
+	size_t i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		acc += (data[i] << 8) + data[i + 1];
+	}
+
+	if (len % 2) {
+		acc += data[len - 1] << 8;
+	}
+
+	while (acc >> 16) {
+		acc = (acc & 0xffff) + (acc >> 16);
+	}
+
+	return acc;
+}
+
+#define CHKSUM_BUF_LEN 1500
+
+static uint8_t chksum_buf[CHKSUM_BUF_LEN + 8];
+
+void test_chksum(void)
+{
+	size_t offset, len;
+	uint16_t sum, ref;
+	int i;
+
+	for (i = 0; i < sizeof(chksum_buf); i++) {
+		chksum_buf[i] = sys_rand32_get();
+	}
+
+	/* All alignments and lengths around the unrolled loop sizes */
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len < 70; len++) {
+			sum = net_calc_chksum_buf(0x1234, chksum_buf + offset,
+						  len);
+			ref = ref_chksum(0x1234, chksum_buf + offset, len);
+
+			zassert_equal(sum, ref, "Checksum mismatch offset %zu "
+				      "len %zu (0x%04x vs 0x%04x)", offset, len,
+				      sum, ref);
+		}
+	}
+
+	sum = net_calc_chksum_buf(0, chksum_buf + 1, CHKSUM_BUF_LEN);
+	ref = ref_chksum(0, chksum_buf + 1, CHKSUM_BUF_LEN);
+	zassert_equal(sum, ref, "Checksum mismatch for full buffer");
+
+	/* Carries from all 0xff data */
+	memset(chksum_buf, 0xff, sizeof(chksum_buf));
+
+	sum = net_calc_chksum_buf(0xffff, chksum_buf, CHKSUM_BUF_LEN - 1);
+	ref = ref_chksum(0xffff, chksum_buf, CHKSUM_BUF_LEN - 1);
+	zassert_equal(sum, ref, "Checksum mismatch with carries");
+}
+
+void test_chksum_update(void)
+{
+	struct net_ipv4_hdr hdr = {
+		.vhl = 0x45,
+		.len = htons(1500),
+		.id = { 0x12, 0x34 },
+		.offset = { 0x20, 0x00 },
+		.ttl = 64,
+		.proto = IPPROTO_UDP,
+		.src = { { { 192, 0, 2, 1 } } },
+		.dst = { { { 192, 0, 2, 2 } } },
+	};
+	struct in_addr new_addr = { { { 198, 51, 100, 7 } } };
+	uint16_t old_val;
+	uint32_t old_addr;
+
+	hdr.chksum = htons((uint16_t)~net_calc_chksum_buf(0, (uint8_t *)&hdr,
+							  sizeof(hdr)));
+
+	/* Clear the fragment fields as reassembly does */
+	old_val = UNALIGNED_GET((uint16_t *)hdr.offset);
+	hdr.offset[0] = 0U;
+	hdr.chksum = net_chksum_update_u16(hdr.chksum, old_val, 0U);
+
+	zassert_equal(net_calc_chksum_buf(0, (uint8_t *)&hdr, sizeof(hdr)),
+		      0xffff, "Invalid checksum after 16 bit update");
+
+	/* Rewrite the source address */
+	old_addr = UNALIGNED_GET(&hdr.src.s_addr);
+	net_ipaddr_copy(&hdr.src, &new_addr);
+	hdr.chksum = net_chksum_update_u32(hdr.chksum, old_addr,
+					   UNALIGNED_GET(&hdr.src.s_addr));
+
+	zassert_equal(net_calc_chksum_buf(0, (uint8_t *)&hdr, sizeof(hdr)),
+		      0xffff, "Invalid checksum after 32 bit update");
+}
+
+#define CHKSUM_BENCH_ROUNDS 1000
+
+void test_chksum_bench(void)
+{
+	uint64_t ref_ns, opt_ns;
+	uint32_t start;
+	uint16_t sum = 0U;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < CHKSUM_BENCH_ROUNDS; i++) {
+		sum += ref_chksum(0, chksum_buf, CHKSUM_BUF_LEN);
+	}
+
+	ref_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < CHKSUM_BENCH_ROUNDS; i++) {
+		sum += net_calc_chksum_buf(0, chksum_buf, CHKSUM_BUF_LEN);
+	}
+
+	opt_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	TC_PRINT("Checksum of %d x %d bytes: byte pairs %llu ns, "
+		 "words %llu ns (0x%04x)\n", CHKSUM_BENCH_ROUNDS,
+		 CHKSUM_BUF_LEN, ref_ns, opt_ns, sum);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_user_unit_test(test_net_addr),
-			 ztest_unit_test(test_addr_parse));
+			 ztest_unit_test(test_addr_parse),
+			 ztest_unit_test(test_chksum),
+			 ztest_unit_test(test_chksum_update),
+			 ztest_unit_test(test_chksum_bench));
 
 	ztest_run_test_suite(test_utils_fn);
 }